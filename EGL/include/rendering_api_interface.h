@@ -47,7 +47,8 @@ typedef void * api_context_t;
 
 typedef api_state_t (*init_API_cb_t)();
 typedef void (*terminate_API_cb_t)();
-typedef api_context_t (*create_context_cb_t)();
+typedef api_context_t (*create_context_cb_t)(api_context_t share_context);
+typedef void (*make_current_cb_t)(api_context_t api_context);
 typedef void (*set_write_surface_cb_t)(api_context_t api_context, EGLSurfaceInterface *eglSurfaceInterface);
 typedef void (*set_read_surface_cb_t)(api_context_t api_context, EGLSurfaceInterface *eglSurfaceInterface);
 typedef void (*delete_context_cb_t)(api_context_t api_context);
@@ -59,6 +60,7 @@ typedef struct rendering_api_interface {
     init_API_cb_t init_API_cb;
     terminate_API_cb_t terminate_API_cb;
     create_context_cb_t create_context_cb;
+    make_current_cb_t make_current_cb;
     set_write_surface_cb_t set_write_surface_cb;
     set_read_surface_cb_t set_read_surface_cb;
     delete_context_cb_t delete_context_cb;
@@ -83,6 +85,8 @@ typedef struct vkInterface {
     VkDevice                            vkDevice;
     VkPhysicalDeviceMemoryProperties    vkDeviceMemoryProperties;
     vkSyncItems_t                       *vkSyncItems;
+    void                                (*lockQueue)(void);
+    void                                (*unlockQueue)(void);
 } vkInterface_t;
 
 #endif // __RENDERING_API_INTERFACE_H__
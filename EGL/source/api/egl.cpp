@@ -31,16 +31,19 @@
 #endif // DEBUG_DEPTH
 #define DEBUG_DEPTH                          EGL_LOG_INFO
 
-static RenderingThread currentThread;
+/// The current context, the bound API and the last error are per thread state
+static thread_local RenderingThread currentThread;
 
 #define THREAD_EXEC_RETURN(func)             FUN_ENTRY(DEBUG_DEPTH);                                                        \
                                              return currentThread.func;
 
 #define DRIVER_EXEC(display, func)           FUN_ENTRY(DEBUG_DEPTH);                                                        \
+                                             setCallingThread(&currentThread);                                              \
                                              DisplayDriver *eglDriver = DisplayDriversContainer::GetDisplayDriver(display); \
                                              eglDriver->func;
 
 #define DRIVER_EXEC_RETURN(display, func)    FUN_ENTRY(DEBUG_DEPTH);                                                        \
+                                             setCallingThread(&currentThread);                                              \
                                              DisplayDriver *eglDriver = DisplayDriversContainer::GetDisplayDriver(display); \
                                              return eglDriver ? eglDriver->func : 0;
 
@@ -142,7 +145,6 @@ eglDestroyContext(EGLDisplay dpy, EGLContext ctx)
 EGLAPI EGLBoolean EGLAPIENTRY
 eglMakeCurrent(EGLDisplay dpy, EGLSurface draw, EGLSurface read, EGLContext ctx)
 {
-    DRIVER_EXEC(dpy, SetActiveContext(ctx));
     THREAD_EXEC_RETURN(MakeCurrent(dpy, draw, read, ctx));
 }
 
@@ -27,7 +27,8 @@
 
 EGLContext_t::EGLContext_t(EGLenum rendering_api, const EGLint *attribList)
 : mAPIContext(nullptr), mRenderingAPI(rendering_api), mAPIInterface(nullptr),
-mDisplay(EGL_NO_DISPLAY), mReadSurface(EGL_NO_SURFACE), mDrawSurface(EGL_NO_SURFACE)
+mDisplay(EGL_NO_DISPLAY), mReadSurface(EGL_NO_SURFACE), mDrawSurface(EGL_NO_SURFACE),
+mBoundThread(nullptr), mDestroyPending(false)
 {
     FUN_ENTRY(EGL_LOG_TRACE);
 
@@ -52,7 +53,7 @@ EGLContext_t::GetClientVersionFromConfig(const EGLint *attribList)
 }
 
 EGLBoolean
-EGLContext_t::CreateRenderingContext()
+EGLContext_t::CreateRenderingContext(EGLContext_t *shareContext)
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
@@ -62,7 +63,7 @@ EGLContext_t::CreateRenderingContext()
         return EGL_FALSE;
     }
 
-    mAPIContext = mAPIInterface->create_context_cb();
+    mAPIContext = mAPIInterface->create_context_cb(shareContext ? shareContext->GetAPIContext() : nullptr);
 
     if(!mAPIContext) {
         return EGL_FALSE;
@@ -94,20 +95,18 @@ EGLContext_t::MakeCurrent(EGLDisplay dpy, EGLSurface draw, EGLSurface read)
     //TODO: Include Error Handling in Final implementation
     mDisplay = dpy;
 
-    EGLSurface_t *drawSurface = static_cast<EGLSurface_t *>(draw);
-
-    // TODO: support correct construction/destruction of pbuffers
-    if (drawSurface->GetType() != EGL_WINDOW_BIT) {
-        return EGL_TRUE;
-    }
+    /// Commands of the API are issued to the context that is current on the calling thread
+    mAPIInterface->make_current_cb(mAPIContext);
 
-    if(drawSurface) {
+    /// Rebinding the same surfaces keeps the framebuffers of the context
+    EGLSurface_t *drawSurface = static_cast<EGLSurface_t *>(draw);
+    if(drawSurface && draw != mDrawSurface) {
         mDrawSurface = draw;
         mAPIInterface->set_write_surface_cb(mAPIContext, drawSurface->GetEGLSurfaceInterface());
     }
 
     EGLSurface_t *readSurface = static_cast<EGLSurface_t *>(read);
-    if(readSurface) {
+    if(readSurface && read != mReadSurface) {
         mReadSurface = read;
         mAPIInterface->set_read_surface_cb(mAPIContext, readSurface->GetEGLSurfaceInterface());
     }
@@ -115,6 +114,20 @@ EGLContext_t::MakeCurrent(EGLDisplay dpy, EGLSurface draw, EGLSurface read)
     return EGL_TRUE;
 }
 
+void
+EGLContext_t::Release()
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    /// Work of a context that is no longer current is flushed, as required by eglMakeCurrent()
+    mAPIInterface->finish_cb(mAPIContext);
+    mAPIInterface->make_current_cb(nullptr);
+
+    /// Surfaces may be destroyed once released, so they are bound again on the next MakeCurrent()
+    mDrawSurface = EGL_NO_SURFACE;
+    mReadSurface = EGL_NO_SURFACE;
+}
+
 void
 EGLContext_t::SetNextImageIndex(uint32_t index)
 {
@@ -44,6 +44,11 @@ private:
     EGLSurface                   mReadSurface;
     EGLSurface                   mDrawSurface;
 
+    /// The rendering thread the context is current on, if any
+    const void                  *mBoundThread;
+    /// eglDestroyContext() was called while the context was current
+    bool                         mDestroyPending;
+
     EGLenum                      GetClientVersionFromConfig(const EGLint *attribList);
 
 public:
@@ -53,10 +58,17 @@ public:
     EGLDisplay                   getDisplay()                             const { FUN_ENTRY(EGL_LOG_TRACE); return mDisplay; }
     EGLSurface                   getReadSurface()                         const { FUN_ENTRY(EGL_LOG_TRACE); return mReadSurface; }
     EGLSurface                   getDrawSurface()                         const { FUN_ENTRY(EGL_LOG_TRACE); return mDrawSurface; }
+    api_context_t                GetAPIContext()                          const { FUN_ENTRY(EGL_LOG_TRACE); return mAPIContext; }
+    const void                  *GetBoundThread()                         const { FUN_ENTRY(EGL_LOG_TRACE); return mBoundThread; }
+    bool                         IsDestroyPending()                       const { FUN_ENTRY(EGL_LOG_TRACE); return mDestroyPending; }
+
+    void                         SetBoundThread(const void *thread)             { FUN_ENTRY(EGL_LOG_TRACE); mBoundThread = thread; }
+    void                         SetDestroyPending(bool pending)                { FUN_ENTRY(EGL_LOG_TRACE); mDestroyPending = pending; }
 
-    EGLBoolean                   CreateRenderingContext();
+    EGLBoolean                   CreateRenderingContext(EGLContext_t *shareContext);
     EGLBoolean                   DestroyRenderingContext();
     EGLBoolean                   MakeCurrent(EGLDisplay dpy, EGLSurface draw, EGLSurface read);
+    void                         Release();
     void                         SetNextImageIndex(uint32_t index);
     void                         Finish();
 
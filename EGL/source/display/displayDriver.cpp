@@ -33,12 +33,12 @@
 #define EGL_VERSION_MAJOR   1
 #define EGL_VERSION_MINOR   4
 
-RenderingThread *callingThread = nullptr;
+thread_local RenderingThread *callingThread = nullptr;
 
 void setCallingThread(RenderingThread *thread) { callingThread = thread; }
 
 DisplayDriver::DisplayDriver(void)
-: mDisplay(nullptr), mActiveContext(nullptr), mWindowInterface(nullptr)
+: mDisplay(nullptr), mWindowInterface(nullptr)
 {
     FUN_ENTRY(EGL_LOG_TRACE);
 }
@@ -350,14 +350,20 @@ DisplayDriver::SwapBuffers(EGLDisplay dpy, EGLSurface surface)
         return EGL_TRUE;
     }
 
-    mActiveContext->Finish();
+    EGLContext_t *activeContext = static_cast<EGLContext_t *>(callingThread->GetCurrentContext());
+    if(activeContext == nullptr || activeContext->getDrawSurface() != surface) {
+        callingThread->RecordError(EGL_BAD_SURFACE);
+        return EGL_FALSE;
+    }
+
+    activeContext->Finish();
 
     if(EGL_FALSE == mWindowInterface->PresentImage(eglSurface)) {
         return EGL_FALSE;
     }
 
     imageIndex = mWindowInterface->AcquireNextImage(eglSurface);
-    mActiveContext->SetNextImageIndex(imageIndex);
+    activeContext->SetNextImageIndex(imageIndex);
 
     return EGL_TRUE;
 }
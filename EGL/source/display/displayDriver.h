@@ -43,7 +43,6 @@ void setCallingThread(RenderingThread *thread);
 class DisplayDriver {
 private:
     EGLDisplay                   mDisplay;
-    EGLContext_t                *mActiveContext;
     PlatformWindowInterface     *mWindowInterface;
 
     EGLImageKHR                  CreateImageNativeBufferAndroid(EGLDisplay dpy, EGLContext ctx, EGLenum target, EGLClientBuffer buffer, const EGLint *attrib_list);
@@ -57,7 +56,6 @@ public:
 
     inline EGLDisplay            GetDisplay()                                   { FUN_ENTRY(EGL_LOG_TRACE); return mDisplay; }
     inline void                  SetDisplay(EGLDisplay display)                 { FUN_ENTRY(EGL_LOG_TRACE); mDisplay = display; }
-    inline void                  SetActiveContext(EGLContext ctx)               { FUN_ENTRY(EGL_LOG_TRACE); mActiveContext = static_cast<EGLContext_t *>(ctx); }
 
     /// EGL API core functions
     EGLBoolean                   Initialize(EGLDisplay dpy, EGLint *major, EGLint *minor);
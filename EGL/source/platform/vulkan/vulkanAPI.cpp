@@ -209,7 +209,10 @@ VulkanAPI::PresentImage(const VulkanResources *vkResources, uint32_t imageIndex,
     presentInfo.pImageIndices       = &imageIndex;
     presentInfo.pResults            = NULL;
 
+    /// The queue is shared with the submissions of the rendering contexts
+    mVkInterface->lockQueue();
     VkResult res = mWsiCallbacks->fpQueuePresentKHR(mVkInterface->vkQueue, &presentInfo);
+    mVkInterface->unlockQueue();
 
     if(res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_SUBOPTIMAL_KHR) {
         assert(0);
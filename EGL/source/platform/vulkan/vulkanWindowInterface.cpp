@@ -299,6 +299,11 @@ VulkanWindowInterface::DestroySurfaceImages(EGLSurface_t *eglSurface)
     }
 
     if(vkResources->GetSwapchain() != VK_NULL_HANDLE) {
+        /// Frames rendered to the swapchain images may still be in flight
+        mVkInterface->lockQueue();
+        vkQueueWaitIdle(mVkInterface->vkQueue);
+        mVkInterface->unlockQueue();
+
         mVkAPI->DestroySwapchain(vkResources);
         vkResources->SetSwapchain(VK_NULL_HANDLE);
     }
@@ -42,8 +42,10 @@ const char * const RenderingThread::EGLErrors[] = {   "EGL_SUCCESS",
                                                       "EGL_CONTEXT_LOST"};
 
 
+std::mutex RenderingThread::mBindMutex;
+
 RenderingThread::RenderingThread()
-: mLastError(EGL_SUCCESS)
+: mCurrentAPI(EGL_OPENGL_ES_API), mGLESCurrentContext(nullptr), mVGCurrentContext(nullptr), mLastError(EGL_SUCCESS)
 {
     FUN_ENTRY(EGL_LOG_TRACE);
 }
@@ -116,9 +118,49 @@ RenderingThread::ReleaseThread(void)
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
-    NOT_IMPLEMENTED();
+    ReleaseCurrentContext();
+    mCurrentAPI = EGL_OPENGL_ES_API;
+    mLastError  = EGL_SUCCESS;
 
-    return EGL_FALSE;
+    return EGL_TRUE;
+}
+
+EGLContext_t **
+RenderingThread::GetCurrentContextSlot(void)
+{
+    FUN_ENTRY(EGL_LOG_TRACE);
+
+    switch(mCurrentAPI) {
+        case EGL_OPENGL_ES_API:    return &mGLESCurrentContext; break;
+        case EGL_OPENVG_API:       return &mVGCurrentContext; break;
+        default:                   return nullptr;
+    }
+}
+
+void
+RenderingThread::ReleaseCurrentContext(void)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    EGLContext_t **currentContext = GetCurrentContextSlot();
+    if(!currentContext || !*currentContext) {
+        return;
+    }
+
+    EGLContext_t *eglContext = *currentContext;
+    *currentContext = nullptr;
+
+    eglContext->Release();
+    {
+        std::lock_guard<std::mutex> lock(mBindMutex);
+        eglContext->SetBoundThread(nullptr);
+    }
+
+    /// Contexts destroyed while current are deleted once they are released
+    if(eglContext->IsDestroyPending()) {
+        eglContext->DestroyRenderingContext();
+        delete eglContext;
+    }
 }
 
 EGLContext
@@ -170,9 +212,15 @@ RenderingThread::CreateContext(EGLDisplay dpy, EGLConfig config, EGLContext shar
 {
     FUN_ENTRY(EGL_LOG_TRACE);
 
+    EGLContext_t *shareContext = static_cast<EGLContext_t *>(share_context);
+    if(shareContext && shareContext->IsDestroyPending()) {
+        RecordError(EGL_BAD_CONTEXT);
+        return nullptr;
+    }
+
     EGLContext_t *eglContext = new EGLContext_t(mCurrentAPI, attrib_list);
 
-    if(EGL_FALSE == eglContext->CreateRenderingContext()) {
+    if(EGL_FALSE == eglContext->CreateRenderingContext(shareContext)) {
         delete eglContext;
         return nullptr;
     }
@@ -192,6 +240,15 @@ RenderingThread::DestroyContext(EGLDisplay dpy, EGLContext ctx)
         return EGL_FALSE;
     }
 
+    /// A context that is current to some thread is deleted when it is released
+    {
+        std::lock_guard<std::mutex> lock(mBindMutex);
+        if(eglContext->GetBoundThread()) {
+            eglContext->SetDestroyPending(true);
+            return EGL_TRUE;
+        }
+    }
+
     if(EGL_FALSE == eglContext->DestroyRenderingContext()) {
         return EGL_FALSE;
     }
@@ -215,37 +272,60 @@ RenderingThread::MakeCurrent(EGLDisplay dpy, EGLSurface draw, EGLSurface read, E
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
-    if(!ctx) {
-        return EGL_FALSE;
-    }
-
     EGLContext_t *eglContext = static_cast<EGLContext_t *>(ctx);
-    assert(eglContext);
-    if(eglContext == nullptr) {
-        RecordError(EGL_BAD_CONTEXT);
-        return EGL_FALSE;
-    }
     EGLSurface_t *drawSurface = static_cast<EGLSurface_t *>(draw);
     EGLSurface_t *readSurface = static_cast<EGLSurface_t *>(read);
 
+    /// Releasing the current context of the thread
+    if(eglContext == nullptr) {
+        if(drawSurface != nullptr || readSurface != nullptr) {
+            RecordError(EGL_BAD_MATCH);
+            return EGL_FALSE;
+        }
+
+        ReleaseCurrentContext();
+        return EGL_TRUE;
+    }
+
     if (drawSurface == nullptr || readSurface == nullptr) {
         RecordError(EGL_BAD_SURFACE);
         return EGL_FALSE;
     }
 
-    if(eglContext->MakeCurrent(dpy, draw, read) != EGL_TRUE) {
+    EGLContext_t **currentContext = GetCurrentContextSlot();
+    if(!currentContext) {
+        RecordError(EGL_BAD_MATCH);
         return EGL_FALSE;
     }
 
-    switch(mCurrentAPI) {
-        case EGL_OPENGL_ES_API:
-            mGLESCurrentContext = eglContext;
-            break;
-        case EGL_OPENVG_API:
-            mVGCurrentContext = eglContext;
-            break;
+    {
+        std::lock_guard<std::mutex> lock(mBindMutex);
+        if(eglContext->IsDestroyPending()) {
+            RecordError(EGL_BAD_CONTEXT);
+            return EGL_FALSE;
+        }
+
+        if(eglContext->GetBoundThread() && eglContext->GetBoundThread() != this) {
+            RecordError(EGL_BAD_ACCESS);
+            return EGL_FALSE;
+        }
+
+        eglContext->SetBoundThread(this);
     }
 
+    if(*currentContext != eglContext) {
+        ReleaseCurrentContext();
+    }
+
+    if(eglContext->MakeCurrent(dpy, draw, read) != EGL_TRUE) {
+        *currentContext = nullptr;
+        std::lock_guard<std::mutex> lock(mBindMutex);
+        eglContext->SetBoundThread(nullptr);
+        return EGL_FALSE;
+    }
+
+    *currentContext = eglContext;
+
     return EGL_TRUE;
 }
 
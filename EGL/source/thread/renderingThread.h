@@ -27,6 +27,7 @@
 #include "api/eglContext.h"
 #include "EGL/egl.h"
 #include "EGL/eglext.h"
+#include <mutex>
 
 class RenderingThread {
 private:
@@ -37,6 +38,12 @@ private:
     EGLContext_t           *mVGCurrentContext;
     EGLint                  mLastError;
 
+    /// Guards binding contexts to threads, as a context may be current to one thread at a time
+    static std::mutex       mBindMutex;
+
+    EGLContext_t          **GetCurrentContextSlot(void);
+    void                    ReleaseCurrentContext(void);
+
 public:
     RenderingThread(void);
     ~RenderingThread(void) { }
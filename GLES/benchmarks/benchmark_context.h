@@ -0,0 +1,125 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       benchmark_context.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Pbuffer Surfaces, Contexts and Programs of the GLES Benchmarks
+ *
+ */
+
+#ifndef __BENCHMARK_CONTEXT_H__
+#define __BENCHMARK_CONTEXT_H__
+
+#include "EGL/egl.h"
+#include "GLES2/gl2.h"
+
+typedef struct benchmarkContext_t {
+    EGLDisplay display;
+    EGLSurface surface;
+    EGLContext context;
+} benchmarkContext_t;
+
+static inline bool
+CreateBenchmarkContext(benchmarkContext_t *benchmarkContext, EGLint width, EGLint height)
+{
+    static const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+        EGL_RED_SIZE,        8,
+        EGL_GREEN_SIZE,      8,
+        EGL_BLUE_SIZE,       8,
+        EGL_ALPHA_SIZE,      8,
+        EGL_NONE
+    };
+    static const EGLint contextAttribs[] = { EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE };
+    const EGLint surfaceAttribs[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+
+    benchmarkContext->display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if(benchmarkContext->display == EGL_NO_DISPLAY || !eglInitialize(benchmarkContext->display, NULL, NULL)) {
+        return false;
+    }
+
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if(!eglChooseConfig(benchmarkContext->display, configAttribs, &config, 1, &numConfigs) || !numConfigs) {
+        return false;
+    }
+
+    benchmarkContext->surface = eglCreatePbufferSurface(benchmarkContext->display, config, surfaceAttribs);
+    benchmarkContext->context = eglCreateContext(benchmarkContext->display, config, EGL_NO_CONTEXT, contextAttribs);
+
+    return benchmarkContext->surface != EGL_NO_SURFACE && benchmarkContext->context != EGL_NO_CONTEXT &&
+           eglMakeCurrent(benchmarkContext->display, benchmarkContext->surface, benchmarkContext->surface, benchmarkContext->context);
+}
+
+static inline void
+DestroyBenchmarkContext(benchmarkContext_t *benchmarkContext)
+{
+    eglMakeCurrent(benchmarkContext->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(benchmarkContext->display, benchmarkContext->context);
+    eglDestroySurface(benchmarkContext->display, benchmarkContext->surface);
+    eglTerminate(benchmarkContext->display);
+}
+
+static inline GLuint
+CreateBenchmarkShader(GLenum type, const char *source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if(status != GL_TRUE) {
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    return shader;
+}
+
+// the position attribute is bound to location 0, the shaders are flagged for deletion with the program
+static inline GLuint
+CreateBenchmarkProgram(const char *vertexShaderSource, const char *fragmentShaderSource)
+{
+    GLuint vertexShader   = CreateBenchmarkShader(GL_VERTEX_SHADER,   vertexShaderSource);
+    GLuint fragmentShader = CreateBenchmarkShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+    if(!vertexShader || !fragmentShader) {
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glBindAttribLocation(program, 0, "aPosition");
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if(status != GL_TRUE) {
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+#endif // __BENCHMARK_CONTEXT_H__
@@ -0,0 +1,112 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       pixel_conversion_benchmark.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Throughput of the Pixel Convertion Row Kernels
+ *
+ *  @scope
+ *
+ *  Converts a 1024x1024 image with every row kernel, for every instruction
+ *  set supported by the CPU, and reports the throughput in GB/s of source
+ *  and destination bytes. The output of every kernel is checked against the
+ *  scalar kernel first.
+ *
+ */
+
+#include "utils/pixelKernels.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static const uint32_t imageWidth  = 1024;
+static const uint32_t imageHeight = 1024;
+static const uint32_t iterations  = 20;
+
+static const uint32_t srcPixelSizes[PIXEL_KERNEL_MAX] = { 4, 3, 4, 1, 2, 1, 2, 2, 2 };
+static const uint32_t dstPixelSizes[PIXEL_KERNEL_MAX] = { 4, 4, 3, 4, 4, 4, 4, 4, 4 };
+
+static bool
+Validate(pixelKernel_t kernel, pixelRowKernel_t rowKernel, const uint8_t *src)
+{
+    const pixelRowKernel_t scalarKernel = GetPixelRowKernel(kernel, PIXEL_KERNEL_ISA_SCALAR);
+
+    // odd widths exercise the tails of the vectorized kernels
+    for(uint32_t width = 1; width <= 67; ++width) {
+        std::vector<uint8_t> expected(width * dstPixelSizes[kernel] + 1, 0xCD);
+        std::vector<uint8_t> result(width * dstPixelSizes[kernel] + 1, 0xCD);
+        scalarKernel(src, expected.data(), width);
+        rowKernel(src, result.data(), width);
+        if(memcmp(expected.data(), result.data(), expected.size())) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int
+main(void)
+{
+    std::vector<uint8_t> src(imageWidth * imageHeight * 4);
+    std::vector<uint8_t> dst(imageWidth * imageHeight * 4);
+    for(size_t i = 0; i < src.size(); ++i) {
+        src[i] = static_cast<uint8_t>(rand());
+    }
+
+    const pixelKernelIsa_t cpuIsa = GetPixelKernelIsa();
+    printf("Selected instruction set: %s\n\n", GetPixelKernelIsaName(cpuIsa));
+    printf("%-24s %-8s %10s\n", "Conversion", "ISA", "GB/s");
+
+    int failures = 0;
+    for(int k = 0; k < PIXEL_KERNEL_MAX; ++k) {
+        const pixelKernel_t kernel = static_cast<pixelKernel_t>(k);
+
+        for(int i = 0; i < PIXEL_KERNEL_ISA_MAX; ++i) {
+            const pixelKernelIsa_t isa = static_cast<pixelKernelIsa_t>(i);
+            const pixelRowKernel_t rowKernel = GetPixelRowKernel(kernel, isa);
+            if(!rowKernel) {
+                continue;
+            }
+
+            if(!Validate(kernel, rowKernel, src.data())) {
+                printf("%-24s %-8s %10s\n", GetPixelKernelName(kernel), GetPixelKernelIsaName(isa), "MISMATCH");
+                ++failures;
+                continue;
+            }
+
+            const uint32_t srcRowStride = imageWidth * srcPixelSizes[kernel];
+            const uint32_t dstRowStride = imageWidth * dstPixelSizes[kernel];
+
+            const auto start = std::chrono::steady_clock::now();
+            for(uint32_t it = 0; it < iterations; ++it) {
+                for(uint32_t row = 0; row < imageHeight; ++row) {
+                    rowKernel(&src[row * srcRowStride], &dst[row * dstRowStride], imageWidth);
+                }
+            }
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            const double bytes = static_cast<double>(srcRowStride + dstRowStride) * imageHeight * iterations;
+            printf("%-24s %-8s %10.2f\n", GetPixelKernelName(kernel), GetPixelKernelIsaName(isa), bytes / elapsed.count() / 1e9);
+        }
+    }
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,170 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       texture_atlas_benchmark.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Throughput of Glyph Updates to a Texture Atlas
+ *
+ *  @scope
+ *
+ *  Renders into a pbuffer surface from a 2048x2048 RGBA atlas, the way text
+ *  renderers do: every frame updates a number of 16x16 glyphs with
+ *  glTexSubImage2D and draws with the atlas after each update. Reports the
+ *  glyph updates per second and the frame time, next to the cost of
+ *  specifying the whole atlas again with glTexImage2D. The last glyph is
+ *  read back through a draw to check that the updates reached the atlas.
+ *
+ */
+
+#include "benchmark_context.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static const GLsizei  atlasSize      = 2048;
+static const GLsizei  glyphSize      = 16;
+static const GLsizei  surfaceSize    = 64;
+static const uint32_t frames         = 200;
+static const uint32_t glyphsPerFrame = 64;
+static const uint32_t respecifyCount = 10;
+
+static const char *vertexShaderSource =
+    "attribute vec2 aPosition;\n"
+    "uniform vec4 uTexRect;\n"
+    "varying vec2 vTexCoord;\n"
+    "void main() {\n"
+    "    vTexCoord   = uTexRect.xy + (aPosition * 0.5 + 0.5) * uTexRect.zw;\n"
+    "    gl_Position = vec4(aPosition, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *fragmentShaderSource =
+    "precision mediump float;\n"
+    "uniform sampler2D uAtlas;\n"
+    "varying vec2 vTexCoord;\n"
+    "void main() {\n"
+    "    gl_FragColor = texture2D(uAtlas, vTexCoord);\n"
+    "}\n";
+
+static const GLfloat quad[] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+
+static void
+GlyphColor(uint32_t glyph, uint8_t *color)
+{
+    color[0] = static_cast<uint8_t>(glyph * 37);
+    color[1] = static_cast<uint8_t>(glyph * 91 + 17);
+    color[2] = static_cast<uint8_t>(glyph * 53 + 101);
+    color[3] = 255;
+}
+
+int
+main(void)
+{
+    benchmarkContext_t benchmarkContext;
+    if(!CreateBenchmarkContext(&benchmarkContext, surfaceSize, surfaceSize)) {
+        printf("Failed to create a pbuffer surface and an OpenGL ES 2.0 context\n");
+        return EXIT_FAILURE;
+    }
+
+    GLuint program = CreateBenchmarkProgram(vertexShaderSource, fragmentShaderSource);
+    if(!program) {
+        printf("Failed to build the program\n");
+        return EXIT_FAILURE;
+    }
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "uAtlas"), 0);
+    const GLint texRectLocation = glGetUniformLocation(program, "uTexRect");
+
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, quad);
+    glEnableVertexAttribArray(0);
+    glViewport(0, 0, surfaceSize, surfaceSize);
+
+    std::vector<uint8_t> atlas(atlasSize * atlasSize * 4, 0);
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlasSize, atlasSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, atlas.data());
+    glUniform4f(texRectLocation, 0.0f, 0.0f, 1.0f, 1.0f);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glFinish();
+
+    // glyphs are written to consecutive cells of the atlas, as a glyph cache fills up
+    const uint32_t cellsPerRow = atlasSize / glyphSize;
+    const uint32_t cells       = cellsPerRow * cellsPerRow;
+    std::vector<uint8_t> glyphs(glyphsPerFrame * glyphSize * glyphSize * 4);
+
+    uint32_t glyph = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for(uint32_t frame = 0; frame < frames; ++frame) {
+        for(uint32_t i = 0; i < glyphsPerFrame; ++i, ++glyph) {
+            uint8_t *pixels = &glyphs[i * glyphSize * glyphSize * 4];
+            uint8_t color[4];
+            GlyphColor(glyph, color);
+            for(GLsizei p = 0; p < glyphSize * glyphSize; ++p) {
+                memcpy(&pixels[p * 4], color, sizeof(color));
+            }
+
+            const uint32_t cell = glyph % cells;
+            glTexSubImage2D(GL_TEXTURE_2D, 0, (cell % cellsPerRow) * glyphSize, (cell / cellsPerRow) * glyphSize,
+                            glyphSize, glyphSize, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        }
+        eglSwapBuffers(benchmarkContext.display, benchmarkContext.surface);
+    }
+    glFinish();
+    const std::chrono::duration<double> updateElapsed = std::chrono::steady_clock::now() - start;
+
+    // sample only the last glyph, all the pixels of the surface must have its color
+    const uint32_t lastCell = (glyph - 1) % cells;
+    glUniform4f(texRectLocation, static_cast<float>((lastCell % cellsPerRow) * glyphSize) / atlasSize,
+                                 static_cast<float>((lastCell / cellsPerRow) * glyphSize) / atlasSize,
+                                 static_cast<float>(glyphSize) / atlasSize,
+                                 static_cast<float>(glyphSize) / atlasSize);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    uint8_t result[4];
+    uint8_t expected[4];
+    GlyphColor(glyph - 1, expected);
+    glReadPixels(surfaceSize / 2, surfaceSize / 2, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, result);
+    const bool valid = !memcmp(result, expected, sizeof(expected));
+
+    const auto respecifyStart = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < respecifyCount; ++i) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlasSize, atlasSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, atlas.data());
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+    glFinish();
+    const std::chrono::duration<double> respecifyElapsed = std::chrono::steady_clock::now() - respecifyStart;
+
+    const double updates = static_cast<double>(frames) * glyphsPerFrame;
+    printf("Atlas %dx%d, %u frames of %u %dx%d glyph updates\n\n", atlasSize, atlasSize, frames, glyphsPerFrame, glyphSize, glyphSize);
+    printf("%-32s %12.0f\n",   "glTexSubImage2D updates/s",   updates / updateElapsed.count());
+    printf("%-32s %12.2f\n",   "glTexSubImage2D MB/s",        updates * glyphSize * glyphSize * 4 / updateElapsed.count() / 1e6);
+    printf("%-32s %12.3f\n",   "Frame time (ms)",             updateElapsed.count() * 1e3 / frames);
+    printf("%-32s %12.3f\n",   "glTexImage2D atlas (ms)",     respecifyElapsed.count() * 1e3 / respecifyCount);
+    printf("%-32s %12s\n",     "Last glyph",                  valid ? "OK" : "MISMATCH");
+
+    glDeleteTextures(1, &texture);
+    glDeleteProgram(program);
+    DestroyBenchmarkContext(&benchmarkContext);
+
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,137 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       texture_sampling_benchmark.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Throughput of Sampling a Large Texture
+ *
+ *  @scope
+ *
+ *  Fills a 1024x1024 pbuffer surface with full screen quads that sample a
+ *  1024x1024 RGBA texture with bilinear filtering, rotated by a different
+ *  angle on every draw, so that texels are fetched along rows as well as
+ *  along columns. Reports the sampled fragments per second.
+ *
+ *  Textures of that size use optimal tiling, unless the environment variable
+ *  GLOVE_LINEAR_TEXTURE_MAX_TEXELS is set to at least 1048576. Running the
+ *  benchmark with and without it compares the two layouts.
+ *
+ */
+
+#include "benchmark_context.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+static const GLsizei  textureSize = 1024;
+static const GLsizei  surfaceSize = 1024;
+static const uint32_t warmupDraws = 10;
+static const uint32_t draws       = 200;
+
+static const char *vertexShaderSource =
+    "attribute vec2 aPosition;\n"
+    "uniform mat2 uRotation;\n"
+    "varying vec2 vTexCoord;\n"
+    "void main() {\n"
+    "    vTexCoord   = uRotation * aPosition * 0.5 + 0.5;\n"
+    "    gl_Position = vec4(aPosition, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *fragmentShaderSource =
+    "precision mediump float;\n"
+    "uniform sampler2D uTexture;\n"
+    "varying vec2 vTexCoord;\n"
+    "void main() {\n"
+    "    gl_FragColor = texture2D(uTexture, vTexCoord);\n"
+    "}\n";
+
+static const GLfloat quad[] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+
+static void
+Draw(GLint rotationLocation, uint32_t draw)
+{
+    const float angle = static_cast<float>(draw) * 0.1f;
+    const GLfloat rotation[] = { cosf(angle), sinf(angle), -sinf(angle), cosf(angle) };
+
+    glUniformMatrix2fv(rotationLocation, 1, GL_FALSE, rotation);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
+
+int
+main(void)
+{
+    benchmarkContext_t benchmarkContext;
+    if(!CreateBenchmarkContext(&benchmarkContext, surfaceSize, surfaceSize)) {
+        printf("Failed to create a pbuffer surface and an OpenGL ES 2.0 context\n");
+        return EXIT_FAILURE;
+    }
+
+    GLuint program = CreateBenchmarkProgram(vertexShaderSource, fragmentShaderSource);
+    if(!program) {
+        printf("Failed to build the program\n");
+        return EXIT_FAILURE;
+    }
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "uTexture"), 0);
+    const GLint rotationLocation = glGetUniformLocation(program, "uRotation");
+
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, quad);
+    glEnableVertexAttribArray(0);
+    glViewport(0, 0, surfaceSize, surfaceSize);
+
+    std::vector<uint8_t> pixels(textureSize * textureSize * 4);
+    for(size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = static_cast<uint8_t>(rand());
+    }
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, textureSize, textureSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+    for(uint32_t i = 0; i < warmupDraws; ++i) {
+        Draw(rotationLocation, i);
+    }
+    glFinish();
+
+    const auto start = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < draws; ++i) {
+        Draw(rotationLocation, i);
+    }
+    glFinish();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const char *maxTexels = getenv("GLOVE_LINEAR_TEXTURE_MAX_TEXELS");
+    const double fragments = static_cast<double>(surfaceSize) * surfaceSize * draws;
+    printf("Texture %dx%d, %u draws to a %dx%d surface\n", textureSize, textureSize, draws, surfaceSize, surfaceSize);
+    printf("GLOVE_LINEAR_TEXTURE_MAX_TEXELS: %s\n\n", maxTexels ? maxTexels : "default");
+    printf("%-32s %12.2f\n", "Sampled Mfragments/s", fragments / elapsed.count() / 1e6);
+    printf("%-32s %12.3f\n", "Draw time (ms)",       elapsed.count() * 1e3 / draws);
+
+    glDeleteTextures(1, &texture);
+    glDeleteProgram(program);
+    DestroyBenchmarkContext(&benchmarkContext);
+
+    return EXIT_SUCCESS;
+}
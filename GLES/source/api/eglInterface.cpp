@@ -29,7 +29,8 @@ api_state_t           gles2_state = nullptr;
 
 api_state_t           init_API();
           void        terminate_API();
-api_context_t         create_context();
+api_context_t         create_context(api_context_t share_context);
+void                  make_current(api_context_t api_context);
 void                  set_write_surface(api_context_t api_context, EGLSurfaceInterface *eglSurfaceInterface);
 void                  set_read_surface(api_context_t api_context, EGLSurfaceInterface *eglSurfaceInterface);
 void                  delete_context(api_context_t api_context);
@@ -37,12 +38,15 @@ void                  set_next_image_index(api_context_t api_context, uint32_t i
 void                  finish(api_context_t api_context);
 
 static void           FillInVkInterface(vkContext_t* vkContext);
+static void           LockVkQueue(void);
+static void           UnlockVkQueue(void);
 
 rendering_api_interface_t GLES2Interface = {
     gles2_state,
     init_API,
     terminate_API,
     create_context,
+    make_current,
     set_write_surface,
     set_read_surface,
     delete_context,
@@ -59,6 +63,19 @@ static void FillInVkInterface(vkContext_t* vkContext)
     vkInterface.vkDeviceMemoryProperties = vkContext->vkDeviceMemoryProperties;
     vkInterface.vkDevice = vkContext->vkDevice;
     vkInterface.vkSyncItems = vkContext->vkSyncItems;
+    vkInterface.lockQueue = LockVkQueue;
+    vkInterface.unlockQueue = UnlockVkQueue;
+}
+
+/// Presentation shares vkQueue with the submissions of all contexts
+static void LockVkQueue(void)
+{
+    vulkanAPI::GetContext()->mQueueMutex.lock();
+}
+
+static void UnlockVkQueue(void)
+{
+    vulkanAPI::GetContext()->mQueueMutex.unlock();
 }
 
 api_state_t init_API()
@@ -80,22 +97,33 @@ void terminate_API()
 
 }
 
-api_context_t create_context()
+api_context_t create_context(api_context_t share_context)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    Context *ctx = new Context();
+    Context *ctx = new Context(reinterpret_cast<Context *>(share_context));
+    if(!ctx->IsCreated()) {
+        delete ctx;
+        return nullptr;
+    }
+
     return ctx;
 }
 
+void make_current(api_context_t api_context)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// A null context releases the current context of the calling thread
+    SetCurrentContext(reinterpret_cast<Context *>(api_context));
+}
+
 void set_write_surface(api_context_t api_context, EGLSurfaceInterface *eglSurfaceInterface)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
     Context *ctx = reinterpret_cast<Context *>(api_context);
     ctx->SetWriteSurface(eglSurfaceInterface);
-
-    SetCurrentContext(ctx);
 }
 
 void set_read_surface(api_context_t api_context, EGLSurfaceInterface *eglSurfaceInterface)
@@ -104,8 +132,6 @@ void set_read_surface(api_context_t api_context, EGLSurfaceInterface *eglSurface
 
     Context *ctx = reinterpret_cast<Context *>(api_context);
     ctx->SetReadSurface(eglSurfaceInterface);
-
-    SetCurrentContext(ctx);
 }
 
 void delete_context(api_context_t api_context)
@@ -128,6 +154,12 @@ void finish(api_context_t api_context)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    /// Contexts may be finished while they are not current on the calling thread
     Context *ctx = reinterpret_cast<Context *>(api_context);
-    ctx->Finish();
+    Context *previousContext = GetCurrentContext();
+    SetCurrentContext(ctx);
+
+    ctx->FinishFrame();
+
+    SetCurrentContext(previousContext);
 }
@@ -924,3 +924,8 @@ GL_APICALL void GL_APIENTRY glProgramBinaryOES(GLuint program, GLenum binaryForm
 {
     CONTEXT_EXEC(ProgramBinaryOES(program, binaryFormat, binary, length));
 }
+
+GL_APICALL void GL_APIENTRY glMaxShaderCompilerThreadsKHR(GLuint count)
+{
+    CONTEXT_EXEC(MaxShaderCompilerThreadsKHR(count));
+}
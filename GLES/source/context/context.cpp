@@ -19,12 +19,25 @@
  *
  *  @brief      Default Context and Resources Initialization
  *
+ *  @section
+ *
+ *  Each thread has its own current context. Every context records its
+ *  commands and batches its uploads on its own, so the command buffer
+ *  manager and the upload queue of the current context are published to the
+ *  Vulkan objects through thread local pointers. Contexts of the same share
+ *  group hold a reference to a common resource manager.
+ *
  */
 
 #include "context.h"
 #include "utils/VkToGlConverter.h"
 
-static Context *currentContext = nullptr;
+static thread_local Context *currentContext = nullptr;
+
+/// The shader cache is shared by all contexts, created with the first one and destroyed with the last one
+static std::mutex   shaderCacheMutex;
+static ShaderCache *shaderCache         = nullptr;
+static uint32_t     shaderCacheRefCount = 0;
 
 Context *GetCurrentContext()
 {
@@ -38,18 +51,121 @@ void SetCurrentContext(Context *ctx)
     FUN_ENTRY(GL_LOG_TRACE);
 
     currentContext = ctx;
+
+    vkContext_t::mCommandBufferManager = ctx ? ctx->GetCommandBufferManager() : nullptr;
+    vkContext_t::mUploadQueue          = ctx ? ctx->GetUploadQueue()          : nullptr;
+}
+
+static string
+GetShaderCacheDirectory(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// Unless overridden, entries are stored under the cache directory of the user,
+    /// as defined by the XDG base directory specification. Without one they are not stored.
+    const char *directory = getenv("GLOVE_SHADER_CACHE_DIR");
+    if(directory && *directory) {
+        return string(directory);
+    }
+
+    const char *xdgCacheHome = getenv("XDG_CACHE_HOME");
+    const char *home         = getenv("HOME");
+    if(xdgCacheHome && *xdgCacheHome) {
+        return string(xdgCacheHome) + "/" + GLOVE_SHADER_CACHE_DIRECTORY;
+    } else if(home && *home) {
+        return string(home) + "/.cache/" + GLOVE_SHADER_CACHE_DIRECTORY;
+    }
+
+    return string();
+}
+
+static ShaderCache *
+AcquireShaderCache(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(shaderCacheMutex);
+
+    if(!shaderCacheRefCount++) {
+        const string directory = GLOVE_PERSISTENT_SHADER_CACHE ? GetShaderCacheDirectory() : string();
+
+        shaderCache = new ShaderCache(GLOVE_SHADER_CACHE_MEMORY_SIZE,
+                                      directory.empty() ? nullptr : directory.c_str(),
+                                      GLOVE_SHADER_CACHE_DISK_SIZE);
+    }
+
+    return shaderCache;
+}
+
+static void
+ReleaseShaderCache(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(shaderCacheMutex);
+
+    if(!--shaderCacheRefCount) {
+        delete shaderCache;
+        shaderCache = nullptr;
+    }
 }
 
-Context::Context()
+static VkDeviceSize
+GetRingBufferSize(const char *variable, VkDeviceSize defaultSize)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const char *size = getenv(variable);
+    const VkDeviceSize regionSize = (size && *size) ? strtoull(size, NULL, 10) : 0;
+
+    return regionSize ? regionSize : defaultSize;
+}
+
+Context::Context(Context *sharedContext)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
     mVkContext      = vulkanAPI::GetContext();
 
+    if(sharedContext) {
+        mResourceManager = sharedContext->mResourceManager;
+        mResourceManager->Ref();
+    } else {
+        mResourceManager = new ResourceManager();
+    }
+    mGenericVertexAttributes = new GenericVertexAttributes();
+
+    /// Contexts without command buffers or an upload queue are not handed out, see IsCreated()
+    mCommandBufferManager = new CommandBufferManager(mVkContext);
+    mCreated = mCommandBufferManager->AllocateVkCmdBuffers();
+
+    mUploadQueue    = new UploadQueue(mVkContext);
+    mCreated = mUploadQueue->Create() && mCreated;
+
+    /// The default resources are initialized through the command buffer
+    /// manager and upload queue of this context
+    Context *previousContext = GetCurrentContext();
+    SetCurrentContext(this);
+
     mShaderCompiler = new GlslangShaderCompiler();
+    mShaderCompileQueue = new TaskQueue(GLOVE_BACKGROUND_SHADER_COMPILATION);
+    mMaxShaderCompilerThreads = 0xFFFFFFFF;
+
+    mShaderCache    = GLOVE_SHADER_CACHE ? AcquireShaderCache() : nullptr;
+
     mClearPass      = new vulkanAPI::ClearPass();
     mPipeline       = new vulkanAPI::Pipeline(mVkContext);
 
+    /// The ring buffers are created on first use
+    mUniformRingBuffer = new vulkanAPI::RingBuffer(mVkContext, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                                   GetRingBufferSize("GLOVE_UNIFORM_RING_BUFFER_SIZE", GLOVE_UNIFORM_RING_BUFFER_SIZE));
+    mVertexRingBuffer  = new vulkanAPI::RingBuffer(mVkContext, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                                                   GetRingBufferSize("GLOVE_VERTEX_RING_BUFFER_SIZE", GLOVE_VERTEX_RING_BUFFER_SIZE));
+    mTextureRingBuffer = new vulkanAPI::RingBuffer(mVkContext, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                   GetRingBufferSize("GLOVE_TEXTURE_RING_BUFFER_SIZE", GLOVE_TEXTURE_RING_BUFFER_SIZE));
+
+    mDrawUploadSerial = 0;
+
     mStateManager.InitVkPipelineStates(mPipeline);
 
     InitializeDefaultTextures();
@@ -58,29 +174,70 @@ Context::Context()
     mReadSurface  = nullptr;
     mWriteFBO     = nullptr;
     mSystemFBO    = nullptr;
-    mTempIbo      = nullptr;
+
+    mSystemFBOPresentable    = false;
+    mSystemFBOPresentPending = false;
+
+    SetCurrentContext(previousContext);
 }
 
 Context::~Context()
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    if(mSystemFBO) {
-        for(uint32_t i = 0; i < mSystemTextures.size(); ++i) {
-            if(mSystemTextures[i]) {
-                delete mSystemTextures[i];
-                mSystemTextures[i] = nullptr;
-            }
-        }
-        mSystemTextures.clear();
+    /// Resources are released through the command buffer manager and
+    /// upload queue of this context, whichever thread destroys it
+    Context *previousContext = GetCurrentContext();
+    SetCurrentContext(this);
 
-        delete mSystemFBO;
-    }
+    ReleaseSystemFramebuffer();
 
+    delete mShaderCompileQueue;
+    if(mShaderCache) {
+        ReleaseShaderCache();
+    }
     delete mShaderCompiler;
     delete mPipeline;
     delete mClearPass;
-    delete mTempIbo;
+    delete mUniformRingBuffer;
+    delete mVertexRingBuffer;
+    delete mTextureRingBuffer;
+
+    delete mDefaultTexture2D;
+    delete mDefaultTextureCubeMap;
+    delete mIncompleteTexture2D;
+    delete mIncompleteTextureCubeMap;
+    delete mGenericVertexAttributes;
+
+    if(!mResourceManager->Unref()) {
+        delete mResourceManager;
+    }
+
+    delete mUploadQueue;
+    delete mCommandBufferManager;
+
+    SetCurrentContext(previousContext != this ? previousContext : nullptr);
+}
+
+void
+Context::ReleaseSystemFramebuffer(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mSystemFBO) {
+        return;
+    }
+
+    for(uint32_t i = 0; i < mSystemTextures.size(); ++i) {
+        if(mSystemTextures[i]) {
+            delete mSystemTextures[i];
+            mSystemTextures[i] = nullptr;
+        }
+    }
+    mSystemTextures.clear();
+
+    delete mSystemFBO;
+    mSystemFBO = nullptr;
 }
 
 void
@@ -88,13 +245,27 @@ Context::InitializeDefaultTextures()
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    /// Unlike named textures, the default textures are not shared
+    mDefaultTexture2D = new Texture(mVkContext);
+    mDefaultTexture2D->SetTarget(GL_TEXTURE_2D);
+    mDefaultTexture2D->SetVkFormat(VK_FORMAT_R8G8B8A8_UNORM);
+    mDefaultTexture2D->SetVkImageUsage(static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
+    mDefaultTexture2D->SetVkImageTarget(vulkanAPI::Image::VK_IMAGE_TARGET_2D);
+    mDefaultTexture2D->InitState();
+
+    mDefaultTextureCubeMap = new Texture(mVkContext);
+    mDefaultTextureCubeMap->SetTarget(GL_TEXTURE_CUBE_MAP);
+    mDefaultTextureCubeMap->SetVkFormat(VK_FORMAT_R8G8B8A8_UNORM);
+    mDefaultTextureCubeMap->SetVkImageUsage(static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
+    mDefaultTextureCubeMap->SetVkImageTarget(vulkanAPI::Image::VK_IMAGE_TARGET_CUBE);
+    mDefaultTextureCubeMap->InitState();
+
+    mIncompleteTexture2D      = nullptr;
+    mIncompleteTextureCubeMap = nullptr;
+
     for(int i = 0; i < GLOVE_MAX_COMBINED_TEXTURE_IMAGE_UNITS; ++i) {
-        Texture *tex = mResourceManager.GetDefaultTexture(GL_TEXTURE_2D);
-                 tex->SetVkContext(mVkContext);
-        mStateManager.GetActiveObjectsState()->SetActiveTexture(GL_TEXTURE_2D      , i, tex);
-                 tex = mResourceManager.GetDefaultTexture(GL_TEXTURE_CUBE_MAP);
-                 tex->SetVkContext(mVkContext);
-        mStateManager.GetActiveObjectsState()->SetActiveTexture(GL_TEXTURE_CUBE_MAP, i, tex);
+        mStateManager.GetActiveObjectsState()->SetActiveTexture(GL_TEXTURE_2D      , i, mDefaultTexture2D);
+        mStateManager.GetActiveObjectsState()->SetActiveTexture(GL_TEXTURE_CUBE_MAP, i, mDefaultTextureCubeMap);
     }
 }
 
@@ -115,7 +286,7 @@ Context::CreateFBOFromEGLSurface(EGLSurfaceInterface *eglSurfaceInterface)
 
     Texture *tex = CreateDepthStencil(eglSurfaceInterface);
     fbo->SetDepthStencilAttachmentTexture(tex);
-    fbo->CreateVkRenderPass(true, false);
+    fbo->CreateVkRenderPass();
     fbo->Create();
     mSystemTextures.push_back(tex);
 
@@ -216,7 +387,6 @@ Context::CreateDepthStencil(EGLSurfaceInterface *eglSurfaceInterface)
     tex->SetTarget(GL_TEXTURE_2D);
     tex->SetVkFormat(depthFormat);
     tex->SetVkImageUsage(VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
-    tex->SetVkImageTiling(VK_IMAGE_TILING_OPTIMAL);
     tex->SetVkImageTarget(vulkanAPI::Image::VK_IMAGE_TARGET_2D);
 
     GLenum glformat = VkFormatToGlInternalformat(depthFormat);
@@ -235,6 +405,17 @@ Context::SetWriteSurface(EGLSurfaceInterface *eglSurfaceInterface)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
+    if(mWriteFBO) {
+        Finish();
+    }
+
+    /// The framebuffer of the previous surface is not used by this context anymore
+    ReleaseSystemFramebuffer();
+
+    /// Only window surfaces are acquired from and presented by EGL
+    mSystemFBOPresentable = (EGL_WINDOW_BIT == eglSurfaceInterface->type);
+    mCommandBufferManager->SetVkSyncItems(mSystemFBOPresentable ? mVkContext->vkSyncItems : nullptr);
+
     mWriteSurface = eglSurfaceInterface->surface;
     mWriteFBO     = CreateFBOFromEGLSurface(eglSurfaceInterface);
 
@@ -31,6 +31,8 @@
 #include "resources/resourceManager.h"
 #include "vulkan/pipeline.h"
 #include "vulkan/clearPass.h"
+#include "vulkan/ringBuffer.h"
+#include "vulkan/uploadQueue.h"
 #include "vulkan/context.h"
 #include "rendering_api_interface.h"
 
@@ -51,23 +53,45 @@ private:
     const vkContext_t *                         mVkContext;
 // ------------
     StateManager                                mStateManager;
-    ResourceManager                             mResourceManager;
+    ResourceManager *                           mResourceManager;
+    GenericVertexAttributes *                   mGenericVertexAttributes;
+    Texture *                                   mDefaultTexture2D;
+    Texture *                                   mDefaultTextureCubeMap;
+    /// Bound in place of incomplete textures, created on first use
+    Texture *                                   mIncompleteTexture2D;
+    Texture *                                   mIncompleteTextureCubeMap;
+    CommandBufferManager *                      mCommandBufferManager;
+    UploadQueue *                               mUploadQueue;
     ShaderCompiler *                            mShaderCompiler;
+    TaskQueue *                                 mShaderCompileQueue;
+    ShaderCache *                               mShaderCache;
+    GLuint                                      mMaxShaderCompilerThreads;
     vulkanAPI::Pipeline *                       mPipeline;
     vulkanAPI::ClearPass *                      mClearPass;
+    vulkanAPI::RingBuffer *                     mUniformRingBuffer;
+    vulkanAPI::RingBuffer *                     mVertexRingBuffer;
+    vulkanAPI::RingBuffer *                     mTextureRingBuffer;
+    uniformStatistics_t                         mUniformStatistics;
+    uniformStatistics_t                         mFrameUniformStatistics;
+    uint64_t                                    mDrawUploadSerial;
+    bool                                        mCreated;
+    /// Reused by every draw to list the textures it samples
+    vector<Texture *>                           mSampledTextures;
 
 // ------------
     void        *                               mWriteSurface;
     void        *                               mReadSurface;
-    BufferObject*                               mTempIbo;
     Framebuffer *                               mWriteFBO;
 
     Framebuffer *                               mSystemFBO;
     vector<Texture *>                           mSystemTextures;
+    bool                                        mSystemFBOPresentable;
+    bool                                        mSystemFBOPresentPending;
 // ------------
 
     Shader        *GetShaderPtr(GLuint shader);
     ShaderProgram *GetProgramPtr(GLuint program);
+    ShaderProgram *LookupProgramPtr(GLuint program);
 
     Framebuffer   *CreateFBOFromEGLSurface(EGLSurfaceInterface *eglSurfaceInterface);
     Framebuffer   *InitializeFrameBuffer(EGLSurfaceInterface *eglSurfaceInterface);
@@ -76,26 +100,33 @@ private:
     Texture       *CreateDepthStencil(EGLSurfaceInterface *eglSurfaceInterface);
 
     void BeginRendering(void);
+    void EndRendering(void);
+    void PrepareSampledTextures(void);
+    void AllocateTexture(Texture *texture);
+    bool IsFramebufferCopySupported(const Texture *texture, GLint x, GLint y, GLsizei width, GLsizei height);
+    bool CopyFramebufferToTexture(Texture *texture, GLint level, GLint layer, GLint xoffset, GLint yoffset, GLint x, GLint y, GLsizei width, GLsizei height);
     void PushGeometry(uint32_t vertCount, uint32_t firstVertex, bool indexed, GLenum type, const void *indices);
-    void UpdateVertexAttributes(uint32_t vertCount, uint32_t firstVertex);
+    void UpdateVertexAttributes(void);
+    bool UpdateDrawData(uint32_t vertCount, uint32_t firstVertex, bool indexed, GLenum type, const void *indices, VkBuffer *indexBuffer, VkDeviceSize *indexOffset);
+    bool UpdateIndexBuffer(uint32_t vertCount, GLenum type, const void *indices, VkBuffer *indexBuffer, VkDeviceSize *indexOffset);
     void BindUniformDescriptors(VkCommandBuffer *CmdBuffer);
-    void BindVertexBuffers(VkCommandBuffer *CmdBuffer, const void *indices, GLenum type, bool indexed, uint32_t vertCount);
+    void BindVertexBuffers(VkCommandBuffer *CmdBuffer, VkBuffer indexBuffer, VkDeviceSize indexOffset, GLenum type);
     void DrawGeometry(VkCommandBuffer *CmdBuffer, bool indexed, uint32_t firstVertex, uint32_t vertCount);
     void SetCapability(GLenum cap, GLboolean enable);
 
-    bool AllocateTempIndexBuffer(const void *srcData, size_t size, BufferObject** ibo);
-    bool ConvertIndexBufferToUint16(const void* srcData, size_t elementCount, BufferObject** ibo);
-
     void InitializeDefaultTextures(void);
 
     void SetClearRect(void);
     void SetClearAttachments(bool clearColor, bool clearDepth, bool clearStencil);
     bool SetPipelineProgramShaderStages(ShaderProgram *progPtr);
     void SetSystemFramebuffer(Framebuffer *FBO);
+    void ReleaseSystemFramebuffer(void);
 
 // Get Functions
-           uint32_t         GetProgramId(const ShaderProgram *progPtr)           { FUN_ENTRY(GL_LOG_TRACE); return (progPtr)   ? mResourceManager.FindShaderProgramID(progPtr) : 0; }
-           uint32_t         GetShaderId(const Shader *shaderPtr)                 { FUN_ENTRY(GL_LOG_TRACE); return (shaderPtr) ? mResourceManager.FindShaderID(shaderPtr)      : 0; }
+           uint32_t         GetProgramId(const ShaderProgram *progPtr)           { FUN_ENTRY(GL_LOG_TRACE); return (progPtr)   ? mResourceManager->FindShaderProgramID(progPtr) : 0; }
+           uint32_t         GetShaderId(const Shader *shaderPtr)                 { FUN_ENTRY(GL_LOG_TRACE); return (shaderPtr) ? mResourceManager->FindShaderID(shaderPtr)      : 0; }
+           uint32_t         GetTextureId(const Texture *texPtr)                  { FUN_ENTRY(GL_LOG_TRACE); return (texPtr == mDefaultTexture2D || texPtr == mDefaultTextureCubeMap) ? 0 : mResourceManager->GetTextureID(texPtr); }
+    inline Texture *        GetDefaultTexture(GLenum target)                     { FUN_ENTRY(GL_LOG_TRACE); return target == GL_TEXTURE_2D ? mDefaultTexture2D : mDefaultTextureCubeMap; }
 
 // Is/Has Functions
     inline bool             HasShaderCompiler(void)                              { FUN_ENTRY(GL_LOG_TRACE); GLboolean compilerSupport;
@@ -107,13 +138,21 @@ private:
     inline void             RecordError(GLenum error)                            { FUN_ENTRY(GL_LOG_TRACE); if (mStateManager.GetError() == GL_NO_ERROR) { mStateManager.SetError(error); } }
 
 public:
-    Context();
+    Context(Context *sharedContext);
     ~Context();
 
     void                    DeleteShader(Shader *shaderPtr);
 
 // Get Functions
     inline  StateManager    *GetStateManager(void)                                { FUN_ENTRY(GL_LOG_TRACE); return &mStateManager; }
+    inline  CommandBufferManager *GetCommandBufferManager(void)                   { FUN_ENTRY(GL_LOG_TRACE); return mCommandBufferManager; }
+    inline  UploadQueue     *GetUploadQueue(void)                                 { FUN_ENTRY(GL_LOG_TRACE); return mUploadQueue; }
+    /// Uniform uploads of the last presented frame
+    inline  const uniformStatistics_t &GetUniformStatistics(void)           const { FUN_ENTRY(GL_LOG_TRACE); return mFrameUniformStatistics; }
+            Texture         *GetSampledTexture(GLenum target, int unit);
+
+// Is Functions
+    inline  bool            IsCreated(void)                                 const { FUN_ENTRY(GL_LOG_TRACE); return mCreated; }
 
 // Set Functions
             void             SetWriteSurface(EGLSurfaceInterface *eglSurfaceInterface);
@@ -166,6 +205,7 @@ public:
     void            Enable(GLenum cap);
     void            EnableVertexAttribArray(GLuint index);
     void            Finish(void);
+    void            FinishFrame(void);
     void            Flush(void);
     void            FramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer);
     void            FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
@@ -272,6 +312,7 @@ public:
     void            PushGroupMarkerEXT(void);
     void            GetProgramBinaryOES(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
     void            ProgramBinaryOES(GLuint program, GLenum binaryFormat, const void *binary, GLint length);
+    void            MaxShaderCompilerThreadsKHR(GLuint count);
 
 };
 
@@ -35,13 +35,19 @@ Context::BindFramebuffer(GLenum target, GLuint framebuffer)
 
     Framebuffer *fbo;
     if(framebuffer) {
-        fbo = mResourceManager.GetFramebuffer(framebuffer);
+        fbo = mResourceManager->GetFramebuffer(framebuffer);
         if(fbo->GetTarget() == GL_INVALID_VALUE) {
             fbo->SetTarget(target);
             fbo->SetVkContext(mVkContext);
         }
     }
 
+    /// The active render pass belongs to the previously bound framebuffer. It only has to end,
+    /// draws that are still in flight keep rendering to the previous attachments.
+    if(mWriteFBO && mWriteFBO != (framebuffer ? fbo : mSystemFBO)) {
+        EndRendering();
+    }
+
     mWriteFBO = framebuffer ? fbo : mSystemFBO;
     mStateManager.GetActiveObjectsState()->SetActiveFramebufferObjectID(framebuffer);
     mPipeline->SetUpdatePipeline(true);
@@ -60,7 +66,7 @@ Context::CheckFramebufferStatus(GLenum target)
 
     return (mStateManager.GetActiveObjectsState()->IsDefaultFramebufferObjectActive()) ?
             GL_FRAMEBUFFER_COMPLETE :
-            mResourceManager.GetFramebuffer(mStateManager.GetActiveObjectsState()->GetActiveFramebufferObjectID())->CheckStatus();
+            mResourceManager->GetFramebuffer(mStateManager.GetActiveObjectsState()->GetActiveFramebufferObjectID())->CheckStatus();
 }
 
 void
@@ -73,13 +79,16 @@ Context::DeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
         return;
     }
 
+    /// The Vulkan objects of the framebuffers are retired, pending draws may still use them.
+    /// Only the render pass that is being recorded must end, if it belongs to a deleted framebuffer.
     while(n-- != 0) {
         uint32_t fboindex = *framebuffers++;
 
-        if(fboindex && mResourceManager.FramebufferExists(fboindex)) {
-            Framebuffer *fbo = mResourceManager.GetFramebuffer(fboindex);
+        if(fboindex && mResourceManager->FramebufferExists(fboindex)) {
+            Framebuffer *fbo = mResourceManager->GetFramebuffer(fboindex);
 
             if(fbo == mWriteFBO) {
+                Flush();
                 mWriteFBO = mSystemFBO;
 
                 mStateManager.GetActiveObjectsState()->SetActiveFramebufferObjectID(0);
@@ -87,7 +96,7 @@ Context::DeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
                 mPipeline->SetUpdateViewportState(true);
             }
 
-            mResourceManager.DeallocateFramebuffer(fboindex);
+            mResourceManager->DeallocateFramebuffer(fboindex);
         }
     }
 }
@@ -108,24 +117,27 @@ Context::FramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum render
     }
 
     if( mStateManager.GetActiveObjectsState()->IsDefaultFramebufferObjectActive() ||
-      ( renderbuffer && !mResourceManager.RenderbufferExists(renderbuffer))) {
+      ( renderbuffer && !mResourceManager->RenderbufferExists(renderbuffer))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
 
+    /// Attachment changes invalidate the render pass that is being recorded, pending clears are applied first
+    EndRendering();
+
     switch(attachment) {
     case GL_COLOR_ATTACHMENT0:
-        mWriteFBO->SetColorAttachmentTexture(renderbuffer ? mResourceManager.GetRenderbuffer(renderbuffer)->GetTexture() : nullptr);
+        mWriteFBO->SetColorAttachmentTexture(renderbuffer ? mResourceManager->GetRenderbuffer(renderbuffer)->GetTexture() : nullptr);
         mWriteFBO->SetColorAttachmentType(renderbuffer ? GL_RENDERBUFFER : GL_NONE);
         mWriteFBO->SetColorAttachmentName(renderbuffer);
         break;
     case GL_DEPTH_ATTACHMENT:
-        mWriteFBO->SetDepthAttachmentTexture(renderbuffer ? mResourceManager.GetRenderbuffer(renderbuffer)->GetTexture() : nullptr);
+        mWriteFBO->SetDepthAttachmentTexture(renderbuffer ? mResourceManager->GetRenderbuffer(renderbuffer)->GetTexture() : nullptr);
         mWriteFBO->SetDepthAttachmentType(renderbuffer ? GL_RENDERBUFFER : GL_NONE);
         mWriteFBO->SetDepthAttachmentName(renderbuffer);
         break;
     case GL_STENCIL_ATTACHMENT:
-        mWriteFBO->SetStencilAttachmentTexture(renderbuffer ? mResourceManager.GetRenderbuffer(renderbuffer)->GetTexture() : nullptr);
+        mWriteFBO->SetStencilAttachmentTexture(renderbuffer ? mResourceManager->GetRenderbuffer(renderbuffer)->GetTexture() : nullptr);
         mWriteFBO->SetStencilAttachmentType(renderbuffer ? GL_RENDERBUFFER : GL_NONE);
         mWriteFBO->SetStencilAttachmentName(renderbuffer);
         break;
@@ -157,33 +169,36 @@ Context::FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget
     }
 
     if(mStateManager.GetActiveObjectsState()->IsDefaultFramebufferObjectActive() ||
-       (texture &&  mResourceManager.TextureExists(texture) &&
-       ((mResourceManager.GetTexture(texture)->GetTarget() == GL_TEXTURE_2D       && textarget != GL_TEXTURE_2D) ||
-        (mResourceManager.GetTexture(texture)->GetTarget() == GL_TEXTURE_CUBE_MAP && textarget == GL_TEXTURE_2D))
+       (texture &&  mResourceManager->TextureExists(texture) &&
+       ((mResourceManager->GetTexture(texture)->GetTarget() == GL_TEXTURE_2D       && textarget != GL_TEXTURE_2D) ||
+        (mResourceManager->GetTexture(texture)->GetTarget() == GL_TEXTURE_CUBE_MAP && textarget == GL_TEXTURE_2D))
       )
       ) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
 
+    /// Attachment changes invalidate the render pass that is being recorded, pending clears are applied first
+    EndRendering();
+
     switch(attachment) {
     case GL_COLOR_ATTACHMENT0:
-        mWriteFBO->SetColorAttachmentTexture(texture ? mResourceManager.GetTexture(texture) : nullptr);
+        mWriteFBO->SetColorAttachmentTexture(texture ? mResourceManager->GetTexture(texture) : nullptr);
         mWriteFBO->SetColorAttachmentType(texture ? GL_TEXTURE : GL_NONE);
         mWriteFBO->SetColorAttachmentName(texture);
-        mWriteFBO->SetColorAttachmentLayer(texture && mResourceManager.GetTexture(texture)->IsCubeMap() ? textarget : GL_TEXTURE_CUBE_MAP_POSITIVE_X);
+        mWriteFBO->SetColorAttachmentLayer(texture && mResourceManager->GetTexture(texture)->IsCubeMap() ? textarget : GL_TEXTURE_CUBE_MAP_POSITIVE_X);
         break;
     case GL_DEPTH_ATTACHMENT:
-        mWriteFBO->SetDepthAttachmentTexture(texture ? mResourceManager.GetTexture(texture) : nullptr);
+        mWriteFBO->SetDepthAttachmentTexture(texture ? mResourceManager->GetTexture(texture) : nullptr);
         mWriteFBO->SetDepthAttachmentType(texture ? GL_TEXTURE : GL_NONE);
         mWriteFBO->SetDepthAttachmentName(texture);
-        mWriteFBO->SetDepthAttachmentLayer(texture && mResourceManager.GetTexture(texture)->IsCubeMap() ? textarget : GL_TEXTURE_CUBE_MAP_POSITIVE_X);
+        mWriteFBO->SetDepthAttachmentLayer(texture && mResourceManager->GetTexture(texture)->IsCubeMap() ? textarget : GL_TEXTURE_CUBE_MAP_POSITIVE_X);
         break;
     case GL_STENCIL_ATTACHMENT:
-        mWriteFBO->SetStencilAttachmentTexture(texture ? mResourceManager.GetTexture(texture) : nullptr);
+        mWriteFBO->SetStencilAttachmentTexture(texture ? mResourceManager->GetTexture(texture) : nullptr);
         mWriteFBO->SetStencilAttachmentType(texture ? GL_TEXTURE : GL_NONE);
         mWriteFBO->SetStencilAttachmentName(texture);
-        mWriteFBO->SetStencilAttachmentLayer(texture && mResourceManager.GetTexture(texture)->IsCubeMap() ? textarget : GL_TEXTURE_CUBE_MAP_POSITIVE_X);
+        mWriteFBO->SetStencilAttachmentLayer(texture && mResourceManager->GetTexture(texture)->IsCubeMap() ? textarget : GL_TEXTURE_CUBE_MAP_POSITIVE_X);
         break;
     default:
         RecordError(GL_INVALID_ENUM);
@@ -202,7 +217,7 @@ Context::GenFramebuffers(GLsizei n, GLuint* framebuffers)
     }
 
     while (n != 0) {
-        *framebuffers++ = mResourceManager.AllocateFramebuffer();
+        *framebuffers++ = mResourceManager->AllocateFramebuffer();
         --n;
     }
 }
@@ -223,7 +238,7 @@ Context::GetFramebufferAttachmentParameteriv(GLenum target, GLenum attachment, G
     }
 
     uint32_t activeFBOid = mStateManager.GetActiveObjectsState()->GetActiveFramebufferObjectID();
-    Framebuffer *fbo = mResourceManager.GetFramebuffer(activeFBOid);
+    Framebuffer *fbo = mResourceManager->GetFramebuffer(activeFBOid);
 
     GLenum type  = GL_NONE;
     GLenum name  = 0;
@@ -236,7 +251,7 @@ Context::GetFramebufferAttachmentParameteriv(GLenum target, GLenum attachment, G
         name  = fbo->GetColorAttachmentName();
         if(type == GL_TEXTURE) {
             level = fbo->GetColorAttachmentLevel();
-            layer = mResourceManager.GetTexture(name)->IsCubeMap() ? fbo->GetColorAttachmentLayer() : 0;
+            layer = mResourceManager->GetTexture(name)->IsCubeMap() ? fbo->GetColorAttachmentLayer() : 0;
         }
         break;
     case GL_DEPTH_ATTACHMENT:
@@ -244,7 +259,7 @@ Context::GetFramebufferAttachmentParameteriv(GLenum target, GLenum attachment, G
         name  = fbo->GetDepthAttachmentName();
         if(type == GL_TEXTURE) {
             level = fbo->GetDepthAttachmentLevel();
-            layer = mResourceManager.GetTexture(name)->IsCubeMap() ? fbo->GetDepthAttachmentLayer() : 0;
+            layer = mResourceManager->GetTexture(name)->IsCubeMap() ? fbo->GetDepthAttachmentLayer() : 0;
         }
         break;
     case GL_STENCIL_ATTACHMENT:
@@ -252,7 +267,7 @@ Context::GetFramebufferAttachmentParameteriv(GLenum target, GLenum attachment, G
         name = fbo->GetStencilAttachmentName();
         if(type == GL_TEXTURE) {
             level = fbo->GetStencilAttachmentLevel();
-            layer = mResourceManager.GetTexture(name)->IsCubeMap() ? fbo->GetStencilAttachmentLayer() : 0;
+            layer = mResourceManager->GetTexture(name)->IsCubeMap() ? fbo->GetStencilAttachmentLayer() : 0;
         }
         break;
     default:
@@ -292,8 +307,8 @@ Context::IsFramebuffer(GLuint framebuffer)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(framebuffer && mResourceManager.FramebufferExists(framebuffer)) {
-        Framebuffer *pFrameBuffer = mResourceManager.GetFramebuffer(framebuffer);
+    if(framebuffer && mResourceManager->FramebufferExists(framebuffer)) {
+        Framebuffer *pFrameBuffer = mResourceManager->GetFramebuffer(framebuffer);
         return (pFrameBuffer && pFrameBuffer->GetTarget() != GL_INVALID_VALUE) ? GL_TRUE : GL_FALSE;
     }
 
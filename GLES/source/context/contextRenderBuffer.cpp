@@ -38,7 +38,7 @@ Context::BindRenderbuffer(GLenum target, GLuint renderbuffer)
         return;
     }
 
-    Renderbuffer *rendbuff = mResourceManager.GetRenderbuffer(renderbuffer);
+    Renderbuffer *rendbuff = mResourceManager->GetRenderbuffer(renderbuffer);
     if(rendbuff->GetTarget() == GL_INVALID_VALUE) {
         rendbuff->SetVkContext(mVkContext);
         rendbuff->SetTarget(target);
@@ -56,11 +56,19 @@ Context::DeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers)
         return;
     }
 
+    /// The Vulkan objects of the renderbuffers are retired, so pending draws may keep rendering to them.
+    /// Only the render pass that is being recorded must end, if the renderbuffers are attached to it.
     while(n-- != 0) {
         uint32_t index = *renderbuffers++;
 
-        if(index && mResourceManager.RenderbufferExists(index)) {
-            Renderbuffer *rbo = mResourceManager.GetRenderbuffer(index);
+        if(index && mResourceManager->RenderbufferExists(index)) {
+            Renderbuffer *rbo = mResourceManager->GetRenderbuffer(index);
+
+            if(rbo->GetTexture() == mWriteFBO->GetColorAttachmentTexture() ||
+               rbo->GetTexture() == mWriteFBO->GetDepthAttachmentTexture() ||
+               rbo->GetTexture() == mWriteFBO->GetStencilAttachmentTexture()) {
+                Flush();
+            }
 
             if(rbo->GetTexture() == mWriteFBO->GetColorAttachmentTexture()) {
                 mWriteFBO->SetColorAttachmentTexture(nullptr);
@@ -83,7 +91,7 @@ Context::DeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers)
             if(mStateManager.GetActiveObjectsState()->EqualsActiveRenderbufferObject(index)) {
                 mStateManager.GetActiveObjectsState()->SetActiveRenderbufferObjectID(0);
             }
-            mResourceManager.DeallocateRenderbuffer(index);
+            mResourceManager->DeallocateRenderbuffer(index);
         }
     }
 }
@@ -99,7 +107,7 @@ Context::GenRenderbuffers(GLsizei n, GLuint *renderbuffers)
     }
 
     while (n != 0) {
-        *renderbuffers++ = mResourceManager.AllocateRenderbuffer();
+        *renderbuffers++ = mResourceManager->AllocateRenderbuffer();
         --n;
     }
 }
@@ -121,7 +129,7 @@ Context::GetRenderbufferParameteriv(GLenum target, GLenum pname, GLint* params)
         return;
     }
 
-    Renderbuffer* activeRenderbuffer = mResourceManager.GetRenderbuffer(activeRenderbufferId);
+    Renderbuffer* activeRenderbuffer = mResourceManager->GetRenderbuffer(activeRenderbufferId);
 
     if(activeRenderbuffer->GetTarget() == GL_INVALID_VALUE) {
         *params = (pname == GL_RENDERBUFFER_INTERNAL_FORMAT) ? GL_RGBA4 : 0;
@@ -147,8 +155,8 @@ Context::IsRenderbuffer(GLuint renderbuffer)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(renderbuffer && mResourceManager.RenderbufferExists(renderbuffer)) {
-        Renderbuffer *pRenderBuffer = mResourceManager.GetRenderbuffer(renderbuffer);
+    if(renderbuffer && mResourceManager->RenderbufferExists(renderbuffer)) {
+        Renderbuffer *pRenderBuffer = mResourceManager->GetRenderbuffer(renderbuffer);
         return (pRenderBuffer && pRenderBuffer->GetTarget() != GL_INVALID_VALUE) ? GL_TRUE : GL_FALSE;
     }
 
@@ -182,7 +190,9 @@ Context::RenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width
         return;
     }
 
-    Renderbuffer* activeRenderbuffer = mResourceManager.GetRenderbuffer(activeRenderbufferId);
+    Finish();
+
+    Renderbuffer* activeRenderbuffer = mResourceManager->GetRenderbuffer(activeRenderbufferId);
     if(!activeRenderbuffer->Allocate(width, height, internalformat)) {
         RecordError(GL_OUT_OF_MEMORY);
         return;
@@ -28,11 +28,72 @@ Context::BeginRendering(void)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
+    /// Keep recording into the render pass that is already active. Any operation that
+    /// invalidates it (attachment or framebuffer changes) ends it through Finish() first.
+    if(mWriteFBO->GetVkRenderPassStarted()) {
+        return;
+    }
+
+    /// The attachment is transitioned in the draw command buffer, which is therefore submitted after its uploads
     mVkContext->mCommandBufferManager->BeginVkDrawCommandBuffer();
     mWriteFBO->PrepareVkImage(VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-    mWriteFBO->BeginVkRenderPass( mStateManager.GetFramebufferOperationsState()->GetDepthMask(),
-                                  mStateManager.GetFramebufferOperationsState()->GetStencilMaskFront() |
-                                  mStateManager.GetFramebufferOperationsState()->GetStencilMaskBack());
+    mWriteFBO->BeginVkRenderPass();
+
+    if(mWriteFBO->GetColorAttachmentTexture()) {
+        mDrawUploadSerial = std::max(mDrawUploadSerial, mWriteFBO->GetColorAttachmentTexture()->GetUploadSerial());
+    }
+
+    if(mWriteFBO == mSystemFBO && mSystemFBOPresentable) {
+        mSystemFBOPresentPending = true;
+    }
+}
+
+void
+Context::EndRendering(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    /// Clears that have been folded into a render pass that has not begun yet
+    if(mWriteFBO->GetRenderPass()->HasPendingClears()) {
+        BeginRendering();
+    }
+
+    mWriteFBO->EndVkRenderPass();
+}
+
+void
+Context::PrepareSampledTextures(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    /// Textures that have been rendered to are transitioned back for sampling. Layouts cannot
+    /// change within a render pass, so the active one ends and the draw begins a new one that
+    /// loads the attachments. Sampling the color attachment itself is left undefined.
+    const Texture *colorAttachment = mWriteFBO->GetColorAttachmentTexture();
+    bool transitioned = false;
+
+    mStateManager.GetActiveShaderProgram()->GetSampledTextures(mSampledTextures);
+    for(Texture *texture : mSampledTextures) {
+        if(texture == colorAttachment || texture->GetImage()->GetImage() == VK_NULL_HANDLE) {
+            continue;
+        }
+
+        texture->CreateVkImageSubResourceRange();
+        if(texture->GetVkImageLayout() == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+            continue;
+        }
+
+        if(!transitioned) {
+            EndRendering();
+            transitioned = true;
+        }
+        texture->PrepareVkImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+
+    /// Descriptors are written with the layouts the textures are in
+    if(transitioned) {
+        mStateManager.GetActiveShaderProgram()->EnableUpdateOfDescriptorSets();
+    }
 }
 
 void
@@ -132,21 +193,27 @@ Context::Clear(GLbitfield mask)
     SetClearRect();
     SetClearAttachments(clearColor, clearDepth, clearStencil);
 
-    // Clearing attachments via vkCmdClearAttachments is not correct from performance point of view.
-    // TODO: Add clear values in VkRenderPassBeginInfo (currently set to NULL) when calling Begin of Vk Renderpass.
+    /// Clears of the whole framebuffer that precede the first draw are folded into the begin
+    /// of the render pass as clear load ops. The render pass begins with the first draw, or
+    /// when the recorded commands are flushed. Any other clear is recorded inside it.
+    const VkClearRect *clearRect = mClearPass->GetRect();
+    if(!mWriteFBO->GetVkRenderPassStarted()          &&
+       clearRect->rect.offset.x      == 0            &&
+       clearRect->rect.offset.y      == 0            &&
+       static_cast<int>(clearRect->rect.extent.width)  == mWriteFBO->GetWidth() &&
+       static_cast<int>(clearRect->rect.extent.height) == mWriteFBO->GetHeight()) {
+        for(uint32_t i = 0; i < mClearPass->GetAttachmentsCount(); ++i) {
+            mWriteFBO->GetRenderPass()->SetClearAttachment(&mClearPass->GetAttachments()[i]);
+        }
+        return;
+    }
+
     BeginRendering();
     vkCmdClearAttachments(mVkContext->mCommandBufferManager->GetActiveCommandBuffer(),
                           mClearPass->GetAttachmentsCount(),
                           mClearPass->GetAttachments(),
                           mClearPass->GetRectCount(),
                           mClearPass->GetRect());
-
-    // TODO: Flush Vulkan cmd buffers in eglSwapBuffers for better performance.
-    Finish();
-
-    if(mWriteFBO == mSystemFBO) {
-        mWriteFBO->PrepareVkImage(VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
-    }
 }
 
 void
@@ -154,17 +221,43 @@ Context::PushGeometry(uint32_t vertCount, uint32_t firstVertex, bool indexed, GL
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
+    ShaderProgram *progPtr = mStateManager.GetActiveShaderProgram();
+    if(*progPtr->GetVkDescSet()) {
+        progPtr->UpdateBuiltInUniformData(mStateManager.GetViewportTransformationState()->GetMinDepthRange(),
+                                          mStateManager.GetViewportTransformationState()->GetMaxDepthRange());
+    }
+
+    UpdateVertexAttributes();
+    PrepareSampledTextures();
+
+    /// Uniform blocks, client vertex arrays and client indices are streamed to the ring buffers and changed
+    /// samplers are written to a descriptor set of the active frame. Only when the ring buffer regions or the
+    /// descriptor arena of the active frame are exhausted the recorded draws are submitted.
+    VkBuffer     indexBuffer = VK_NULL_HANDLE;
+    VkDeviceSize indexOffset = 0;
+    if(!UpdateDrawData(vertCount, firstVertex, indexed, type, indices, &indexBuffer, &indexOffset)) {
+        Flush();
+        if(!UpdateDrawData(vertCount, firstVertex, indexed, type, indices, &indexBuffer, &indexOffset)) {
+            RecordError(GL_OUT_OF_MEMORY);
+            return;
+        }
+    }
+
     BeginRendering();
-    UpdateVertexAttributes(vertCount, firstVertex);
 
     if(SetPipelineProgramShaderStages(mStateManager.GetActiveShaderProgram())) {
-        mPipeline->Create(mWriteFBO->GetVkRenderPass());
+        mPipeline->Create(mWriteFBO->GetRenderPass());
     }
 
     VkCommandBuffer activeCmdBuffer = mVkContext->mCommandBufferManager->GetActiveCommandBuffer();
     mPipeline->Bind(&activeCmdBuffer);
     BindUniformDescriptors(&activeCmdBuffer);
-    BindVertexBuffers(&activeCmdBuffer, indices, type, indexed, vertCount);
+
+    /// The draw command buffer is submitted only after the uploads of the textures it reads from,
+    /// including the texture that is sampled in place of incomplete ones
+    mDrawUploadSerial = std::max(mDrawUploadSerial, progPtr->GetSampledUploadSerial());
+
+    BindVertexBuffers(&activeCmdBuffer, indexBuffer, indexOffset, type);
 
     if(mPipeline->GetUpdateViewportState()) {
         mPipeline->ComputeViewport(mWriteFBO->GetHeight(),
@@ -194,114 +287,108 @@ Context::PushGeometry(uint32_t vertCount, uint32_t firstVertex, bool indexed, GL
     mPipeline->UpdateDynamicState(&activeCmdBuffer, mStateManager.GetRasterizationState()->GetLineWidth());
 
     DrawGeometry(&activeCmdBuffer, indexed, firstVertex, vertCount);
-
-    // TODO: Flush Vulkan cmd buffers in eglSwapBuffers for better performance.
-    Finish();
-
-    if(mWriteFBO == mSystemFBO) {
-        mWriteFBO->PrepareVkImage(VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
-    }
 }
 
-void Context::UpdateVertexAttributes(uint32_t vertCount, uint32_t firstVertex)
+void Context::UpdateVertexAttributes(void)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
     /// A glVertexAttrib related function has been called. Check to see if mVkPipelineVertexInput needs to be updated.
     /// If this is true then VkPipeline needs to be updated too.
-    /// Otherwise only the buffer that will be bound with vkCmdBindVertexBuffers need to be updated
-    if(mPipeline->GetUpdateVertexAttribVBOs() || firstVertex) {
-        mStateManager.GetActiveShaderProgram()->PrepareVertexAttribBufferObjects(vertCount, firstVertex, mResourceManager.GetGenericVertexAttributes());
+    /// Otherwise only the buffers that will be bound with vkCmdBindVertexBuffers need to be updated
+    if(mPipeline->GetUpdateVertexAttribVBOs()) {
+        mStateManager.GetActiveShaderProgram()->PrepareVertexAttribBufferObjects(mGenericVertexAttributes);
         mPipeline->SetUpdatePipeline(true);
         mPipeline->SetUpdateVertexAttribVBOs(false);
     }
 }
 
-void Context::BindUniformDescriptors(VkCommandBuffer *CmdBuffer)
+bool Context::UpdateDrawData(uint32_t vertCount, uint32_t firstVertex, bool indexed, GLenum type, const void *indices, VkBuffer *indexBuffer, VkDeviceSize *indexOffset)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    if(*mStateManager.GetActiveShaderProgram()->GetVkDescSet()) {
-        mStateManager.GetActiveShaderProgram()->UpdateBuiltInUniformData(mStateManager.GetViewportTransformationState()->GetMinDepthRange(),
-                                                                         mStateManager.GetViewportTransformationState()->GetMaxDepthRange());
-        mStateManager.GetActiveShaderProgram()->UpdateDescriptorSet();
-        vkCmdBindDescriptorSets(*CmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mStateManager.GetActiveShaderProgram()->GetVkPipelineLayout(), 0, 1, mStateManager.GetActiveShaderProgram()->GetVkDescSet(), 0, NULL);
+    ShaderProgram *progPtr = mStateManager.GetActiveShaderProgram();
+    /// The descriptor set refers to the uniform ring buffer the blocks have been streamed to
+    if(*progPtr->GetVkDescSet() && (!progPtr->UpdateUniformBufferData(mUniformRingBuffer, &mUniformStatistics) ||
+                                    !progPtr->UpdateDescriptorSet(mUniformRingBuffer->GetVkBuffer()))) {
+        return false;
     }
-}
 
-bool Context::AllocateTempIndexBuffer(const void *data, size_t size, BufferObject** ibo) {
-    if(mTempIbo != nullptr) {
-        delete mTempIbo;
-        mTempIbo = nullptr;
+    if(!progPtr->UpdateVertexAttribData(vertCount, firstVertex, mGenericVertexAttributes, mVertexRingBuffer)) {
+        return false;
     }
-    mTempIbo = new IndexBufferObject(mVkContext);
-    mTempIbo->SetTarget(GL_ELEMENT_ARRAY_BUFFER);
-    *ibo = mTempIbo;
-    return mTempIbo->Allocate(size, data);
+
+    return !indexed || UpdateIndexBuffer(vertCount, type, indices, indexBuffer, indexOffset);
 }
 
-bool Context::ConvertIndexBufferToUint16(const void* srcData, size_t elementCount, BufferObject** ibo) {
+bool Context::UpdateIndexBuffer(uint32_t vertCount, GLenum type, const void *indices, VkBuffer *indexBuffer, VkDeviceSize *indexOffset)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
 
-    uint16_t *converted_indices_u16 = new uint16_t[elementCount];
-    uint32_t actual_size = elementCount * sizeof(uint16_t);
+    // Index buffer requires special handling for passing data and handling unsigned bytes:
+    // - If there is a index buffer bound, use the indices parameter as offset.
+    // - Otherwise, indices contains the index buffer data. Therefore stream the data to the vertex ring buffer.
+    // If the data format is GL_UNSIGNED_BYTE (not supported by Vulkan), convert the data to uint16 while streaming it.
+    BufferObject *ibo = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ELEMENT_ARRAY_BUFFER);
+    if(ibo && type != GL_UNSIGNED_BYTE) {
+        *indexBuffer = ibo->GetVkBuffer();
+        *indexOffset = reinterpret_cast<VkDeviceSize>(indices);
+        return true;
+    }
 
-    bool validatedBuffer = ConvertBuffer<uint8_t, uint16_t>(srcData, converted_indices_u16, elementCount);
-    if(validatedBuffer) {
-        converted_indices_u16 = converted_indices_u16;
-        validatedBuffer = AllocateTempIndexBuffer(converted_indices_u16, actual_size, ibo);
+    vector<uint8_t> iboData;
+    const void *srcData = indices;
+    if(ibo) {
+        iboData.resize(vertCount);
+        ibo->GetData(vertCount, reinterpret_cast<VkDeviceSize>(indices), iboData.data());
+        srcData = iboData.data();
     }
-    delete[] converted_indices_u16;
 
-    return validatedBuffer;
+    if(!srcData) {
+        return true;
+    }
+
+    const VkDeviceSize size = vertCount * (type == GL_UNSIGNED_INT ? sizeof(GLuint) : sizeof(GLushort));
+    uint8_t *pData = mVertexRingBuffer->Allocate(size, indexOffset);
+    if(!pData) {
+        return false;
+    }
+
+    if(type == GL_UNSIGNED_BYTE) {
+        ConvertBuffer<uint8_t, uint16_t>(srcData, pData, vertCount);
+    } else {
+        memcpy(pData, srcData, size);
+    }
+    mVertexRingBuffer->Flush(size, *indexOffset);
+
+    *indexBuffer = mVertexRingBuffer->GetVkBuffer();
+
+    return true;
 }
 
-void Context::BindVertexBuffers(VkCommandBuffer *CmdBuffer, const void *indices, GLenum type, bool indexed, uint32_t vertCount)
+void Context::BindUniformDescriptors(VkCommandBuffer *CmdBuffer)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    if(mStateManager.GetActiveShaderProgram()->GetActiveVertexVkBuffersCount()) {
-        VkDeviceSize offsets[mStateManager.GetActiveShaderProgram()->GetActiveVertexVkBuffersCount()];
-        memset(offsets, 0, sizeof(VkDeviceSize) * mStateManager.GetActiveShaderProgram()->GetActiveVertexVkBuffersCount());
-        vkCmdBindVertexBuffers(*CmdBuffer, 0, mStateManager.GetActiveShaderProgram()->GetActiveVertexVkBuffersCount(), mStateManager.GetActiveShaderProgram()->GetActiveVertexVkBuffers(), offsets);
-    }
-
-    if(!indexed) {
-        return;
+    ShaderProgram *progPtr = mStateManager.GetActiveShaderProgram();
+    if(*progPtr->GetVkDescSet()) {
+        const vector<uint32_t> &dynamicOffsets = progPtr->GetDynamicOffsets();
+        vkCmdBindDescriptorSets(*CmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, progPtr->GetVkPipelineLayout(), 0, 1, progPtr->GetVkDescSet(),
+                                static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data());
     }
+}
 
-    VkDeviceSize offset = 0;
-    BufferObject *ibo = nullptr;
-    bool validatedBuffer = true;
-    uint32_t actual_size = vertCount * (type == GL_UNSIGNED_INT ? sizeof(GLuint) : sizeof(GLushort));
-
-    // Index buffer requires special handling for passing data and handling unsigned bytes:
-    // - If there is a index buffer bound, use the indices parameter as offset.
-    // - Otherwise, indices contains the index buffer data. Therefore create a temporary object and store the data there.
-    // If the data format is GL_UNSIGNED_BYTE (not supported by Vulkan), convert the data to uint16 and pass this instead.
-    if(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ELEMENT_ARRAY_BUFFER) != nullptr) {
-        ibo = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ELEMENT_ARRAY_BUFFER);
-        offset = reinterpret_cast<VkDeviceSize>(indices);
-
-        if(type == GL_UNSIGNED_BYTE) {
-            actual_size = ibo->GetSize();
-            assert(actual_size > 0);
-            uint8_t *srcData     = new uint8_t[actual_size];
-            ibo->GetData(actual_size, offset, srcData);
-            offset = 0;
-            validatedBuffer = ConvertIndexBufferToUint16(srcData, vertCount, &ibo);
-            delete[] srcData;
-        }
+void Context::BindVertexBuffers(VkCommandBuffer *CmdBuffer, VkBuffer indexBuffer, VkDeviceSize indexOffset, GLenum type)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
 
-    } else {
-        if(type == GL_UNSIGNED_BYTE) {
-            validatedBuffer = ConvertIndexBufferToUint16(indices, vertCount, &ibo);
-        } else {
-            validatedBuffer = AllocateTempIndexBuffer(indices, actual_size, &ibo);
-        }
+    ShaderProgram *progPtr = mStateManager.GetActiveShaderProgram();
+    if(progPtr->GetActiveVertexVkBuffersCount()) {
+        vkCmdBindVertexBuffers(*CmdBuffer, 0, progPtr->GetActiveVertexVkBuffersCount(), progPtr->GetActiveVertexVkBuffers(), progPtr->GetActiveVertexVkOffsets());
     }
 
-    if(validatedBuffer) {
-        vkCmdBindIndexBuffer(*CmdBuffer, ibo->GetVkBuffer(), offset, type == GL_UNSIGNED_INT ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16);
+    if(indexBuffer != VK_NULL_HANDLE) {
+        vkCmdBindIndexBuffer(*CmdBuffer, indexBuffer, indexOffset, type == GL_UNSIGNED_INT ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16);
     }
 }
 
@@ -393,15 +480,68 @@ Context::Finish(void)
 
     Flush();
 
+    mVkContext->mUploadQueue->WaitIdle();
     mVkContext->mCommandBufferManager->WaitLastSubmition();
 }
 
+void
+Context::FinishFrame(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// The swapchain image is transitioned for presentation once per frame, and only if
+    /// something has been rendered to it, at the end of the last submission of the frame.
+    if(mWriteFBO) {
+        EndRendering();
+    }
+    if(mSystemFBOPresentPending) {
+        mSystemFBO->PrepareVkImage(VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+        mSystemFBOPresentPending = false;
+    }
+
+    /// The frame is only submitted, recording the next one overlaps with its execution.
+    /// Its resources are recycled once the command buffer manager wraps around to it.
+    Flush();
+
+    if(GLOVE_DUMP_FRAME_STATISTICS) {
+        printf("FRAME STATISTICS: %u queue submissions, %u fence waits, pipeline cache %u hits / %u misses\n",
+               mVkContext->mCommandBufferManager->GetFrameSubmitCount(),
+               mVkContext->mCommandBufferManager->GetFrameFenceWaitCount(),
+               mPipeline->GetCacheHits(),
+               mPipeline->GetCacheMisses());
+        printf("FRAME STATISTICS: %.3f ms CPU recording, %.3f ms GPU execution (%s)\n",
+               mVkContext->mCommandBufferManager->GetFrameCpuTime(),
+               mVkContext->mCommandBufferManager->GetFrameGpuTime(),
+               mVkContext->mCommandBufferManager->IsGpuTimingSupported() ? "completed frames" : "unsupported");
+        printf("FRAME STATISTICS: %u uniform blocks, %llu uniform bytes uploaded / %llu modified\n",
+               mUniformStatistics.uploadedBlocks,
+               static_cast<unsigned long long>(mUniformStatistics.uploadedBytes),
+               static_cast<unsigned long long>(mUniformStatistics.modifiedBytes));
+    }
+
+    mFrameUniformStatistics = mUniformStatistics;
+    mUniformStatistics      = uniformStatistics_t();
+
+    mVkContext->mCommandBufferManager->ResetFrameStatistics();
+}
+
 void
 Context::Flush(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    mWriteFBO->EndVkRenderPass();
+    /// Contexts that have never been made current have nothing to flush
+    if(!mWriteFBO) {
+        return;
+    }
+
+    EndRendering();
     mVkContext->mCommandBufferManager->EndVkDrawCommandBuffer();
+
+    /// Pending texture uploads are submitted first. On a dedicated transfer queue
+    /// only the ones the recorded draws depend on are waited for.
+    mVkContext->mUploadQueue->Synchronize(mDrawUploadSerial);
+    mDrawUploadSerial = 0;
+
     mVkContext->mCommandBufferManager->SubmitVkDrawCommandBuffer();
 }
@@ -50,13 +50,15 @@ Context::CreateShader(GLenum type)
         return 0;
     }
 
-    GLuint res     = mResourceManager.AllocateShader();
-    Shader *shader = mResourceManager.GetShader(res);
+    GLuint res     = mResourceManager->AllocateShader();
+    Shader *shader = mResourceManager->GetShader(res);
     shader->SetShaderType(type == GL_VERTEX_SHADER ? SHADER_TYPE_VERTEX : SHADER_TYPE_FRAGMENT);
     shader->SetVkContext(mVkContext);
     shader->SetShaderCompiler(mShaderCompiler);
+    shader->SetCompileQueue(mShaderCompileQueue);
+    shader->SetShaderCache(mShaderCache);
 
-    return mResourceManager.PushShadingObject((ShadingNamespace_t){SHADER_ID, res});
+    return mResourceManager->PushShadingObject((ShadingNamespace_t){SHADER_ID, res});
 }
 
 void
@@ -80,9 +82,12 @@ Context::DeleteShader(Shader *shaderPtr)
         return;
     }
 
+    /// Pending compile or link tasks may still read the shader
+    shaderPtr->Synchronize();
+
     if(!shaderPtr->GetRefCount()) {
-        mResourceManager.EraseShadingObject(GetShaderId(shaderPtr));
-        mResourceManager.DeallocateShader(shaderPtr);
+        mResourceManager->EraseShadingObject(GetShaderId(shaderPtr));
+        mResourceManager->DeallocateShader(shaderPtr);
     } else {
         shaderPtr->MarkForDeletion();
     }
@@ -93,18 +98,18 @@ Context::GetShaderPtr(GLuint shader)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    if(!shader || shader >= mResourceManager.GetShadingObjectCount() || !mResourceManager.ShadingObjectExists(shader)) {
+    if(!shader || shader >= mResourceManager->GetShadingObjectCount() || !mResourceManager->ShadingObjectExists(shader)) {
         RecordError(GL_INVALID_VALUE);
         return nullptr;
     }
 
-    ShadingNamespace_t shadId = mResourceManager.GetShadingObject(shader);
+    ShadingNamespace_t shadId = mResourceManager->GetShadingObject(shader);
     if(!shadId.arrayIndex || shadId.type != SHADER_ID) {
         RecordError(GL_INVALID_OPERATION);
         return nullptr;
     }
 
-    return mResourceManager.GetShader(shadId.arrayIndex);
+    return mResourceManager->GetShader(shadId.arrayIndex);
 }
 
 void
@@ -117,6 +122,14 @@ Context::GetShaderiv(GLuint shader, GLenum pname, GLint *params)
         return;
     }
 
+    /// Completion status is polled without blocking, all other queries wait for the compilation
+    if(pname == GL_COMPLETION_STATUS_KHR) {
+        *params = shaderPtr->IsCompileCompleted() ? GL_TRUE : GL_FALSE;
+        return;
+    }
+
+    shaderPtr->Synchronize();
+
     switch(pname) {
     case GL_COMPILE_STATUS:         *params = shaderPtr->IsCompiled()           ? GL_TRUE : GL_FALSE; break;
     case GL_DELETE_STATUS:          *params = shaderPtr->GetMarkForDeletion()   ? GL_TRUE : GL_FALSE; break;
@@ -146,6 +159,8 @@ Context::GetShaderInfoLog(GLuint shader, GLsizei bufsize, GLsizei* length, char*
         return;
     }
 
+    shaderPtr->Synchronize();
+
     char *log = shaderPtr->GetInfoLog();
 
     if(log) {
@@ -269,7 +284,7 @@ Context::IsShader(GLuint shader)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    return mResourceManager.IsShadingObject(shader, SHADER_ID);
+    return mResourceManager->IsShadingObject(shader, SHADER_ID);
 }
 
 void
@@ -298,6 +313,8 @@ Context::ShaderSource(GLuint shader, GLsizei count, const GLchar* const* string,
         RecordError(GL_INVALID_VALUE);
         return;
     }
+
+    shaderPtr->Synchronize();
     shaderPtr->SetShaderSource(count, string, length);
 }
 
@@ -310,3 +327,15 @@ Context::ReleaseShaderCompiler(void)
 
     NOT_IMPLEMENTED();
 }
+
+void
+Context::MaxShaderCompilerThreadsKHR(GLuint count)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mMaxShaderCompilerThreads = count;
+
+    /// Tasks share the state of the context's compiler and run on one worker
+    /// thread in submission order. A count of zero executes them in place.
+    mShaderCompileQueue->SetAsynchronous(GLOVE_BACKGROUND_SHADER_COMPILATION && count > 0);
+}
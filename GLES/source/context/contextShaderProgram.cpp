@@ -81,13 +81,15 @@ Context::CreateProgram(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    GLuint         res     = mResourceManager.AllocateShaderProgram();
-    ShaderProgram *progPtr = mResourceManager.GetShaderProgram(res);
+    GLuint         res     = mResourceManager->AllocateShaderProgram();
+    ShaderProgram *progPtr = mResourceManager->GetShaderProgram(res);
     progPtr->SetVkContext(mVkContext);
     progPtr->SetGlContext(this);
     progPtr->SetShaderCompiler(mShaderCompiler);
+    progPtr->SetCompileQueue(mShaderCompileQueue);
+    progPtr->SetShaderCache(mShaderCache);
 
-    return mResourceManager.PushShadingObject((ShadingNamespace_t){SHADER_PROGRAM_ID, res});
+    return mResourceManager->PushShadingObject((ShadingNamespace_t){SHADER_PROGRAM_ID, res});
 }
 
 void
@@ -104,10 +106,11 @@ Context::DeleteProgram(GLuint program)
         return;
     }
 
+    /// The Vulkan objects of the program are retired, pending draws may still use them
     if(progPtr != mStateManager.GetActiveShaderProgram()) {
         progPtr->DetachAndDeleteShaders();
-        mResourceManager.EraseShadingObject(program);
-        mResourceManager.DeallocateShaderProgram(progPtr);
+        mResourceManager->EraseShadingObject(program);
+        mResourceManager->DeallocateShaderProgram(progPtr);
     } else {
         progPtr->MarkForDeletion();
     }
@@ -136,8 +139,9 @@ Context::DetachShader(GLuint program, GLuint shader)
     progPtr->DetachShader(shaderPtr);
 
     if(!shaderPtr->GetRefCount() && shaderPtr->GetMarkForDeletion()) {
-        mResourceManager.EraseShadingObject(shader);
-        mResourceManager.DeallocateShader(shaderPtr);
+        shaderPtr->Synchronize();
+        mResourceManager->EraseShadingObject(shader);
+        mResourceManager->DeallocateShader(shaderPtr);
     }
 }
 
@@ -284,15 +288,22 @@ Context::GetProgramBinaryOES(GLuint program, GLsizei bufSize, GLsizei *length, G
         return;
     }
 
-    progPtr->GetBinaryData(binary, length);
+    mShaderCompileQueue->WaitIdle();
 
-    if(bufSize < *length) {
-        *length = 0;
+    /// The data is written only if it fits, with the length that has been reported
+    if(bufSize < progPtr->GetBinaryLength()) {
+        if(length) {
+            *length = 0;
+        }
         RecordError(GL_INVALID_OPERATION);
         return;
     }
 
-    return;
+    GLsizei binaryLength = 0;
+    progPtr->GetBinaryData(binary, &binaryLength);
+    if(length) {
+        *length = binaryLength;
+    }
 }
 
 void
@@ -337,18 +348,33 @@ Context::GetProgramPtr(GLuint program)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    if(!program || program >= mResourceManager.GetShadingObjectCount() || !mResourceManager.ShadingObjectExists(program)) {
+    ShaderProgram *progPtr = LookupProgramPtr(program);
+
+    /// Every use of a program other than linking it needs the results of its pending link
+    if(progPtr) {
+        progPtr->Synchronize();
+    }
+
+    return progPtr;
+}
+
+ShaderProgram *
+Context::LookupProgramPtr(GLuint program)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(!program || program >= mResourceManager->GetShadingObjectCount() || !mResourceManager->ShadingObjectExists(program)) {
         RecordError(GL_INVALID_VALUE);
         return nullptr;
     }
 
-    ShadingNamespace_t progId = mResourceManager.GetShadingObject(program);
+    ShadingNamespace_t progId = mResourceManager->GetShadingObject(program);
     if(!progId.arrayIndex || progId.type != SHADER_PROGRAM_ID) {
         RecordError(GL_INVALID_OPERATION);
         return nullptr;
     }
 
-    return mResourceManager.GetShaderProgram(progId.arrayIndex);
+    return mResourceManager->GetShaderProgram(progId.arrayIndex);
 }
 
 void
@@ -359,12 +385,14 @@ Context::GetProgramiv(GLuint program, GLenum pname, GLint* params)
     if(pname != GL_DELETE_STATUS && pname != GL_LINK_STATUS && pname != GL_VALIDATE_STATUS &&
        pname != GL_INFO_LOG_LENGTH && pname != GL_ATTACHED_SHADERS && pname != GL_ACTIVE_ATTRIBUTES &&
        pname != GL_ACTIVE_ATTRIBUTE_MAX_LENGTH && pname != GL_ACTIVE_UNIFORMS &&
-       pname != GL_ACTIVE_UNIFORM_MAX_LENGTH && pname != GL_PROGRAM_BINARY_LENGTH_OES) {
+       pname != GL_ACTIVE_UNIFORM_MAX_LENGTH && pname != GL_PROGRAM_BINARY_LENGTH_OES &&
+       pname != GL_COMPLETION_STATUS_KHR) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
 
-    ShaderProgram *progPtr = GetProgramPtr(program);
+    /// Completion status is polled without blocking, all other queries wait for the link
+    ShaderProgram *progPtr = pname == GL_COMPLETION_STATUS_KHR ? LookupProgramPtr(program) : GetProgramPtr(program);
     if(!progPtr) {
         RecordError(GL_INVALID_VALUE);
         return;
@@ -386,6 +414,7 @@ Context::GetProgramiv(GLuint program, GLenum pname, GLint* params)
     case GL_ACTIVE_UNIFORMS:             *params = progPtr->GetNumberOfActiveUniforms(); break;
     case GL_ACTIVE_UNIFORM_MAX_LENGTH:   *params = progPtr->GetActiveUniformMaxLen(); break;
     case GL_PROGRAM_BINARY_LENGTH_OES:   *params = progPtr->GetBinaryLength(); break;
+    case GL_COMPLETION_STATUS_KHR:       *params = progPtr->IsLinkCompleted() ? GL_TRUE : GL_FALSE; break;
     default:                             RecordError(GL_INVALID_ENUM); return; break;
     }
 }
@@ -547,7 +576,7 @@ Context::IsProgram(GLuint program)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    return mResourceManager.IsShadingObject(program, SHADER_PROGRAM_ID);
+    return mResourceManager->IsShadingObject(program, SHADER_PROGRAM_ID);
 }
 
 bool
@@ -576,16 +605,24 @@ Context::LinkProgram(GLuint program)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    ShaderProgram *progPtr = GetProgramPtr(program);
+    ShaderProgram *progPtr = LookupProgramPtr(program);
     if(!progPtr) {
         return;
     }
+
     progPtr->LinkProgram();
-    progPtr->SetShaderModules();
+
+    /// The program in use is needed by the next draw, so its link is waited for
+    /// here. Any other program completes when it is first used or queried.
+    if(progPtr != mStateManager.GetActiveShaderProgram() && mShaderCompileQueue->IsAsynchronous()) {
+        return;
+    }
+
+    progPtr->Synchronize();
 
     mPipeline->SetUpdatePipeline(progPtr->IsLinked());
     if(SetPipelineProgramShaderStages(progPtr)) {
-        mPipeline->Create(mWriteFBO->GetVkRenderPass());
+        mPipeline->Create(mWriteFBO->GetRenderPass());
     }
 }
 
@@ -606,6 +643,11 @@ Context::ProgramBinaryOES(GLuint program, GLenum binaryFormat, const void *binar
         return;
     }
 
+    Finish();
+
+    /// The reflection of the compiler is shared with the pending compile tasks
+    mShaderCompileQueue->WaitIdle();
+
     GLuint vs = CreateShader(GL_VERTEX_SHADER);
     GLuint fs = CreateShader(GL_FRAGMENT_SHADER);
     AttachShader(program, vs);
@@ -1358,8 +1400,8 @@ Context::UseProgram(GLuint program)
 
     if(mStateManager.GetActiveShaderProgram() && mStateManager.GetActiveShaderProgram()->GetMarkForDeletion()) {
         mStateManager.GetActiveShaderProgram()->DetachAndDeleteShaders();
-        mResourceManager.EraseShadingObject(GetProgramId(mStateManager.GetActiveShaderProgram()));
-        mResourceManager.DeallocateShaderProgram(mStateManager.GetActiveShaderProgram());
+        mResourceManager->EraseShadingObject(GetProgramId(mStateManager.GetActiveShaderProgram()));
+        mResourceManager->DeallocateShaderProgram(mStateManager.GetActiveShaderProgram());
     }
 
     mStateManager.GetActiveObjectsState()->SetActiveShaderProgram(progPtr);
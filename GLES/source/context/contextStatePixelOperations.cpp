@@ -93,6 +93,8 @@ Context::ReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum form
 
     // The selected image has to be read with reverted y offset from Vulkan layer
     srcRect.y = activeTexture->GetInvertedYOrigin(&srcRect);
+
+    Finish();
     activeTexture->CopyPixelsToHost(&srcRect, &dstRect, 0, 0, dstInternalFormat, pixels);
 
 #if GLOVE_SAVE_READPIXELS_TO_FILE == true
@@ -51,7 +51,7 @@ Context::BindTexture(GLenum target, GLuint texture)
     Texture *tex = nullptr;
     if(texture)
     {
-        tex = mResourceManager.GetTexture(texture);
+        tex = mResourceManager->GetTexture(texture);
 
         if(tex->GetTarget() == GL_INVALID_VALUE) {
             tex->SetVkContext(mVkContext);
@@ -65,7 +65,7 @@ Context::BindTexture(GLenum target, GLuint texture)
             return;
         }
     } else {
-        tex = mResourceManager.GetDefaultTexture(target);
+        tex = GetDefaultTexture(target);
     }
 
     mStateManager.GetActiveObjectsState()->SetActiveTexture(target, tex);
@@ -84,11 +84,19 @@ Context::DeleteTextures(GLsizei n, const GLuint* textures)
         return;
     }
 
+    /// The Vulkan objects of the textures are retired, so pending draws may keep sampling from them.
+    /// Only the render pass that is being recorded must end, if the textures are attached to it.
     while (n-- != 0) {
         uint32_t texture = *textures++;
 
-        if (texture && mResourceManager.TextureExists(texture)) {
-            Texture *tex = mResourceManager.GetTexture(texture);
+        if (texture && mResourceManager->TextureExists(texture)) {
+            Texture *tex = mResourceManager->GetTexture(texture);
+
+            if(tex == mWriteFBO->GetColorAttachmentTexture() ||
+               tex == mWriteFBO->GetDepthAttachmentTexture() ||
+               tex == mWriteFBO->GetStencilAttachmentTexture()) {
+                Flush();
+            }
 
             if(tex == mWriteFBO->GetColorAttachmentTexture()) {
                 mWriteFBO->SetColorAttachmentTexture(nullptr);
@@ -111,11 +119,11 @@ Context::DeleteTextures(GLsizei n, const GLuint* textures)
             GLenum target = tex->GetTarget();
             for(int i = 0; i < GLOVE_MAX_COMBINED_TEXTURE_IMAGE_UNITS && target != GL_INVALID_VALUE; ++i) {
                 if(mStateManager.GetActiveObjectsState()->EqualsActiveTexture(target, i, tex)) {
-                    mStateManager.GetActiveObjectsState()->SetActiveTexture(target, i, mResourceManager.GetDefaultTexture(target));
+                    mStateManager.GetActiveObjectsState()->SetActiveTexture(target, i, GetDefaultTexture(target));
                 }
             }
 
-            mResourceManager.DeallocateTexture(texture);
+            mResourceManager->DeallocateTexture(texture);
         }
     }
 }
@@ -147,7 +155,19 @@ Context::GenerateMipmap(GLenum target)
         return;
     }
 
+    /// The levels are blitted from the base level on the device, after the rendering that may have written to it
+    if(activeTexture->IsReadbackRequired()) {
+        Finish();
+    } else if(mWriteFBO) {
+        EndRendering();
+    }
+
     activeTexture->GenerateMipmaps(mStateManager.GetHintAspectsState()->GetMode(GL_GENERATE_MIPMAP_HINT));
+
+    mDrawUploadSerial = std::max(mDrawUploadSerial, activeTexture->GetUploadSerial());
+    if(mStateManager.GetActiveShaderProgram() != nullptr) {
+        mStateManager.GetActiveShaderProgram()->EnableUpdateOfDescriptorSets();
+    }
 }
 
 void
@@ -161,7 +181,7 @@ Context::GenTextures(GLsizei n, GLuint* textures)
     }
 
     while (n != 0) {
-        *textures++ = mResourceManager.AllocateTexture();
+        *textures++ = mResourceManager->AllocateTexture();
         --n;
     }
 }
@@ -302,7 +322,112 @@ Context::IsTexture(GLuint texture)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    return (texture && mResourceManager.TextureExists(texture) && mResourceManager.GetTexture(texture)->GetTarget() != GL_INVALID_VALUE) ? GL_TRUE : GL_FALSE;
+    return (texture && mResourceManager->TextureExists(texture) && mResourceManager->GetTexture(texture)->GetTarget() != GL_INVALID_VALUE) ? GL_TRUE : GL_FALSE;
+}
+
+Texture *
+Context::GetSampledTexture(GLenum target, int unit)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    Texture *activeTexture = mStateManager.GetActiveObjectsState()->GetActiveTexture(target, unit);
+    if(activeTexture->IsCompleted()) {
+        return activeTexture;
+    }
+
+    /// Incomplete textures are sampled as opaque black. Their levels are left as they
+    /// are, and their image is only created once they have been completed.
+    Texture *&incompleteTexture = target == GL_TEXTURE_2D ? mIncompleteTexture2D : mIncompleteTextureCubeMap;
+    if(!incompleteTexture) {
+        const uint8_t pixels[4] = {0, 0, 0, 255};
+
+        incompleteTexture = new Texture(mVkContext);
+        incompleteTexture->SetTarget(target);
+        incompleteTexture->SetVkFormat(VK_FORMAT_R8G8B8A8_UNORM);
+        incompleteTexture->SetVkImageUsage(static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
+        incompleteTexture->SetVkImageTarget(target == GL_TEXTURE_2D ? vulkanAPI::Image::VK_IMAGE_TARGET_2D : vulkanAPI::Image::VK_IMAGE_TARGET_CUBE);
+        incompleteTexture->InitState();
+        for(GLint layer = 0; layer < incompleteTexture->GetLayersCount(); ++layer) {
+            incompleteTexture->SetState(1, 1, 0, layer, GL_RGBA, GL_UNSIGNED_BYTE, Texture::GetDefaultInternalAlignment(), pixels);
+        }
+        incompleteTexture->IsCompleted();
+        incompleteTexture->Allocate();
+    }
+
+    return incompleteTexture;
+}
+
+void
+Context::AllocateTexture(Texture *texture)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// Levels that the new image does not have are read back after the rendering that may have
+    /// written to them. The ones it keeps are copied over outside of any render pass.
+    /// Uploads are submitted ahead of the draw command buffer, so the draws recorded so far, that
+    /// may sample the current contents of the texture, are submitted before the new ones. Submission
+    /// order does not hold across queues, so on a dedicated transfer queue they are waited for.
+    const bool sampledDrawsPending = texture->GetImage()->GetImage() != VK_NULL_HANDLE &&
+                                     mVkContext->mCommandBufferManager->IsDrawCommandBufferRecording();
+    if(texture->IsReadbackRequired() || (sampledDrawsPending && mVkContext->mUploadQueue->IsDedicatedQueue())) {
+        Finish();
+    } else if(sampledDrawsPending) {
+        Flush();
+    } else if(mWriteFBO) {
+        EndRendering();
+    }
+
+    /// The previous image is retired until the draws and uploads that reference it have completed
+    texture->Allocate();
+
+    /// The copies of the levels that are kept are recorded after the uploads of the new image
+    mDrawUploadSerial = std::max(mDrawUploadSerial, texture->GetUploadSerial());
+    if(mStateManager.GetActiveShaderProgram() != nullptr) {
+        mStateManager.GetActiveShaderProgram()->EnableUpdateOfDescriptorSets();
+    }
+}
+
+bool
+Context::IsFramebufferCopySupported(const Texture *texture, GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// Blits copy all channels of the color attachment, the sampled views of the textures give
+    /// only those of their base format. The rectangle has to lie inside the attachment.
+    const Texture *fbTexture = mWriteFBO->GetColorAttachmentTexture();
+    return fbTexture != nullptr && fbTexture != texture                                     &&
+           x >= 0 && y >= 0 && x + width  <= mWriteFBO->GetWidth()                          &&
+                               y + height <= mWriteFBO->GetHeight();
+}
+
+bool
+Context::CopyFramebufferToTexture(Texture *texture, GLint level, GLint layer, GLint xoffset, GLint yoffset, GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!texture->IsCompleted() || !IsFramebufferCopySupported(texture, x, y, width, height)) {
+        return false;
+    }
+
+    /// Whether the image can be blitted to depends on its tiling, which is only known once it has been created
+    Texture *fbTexture = mWriteFBO->GetColorAttachmentTexture();
+    if(!texture->IsBlitSupported(fbTexture)) {
+        return false;
+    }
+
+    /// The framebuffer is rendered upside down, its rows are flipped by the blit
+    const GLint fbLayer = fbTexture->GetTarget() == GL_TEXTURE_CUBE_MAP ? mWriteFBO->GetColorAttachmentLayer() - GL_TEXTURE_CUBE_MAP_POSITIVE_X : 0;
+    const Rect srcRect(x, mWriteFBO->GetHeight() - height - y, width, height);
+    const Rect dstRect(xoffset, yoffset, width, height);
+
+    /// The blit is recorded outside of any render pass, after the pending uploads to the texture
+    EndRendering();
+    if(!texture->BlitPixelsFromTexture(fbTexture, &srcRect, mWriteFBO->GetColorAttachmentLevel(), fbLayer, &dstRect, level, layer, true)) {
+        return false;
+    }
+
+    mDrawUploadSerial = std::max(mDrawUploadSerial, texture->GetUploadSerial());
+    return true;
 }
 
 void
@@ -371,12 +496,15 @@ Context::TexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei w
     GLint layer = (target == GL_TEXTURE_2D) ? 0 : target - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
     Texture *activeTexture = mStateManager.GetActiveObjectsState()->GetActiveTexture(target);
 
-    // copy the buffer contents to the texture
+    // keep the buffer contents until the texture is complete
     activeTexture->SetState(width, height, level, layer, format, type, mStateManager.GetPixelStorageState()->GetPixelStoreUnpack(), pixels);
 
     if(activeTexture->IsCompleted()) {
         // pass contents to the driver
-        activeTexture->Allocate();
+        AllocateTexture(activeTexture);
+    } else if(mStateManager.GetActiveShaderProgram() != nullptr) {
+        // sample the incomplete texture as such
+        mStateManager.GetActiveShaderProgram()->EnableUpdateOfDescriptorSets();
     }
 }
 
@@ -445,12 +573,26 @@ Context::TexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset,
                       GlTypeToElementSize(activeTexture->GetType()),
                       Texture::GetDefaultInternalAlignment());
 
-    // copy the buffer contents to the texture
+    // copy only the subrectangle into the existing image, outside of any render pass and
+    // after the pending uploads to it, unless the image has to be created again anyway
+    if(mWriteFBO && activeTexture->IsCompleted()) {
+        EndRendering();
+        if(activeTexture->UpdatePixelsFromHost(&srcRect, &dstRect, level, layer, srcInternalFormat, pixels, mTextureRingBuffer)) {
+            mDrawUploadSerial = std::max(mDrawUploadSerial, activeTexture->GetUploadSerial());
+            return;
+        }
+    }
+
+    // otherwise update the contents on the host, reading back the rest
+    // of the level first if it only lives in the image
+    if(activeTexture->IsReadbackRequired(&dstRect, level, layer)) {
+        Finish();
+    }
     activeTexture->SetSubState(&srcRect, &dstRect, level, layer, srcInternalFormat, pixels);
 
     if(activeTexture->IsCompleted()) {
         // pass contents to the driver
-        activeTexture->Allocate();
+        AllocateTexture(activeTexture);
     }
 }
 
@@ -503,10 +645,34 @@ Context::CopyTexImage2D(GLenum target, GLint level, GLenum internalformat, GLint
        return;
     }
 
-    // transfer the data to the cpu and upload it to a new texture
+    const GLint    layer   = (target == GL_TEXTURE_2D) ? 0 : target - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
+    const GLenum   dstType = GlInternalFormatToGlType(internalformat);
+
+    // blit the framebuffer into the level on the device, into the existing image if the
+    // level is specified again as it was, otherwise into the image that is created for it.
+    // Blits to the image are checked for once it has been created.
+    if(IsFramebufferCopySupported(activeTexture, x, y, width, height)) {
+        const bool respecified = !activeTexture->IsCompleted()                                       ||
+                                 level >= activeTexture->GetMipLevelsCount()                         ||
+                                 width  != std::max(activeTexture->GetWidth()  >> level, 1)          ||
+                                 height != std::max(activeTexture->GetHeight() >> level, 1)          ||
+                                 internalformat != activeTexture->GetFormat()                        ||
+                                 dstType        != activeTexture->GetType();
+        if(respecified) {
+            activeTexture->SetState(width, height, level, layer, internalformat, dstType, Texture::GetDefaultInternalAlignment(), nullptr);
+            if(activeTexture->IsCompleted()) {
+                AllocateTexture(activeTexture);
+            }
+        }
+
+        if(CopyFramebufferToTexture(activeTexture, level, layer, 0, 0, x, y, width, height)) {
+            return;
+        }
+    }
+
+    // otherwise transfer the data to the cpu and upload it to a new texture
     GLenum srcInternalFormat = GlFormatToGlInternalFormat(fbFormat, fbTexture->GetType());
     GLenum dstInternalFormat = internalformat;
-    GLenum dstType           = GlInternalFormatToGlType(dstInternalFormat);
     ImageRect srcRect(x, y, width, height,
                       GlInternalFormatTypeToNumElements(srcInternalFormat, fbTexture->GetType()),
                       GlTypeToElementSize(fbTexture->GetType()),
@@ -516,12 +682,13 @@ Context::CopyTexImage2D(GLenum target, GLint level, GLenum internalformat, GLint
                       GlTypeToElementSize(dstType),
                       Texture::GetDefaultInternalAlignment());
 
-    const GLint    layer   = (target == GL_TEXTURE_2D) ? 0 : target - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
-
     const size_t stageSize = dstRect.GetRectBufferSize();
     uint8_t *stagePixels = new uint8_t[stageSize];
     srcRect.y = fbTexture->GetInvertedYOrigin(&srcRect);
 
+    // execute pending rendering before reading back the framebuffer
+    Finish();
+
     // copy the framebuffer contents to the temp buffer
     // and convert them to the texture's internal format
     fbTexture->CopyPixelsToHost(&srcRect, &dstRect, 0, layer, internalformat, (void *)stagePixels);
@@ -532,7 +699,7 @@ Context::CopyTexImage2D(GLenum target, GLint level, GLenum internalformat, GLint
 
     if(activeTexture->IsCompleted()) {
         // pass contents to the driver
-        activeTexture->Allocate();
+        AllocateTexture(activeTexture);
     }
 }
 
@@ -582,6 +749,12 @@ Context::CopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoff
     }
     GLint layer = (target == GL_TEXTURE_2D) ? 0 : target - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
 
+    // blit the framebuffer subrectangle into the existing image on the device
+    if(CopyFramebufferToTexture(activeTexture, level, layer, xoffset, yoffset, x, y, width, height)) {
+        return;
+    }
+
+    // otherwise transfer the data to the cpu and update the texture from there
      GLenum srcInternalFormat = GlFormatToGlInternalFormat(fbFormat, fbTexture->GetType());
      GLenum dstInternalFormat = internalformat;
      ImageRect srcRect(x,       y,       width, height,
@@ -597,6 +770,9 @@ Context::CopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoff
      uint8_t *stagePixels = new uint8_t[stageSize];
      srcRect.y = fbTexture->GetInvertedYOrigin(&srcRect);
 
+     // execute pending rendering before reading back the framebuffer
+     Finish();
+
      // copy the framebuffer subcontents to the temp buffer
      // and convert them to the texture's internal format
      fbTexture->CopyPixelsToHost(&srcRect, &dstRect, 0, layer, dstInternalFormat, (void *)stagePixels);
@@ -612,7 +788,7 @@ Context::CopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoff
 
      if(activeTexture->IsCompleted()) {
          // pass contents to the driver
-         activeTexture->Allocate();
+         AllocateTexture(activeTexture);
      }
 }
 
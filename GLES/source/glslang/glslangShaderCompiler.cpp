@@ -22,10 +22,25 @@
  */
 
 #include "glslangShaderCompiler.h"
+#include <chrono>
 
 bool GlslangShaderCompiler::mSlangInitialized = false;
+uint32_t GlslangShaderCompiler::mSlangRefCount = 0;
+std::mutex GlslangShaderCompiler::mSlangMutex;
 static TBuiltInResource slangShaderResources;
 
+typedef std::chrono::steady_clock compileClock_t;
+
+static inline double
+ElapsedMilliseconds(compileClock_t::time_point &start)
+{
+    const compileClock_t::time_point now = compileClock_t::now();
+    const double elapsed = std::chrono::duration<double, std::milli>(now - start).count();
+    start = now;
+
+    return elapsed;
+}
+
 GlslangShaderCompiler::GlslangShaderCompiler()
 : mSlangVertCompiler(nullptr),
   mSlangFragCompiler(nullptr),
@@ -87,11 +102,19 @@ GlslangShaderCompiler::CompileVertexShader(const char* const* source)
         delete mSlangVertCompiler;
     }
 
+    compileClock_t::time_point start = compileClock_t::now();
+
     mVertSource = string(*source);
     mSlangVertCompiler = new GlslangCompiler();
     assert(mSlangVertCompiler);
 
-    return mSlangVertCompiler->CompileShader(source, &slangShaderResources, EShLangVertex);
+    const bool result = mSlangVertCompiler->CompileShader(source, &slangShaderResources, EShLangVertex);
+
+    if(GLOVE_DUMP_SHADER_COMPILE_TIMES) {
+        printf("SHADER COMPILE TIMES: vertex shader compiled in %.3f ms\n", ElapsedMilliseconds(start));
+    }
+
+    return result;
 }
 
 bool
@@ -105,11 +128,19 @@ GlslangShaderCompiler::CompileFragmentShader(const char* const* source)
         delete mSlangFragCompiler;
     }
 
+    compileClock_t::time_point start = compileClock_t::now();
+
     mFragSource = string(*source);
     mSlangFragCompiler = new GlslangCompiler();
     assert(mSlangFragCompiler);
 
-    return mSlangFragCompiler->CompileShader(source, &slangShaderResources, EShLangFragment);
+    const bool result = mSlangFragCompiler->CompileShader(source, &slangShaderResources, EShLangFragment);
+
+    if(GLOVE_DUMP_SHADER_COMPILE_TIMES) {
+        printf("SHADER COMPILE TIMES: fragment shader compiled in %.3f ms\n", ElapsedMilliseconds(start));
+    }
+
+    return result;
 }
 
 const char*
@@ -186,6 +217,14 @@ GlslangShaderCompiler::PrepareReflection(void)
     CompileUniforms(mSlangProgLinker->GetSlangProgram());
 }
 
+const char*
+GlslangShaderCompiler::GetShaderSource(shader_type_t shaderType)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    return (shaderType == SHADER_TYPE_VERTEX) ? mVertSource.c_str() : mFragSource.c_str();
+}
+
 bool
 GlslangShaderCompiler::LinkProgram(ShaderProgram& shaderProgram)
 {
@@ -200,12 +239,18 @@ GlslangShaderCompiler::LinkProgram(ShaderProgram& shaderProgram)
         SaveShaderSourceToFile(&shaderProgram, false, mFragSource.c_str(), SHADER_TYPE_FRAGMENT);
     }
 
+    /// Time spent per step of the link, see GLOVE_DUMP_SHADER_COMPILE_TIMES
+    double convertTime, compileTime, linkTime, spirvTime;
+    compileClock_t::time_point start = compileClock_t::now();
+
     Shader* vertex = shaderProgram.GetVertexShader();
     assert(vertex);
 
     mVertSource400 = string(mVertSource);
     const char* source = ConvertShader(shaderProgram, SHADER_TYPE_VERTEX);
+    convertTime = ElapsedMilliseconds(start);
     result = mSlangVertCompiler->CompileShader400(&source, &slangShaderResources, EShLangVertex);
+    compileTime = ElapsedMilliseconds(start);
     if(!result) {
         return false;
     }
@@ -215,7 +260,9 @@ GlslangShaderCompiler::LinkProgram(ShaderProgram& shaderProgram)
 
     mFragSource400 = string(mFragSource);
     source = ConvertShader(shaderProgram, SHADER_TYPE_FRAGMENT);
+    convertTime += ElapsedMilliseconds(start);
     result = mSlangFragCompiler->CompileShader400(&source, &slangShaderResources, EShLangFragment);
+    compileTime += ElapsedMilliseconds(start);
     if(!result) {
         return false;
     }
@@ -229,8 +276,15 @@ GlslangShaderCompiler::LinkProgram(ShaderProgram& shaderProgram)
     SetUniformBlocksSizes(mSlangProgLinker->GetSlangProgram400());
     SetUniformBlocksOffset(mSlangProgLinker->GetSlangProgram400());
     BuildUniformReflection();
+    linkTime = ElapsedMilliseconds(start);
 
     mSlangProgLinker->GenerateSPV(vertex->GetSPV(), fragment->GetSPV());
+    spirvTime = ElapsedMilliseconds(start);
+
+    if(GLOVE_DUMP_SHADER_COMPILE_TIMES) {
+        printf("SHADER COMPILE TIMES: program converted in %.3f ms, recompiled in %.3f ms, linked in %.3f ms, SPIR-V generated in %.3f ms\n",
+               convertTime, compileTime, linkTime, spirvTime);
+    }
 
     if(mSaveBinaryToFiles) {
         SaveBinaryToFiles(&shaderProgram);
@@ -324,7 +378,9 @@ GlslangShaderCompiler::InitializeGlslang()
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(!mSlangInitialized) {
+    std::lock_guard<std::mutex> lock(mSlangMutex);
+
+    if(!mSlangRefCount++) {
         mSlangInitialized = glslang::InitializeProcess();
         InitSlangShaderResources();
     }
@@ -353,7 +409,10 @@ GlslangShaderCompiler::TerminateGlslang()
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mSlangInitialized) {
+    std::lock_guard<std::mutex> lock(mSlangMutex);
+
+    assert(mSlangRefCount);
+    if(!--mSlangRefCount && mSlangInitialized) {
         glslang::FinalizeProcess();
         mSlangInitialized = false;
     }
@@ -34,6 +34,9 @@
 class GlslangShaderCompiler : public ShaderCompiler {
 private:
     static bool mSlangInitialized;
+    /// glslang is initialized once per process and shared by the compilers of all contexts
+    static uint32_t mSlangRefCount;
+    static std::mutex mSlangMutex;
     GlslangCompiler* mSlangVertCompiler;
     GlslangCompiler* mSlangFragCompiler;
     GlslangLinker*   mSlangProgLinker;
@@ -108,6 +111,7 @@ public:
     bool CompileFragmentShader(const char* const* source) override;
     const char* GetProgramInfoLog(void) override;
     const char* GetShaderInfoLog(shader_type_t shaderType) override;
+    const char* GetShaderSource(shader_type_t shaderType) override;
     bool LinkProgram(ShaderProgram& shaderProgram) override;
     void PrepareReflection(void) override;
     uint32_t SerializeReflection(void* binary) override;
@@ -73,7 +73,14 @@ const char * const ShaderConverter::shaderLimitsBuiltIns = "#define gl_MaxVertex
 ShaderConverter::ShaderConverter()
 : mConversionType(INVALID_SHADER_CONVERSION),
   mShaderType(INVALID_SHADER),
-  mMemLayoutQualifier("std140")
+  mMemLayoutQualifier("std140"),
+  mSlangProg(nullptr),
+  mIoMapResolver(nullptr),
+  mUniformBlockMap(nullptr),
+  mReflection(nullptr),
+  mUnusedBlockBindings(0),
+  mLastClosingBrace(string::npos),
+  mCloseUniformBlock(false)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 }
@@ -100,14 +107,27 @@ ShaderConverter::Convert100To400(std::string& source, const uniformBlockMap_t &u
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    ProcessHeader(source, uniformBlockMap);
-    ProcessUniforms(source, uniformBlockMap);
-    ProcessVaryings(source);
-    ProcessVertexAttributes(source, reflection);
+    mUniformBlockMap     = &uniformBlockMap;
+    mReflection          = reflection;
+    mUnusedBlockBindings = uniformBlockMap.size();
+    mCloseUniformBlock   = false;
+    mLastClosingBrace    = string::npos;
+
+    BuildVaryingLocations();
+
+    /// The source is converted in a single pass, straight into the output,
+    /// instead of being rewritten in place once per kind of declaration
+    string converted;
+    converted.reserve(2 * source.size() + 2048);
+
+    EmitHeader(converted);
+    ConvertDeclarations(source, converted, true);
 
     if(mShaderType == SHADER_TYPE_VERTEX) {
-        ConvertGLToVulkanDepthRange(source);
+        ConvertGLToVulkanDepthRange(converted);
     }
+
+    source.swap(converted);
 }
 
 void
@@ -120,221 +140,362 @@ ShaderConverter::Initialize(shader_conversion_type_t conversionType, shader_type
 }
 
 void
-ShaderConverter::ProcessHeader(std::string& source, const uniformBlockMap_t &uniformBlockMap)
+ShaderConverter::EmitHeader(string &output)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    /// Do not add vulkan_DepthRange declaration if gl_DepthRange is not active in the input shader
-    const bool depthRangeActive = uniformBlockMap.find(string("gl_DepthRange")) != uniformBlockMap.cend();
-    const string sourceHeader = string(shaderVersion) +
-                                string(shaderExtensions) +
-                                string(shaderPrecision) +
-                                string(shaderTexture2d) +
-                                string(shaderTextureCube) +
-                                (depthRangeActive ? string(shaderDepthRange) : string("")) +
-                                string(shaderLimitsBuiltIns);
-
-    /// If #version is present
-    size_t found = source.find("#version");
-    if(found != string::npos) {
-        size_t f1 = source.find("\n", found);
-        source.replace(found, f1 - found, sourceHeader);
-    } else {
-        source.insert(0, sourceHeader);
+    output.append(shaderVersion);
+    output.append(shaderExtensions);
+    output.append(shaderPrecision);
+    output.append(shaderTexture2d);
+    output.append(shaderTextureCube);
+
+    /// Do not add vulkan_DepthRange declaration if gl_DepthRange is not active in the input shader.
+    /// It is the only part of the header holding declarations to convert.
+    if(mUniformBlockMap->find(string("gl_DepthRange")) != mUniformBlockMap->cend()) {
+        ConvertDeclarations(string(shaderDepthRange), output, false);
     }
+
+    output.append(shaderLimitsBuiltIns);
 }
 
 void
-ShaderConverter::ProcessUniforms(std::string& source, const uniformBlockMap_t &uniformBlockMap)
+ShaderConverter::BuildVaryingLocations(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    /// Start of dead uniform blocks where the active end
-    uint32_t unusedBlockBindings = uniformBlockMap.size();
-    uniformBlockMap_t::const_iterator uniBlockIt;
-    string layoutSyntax;
-    string blockSyntax;
-
-    /// Convert uniforms into uniform blocks
-    string token;
-    const string uniformLiteralStr("uniform");
-
-    size_t found = FindToken(uniformLiteralStr, source, 0);
-    while(found != string::npos) {
-        size_t f1 = found;
-        found = SkipWhiteSpaces(source, found + uniformLiteralStr.length());
-
-        /// Either type or precision qualifier
-        token = GetNextToken(source, found);
-        if(IsPrecisionQualifier(token)) {
-            found = SkipWhiteSpaces(source, found + token.length());
-            token = GetNextToken(source, found);
+    assert(mSlangProg);
+
+    int location = 0;
+    mVaryingLocations.clear();
+    for(uint32_t out = 0; out < mIoMapResolver->GetNumLiveVaryingOutVariables(); ++out) {
+        for(uint32_t in = 0; in < mIoMapResolver->GetNumLiveVaryingInVariables(); ++in) {
+            const char *inName = mIoMapResolver->GetVaryingInName(in);
+            const char *outName = mIoMapResolver->GetVaryingOutName(out);
+            if(!strcmp(inName, outName)) {
+                assert(mVaryingLocations.find(string(inName)) == mVaryingLocations.end());
+                mVaryingLocations[string(inName)] = location;
+                location++;
+            }
         }
+    }
+}
 
-        /// Definitely type now
-        if(!CanTypeBeInUniformBlock(token)) {
-            /// Sampler type
-            found = SkipWhiteSpaces(source, found + token.length());
-            /// Variable name
-            token = GetNextToken(source, found);
+/// Classes of the characters of the source, looked up once per character by the scan
+#define CHAR_CLASS_WORD                                 0x01
+#define CHAR_CLASS_SPACE                                0x02
+#define CHAR_CLASS_SPECIAL                              0x04
+
+static const struct CharClassTable {
+    uint8_t classes[256];
+
+    CharClassTable()
+    {
+        memset(classes, 0, sizeof(classes));
+        for(int c = 'a'; c <= 'z'; ++c) { classes[c] = CHAR_CLASS_WORD; }
+        for(int c = 'A'; c <= 'Z'; ++c) { classes[c] = CHAR_CLASS_WORD; }
+        for(int c = '0'; c <= '9'; ++c) { classes[c] = CHAR_CLASS_WORD; }
+        classes[static_cast<uint8_t>('_')]  = CHAR_CLASS_WORD;
+
+        classes[static_cast<uint8_t>(' ')]  = CHAR_CLASS_SPACE;
+        classes[static_cast<uint8_t>('\t')] = CHAR_CLASS_SPACE;
+        classes[static_cast<uint8_t>('\r')] = CHAR_CLASS_SPACE;
+        classes[static_cast<uint8_t>('\v')] = CHAR_CLASS_SPACE;
+        classes[static_cast<uint8_t>('\f')] = CHAR_CLASS_SPACE;
+        classes[static_cast<uint8_t>('\n')] = CHAR_CLASS_SPACE | CHAR_CLASS_SPECIAL;
+
+        /// Characters that start comments and directives, or end blocks and declarations
+        classes[static_cast<uint8_t>('/')]  = CHAR_CLASS_SPECIAL;
+        classes[static_cast<uint8_t>('#')]  = CHAR_CLASS_SPECIAL;
+        classes[static_cast<uint8_t>('{')]  = CHAR_CLASS_SPECIAL;
+        classes[static_cast<uint8_t>('}')]  = CHAR_CLASS_SPECIAL;
+        classes[static_cast<uint8_t>(';')]  = CHAR_CLASS_SPECIAL;
+    }
+} charClassTable;
 
-            uniBlockIt = uniformBlockMap.find(token);
-            if(uniBlockIt != uniformBlockMap.cend()) {
-                layoutSyntax = "layout(binding = " + to_string(uniBlockIt->second.binding) + string(") ");
-            } else {
-                layoutSyntax = "layout(binding = " + to_string(unusedBlockBindings) + string(") ");
-                ++unusedBlockBindings;
-            }
-            source.insert(f1, layoutSyntax);
+static inline uint8_t
+CharClass(char c)
+{
+    return charClassTable.classes[static_cast<uint8_t>(c)];
+}
 
-            found = FindToken(uniformLiteralStr, source, found + token.length() + layoutSyntax.length());
-            continue;
-        }
+static inline bool
+IsWordChar(char c)
+{
+    return (CharClass(c) & CHAR_CLASS_WORD) != 0;
+}
 
-        found = SkipWhiteSpaces(source, found + token.length());
+static inline bool
+IsSpaceChar(char c)
+{
+    return (CharClass(c) & CHAR_CLASS_SPACE) != 0;
+}
 
-        /// Variable name
-        token = GetNextToken(source, found);
+static size_t
+SkipComment(const string &input, size_t pos)
+{
+    if(input[pos] != '/' || pos + 1 >= input.size()) {
+        return pos;
+    }
+
+    if(input[pos + 1] == '/') {
+        const size_t end = input.find('\n', pos);
+        return (end == string::npos) ? input.size() : end;
+    }
+
+    if(input[pos + 1] == '*') {
+        const size_t end = input.find("*/", pos + 2);
+        return (end == string::npos) ? input.size() : end + 2;
+    }
+
+    return pos;
+}
 
-        if(!token.compare(STRINGIFY_MACRO(VULKAN_DEPTH_RANGE))) {
-            token = std::string("gl_DepthRange");
+/// Whether only white spaces precede pos on its line
+static bool
+IsLineStart(const string &input, size_t pos)
+{
+    while(pos > 0 && input[pos - 1] != '\n') {
+        if(!IsSpaceChar(input[--pos])) {
+            return false;
         }
+    }
 
-        /// Construct uniform block
-        uniBlockIt = uniformBlockMap.find(token);
-        if(uniBlockIt != uniformBlockMap.cend()) {
-            const uniformBlock_t &block = uniBlockIt->second;
-            layoutSyntax = "layout(" + mMemLayoutQualifier + ", binding = " + to_string(block.binding) + string(") ");
-            source.insert(f1, layoutSyntax);
-            f1 += layoutSyntax.length();
+    return true;
+}
 
-            blockSyntax = block.glslBlockName + string(" {");
-            source.insert(f1 + strlen("uniform\0") + 1, blockSyntax);
+/// Returns the next word after pos, skipping white spaces and comments, and moves pos past it
+static string
+NextWord(const string &input, size_t &pos)
+{
+    while(pos < input.size()) {
+        const size_t end = SkipComment(input, pos);
+        if(end != pos) {
+            pos = end;
+        } else if(IsSpaceChar(input[pos])) {
+            ++pos;
         } else {
-            /// inactive uniform
-            layoutSyntax = "layout(" + mMemLayoutQualifier + ", binding = " + to_string(unusedBlockBindings) + string(") ");
-            source.insert(f1, layoutSyntax);
-            f1 += layoutSyntax.length();
-
-            blockSyntax = string("uni") + to_string(unusedBlockBindings) + string(" {");
-            source.insert(f1 + strlen("uniform\0") + 1, blockSyntax);
-            ++unusedBlockBindings;
+            break;
         }
+    }
 
-        /// Close brackets and add block name
-        found = source.find(";", found);
-        blockSyntax = string("};");
-        source.insert(found + 1, blockSyntax);
-
-        found = FindToken(uniformLiteralStr, source, found);
+    const size_t start = pos;
+    while(pos < input.size() && IsWordChar(input[pos])) {
+        ++pos;
     }
+
+    return string(input, start, pos - start);
 }
 
 void
-ShaderConverter::ProcessVaryings(std::string& source)
+ShaderConverter::ConvertDeclarations(const string &input, string &output, bool skipVersion)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    /// Handle varyings
-    assert(mSlangProg);
+    const size_t size = input.size();
+    bool lineStart = true;
+    size_t pos = 0;
+    uint32_t depth = 0;
+
+    /// Start of the input that is copied untouched but not appended to the output yet
+    size_t run = 0;
+
+    while(pos < size) {
+        /// The qualifiers only appear at global scope, so function bodies are
+        /// skipped up to the next brace, comment or directive at once
+        if(depth) {
+            const size_t skipped = strcspn(input.c_str() + pos, "{}/#\n");
+            if(skipped) {
+                lineStart = false;
+                pos += skipped;
+                if(pos >= size) {
+                    break;
+                }
+            }
+        }
 
-    int location = 0;
-    map<string, int> varyingsLocationMap;
-    for(uint32_t out = 0; out < mIoMapResolver->GetNumLiveVaryingOutVariables(); ++out) {
-        for(uint32_t in = 0; in < mIoMapResolver->GetNumLiveVaryingInVariables(); ++in) {
-            const char *inName = mIoMapResolver->GetVaryingInName(in);
-            const char *outName = mIoMapResolver->GetVaryingOutName(out);
-            if(!strcmp(inName, outName)) {
-                assert(varyingsLocationMap.find(string(inName)) == varyingsLocationMap.end());
-                varyingsLocationMap[string(inName)] = location;
-                location++;
+        const char c = input[pos];
+        const uint8_t charClass = CharClass(c);
+
+        /// Most characters are only copied, words other than the three qualifiers as well
+        if(!(charClass & CHAR_CLASS_SPECIAL)) {
+            if(charClass & CHAR_CLASS_WORD) {
+                size_t end = pos + 1;
+                while(end < size && IsWordChar(input[end])) {
+                    ++end;
+                }
+
+                const size_t length = end - pos;
+                if(c == 'u' && length == 7 && !input.compare(pos, length, "uniform")) {
+                    output.append(input, run, pos - run);
+                    end = run = ConvertUniform(input, end, output);
+                } else if(c == 'v' && length == 7 && !input.compare(pos, length, "varying")) {
+                    output.append(input, run, pos - run);
+                    ConvertVarying(input, end, output);
+                    run = end;
+                } else if(c == 'a' && length == 9 && !input.compare(pos, length, "attribute")) {
+                    output.append(input, run, pos - run);
+                    ConvertAttribute(input, end, output);
+                    run = end;
+                }
+
+                lineStart = false;
+                pos = end;
+            } else {
+                lineStart = lineStart && (charClass & CHAR_CLASS_SPACE);
+                ++pos;
             }
+            continue;
         }
-    }
 
-    const string varyingLiteralStr("varying");
+        /// Comments are copied untouched
+        if(c == '/') {
+            const size_t commentEnd = SkipComment(input, pos);
+            if(commentEnd != pos) {
+                pos = commentEnd;
+                continue;
+            }
+        }
 
-    size_t found = FindToken(varyingLiteralStr, source, 0);
-    while(found != string::npos) {
-        size_t f1 = found;
-        found = SkipWhiteSpaces(source, found + varyingLiteralStr.length());
+        /// So are preprocessor directives, except #version which the header replaces
+        if(c == '#' && (lineStart || (depth && IsLineStart(input, pos)))) {
+            size_t end = pos;
+            while(end < size && (input[end] != '\n' || input[end - 1] == '\\')) {
+                ++end;
+            }
 
-        /// Either type or precision qualifier
-        string token = GetNextToken(source, found);
-        if(IsPrecisionQualifier(token)) {
-            found = SkipWhiteSpaces(source, found + token.length());
-            token = GetNextToken(source, found);
+            size_t directive = pos + 1;
+            if(skipVersion && !NextWord(input, directive).compare("version")) {
+                output.append(input, run, pos - run);
+                run = end;
+            }
+            pos = end;
+            continue;
         }
 
-        /// Definitely type now
-        found = SkipWhiteSpaces(source, found + token.length());
+        lineStart = (c == '\n');
 
-        /// Variable name
-        token = GetNextToken(source, found);
+        if(c == '{') {
+            ++depth;
+        } else if(c == '}') {
+            depth = depth ? depth - 1 : 0;
+            mLastClosingBrace = output.size() + pos - run;
+        }
 
-        if(varyingsLocationMap.find(token) != varyingsLocationMap.end()) {
-            string layoutSyntax = string("layout(location = ") +
-                                  to_string(varyingsLocationMap[token]) +
-                                  (mShaderType == SHADER_TYPE_VERTEX ? string(") out") : string(") in"));
-            source.replace(f1, varyingLiteralStr.length(), layoutSyntax);
-        } else {
-            source.replace(f1, varyingLiteralStr.length(), "");
+        ++pos;
+
+        /// Close the uniform block opened for the last default block uniform
+        if(c == ';' && mCloseUniformBlock) {
+            output.append(input, run, pos - run);
+            output.append("};");
+            run = pos;
+            mCloseUniformBlock = false;
         }
+    }
+
+    output.append(input, run, size - run);
+}
 
-        found = FindToken(varyingLiteralStr, source, found);
+size_t
+ShaderConverter::ConvertUniform(const string &input, size_t pos, string &output)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// Either type or precision qualifier
+    size_t found = pos;
+    string type = NextWord(input, found);
+    if(IsPrecisionQualifier(type)) {
+        type = NextWord(input, found);
     }
 
+    /// Variable name
+    string name = NextWord(input, found);
+
+    /// Samplers get their binding only
+    if(!CanTypeBeInUniformBlock(type)) {
+        const uniformBlockMap_t::const_iterator uniBlockIt = mUniformBlockMap->find(name);
+        const uint32_t binding = (uniBlockIt != mUniformBlockMap->cend()) ? uniBlockIt->second.binding : mUnusedBlockBindings++;
+
+        output.append("layout(binding = " + to_string(binding) + ") uniform");
+        return pos;
+    }
+
+    if(!name.compare(STRINGIFY_MACRO(VULKAN_DEPTH_RANGE))) {
+        name = std::string("gl_DepthRange");
+    }
+
+    /// Construct uniform block, closed after the declaration
+    const uniformBlockMap_t::const_iterator uniBlockIt = mUniformBlockMap->find(name);
+    if(uniBlockIt != mUniformBlockMap->cend()) {
+        const uniformBlock_t &block = uniBlockIt->second;
+        output.append("layout(" + mMemLayoutQualifier + ", binding = " + to_string(block.binding) + ") uniform " + block.glslBlockName + " {");
+    } else {
+        /// inactive uniform
+        output.append("layout(" + mMemLayoutQualifier + ", binding = " + to_string(mUnusedBlockBindings) + ") uniform uni" + to_string(mUnusedBlockBindings) + " {");
+        ++mUnusedBlockBindings;
+    }
+    mCloseUniformBlock = true;
+
+    /// The declaration goes on after the separator of the uniform qualifier
+    return (pos < input.size() && IsSpaceChar(input[pos])) ? pos + 1 : pos;
 }
 
 void
-ShaderConverter::ProcessVertexAttributes(std::string& source, ShaderReflection* reflection)
+ShaderConverter::ConvertVarying(const string &input, size_t pos, string &output)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(!reflection->GetLiveAttributes()) {
-        return;
+    /// Either type or precision qualifier
+    string token = NextWord(input, pos);
+    if(IsPrecisionQualifier(token)) {
+        token = NextWord(input, pos);
     }
 
-    /// Handle vertex attributes
-    const string attributeLiteralStr("attribute");
-
-    size_t found = FindToken(attributeLiteralStr, source, 0);
-    while(found != string::npos) {
-        size_t f1 = found;
-        found = SkipWhiteSpaces(source, found + attributeLiteralStr.length());
+    /// Variable name
+    token = NextWord(input, pos);
 
-        /// Either type or precision qualifier
-        string token = GetNextToken(source, found);
-        if(IsPrecisionQualifier(token)) {
-            found = SkipWhiteSpaces(source, found + token.length());
-            token = GetNextToken(source, found);
-        }
+    map<string, int>::const_iterator it = mVaryingLocations.find(token);
+    if(it != mVaryingLocations.end()) {
+        output.append("layout(location = " + to_string(it->second) + (mShaderType == SHADER_TYPE_VERTEX ? ") out" : ") in"));
+    }
+}
 
-        /// Definitely type now
-        found = SkipWhiteSpaces(source, found + token.length());
-        /// Variable name
-        token = GetNextToken(source, found);
+void
+ShaderConverter::ConvertAttribute(const string &input, size_t pos, string &output)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
 
-        int location = reflection->GetAttributeLocation(token.c_str());
-        if(location >=0) {
-            string layoutSyntax = string("layout(location = ") + to_string(location) + string(") in");
-            source.replace(f1, attributeLiteralStr.length(), layoutSyntax);
-        } else {
-            source.replace(f1, attributeLiteralStr.length(), "");
-        }
+    if(!mReflection->GetLiveAttributes()) {
+        output.append("attribute");
+        return;
+    }
 
-        found = FindToken(attributeLiteralStr, source, found);
+    /// Either type or precision qualifier
+    string token = NextWord(input, pos);
+    if(IsPrecisionQualifier(token)) {
+        token = NextWord(input, pos);
     }
 
+    /// Variable name
+    token = NextWord(input, pos);
+
+    int location = mReflection->GetAttributeLocation(token.c_str());
+    if(location >= 0) {
+        output.append("layout(location = " + to_string(location) + ") in");
+    }
 }
 
 // This adds overhead in Vertex Shader. Is there any better way to convert GL to Vulkan depth range?
 void
 ShaderConverter::ConvertGLToVulkanDepthRange(string& source)
 {
-    // Find last "}"
-    size_t pos = source.rfind("}");
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // Insert before the last "}", the end of main
+    if(mLastClosingBrace == string::npos) {
+        return;
+    }
 
     string GlToVkDepthRangeConversion = string("    gl_Position.z = (gl_Position.z + gl_Position.w) / 2.0;\n");
-    source.insert(pos, GlToVkDepthRangeConversion);
+    source.insert(mLastClosingBrace, GlToVkDepthRangeConversion);
 }
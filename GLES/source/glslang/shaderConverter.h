@@ -60,11 +60,21 @@ private:
     glslang::TProgram*          mSlangProg;
     const GlslangIoMapResolver *mIoMapResolver;
 
+    /// State of the conversion in progress
+    const uniformBlockMap_t *   mUniformBlockMap;
+    ShaderReflection *          mReflection;
+    map<string, int>            mVaryingLocations;
+    uint32_t                    mUnusedBlockBindings;
+    size_t                      mLastClosingBrace;
+    bool                        mCloseUniformBlock;
+
     void Convert100To400(string& source,const uniformBlockMap_t &uniformBlockMap, ShaderReflection* reflection);
-    void ProcessHeader(string& source, const uniformBlockMap_t &uniformBlockMap);
-    void ProcessUniforms(string& source, const uniformBlockMap_t &uniformBlockMap);
-    void ProcessVaryings(string& source);
-    void ProcessVertexAttributes(string& source, ShaderReflection* reflection);
+    void EmitHeader(string &output);
+    void BuildVaryingLocations(void);
+    void ConvertDeclarations(const string &input, string &output, bool skipVersion);
+    size_t ConvertUniform(const string &input, size_t pos, string &output);
+    void ConvertVarying(const string &input, size_t pos, string &output);
+    void ConvertAttribute(const string &input, size_t pos, string &output);
     void ConvertGLToVulkanDepthRange(string& source);
 
 };
@@ -25,9 +25,15 @@
  *  ES context (GPU). These can be used to store vertex data, pixel data retrieved
  *  from images or the framebuffer, and a variety of other things.
  *
+ *  Vertex attributes in formats that the device cannot fetch, like GL_FIXED,
+ *  are read from float copies of the buffer data. A copy is kept for every
+ *  attribute layout that reads from the buffer, and it is converted again
+ *  whenever the data of the buffer change.
+ *
  */
 
 #include "bufferObject.h"
+#include <algorithm>
 
 BufferObject::BufferObject(const vkContext_t *vkContext, const VkBufferUsageFlags vkBufferUsageFlags, const VkSharingMode vkSharingMode, const VkFlags vkFlags)
 : mVkContext(vkContext), mUsage(GL_STATIC_DRAW), mTarget(GL_INVALID_VALUE)
@@ -42,6 +48,8 @@ BufferObject::~BufferObject()
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
+    ReleaseConvertedBuffers();
+
     delete mBuffer;
     delete mMemory;
 }
@@ -51,10 +59,100 @@ BufferObject::Release()
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    ReleaseConvertedBuffers();
+
     mBuffer->Release();
     mMemory->Release();
 }
 
+void
+BufferObject::ReleaseConvertedBuffers(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// The copies are retired, pending draws may still read from them
+    for(auto &converted : mConvertedBuffers) {
+        delete converted.buffer;
+        delete converted.memory;
+    }
+    mConvertedBuffers.clear();
+}
+
+bool
+BufferObject::AllocateConvertedBuffer(convertedBuffer_t *converted)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// Only whole vertices that fit in the buffer are converted, the rest of the copy reads as zero
+    bool isUnsigned;
+    const size_t elementSize = converted->nComponents * nBytesOfVkIntFormat(converted->srcFormat, &isUnsigned);
+    const size_t size        = GetSize();
+    converted->vertCount     = (size >= converted->offset + elementSize) ?
+                               static_cast<uint32_t>((size - converted->offset - elementSize) / converted->stride + 1) : 0;
+
+    const VkDeviceSize convertedSize = std::max(converted->vertCount, 1u) * converted->nComponents * sizeof(float);
+
+    converted->buffer = new vulkanAPI::Buffer(mVkContext, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+    converted->memory = new vulkanAPI::Memory(mVkContext, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    converted->buffer->SetSize(convertedSize);
+
+    return converted->buffer->CreateVkBuffer()                                           &&
+           converted->memory->GetBufferMemoryRequirements(converted->buffer->GetVkBuffer()) &&
+           converted->memory->Allocate()                                                 &&
+           converted->memory->SetData(VK_FORMAT_UNDEFINED, false, convertedSize, 0, nullptr) &&
+           converted->memory->BindBufferMemory(converted->buffer->GetVkBuffer());
+}
+
+void
+BufferObject::ConvertVertexData(const convertedBuffer_t *converted)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!converted->vertCount) {
+        return;
+    }
+
+    vulkanAPI::Memory::CopyVertexData(converted->srcFormat, converted->normalize, converted->nComponents, converted->stride,
+                                      converted->vertCount, mMemory->GetMappedData() + converted->offset,
+                                      converted->memory->GetMappedData());
+    converted->memory->FlushData(converted->vertCount * converted->nComponents * sizeof(float), 0);
+}
+
+VkBuffer
+BufferObject::GetConvertedVkBuffer(VkFormat srcFormat, bool normalize, uint32_t nComponents, size_t stride, size_t offset)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    for(const auto &converted : mConvertedBuffers) {
+        if(converted.srcFormat == srcFormat && converted.normalize == normalize && converted.nComponents == nComponents &&
+           converted.stride == stride && converted.offset == offset) {
+            return converted.buffer->GetVkBuffer();
+        }
+    }
+
+    if(!HasData() || !mMemory->GetMappedData()) {
+        return VK_NULL_HANDLE;
+    }
+
+    convertedBuffer_t converted;
+    converted.srcFormat   = srcFormat;
+    converted.normalize   = normalize;
+    converted.nComponents = nComponents;
+    converted.stride      = stride;
+    converted.offset      = offset;
+
+    if(!AllocateConvertedBuffer(&converted)) {
+        delete converted.buffer;
+        delete converted.memory;
+        return VK_NULL_HANDLE;
+    }
+
+    ConvertVertexData(&converted);
+    mConvertedBuffers.push_back(converted);
+
+    return converted.buffer->GetVkBuffer();
+}
+
 bool
 BufferObject::Allocate(VkFormat srcFormat, bool normalize, size_t size, const void *data)
 {
@@ -93,6 +191,11 @@ BufferObject::UpdateData(size_t size, size_t offset, const void *data)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     mMemory->UpdateData(size, offset, data);
+
+    /// Buffers are updated after pending draws have completed, so the copies are converted in place
+    for(const auto &converted : mConvertedBuffers) {
+        ConvertVertexData(&converted);
+    }
 }
 
 bool
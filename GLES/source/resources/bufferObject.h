@@ -29,6 +29,18 @@
 
 class BufferObject {
 private:
+    /// Float copy of the data of a vertex attribute whose format the device cannot fetch
+    typedef struct convertedBuffer_t {
+        VkFormat            srcFormat;
+        bool                normalize;
+        uint32_t            nComponents;
+        size_t              stride;
+        size_t              offset;
+        uint32_t            vertCount;
+        vulkanAPI::Buffer*  buffer;
+        vulkanAPI::Memory*  memory;
+    } convertedBuffer_t;
+
     const vkContext_t*      mVkContext;
 
     GLenum                  mUsage;
@@ -36,6 +48,12 @@ private:
 
     vulkanAPI::Memory*      mMemory;
 
+    vector<convertedBuffer_t> mConvertedBuffers;
+
+    bool                    AllocateConvertedBuffer(convertedBuffer_t *converted);
+    void                    ConvertVertexData(const convertedBuffer_t *converted);
+    void                    ReleaseConvertedBuffers(void);
+
 protected:
     vulkanAPI::Buffer*      mBuffer;
 
@@ -62,6 +80,8 @@ public:
     inline GLenum           GetTarget(void)                             const   { FUN_ENTRY(GL_LOG_TRACE); return mTarget; }
     inline size_t           GetSize(void)                               const   { FUN_ENTRY(GL_LOG_TRACE); return mBuffer->GetSize(); }
     inline VkBuffer         GetVkBuffer(void)                                   { FUN_ENTRY(GL_LOG_TRACE); return mBuffer->GetVkBuffer(); }
+    VkBuffer                GetConvertedVkBuffer(VkFormat srcFormat, bool normalize, uint32_t nComponents,
+                                                 size_t stride, size_t offset);
 
 // Set Functions
     inline void             SetTarget(GLenum target)                            { FUN_ENTRY(GL_LOG_TRACE); mTarget    = target; }
@@ -31,7 +31,7 @@
 #include "utils/glUtils.h"
 
 Framebuffer::Framebuffer(const vkContext_t *vkContext)
-: mVkContext(vkContext), mTarget(GL_INVALID_VALUE), mWriteBufferIndex(0), mUpdated(true), mDepthStencilTexture(nullptr)
+: mVkContext(vkContext), mTarget(GL_INVALID_VALUE), mWriteBufferIndex(0), mUpdated(true), mDepthStencilUndefined(true), mDepthStencilTexture(nullptr)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
@@ -166,13 +166,10 @@ Framebuffer::CheckStatus(void)
 }
 
 bool
-Framebuffer::CreateVkRenderPass(bool enableDepthWrite, bool enableStencilWrite)
+Framebuffer::CreateVkRenderPass(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    mRenderPass->SetDepthWriteEnabled(enableDepthWrite);
-    mRenderPass->SetStencilWriteEnabled(enableStencilWrite);
-
     return mRenderPass->Create(mAttachmentColors[mWriteBufferIndex]->GetTexture()->GetVkFormat(),
                                mDepthStencilTexture ? mDepthStencilTexture->GetVkFormat() : VK_FORMAT_UNDEFINED);
 }
@@ -197,16 +194,17 @@ Framebuffer::CreateDepthStencilTexture(void)
         mDepthStencilTexture->SetVkFormat(vkformat);
         mDepthStencilTexture->SetVkImageUsage(VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
         mDepthStencilTexture->SetVkImageLayout(VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
-        mDepthStencilTexture->SetVkImageTiling(VK_IMAGE_TILING_OPTIMAL);
         GLenum glformat = VkFormatToGlInternalformat(mDepthStencilTexture->GetVkFormat());
         mDepthStencilTexture->InitState();
         mDepthStencilTexture->SetState(GetWidth(), GetHeight(), 0, 0, GlInternalFormatToGlFormat(glformat), GlInternalFormatToGlType(glformat), Texture::GetDefaultInternalAlignment(), NULL);
         mDepthStencilTexture->Allocate();
     }
+
+    mDepthStencilUndefined = true;
 }
 
 void
-Framebuffer::BeginVkRenderPass(bool enableDepthWrite, bool enableStencilWrite)
+Framebuffer::BeginVkRenderPass(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
@@ -219,18 +217,33 @@ Framebuffer::BeginVkRenderPass(bool enableDepthWrite, bool enableStencilWrite)
         mUpdated = true;
     }
 
-    if(mUpdated ||
-       mRenderPass->GetDepthWriteEnabled()   != enableDepthWrite   ||
-       mRenderPass->GetStencilWriteEnabled() != enableStencilWrite
-    ) {
-        if(mUpdated) {
-            CreateDepthStencilTexture();
-        }
-        CreateVkRenderPass(enableDepthWrite, enableStencilWrite);
+    if(mUpdated) {
+        CreateDepthStencilTexture();
+        CreateVkRenderPass();
         Create();
         mUpdated = false;
     }
 
+    /// The depth/stencil texture is private to the framebuffer and is never sampled or read back, so
+    /// an aspect without a GL attachment is neither loaded nor stored, and nothing is loaded from
+    /// it before it is first rendered to. The store ops cannot depend on the write masks, as these
+    /// may change while the render pass is active.
+    if(mDepthStencilTexture) {
+        const bool depthAttached   = mAttachmentDepth->GetTexture()   != nullptr;
+        const bool stencilAttached = mAttachmentStencil->GetTexture() != nullptr;
+
+        if(mRenderPass->GetDepthLoadOp() == VK_ATTACHMENT_LOAD_OP_LOAD && (!depthAttached || mDepthStencilUndefined)) {
+            mRenderPass->SetDepthLoadOp(VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+        }
+        if(mRenderPass->GetStencilLoadOp() == VK_ATTACHMENT_LOAD_OP_LOAD && (!stencilAttached || mDepthStencilUndefined)) {
+            mRenderPass->SetStencilLoadOp(VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+        }
+        mRenderPass->SetDepthStoreOp(depthAttached     ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE);
+        mRenderPass->SetStencilStoreOp(stencilAttached ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE);
+
+        mDepthStencilUndefined = false;
+    }
+
     VkCommandBuffer activeCmdBuffer = mVkContext->mCommandBufferManager->GetActiveCommandBuffer();
     mRenderPass->Begin(&activeCmdBuffer,  mFramebuffers[mWriteBufferIndex]->GetFramebuffer(),
                                           GetWidth(),
@@ -251,7 +264,16 @@ Framebuffer::PrepareVkImage(VkImageLayout newImageLayout)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    mAttachmentColors[mWriteBufferIndex]->GetTexture()->PrepareVkImageLayout(newImageLayout);
+    Texture *texture = mAttachmentColors[mWriteBufferIndex]->GetTexture();
+
+    /// Writes of earlier render passes to an attachment that has stayed in its attachment
+    /// layout are ordered by the external dependency of the render pass, not by a barrier
+    texture->CreateVkImageSubResourceRange();
+    if(newImageLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL && texture->GetVkImageLayout() == newImageLayout) {
+        return;
+    }
+
+    texture->PrepareVkImageLayout(newImageLayout);
 }
 
 bool
@@ -266,7 +288,7 @@ Framebuffer::Create(void)
 
         vector<VkImageView> imageViews;
         if(mAttachmentColors[i]->GetTexture()) {
-            imageViews.push_back(mAttachmentColors[i]->GetTexture()->GetVkImageView());
+            imageViews.push_back(mAttachmentColors[i]->GetTexture()->GetVkAttachmentImageView());
         }
         if(mDepthStencilTexture) {
             imageViews.push_back(mDepthStencilTexture->GetVkImageView());
@@ -38,6 +38,8 @@ private:
     GLenum                          mTarget;
     uint32_t                        mWriteBufferIndex;
     bool                            mUpdated;
+    /// The depth/stencil texture has not been rendered to since it was created
+    bool                            mDepthStencilUndefined;
 
     vulkanAPI::RenderPass*          mRenderPass;
     vector<vulkanAPI::Framebuffer*> mFramebuffers;
@@ -58,8 +60,8 @@ public:
     void                    CreateDepthStencilTexture(void);
 
 // RenderPass Functions
-    bool                    CreateVkRenderPass(bool enableDepthWrite, bool enableStencilWrite);
-    void                    BeginVkRenderPass(bool enableDepthWrite, bool enableStencilWrite);
+    bool                    CreateVkRenderPass(void);
+    void                    BeginVkRenderPass(void);
     void                    EndVkRenderPass(void);
     void                    PrepareVkImage(VkImageLayout newImageLayout);
 
@@ -77,6 +79,8 @@ public:
     inline int              GetHeight(void)                             const   { FUN_ENTRY(GL_LOG_TRACE); return mDims.height; }
     inline GLenum           GetTarget(void)                             const   { FUN_ENTRY(GL_LOG_TRACE); return mTarget; }
     inline VkRenderPass *   GetVkRenderPass(void)                       const   { FUN_ENTRY(GL_LOG_TRACE); return mRenderPass->GetRenderPass(); }
+    inline vulkanAPI::RenderPass * GetRenderPass(void)                  const   { FUN_ENTRY(GL_LOG_TRACE); return mRenderPass; }
+    inline bool             GetVkRenderPassStarted(void)                const   { FUN_ENTRY(GL_LOG_TRACE); return mRenderPass->GetStarted();    }
 
     inline GLenum           GetColorAttachmentType(void)                const   { FUN_ENTRY(GL_LOG_TRACE); return mAttachmentColors.size() ? mAttachmentColors[0]->GetType()  : GL_NONE; }
     inline uint32_t         GetColorAttachmentName(void)                const   { FUN_ENTRY(GL_LOG_TRACE); return mAttachmentColors.size() ? mAttachmentColors[0]->GetName()  : 0; }
@@ -41,41 +41,12 @@ GenericVertexAttributes::GenericVertexAttributes()
         mGenericVertexAttributes[i].ptr         = 0;
         mGenericVertexAttributes[i].vbo         = nullptr;
         mGenericVertexAttributes[i].offset      = 0;
-        mGenericVertexAttributes[i].internalVBO = false;
     }
 }
 
 GenericVertexAttributes::~GenericVertexAttributes()
 {
     FUN_ENTRY(GL_LOG_TRACE);
-
-    CleanupVertexAttributes();
-}
-
-void
-GenericVertexAttributes::CleanupIfInternalVBO(uint32_t location)
-{
-    FUN_ENTRY(GL_LOG_DEBUG);
-
-    if(mGenericVertexAttributes[location].internalVBO) {
-
-        delete mGenericVertexAttributes[location].vbo;
-
-        mGenericVertexAttributes[location].vbo         = nullptr;
-        mGenericVertexAttributes[location].internalVBO = false;
-    }
-}
-
-void
-GenericVertexAttributes::CleanupVertexAttributes()
-{
-    FUN_ENTRY(GL_LOG_DEBUG);
-
-    for(uint32_t i = 0; i < GLOVE_MAX_VERTEX_ATTRIBS; ++i) {
-        if(mGenericVertexAttributes[i].vbo) {
-            CleanupIfInternalVBO(i);
-        }
-    }
 }
 
 void
@@ -85,8 +56,6 @@ GenericVertexAttributes::EnableVertexAttribute(uint32_t location, BufferObject *
 
     assert(location < GLOVE_MAX_VERTEX_ATTRIBS);
 
-    CleanupIfInternalVBO(location);
-
     mGenericVertexAttributes[location].active = true;
     mGenericVertexAttributes[location].vbo    = vbo;
 }
@@ -98,8 +67,6 @@ GenericVertexAttributes::DisableVertexAttribute(uint32_t location)
 
     assert(location < GLOVE_MAX_VERTEX_ATTRIBS);
 
-    CleanupIfInternalVBO(location);
-
     mGenericVertexAttributes[location].active = false;
 }
 
@@ -117,23 +84,31 @@ GenericVertexAttributes::SetVertexAttributePointer(uint32_t location, size_t nEl
     SetVertexAttribStride(location, stride);
     SetVertexAttribPointer(location, reinterpret_cast<uintptr_t>(ptr));
     SetVertexAttribOffset(location, static_cast<uint32_t>(reinterpret_cast<uintptr_t>(ptr)));
+    SetVertexAttribVbo(location, vbo);
+}
 
-    if(mGenericVertexAttributes[location].active && mGenericVertexAttributes[location].vbo) {
-        CleanupIfInternalVBO(location);
-    }
+size_t
+GenericVertexAttributes::GetVertexAttribComponentSize(uint32_t location) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
 
-    mGenericVertexAttributes[location].vbo = vbo;
+    switch(mGenericVertexAttributes[location].dataType) {
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE:                  return 1;
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:                 return 2;
+    default:                                return 4;
+    }
 }
 
-void
-GenericVertexAttributes::SetVertexAttribVbo(uint32_t location, BufferObject *vbo)
+size_t
+GenericVertexAttributes::GetVertexAttribDataStride(uint32_t location) const
 {
-    FUN_ENTRY(GL_LOG_DEBUG);
+    FUN_ENTRY(GL_LOG_TRACE);
 
-    if(mGenericVertexAttributes[location].vbo && mGenericVertexAttributes[location].internalVBO) {
-        delete mGenericVertexAttributes[location].vbo;
-    }
-    mGenericVertexAttributes[location].vbo = vbo;
+    /// a stride of 0 means that the attribute values are tightly packed
+    const size_t stride = mGenericVertexAttributes[location].stride;
+    return stride ? stride : mGenericVertexAttributes[location].nElements * GetVertexAttribComponentSize(location);
 }
 
 uint32_t
@@ -41,18 +41,14 @@ private:
         BufferObject *                  vbo;
         VkFormat                        vkFormat;
         GenericVec4                     genericValue;
-        bool                            internalVBO;
     } vertexAttrib_t;
 
     vertexAttrib_t                      mGenericVertexAttributes[GLOVE_MAX_VERTEX_ATTRIBS];
 
-    void                                CleanupIfInternalVBO(uint32_t location);
-
 public:
     GenericVertexAttributes();
     ~GenericVertexAttributes();
 
-    void                                CleanupVertexAttributes();
     void                                DisableVertexAttribute(uint32_t location);
     void                                EnableVertexAttribute(uint32_t location, BufferObject *vbo);
     static uint32_t                     LocationIndexPerType(GLenum type);
@@ -67,11 +63,12 @@ public:
     uintptr_t                           GetVertexAttribPointer(uint32_t location)                 const { FUN_ENTRY(GL_LOG_TRACE); return mGenericVertexAttributes[location].ptr; }
     BufferObject *                      GetVertexAttribVbo(uint32_t location)                     const { FUN_ENTRY(GL_LOG_TRACE); return mGenericVertexAttributes[location].vbo; }
     VkFormat                            GetVertexAttribFormat(uint32_t location)                  const { FUN_ENTRY(GL_LOG_TRACE); return mGenericVertexAttributes[location].vkFormat; }
-    bool                                GetVertexAttribInternalVBO(uint32_t location)             const { FUN_ENTRY(GL_LOG_TRACE); return mGenericVertexAttributes[location].internalVBO; }
+    size_t                              GetVertexAttribComponentSize(uint32_t location)           const;
+    size_t                              GetVertexAttribDataStride(uint32_t location)              const;
     template<typename T> void           GetGenericVertexAttribute(uint32_t location, T *ptr)      const;
 
     template<typename T> void           SetGenericVertexAttribute(uint32_t location, const T *ptr);
-    void                                SetVertexAttribVbo(uint32_t location, BufferObject *vbo);
+    void                                SetVertexAttribVbo(uint32_t location, BufferObject *vbo)        { FUN_ENTRY(GL_LOG_TRACE); mGenericVertexAttributes[location].vbo = vbo; }
     void                                SetVertexAttributePointer(uint32_t location, size_t nElements, int type, bool normalized, size_t stride, const void *ptr, BufferObject *activeVBO);
     void                                SetVertexAttribActive(uint32_t location, bool active)           { FUN_ENTRY(GL_LOG_TRACE); mGenericVertexAttributes[location].active = active; }
     void                                SetVertexAttribSize(uint32_t location, int nElements)           { FUN_ENTRY(GL_LOG_TRACE); mGenericVertexAttributes[location].nElements = nElements; }
@@ -81,7 +78,6 @@ public:
     void                                SetVertexAttribOffset(uint32_t location, uint32_t offset)       { FUN_ENTRY(GL_LOG_TRACE); mGenericVertexAttributes[location].offset = offset; }
     void                                SetVertexAttribPointer(uint32_t location, uintptr_t ptr)        { FUN_ENTRY(GL_LOG_TRACE); mGenericVertexAttributes[location].ptr = ptr; }
     void                                SetVertexAttribFormat(uint32_t location, VkFormat vkFormat)     { FUN_ENTRY(GL_LOG_TRACE); mGenericVertexAttributes[location].vkFormat = vkFormat; }
-    void                                SetVertexAttribInternalVBO(uint32_t location, bool internalVBO) { FUN_ENTRY(GL_LOG_TRACE); mGenericVertexAttributes[location].internalVBO = internalVBO; }
 };
 
 template<typename T> void
@@ -129,15 +129,14 @@ InvertImageYAxis(uint8_t *image, const ImageRect* rect)
 }
 
 // converts and copies pixels between two buffers with different formats
-// e.g., copies RGB565 pixels to BGRA8888
+// e.g., copies RGB565 pixels to BGRA8888, one row at a time
 void
 CopyPixelsConvert(
             const ImageRect* srcRect,
             const void* srcData,
             const ImageRect* dstRect,
             void* dstData,
-            Color (*SrcColorFunPtr)(const uint8_t*),
-            void (*DstColorFunPtr)(Color&, uint8_t*))
+            pixelRowKernel_t rowKernel)
 {
 
     // size of an entire row in bytes
@@ -154,12 +153,7 @@ CopyPixelsConvert(
 
     // perform the convertion
     for(int row = 0; row < srcRect->height; ++row) {
-        for(int col = 0; col < srcRect->width; ++col) {
-            const uint32_t srcIndex = col * srcRect->GetPixelByteOffset();
-            const uint32_t dstIndex = col * dstRect->GetPixelByteOffset();
-            Color color = SrcColorFunPtr(&srcPtr[srcIndex]);
-            DstColorFunPtr(color, &dstPtr[dstIndex]);
-        }
+        rowKernel(srcPtr, dstPtr, srcRect->width);
         // offset by the number of bytes per row
         dstPtr = dstPtr + dstRowStride;
         srcPtr = srcPtr + srcRowStride;
@@ -222,20 +216,20 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
             break;
         case GL_RGBA:
         case GL_RGBA8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromBGRA, &Color::ConvertToRGBA);
+            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, GetPixelRowKernel(PIXEL_KERNEL_SWAP_RB_8888));
             break;
         case GL_LUMINANCE_ALPHA:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromBGRA, &Color::ConvertToLuminanceAlpha);
+            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, ConvertPixelRow<&Color::FromBGRA, &Color::ConvertToLuminanceAlpha, 4, 2>);
             break;
         case GL_LUMINANCE:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromBGRA, &Color::ConvertToLuminance);
+            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, ConvertPixelRow<&Color::FromBGRA, &Color::ConvertToLuminance, 4, 1>);
             break;
         case GL_ALPHA:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromBGRA, &Color::ConvertToAlpha);
+            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, ConvertPixelRow<&Color::FromBGRA, &Color::ConvertToAlpha, 4, 1>);
             break;
         case GL_RGB:
         case GL_RGB8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromBGRA, &Color::ConvertToRGB);
+            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, ConvertPixelRow<&Color::FromBGRA, &Color::ConvertToRGB, 4, 3>);
             break;
 
         default: NOT_FOUND_ENUM(dstFormat); break;
@@ -250,10 +244,10 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
             break;
         case GL_RGB:
         case GL_RGB8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromRGBA, &Color::ConvertToRGB);
+            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, GetPixelRowKernel(PIXEL_KERNEL_RGBA_TO_RGB));
             break;
         case GL_ALPHA:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromRGBA, &Color::ConvertToAlpha);
+            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, ConvertPixelRow<&Color::FromRGBA, &Color::ConvertToAlpha, 4, 1>);
             break;
 
         default: NOT_FOUND_ENUM(dstFormat); break;
@@ -268,7 +262,7 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
             CopyPixelsNoConvertion(srcRect, srcData, dstRect, dstData);
             break;
         case GL_RGBA8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromRGB, &Color::ConvertToRGBA);
+            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, GetPixelRowKernel(PIXEL_KERNEL_RGB_TO_RGBA));
             break;
         default: NOT_FOUND_ENUM(dstFormat); break;
         }
@@ -280,11 +274,11 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
             CopyPixelsNoConvertion(srcRect, srcData, dstRect, dstData);
             break;
         case GL_LUMINANCE:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromLuminanceAlpha, &Color::ConvertToLuminance);
+            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, ConvertPixelRow<&Color::FromLuminanceAlpha, &Color::ConvertToLuminance, 2, 1>);
             break;
         case GL_RGBA:
         case GL_RGBA8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromLuminanceAlpha, &Color::ConvertToRGBA);
+            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, GetPixelRowKernel(PIXEL_KERNEL_LUMINANCE_ALPHA_TO_RGBA));
             break;
         default: NOT_FOUND_ENUM(dstFormat); break;
         }
@@ -296,11 +290,11 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
             CopyPixelsNoConvertion(srcRect, srcData, dstRect, dstData);
             break;
         case GL_LUMINANCE_ALPHA:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromLuminance, &Color::ConvertToLuminanceAlpha);
+            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, ConvertPixelRow<&Color::FromLuminance, &Color::ConvertToLuminanceAlpha, 1, 2>);
             break;
         case GL_RGBA:
         case GL_RGBA8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromLuminance, &Color::ConvertToRGBA);
+            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, GetPixelRowKernel(PIXEL_KERNEL_LUMINANCE_TO_RGBA));
             break;
         default: NOT_FOUND_ENUM(dstFormat); break;
         }
@@ -313,7 +307,7 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
             break;
         case GL_RGBA:
         case GL_RGBA8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromAlpha, &Color::ConvertToRGBA);
+            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, GetPixelRowKernel(PIXEL_KERNEL_ALPHA_TO_RGBA));
             break;
         default: NOT_FOUND_ENUM(dstFormat); break;
         }
@@ -326,7 +320,7 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
             break;
         case GL_RGBA:
         case GL_RGBA8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::From4444, &Color::ConvertToRGBA);
+            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, GetPixelRowKernel(PIXEL_KERNEL_4444_TO_RGBA));
             break;
         default: NOT_FOUND_ENUM(dstFormat); break;
         }
@@ -339,7 +333,7 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
             break;
         case GL_RGBA:
         case GL_RGBA8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::From5551, &Color::ConvertToRGBA);
+            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, GetPixelRowKernel(PIXEL_KERNEL_5551_TO_RGBA));
             break;
         default: NOT_FOUND_ENUM(dstFormat); break;
         }
@@ -353,10 +347,10 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
         case GL_RGBA:
         case GL_RGB8_OES:
         case GL_RGBA8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::From565, &Color::ConvertToRGBA);
+            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, GetPixelRowKernel(PIXEL_KERNEL_565_TO_RGBA));
             break;
         case GL_LUMINANCE:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::From565, &Color::ConvertToLuminance);
+            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, ConvertPixelRow<&Color::From565, &Color::ConvertToLuminance, 2, 1>);
             break;
         default: NOT_FOUND_ENUM(dstFormat); break;
         }
@@ -28,7 +28,7 @@
 #include "GLES2/gl2ext.h"
 #include <cmath>
 #include <algorithm>
-#include "utils/color.hpp"
+#include "utils/pixelKernels.h"
 
 class Rect {
 
@@ -83,8 +83,7 @@ void                    CopyPixelsConvert(
                         const void* srcData,
                         const ImageRect* dstRect,
                         void* dstData,
-                        Color (*SrcColorFunPtr)(const uint8_t*),
-                        void (*DstColorFunPtr)(class Color&, uint8_t*));
+                        pixelRowKernel_t rowKernel);
 void                    ConvertPixels(GLenum srcFormat , GLenum dstFormat,
                         ImageRect* srcRect,
                         const void* srcData,
@@ -22,50 +22,25 @@
  *  @section
  *
  *  OpenGL ES allows developers to allocate, edit and delete a variety of
- *  resources. These include Generic Vertex Attributes, Buffers, Renderbuffers,
- *  Framebuffers, Textures, Shaders, and Shader Programs.
+ *  resources. These include Buffers, Renderbuffers, Framebuffers, Textures,
+ *  Shaders, and Shader Programs. They are shared by all contexts created in
+ *  the same share group, whereas Generic Vertex Attributes and the default
+ *  textures belong to each context.
  */
 
 #include "resourceManager.h"
 
-uint32_t ResourceManager::mShadingObjectCount = 1;
-
 ResourceManager::ResourceManager()
+: mRefCount(1), mShadingObjectCount(1)
 {
     FUN_ENTRY(GL_LOG_TRACE);
-
-    CreateDefaultTextures();
-
-    mGenericVertexAttributes = new GenericVertexAttributes();
 }
 
 ResourceManager::~ResourceManager()
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    delete mDefaultTexture2D;
-    delete mDefaultTextureCubeMap;
-    delete mGenericVertexAttributes;
-}
-
-void
-ResourceManager::CreateDefaultTextures()
-{
-    FUN_ENTRY(GL_LOG_DEBUG);
-
-    mDefaultTexture2D = new Texture();
-    mDefaultTexture2D->SetTarget(GL_TEXTURE_2D);
-    mDefaultTexture2D->SetVkFormat(VK_FORMAT_R8G8B8A8_UNORM);
-    mDefaultTexture2D->SetVkImageUsage(static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
-    mDefaultTexture2D->SetVkImageTarget(vulkanAPI::Image::VK_IMAGE_TARGET_2D);
-    mDefaultTexture2D->InitState();
-
-    mDefaultTextureCubeMap = new Texture();
-    mDefaultTextureCubeMap->SetTarget(GL_TEXTURE_CUBE_MAP);
-    mDefaultTextureCubeMap->SetVkFormat(VK_FORMAT_R8G8B8A8_UNORM);
-    mDefaultTextureCubeMap->SetVkImageUsage(static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
-    mDefaultTextureCubeMap->SetVkImageTarget(vulkanAPI::Image::VK_IMAGE_TARGET_CUBE);
-    mDefaultTextureCubeMap->InitState();
+    assert(!mRefCount);
 }
 
 uint32_t
@@ -73,6 +48,8 @@ ResourceManager::FindShaderID(const Shader *shader)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+
     for(shadingPoolIDs_t::iterator it = mShadingObjectPool.begin(); it != mShadingObjectPool.end(); ++it) {
         if(it->second.type == SHADER_ID && GetShaderID(shader) == it->second.arrayIndex) {
             return it->first;
@@ -86,6 +63,8 @@ ResourceManager::FindShaderProgramID(const ShaderProgram *program)
 {
    FUN_ENTRY(GL_LOG_DEBUG);
 
+   std::lock_guard<std::recursive_mutex> lock(mMutex);
+
    for(shadingPoolIDs_t::iterator it = mShadingObjectPool.begin(); it != mShadingObjectPool.end(); ++it) {
         if(it->second.type == SHADER_PROGRAM_ID && GetShaderProgramID(program) == it->second.arrayIndex) {
             return it->first;
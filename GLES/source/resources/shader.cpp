@@ -28,10 +28,11 @@
  */
 
 #include "shader.h"
+#include "utils/sha256.h"
 
 Shader::Shader(const vkContext_t *vkContext)
-: mVkContext(vkContext), mVkShaderModule(VK_NULL_HANDLE), mShaderCompiler(nullptr), mSource(nullptr),
-  mSourceLength(0), mShaderType(INVALID_SHADER), mRefCounter(0), mMarkForDeletion(false), mCompiled(false)
+: mVkContext(vkContext), mVkShaderModule(VK_NULL_HANDLE), mShaderCompiler(nullptr), mCompileQueue(nullptr), mCompileSerial(0), mShaderCache(nullptr),
+  mSource(nullptr), mSourceLength(0), mShaderType(INVALID_SHADER), mRefCounter(0), mMarkForDeletion(false), mCompiled(false)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 }
@@ -49,7 +50,7 @@ Shader::GetInfoLogLength(void) const
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    return mShaderCompiler->GetShaderInfoLog(mShaderType) ? (int)strlen(mShaderCompiler->GetShaderInfoLog(mShaderType)) : 0;
+    return (int)mInfoLog.length();
 }
 
 void
@@ -158,15 +159,10 @@ Shader::GetInfoLog(void) const
     char *log = nullptr;
 
     if(mShaderCompiler) {
-        uint32_t len = strlen(mShaderCompiler->GetShaderInfoLog(mShaderType)) + 1;
+        uint32_t len = mInfoLog.length() + 1;
         log = new char[len];
 
-        memcpy(log, mShaderCompiler->GetShaderInfoLog(mShaderType), len);
-
-        /// NULL terminate it
-        if(log[len - 1] != '\0') {
-            log[len] = '\0';
-        }
+        memcpy(log, mInfoLog.c_str(), len);
     }
 
     return log;
@@ -192,8 +188,43 @@ Shader::UnrefShader()
     }
 }
 
-bool
-Shader::CompileShader(void)
+void
+Shader::Compile(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    assert(mSource);
+
+    if(!mShaderCache) {
+        CompileSource();
+        return;
+    }
+
+    Sha256 digest;
+    digest.Update(string("shader"));
+    digest.Update((uint32_t)GLOVE_SHADER_CACHE_VERSION);
+    digest.Update((uint32_t)mShaderType);
+    digest.Update(string(mSource));
+    mCacheDigest = digest.FinalizeHex();
+
+    /// Only successful compilations are cached, their entry holds the info log.
+    /// A hit skips glslang, see RestoreCompilerState.
+    vector<uint8_t> data;
+    if(mShaderCache->Find(mCacheDigest, data)) {
+        mCompiled = true;
+        mInfoLog  = string(data.begin(), data.end());
+        return;
+    }
+
+    CompileSource();
+
+    if(mCompiled) {
+        mShaderCache->Insert(mCacheDigest, vector<uint8_t>(mInfoLog.begin(), mInfoLog.end()));
+    }
+}
+
+void
+Shader::CompileSource(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
@@ -206,7 +237,41 @@ Shader::CompileShader(void)
         mCompiled = mShaderCompiler->CompileFragmentShader(&mSource);
     }
 
-    return mCompiled;
+    /// Keep a copy of the log, the compiler's one is replaced by the next shader of the same type
+    mInfoLog = string(mShaderCompiler->GetShaderInfoLog(mShaderType));
+}
+
+void
+Shader::RestoreCompilerState(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// The compiler links the last shader it compiled for each stage, which may be
+    /// another one, or none at all if this one was found in the shader cache
+    if(mCompiled && mSource && strcmp(mShaderCompiler->GetShaderSource(mShaderType), mSource)) {
+        CompileSource();
+    }
+}
+
+void
+Shader::CompileShader(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    assert(mCompileQueue);
+
+    mCompiled      = false;
+    mCompileSerial = mCompileQueue->Submit([this] { Compile(); });
+}
+
+void
+Shader::Synchronize(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mCompileQueue) {
+        mCompileQueue->Wait(mCompileSerial);
+    }
 }
 
 void
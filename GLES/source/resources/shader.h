@@ -25,14 +25,21 @@
 #define __SHADER_H__
 
 #include "shaderCompiler.h"
+#include "shaderCache.h"
+#include "utils/taskQueue.h"
 
 class Shader {
 private:
     const vkContext_t *                 mVkContext;
     VkShaderModule                      mVkShaderModule;
     ShaderCompiler *                    mShaderCompiler;
+    TaskQueue *                         mCompileQueue;
+    uint64_t                            mCompileSerial;
+    ShaderCache *                       mShaderCache;
+    string                              mCacheDigest;
 
     char *                              mSource;
+    string                              mInfoLog;
     vector<uint32_t>                    mSpv;
 
     uint32_t                            mSourceLength;
@@ -43,12 +50,16 @@ private:
 
     void                                FreeSources(void);
     void                                DestroyVkShader(void);
+    void                                Compile(void);
+    void                                CompileSource(void);
 
 public:
     Shader(const vkContext_t *vkContext = nullptr);
     ~Shader();
 
-    bool                                CompileShader(void);
+    void                                CompileShader(void);
+    void                                RestoreCompilerState(void);
+    void                                Synchronize(void);
     VkShaderModule                      CreateVkShaderModule(void);
 
     void                                RefShader(void);
@@ -63,16 +74,22 @@ public:
     vector<uint32_t> &                  GetSPV(void)                                    { FUN_ENTRY(GL_LOG_TRACE); return mSpv; }
     int                                 GetRefCount(void)                       const   { FUN_ENTRY(GL_LOG_TRACE); return mRefCounter; }
     bool                                GetMarkForDeletion(void)                const   { FUN_ENTRY(GL_LOG_TRACE); return mMarkForDeletion; }
+    uint64_t                            GetCompileSerial(void)                  const   { FUN_ENTRY(GL_LOG_TRACE); return mCompileSerial; }
+    const string &                      GetCacheDigest(void)                    const   { FUN_ENTRY(GL_LOG_TRACE); return mCacheDigest; }
 
 // Set Functions
     void                                SetShaderSource(GLsizei count, const GLchar *const *string, const GLint *length);
     void                                SetVkContext(const vkContext_t *vkContext)      { FUN_ENTRY(GL_LOG_TRACE); mVkContext       = vkContext; }
     void                                SetShaderCompiler(ShaderCompiler* compiler)     { FUN_ENTRY(GL_LOG_TRACE); mShaderCompiler  = compiler; }
+    void                                SetCompileQueue(TaskQueue *queue)               { FUN_ENTRY(GL_LOG_TRACE); mCompileQueue    = queue; }
+    void                                SetCompileSerial(uint64_t serial)               { FUN_ENTRY(GL_LOG_TRACE); mCompileSerial   = serial; }
+    void                                SetShaderCache(ShaderCache *cache)              { FUN_ENTRY(GL_LOG_TRACE); mShaderCache     = cache; }
     void                                SetShaderType(shader_type_t type)               { FUN_ENTRY(GL_LOG_TRACE); mShaderType      = type; }
     void                                MarkForDeletion(void)                           { FUN_ENTRY(GL_LOG_TRACE); mMarkForDeletion = true; }
 
 // Is/Has Functions
     bool                                IsCompiled(void)                        const   { FUN_ENTRY(GL_LOG_TRACE); return mCompiled; }
+    bool                                IsCompileCompleted(void)                const   { FUN_ENTRY(GL_LOG_TRACE); return mCompileQueue->IsCompleted(mCompileSerial); }
     bool                                IsVertex(void)                          const   { FUN_ENTRY(GL_LOG_TRACE); return (mShaderType == SHADER_TYPE_VERTEX) ? true : false; }
     bool                                HasSource(void)                         const   { FUN_ENTRY(GL_LOG_TRACE); return (bool)mSource; }
 
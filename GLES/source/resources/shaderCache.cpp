@@ -0,0 +1,380 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       shaderCache.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Content Addressed Cache of Compiled Shaders and Linked Programs
+ *
+ *  @section
+ *
+ *  Translating ESSL to SPIR-V through glslang dominates the cost of compiling
+ *  and linking, and applications recompile the very same sources on every
+ *  start. Results are stored under the SHA-256 digest of everything that
+ *  affects them, so an entry can never be handed back for different inputs.
+ *
+ *  Entries live in a least recently used cache bounded in bytes and, when a
+ *  directory is given, in one file per entry that outlives the process. Files
+ *  are written under a temporary name and renamed, so readers never see a
+ *  partial entry, and carry a checksum of their payload, so a truncated or
+ *  corrupted file is treated as a miss. Whenever the files exceed their size
+ *  limit, the least recently used ones are removed; a hit refreshes the
+ *  modification time of its file. Only files with the extension and header
+ *  of entries are ever removed, as the directory may be shared with other
+ *  files, together with temporary files left behind by interrupted writes.
+ *
+ *  A single cache is shared by all contexts of the process and used from
+ *  their shader compilation queues, so it is locked. The files may be shared
+ *  by several processes as well, which only ever replace whole files.
+ *
+ */
+
+#include "shaderCache.h"
+#include <algorithm>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+#define SHADER_CACHE_FILE_MAGIC                         0x43535647 // "GVSC"
+#define SHADER_CACHE_FILE_EXTENSION                     ".glsc"
+#define SHADER_CACHE_TMP_FILE_EXTENSION                 ".tmp"
+/// Temporary files older than this are left behind by interrupted writes
+#define SHADER_CACHE_TMP_FILE_MAX_AGE                   (60 * 60) // seconds
+
+typedef struct shaderCacheFileHeader_t {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size;
+    uint64_t checksum;
+    char     digest[64];
+} shaderCacheFileHeader_t;
+
+typedef struct shaderCacheFile_t {
+    string   filename;
+    time_t   time;
+    size_t   size;
+} shaderCacheFile_t;
+
+static bool
+HasSuffix(const string &name, const string &suffix)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    return name.size() > suffix.size() && !name.compare(name.size() - suffix.size(), suffix.size(), suffix);
+}
+
+static bool
+IsEntryFile(const string &filename)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    ifstream file(filename, ios::in | ios::binary);
+
+    uint32_t magic = 0;
+    return file.read(reinterpret_cast<char *>(&magic), sizeof(magic)) && magic == SHADER_CACHE_FILE_MAGIC;
+}
+
+static uint64_t
+Checksum(const uint8_t *data, size_t size)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    /// 64-bit FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+ShaderCache::ShaderCache(size_t maxSize, const char *directory, size_t maxDiskSize)
+: mSize(0), mMaxSize(maxSize), mDirectory(directory ? directory : ""), mDirectoryWritable(false),
+  mDiskSize(0), mMaxDiskSize(maxDiskSize), mDiskSizeValid(false), mHits(0), mMisses(0)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(mDirectory.empty()) {
+        return;
+    }
+
+    /// Existing directories are fine, any other failure leaves the directory read only
+    for(size_t pos = mDirectory.find('/', 1); pos != string::npos; pos = mDirectory.find('/', pos + 1)) {
+        mkdir(mDirectory.substr(0, pos).c_str(), 0755);
+    }
+    mkdir(mDirectory.c_str(), 0755);
+
+    mDirectoryWritable = !access(mDirectory.c_str(), W_OK);
+}
+
+ShaderCache::~ShaderCache()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    Release();
+}
+
+bool
+ShaderCache::Find(const string &digest, vector<uint8_t> &data)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    std::unordered_map<string, std::list<Entry>::iterator>::iterator it = mLookup.find(digest);
+    if(it != mLookup.end()) {
+        mEntries.splice(mEntries.begin(), mEntries, it->second);
+        data = it->second->data;
+        ++mHits;
+        return true;
+    }
+
+    if(!mDirectory.empty() && ReadFile(digest, data)) {
+        utime(GetFilename(digest).c_str(), NULL);
+        InsertEntry(digest, data);
+        ++mHits;
+        return true;
+    }
+
+    ++mMisses;
+    return false;
+}
+
+void
+ShaderCache::Insert(const string &digest, const vector<uint8_t> &data)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    InsertEntry(digest, data);
+
+    if(mDirectoryWritable) {
+        WriteFile(digest, data);
+    }
+}
+
+void
+ShaderCache::InsertEntry(const string &digest, const vector<uint8_t> &data)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::unordered_map<string, std::list<Entry>::iterator>::iterator it = mLookup.find(digest);
+    if(it != mLookup.end()) {
+        Evict(it->second);
+    }
+
+    /// Entries larger than the whole cache are only stored on disk
+    if(data.size() > mMaxSize) {
+        return;
+    }
+
+    while(mSize + data.size() > mMaxSize) {
+        Evict(std::prev(mEntries.end()));
+    }
+
+    Entry entry;
+    entry.digest = digest;
+    entry.data   = data;
+
+    mEntries.push_front(entry);
+    mLookup[digest] = mEntries.begin();
+    mSize += data.size();
+}
+
+void
+ShaderCache::Evict(std::list<Entry>::iterator it)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mSize -= it->data.size();
+    mLookup.erase(it->digest);
+    mEntries.erase(it);
+}
+
+void
+ShaderCache::Release(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mEntries.clear();
+    mLookup.clear();
+    mSize = 0;
+}
+
+string
+ShaderCache::GetFilename(const string &digest) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    return mDirectory + "/" + digest + SHADER_CACHE_FILE_EXTENSION;
+}
+
+bool
+ShaderCache::ReadFile(const string &digest, vector<uint8_t> &data) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    data.clear();
+
+    ifstream file(GetFilename(digest), ios::in | ios::binary);
+    if(!file.is_open()) {
+        return false;
+    }
+
+    shaderCacheFileHeader_t header;
+    if(!file.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+        return false;
+    }
+
+    /// Files written by another version, truncated or corrupted files are discarded
+    if(header.magic   != SHADER_CACHE_FILE_MAGIC    ||
+       header.version != GLOVE_SHADER_CACHE_VERSION ||
+       digest.size()  != sizeof(header.digest)      ||
+       memcmp(header.digest, digest.data(), sizeof(header.digest))) {
+        return false;
+    }
+
+    data.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+
+    if(data.size() != header.size || Checksum(data.data(), data.size()) != header.checksum) {
+        data.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void
+ShaderCache::WriteFile(const string &digest, const vector<uint8_t> &data)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(digest.size() != sizeof(((shaderCacheFileHeader_t *)0)->digest)) {
+        return;
+    }
+
+    shaderCacheFileHeader_t header;
+    header.magic    = SHADER_CACHE_FILE_MAGIC;
+    header.version  = GLOVE_SHADER_CACHE_VERSION;
+    header.size     = data.size();
+    header.checksum = Checksum(data.data(), data.size());
+    memcpy(header.digest, digest.data(), sizeof(header.digest));
+
+    /// Write to a temporary file and rename it, so that readers never see a partial entry.
+    /// The name is unique per cache, as several processes may store the same entry at once.
+    const string filename    = GetFilename(digest);
+    const string tmpFilename = filename + "." + to_string(getpid()) + "." + to_string((uintptr_t)this) + SHADER_CACHE_TMP_FILE_EXTENSION;
+
+    /// Writes are not attempted again once the directory turns out to be read only
+    ofstream file(tmpFilename, ios::out | ios::binary | ios::trunc);
+    if(!file.is_open()) {
+        mDirectoryWritable = false;
+        return;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(data.data()), data.size());
+    file.close();
+
+    if(file.fail() || rename(tmpFilename.c_str(), filename.c_str())) {
+        remove(tmpFilename.c_str());
+        return;
+    }
+
+    /// The size of the directory is counted once and then estimated,
+    /// until it exceeds the limit and the files are counted again
+    if(!mDiskSizeValid) {
+        PruneFiles();
+    } else {
+        mDiskSize += sizeof(header) + data.size();
+        if(mDiskSize > mMaxDiskSize) {
+            PruneFiles();
+        }
+    }
+}
+
+void
+ShaderCache::PruneFiles(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    DIR *dir = opendir(mDirectory.c_str());
+    if(!dir) {
+        return;
+    }
+
+    const time_t now = time(NULL);
+    vector<shaderCacheFile_t> files;
+    size_t diskSize = 0;
+
+    struct dirent *dirEntry;
+    while((dirEntry = readdir(dir)) != NULL) {
+        const string name(dirEntry->d_name);
+        const bool tmpFile = HasSuffix(name, SHADER_CACHE_TMP_FILE_EXTENSION) &&
+                             name.find(SHADER_CACHE_FILE_EXTENSION ".") != string::npos;
+        if(!tmpFile && !HasSuffix(name, SHADER_CACHE_FILE_EXTENSION)) {
+            continue;
+        }
+
+        shaderCacheFile_t file;
+        file.filename = mDirectory + "/" + name;
+
+        struct stat fileStat;
+        if(stat(file.filename.c_str(), &fileStat) || !S_ISREG(fileStat.st_mode)) {
+            continue;
+        }
+
+        /// Temporary files may still be written by other caches, unless they are old
+        if(tmpFile) {
+            if(now - fileStat.st_mtime > SHADER_CACHE_TMP_FILE_MAX_AGE) {
+                remove(file.filename.c_str());
+            }
+            continue;
+        }
+
+        if(!IsEntryFile(file.filename)) {
+            continue;
+        }
+
+        file.time = fileStat.st_mtime;
+        file.size = fileStat.st_size;
+        diskSize += file.size;
+        files.push_back(file);
+    }
+    closedir(dir);
+
+    /// Prune down to three quarters of the limit, so that pruning
+    /// does not run again on every following write
+    if(diskSize > mMaxDiskSize) {
+        std::sort(files.begin(), files.end(),
+                  [](const shaderCacheFile_t &a, const shaderCacheFile_t &b) { return a.time < b.time; });
+
+        const size_t targetSize = mMaxDiskSize / 4 * 3;
+        for(size_t i = 0; i < files.size() && diskSize > targetSize; ++i) {
+            if(!remove(files[i].filename.c_str())) {
+                diskSize -= files[i].size;
+            }
+        }
+    }
+
+    mDiskSize      = diskSize;
+    mDiskSizeValid = true;
+}
@@ -0,0 +1,88 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       shaderCache.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Content Addressed Cache of Compiled Shaders and Linked Programs
+ *
+ */
+
+#ifndef __SHADERCACHE_H__
+#define __SHADERCACHE_H__
+
+#include "utils/globals.h"
+#include <list>
+#include <unordered_map>
+
+class ShaderCache {
+
+private:
+
+    typedef struct Entry {
+        string                                  digest;
+        vector<uint8_t>                         data;
+    } Entry;
+
+    std::mutex                                  mMutex;
+
+    /// Most recently used entries are kept at the front
+    std::list<Entry>                            mEntries;
+    std::unordered_map<string, std::list<Entry>::iterator> mLookup;
+
+    size_t                                      mSize;
+    size_t                                      mMaxSize;
+
+    /// Entries are also stored one per file in mDirectory, if not empty.
+    /// A directory that cannot be written to is only read from.
+    string                                      mDirectory;
+    bool                                        mDirectoryWritable;
+    size_t                                      mDiskSize;
+    size_t                                      mMaxDiskSize;
+    bool                                        mDiskSizeValid;
+
+    uint32_t                                    mHits;
+    uint32_t                                    mMisses;
+
+    void            Evict(std::list<Entry>::iterator it);
+    void            InsertEntry(const string &digest, const vector<uint8_t> &data);
+
+    string          GetFilename(const string &digest)                     const;
+    bool            ReadFile(const string &digest, vector<uint8_t> &data) const;
+    void            WriteFile(const string &digest, const vector<uint8_t> &data);
+    void            PruneFiles(void);
+
+public:
+// Constructor
+    ShaderCache(size_t maxSize, const char *directory, size_t maxDiskSize);
+
+// Destructor
+    ~ShaderCache();
+
+// Find/Insert Functions
+    bool            Find(const string &digest, vector<uint8_t> &data);
+    void            Insert(const string &digest, const vector<uint8_t> &data);
+
+// Release Functions
+    void            Release(void);
+
+// Get Functions
+    inline size_t   GetSize(void)                                         const { FUN_ENTRY(GL_LOG_TRACE); return mSize;   }
+    inline uint32_t GetHits(void)                                         const { FUN_ENTRY(GL_LOG_TRACE); return mHits;   }
+    inline uint32_t GetMisses(void)                                       const { FUN_ENTRY(GL_LOG_TRACE); return mMisses; }
+};
+
+#endif // __SHADERCACHE_H__
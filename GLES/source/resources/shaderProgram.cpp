@@ -28,9 +28,10 @@
 
 #include "shaderProgram.h"
 #include "context/context.h"
+#include "utils/sha256.h"
 
 ShaderProgram::ShaderProgram(const vkContext_t *vkContext)
-: mGlContext(nullptr)
+: mGlContext(nullptr), mShaderCompiler(nullptr), mCompileQueue(nullptr), mLinkSerial(0), mShaderCache(nullptr)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
@@ -52,8 +53,14 @@ ShaderProgram::ShaderProgram(const vkContext_t *vkContext)
     mVkDescSetLayoutBind = NULL;
     mVkDescPool = VK_NULL_HANDLE;
     mVkDescSet = VK_NULL_HANDLE;
+    mVkActiveDescSet = VK_NULL_HANDLE;
+    mDescSetArena = nullptr;
+    mDescSetFrameSerial = 0;
+    mDescSetUniformBuffer = VK_NULL_HANDLE;
+    mVkActiveDescSetUsed = false;
     mVkPipelineLayout = VK_NULL_HANDLE;
     mVkPipelineCache = VK_NULL_HANDLE;
+    mVkPipelineCacheDataValid = false;
 
     mStageCount = 0;
 
@@ -61,9 +68,11 @@ ShaderProgram::ShaderProgram(const vkContext_t *vkContext)
     mUpdateDescriptorData = false;
     mMarkForDeletion = false;
     mLinked = false;
+    mLinkPending = false;
     mIsPrecompiled = false;
     mValidated = false;
     mActiveVertexVkBuffersCount = 0;
+    memset(mConvertedVertexAttribs, 0, sizeof(mConvertedVertexAttribs));
 
     SetPipelineVertexInputStateInfo();
 }
@@ -140,7 +149,8 @@ ShaderProgram::GetInfoLogLength(void) const
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    return mShaderCompiler->GetProgramInfoLog() ? (int)strlen(mShaderCompiler->GetProgramInfoLog()) + 1 : 0;
+    /// The length includes the null terminator, unless there is no log at all
+    return mInfoLog.empty() ? 0 : (int)mInfoLog.length() + 1;
 }
 
 Shader *
@@ -220,14 +230,14 @@ ShaderProgram::SetShaderModules(void)
         Shader* shader = HasVertexShader() ? GetVertexShader() : GetFragmentShader();
 
         if(mVkShaderModules[0] != VK_NULL_HANDLE) {
-            mVkContext->mCommandBufferManager->UnrefResouce(mVkShaderModules[0]);
+            mVkContext->mRetirementQueue->UnrefResouce(mVkShaderModules[0], RESOURCE_TYPE_SHADER);
             mVkShaderModules[0] = VK_NULL_HANDLE;
         }
 
         mVkShaderModules[0] = shader->CreateVkShaderModule();
 
         if(mVkShaderModules[0] != VK_NULL_HANDLE) {
-            mVkContext->mCommandBufferManager->RefResource(mVkShaderModules[0], RESOURCE_TYPE_SHADER);
+            mVkContext->mRetirementQueue->RefResource(mVkShaderModules[0], RESOURCE_TYPE_SHADER);
         }
 
         mVkShaderStages[0]  = HasVertexShader() ? VK_SHADER_STAGE_VERTEX_BIT : VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -237,14 +247,14 @@ ShaderProgram::SetShaderModules(void)
         Shader* shader = GetVertexShader();
 
         if(mVkShaderModules[0] != VK_NULL_HANDLE) {
-            mVkContext->mCommandBufferManager->UnrefResouce(mVkShaderModules[0]);
+            mVkContext->mRetirementQueue->UnrefResouce(mVkShaderModules[0], RESOURCE_TYPE_SHADER);
             mVkShaderModules[0] = VK_NULL_HANDLE;
         }
 
         mVkShaderModules[0] = shader->CreateVkShaderModule();
 
         if(mVkShaderModules[0] != VK_NULL_HANDLE) {
-            mVkContext->mCommandBufferManager->RefResource(mVkShaderModules[0], RESOURCE_TYPE_SHADER);
+            mVkContext->mRetirementQueue->RefResource(mVkShaderModules[0], RESOURCE_TYPE_SHADER);
         }
 
         mShaderSPVsize[0]  = shader->GetSPV().size();
@@ -254,14 +264,14 @@ ShaderProgram::SetShaderModules(void)
         shader = GetFragmentShader();
 
         if(mVkShaderModules[1] != VK_NULL_HANDLE) {
-            mVkContext->mCommandBufferManager->UnrefResouce(mVkShaderModules[1]);
+            mVkContext->mRetirementQueue->UnrefResouce(mVkShaderModules[1], RESOURCE_TYPE_SHADER);
             mVkShaderModules[1] = VK_NULL_HANDLE;
         }
 
         mVkShaderModules[1] = shader->CreateVkShaderModule();
 
         if(mVkShaderModules[1] != VK_NULL_HANDLE) {
-            mVkContext->mCommandBufferManager->RefResource(mVkShaderModules[1], RESOURCE_TYPE_SHADER);
+            mVkContext->mRetirementQueue->RefResource(mVkShaderModules[1], RESOURCE_TYPE_SHADER);
         }
 
         mShaderSPVsize[1]  = shader->GetSPV().size();
@@ -356,10 +366,17 @@ ShaderProgram::GetVkPipelineCache(void)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    if(mVkPipelineCache == VK_NULL_HANDLE) {
-        CreateVkPipelineCache(nullptr, 0);
+    if(mVkPipelineCache != VK_NULL_HANDLE) {
+        return mVkPipelineCache;
+    }
+
+    /// Unless seeded from a program binary, pipelines go to the process-wide cache
+    if(mVkContext->vkPipelineCache != VK_NULL_HANDLE) {
+        return mVkContext->vkPipelineCache;
     }
 
+    CreateVkPipelineCache(nullptr, 0);
+
     return mVkPipelineCache;
 }
 
@@ -407,10 +424,144 @@ ShaderProgram::ValidateProgram(void)
 }
 
 bool
-ShaderProgram::LinkProgram()
+ShaderProgram::Link(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const string digest = mShaderCache ? GetCacheDigest() : string();
+    if(!digest.empty() && LinkFromCache(digest)) {
+        return mLinked;
+    }
+
+    LinkSource();
+
+    /// Keep a copy of the log, the compiler's one is replaced by the next link
+    mInfoLog = string(mShaderCompiler->GetProgramInfoLog());
+
+    if(mLinked && !digest.empty()) {
+        StoreToCache(digest);
+    }
+
+    return mLinked;
+}
+
+string
+ShaderProgram::GetCacheDigest(void) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const Shader *vs = mShaders[0];
+    const Shader *fs = mShaders[1];
+
+    if((!vs || !fs) ||
+       (!vs->IsCompiled() || !fs->IsCompiled()) ||
+       vs->GetCacheDigest().empty() || fs->GetCacheDigest().empty()) {
+        return string();
+    }
+
+    /// The shaders' digests cover their sources. The bound attribute locations change
+    /// the generated SPIR-V and the reflection is stored with host sized fields.
+    Sha256 digest;
+    digest.Update(string("program"));
+    digest.Update((uint32_t)GLOVE_SHADER_CACHE_VERSION);
+    digest.Update((uint32_t)sizeof(size_t));
+    digest.Update(vs->GetCacheDigest());
+    digest.Update(fs->GetCacheDigest());
+
+    const ShaderResourceInterface::attribsLayout_t &attribsLayout = mShaderResourceInterface.GetCustomAttribsLayout();
+    digest.Update((uint32_t)attribsLayout.size());
+    for(ShaderResourceInterface::attribsLayout_t::const_iterator it = attribsLayout.begin(); it != attribsLayout.end(); ++it) {
+        digest.Update(it->first);
+        digest.Update(it->second);
+    }
+
+    return digest.FinalizeHex();
+}
+
+bool
+ShaderProgram::LinkFromCache(const string &digest)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    vector<uint8_t> data;
+    if(!mShaderCache->Find(digest, data)) {
+        return false;
+    }
+
+    /// Entry layout: reflection, SPIR-V of both stages as in program binaries, info log
+    const size_t reflectionSize = mShaderCompiler->GetShaderReflection()->GetReflectionSize();
+    size_t offset = reflectionSize;
+    for(uint32_t i = 0; i < 2; ++i) {
+        uint32_t spirvSize;
+        if(data.size() < offset + sizeof(uint32_t)) {
+            return false;
+        }
+        memcpy(&spirvSize, data.data() + offset, sizeof(uint32_t));
+        offset += sizeof(uint32_t) + spirvSize;
+    }
+    if(data.size() < offset) {
+        return false;
+    }
+
+    ResetVulkanVertexInput();
+
+    mShaderCompiler->DeserializeReflection(data.data());
+    GetVertexShader()->GetSPV().clear();
+    GetFragmentShader()->GetSPV().clear();
+    DeserializeShadersSpirv(data.data() + reflectionSize);
+    mInfoLog = string(data.begin() + offset, data.end());
+
+    /// The stored reflection already holds the resolved attribute locations
+    UpdateAttributeInterface();
+    BuildShaderResourceInterface();
+
+    mLinked = true;
+    return true;
+}
+
+void
+ShaderProgram::StoreToCache(const string &digest)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const vector<uint32_t> &vsSpirv = GetVertexShader()->GetSPV();
+    const vector<uint32_t> &fsSpirv = GetFragmentShader()->GetSPV();
+    const uint32_t vsSpirvSize = 4 * vsSpirv.size();
+    const uint32_t fsSpirvSize = 4 * fsSpirv.size();
+    const size_t reflectionSize = mShaderCompiler->GetShaderReflection()->GetReflectionSize();
+
+    /// The reflection leaves the slots of inactive variables unwritten
+    vector<uint8_t> data(reflectionSize + 2 * sizeof(uint32_t) + vsSpirvSize + fsSpirvSize + mInfoLog.size(), 0);
+    uint8_t *rawDataPtr = data.data();
+
+    rawDataPtr += mShaderCompiler->SerializeReflection(rawDataPtr);
+
+    memcpy(rawDataPtr, &vsSpirvSize, sizeof(uint32_t));
+    rawDataPtr += sizeof(uint32_t);
+    memcpy(rawDataPtr, vsSpirv.data(), vsSpirvSize);
+    rawDataPtr += vsSpirvSize;
+
+    memcpy(rawDataPtr, &fsSpirvSize, sizeof(uint32_t));
+    rawDataPtr += sizeof(uint32_t);
+    memcpy(rawDataPtr, fsSpirv.data(), fsSpirvSize);
+    rawDataPtr += fsSpirvSize;
+
+    memcpy(rawDataPtr, mInfoLog.data(), mInfoLog.size());
+
+    mShaderCache->Insert(digest, data);
+}
+
+bool
+ShaderProgram::LinkSource(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    for(uint32_t i = 0; i < 2; ++i) {
+        if(mShaders[i]) {
+            mShaders[i]->RestoreCompilerState();
+        }
+    }
+
     if(!(mLinked = ValidateProgram())) {
         return false;
     }
@@ -461,76 +612,110 @@ ShaderProgram::LinkProgram()
 }
 
 void
-ShaderProgram::PrepareVertexAttribBufferObjects(size_t vertCount, uint32_t firstVertex, GenericVertexAttributes *genericVertAttribs)
+ShaderProgram::LinkProgram(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    assert(mCompileQueue);
+
+    mLinked      = false;
+    mLinkPending = true;
+    mVkPipelineCacheDataValid = false;
+    mLinkSerial  = mCompileQueue->Submit([this] { Link(); });
+
+    /// The link reads the sources of the attached shaders and writes their SPIR-V
+    for(uint32_t i = 0; i < 2; ++i) {
+        if(mShaders[i]) {
+            mShaders[i]->SetCompileSerial(mLinkSerial);
+        }
+    }
+}
+
+void
+ShaderProgram::Synchronize(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(firstVertex) {
-        genericVertAttribs->CleanupVertexAttributes();
+    if(!mLinkPending) {
+        return;
+    }
+
+    mCompileQueue->Wait(mLinkSerial);
+    mLinkPending = false;
+
+    /// Vulkan objects are tracked by the command buffer manager, so they are
+    /// created here, on the thread of the context, once the link completes
+    if(mLinked) {
+        /// The objects of the previous link are retired, pending draws may still use them
+        AllocateVkResources();
     }
 
+    SetShaderModules();
+}
+
+void
+ShaderProgram::PrepareVertexAttribBufferObjects(GenericVertexAttributes *genericVertAttribs)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
     // store the location-binding associations for faster lookup
     std::map<uint32_t, uint32_t> vboLocationBindings;
 
     // reset active buffers
     memset(mActiveVertexVkBuffers, VK_NULL_HANDLE, sizeof(VkBuffer) * mActiveVertexVkBuffersCount);
+    memset(mActiveVertexVkOffsets, 0, sizeof(VkDeviceSize) * mActiveVertexVkBuffersCount);
     mActiveVertexVkBuffersCount = 0;
 
-    GenerateVertexAttribProperties(vertCount, firstVertex, genericVertAttribs, vboLocationBindings);
+    GenerateVertexAttribProperties(genericVertAttribs, vboLocationBindings);
     GenerateVertexInputProperties(genericVertAttribs, vboLocationBindings);
 }
 
-void ShaderProgram::GenerateVertexAttribProperties(size_t vertCount, uint32_t firstVertex, GenericVertexAttributes *genericVertAttribs, std::map<uint32_t, uint32_t>& vboLocationBindings)
+void ShaderProgram::GenerateVertexAttribProperties(GenericVertexAttributes *genericVertAttribs, std::map<uint32_t, uint32_t>& vboLocationBindings)
 {
     // store attribute locations containing the same VkBuffer and stride
     // as they are directly associated with vertex input bindings
     typedef std::pair<VkBuffer, uint32_t> BUFFER_STRIDE_PAIR;
     std::map<BUFFER_STRIDE_PAIR, std::vector<uint32_t>> unique_buffer_stride_map;
 
+    mStreamedVertexAttribs.clear();
+
     for(uint32_t i = 0; i < mShaderResourceInterface.GetLiveAttributes(); ++i) {
         const uint32_t location = mShaderResourceInterface.GetAttributeLocation(i);
         assert(location < GLOVE_MAX_VERTEX_ATTRIBS);
 
-        if(genericVertAttribs->GetVertexAttribActive(location)) {
-            /// Calculate stride if not given from user
-            if(!genericVertAttribs->GetVertexAttribStride(location)) {
-                // gva->stride = gva->nElements * glDataTypeToBpp(gva->dataType);
-                // shaders only accept floats
-                size_t stride = genericVertAttribs->GetVertexAttribSize(location) * sizeof(glsl_float_t);
-                genericVertAttribs->SetVertexAttribStride(location, stride);
-            }
-
-            /// Create new vbo if user passed pointer to data
-            /// This happens when vertex data are located in user space, instead of stored in a Vertex Buffer Objects
-            if(!genericVertAttribs->GetVertexAttribVbo(location)) {
-                BufferObject *vbo = new VertexBufferObject(mVkContext);
-                vbo->Allocate(genericVertAttribs->GetVertexAttribFormat(location),
-                              genericVertAttribs->GetVertexAttribNormalized(location),
-                              (firstVertex + vertCount) * genericVertAttribs->GetVertexAttribStride(location),
-                              (const void *)genericVertAttribs->GetVertexAttribPointer(location));
-
-                genericVertAttribs->SetVertexAttribVbo(location, vbo);
-                genericVertAttribs->SetVertexAttribOffset(location, 0);
-                genericVertAttribs->SetVertexAttribInternalVBO(location, true);
-            }
-        } else {
-            /// Use the generic vertex attribute value registered to that location
-            BufferObject *vbo = new VertexBufferObject(mVkContext);
-            float genericValue[4];
-            genericVertAttribs->GetGenericVertexAttribute(location, genericValue);
-            vbo->Allocate(4 * sizeof(float), (const void *)genericValue);
-
-            genericVertAttribs->SetVertexAttribVbo(location, vbo);
-            genericVertAttribs->SetVertexAttribFormat(location, GlAttribTypeToVkFormat(mShaderResourceInterface.GetAttributeType(i)));
-            genericVertAttribs->SetVertexAttribStride(location, 0);
-            genericVertAttribs->SetVertexAttribInternalVBO(location, true);
+        /// Vertex data located in user space, instead of stored in a Vertex Buffer Object, and
+        /// generic vertex attribute values are streamed to the vertex ring buffer on every draw
+        if(!genericVertAttribs->GetVertexAttribActive(location)) {
+            mStreamedVertexAttribs.push_back(std::make_pair(location, 0));
+            continue;
         }
 
-        assert(genericVertAttribs->GetVertexAttribVbo(location));
+        if(!genericVertAttribs->GetVertexAttribVbo(location)) {
+            mStreamedVertexAttribs.push_back(std::make_pair(location, 0));
+            continue;
+        }
 
         // store each location
-        VkBuffer bo = genericVertAttribs->GetVertexAttribVbo(location)->GetVkBuffer();
-        uint32_t stride = genericVertAttribs->GetVertexAttribStride(location);
+        BufferObject *vbo = genericVertAttribs->GetVertexAttribVbo(location);
+        VkBuffer bo = vbo->GetVkBuffer();
+        uint32_t stride = genericVertAttribs->GetVertexAttribDataStride(location);
+
+        /// Formats that the device cannot fetch are read from a float copy of the buffer data
+        bool converted;
+        GetVertexAttribVkFormat(genericVertAttribs, location, &converted);
+        mConvertedVertexAttribs[location] = false;
+        if(converted) {
+            VkBuffer convertedBo = vbo->GetConvertedVkBuffer(genericVertAttribs->GetVertexAttribFormat(location),
+                                                             genericVertAttribs->GetVertexAttribNormalized(location),
+                                                             genericVertAttribs->GetVertexAttribSize(location),
+                                                             stride, genericVertAttribs->GetVertexAttribOffset(location));
+            if(convertedBo != VK_NULL_HANDLE) {
+                bo     = convertedBo;
+                stride = genericVertAttribs->GetVertexAttribSize(location) * sizeof(glsl_float_t);
+                mConvertedVertexAttribs[location] = true;
+            }
+        }
+
         BUFFER_STRIDE_PAIR p = {bo, stride};
         unique_buffer_stride_map[p].push_back(location);
     }
@@ -545,6 +730,13 @@ void ShaderProgram::GenerateVertexAttribProperties(size_t vertCount, uint32_t fi
         mActiveVertexVkBuffers[current_binding] = bo;
         ++current_binding;
     }
+
+    // streamed attributes are placed at arbitrary offsets of the ring buffer, so each one gets a binding of its own
+    for(auto& iter : mStreamedVertexAttribs) {
+        vboLocationBindings[iter.first] = current_binding;
+        iter.second = current_binding;
+        ++current_binding;
+    }
     mActiveVertexVkBuffersCount = current_binding;
 }
 
@@ -558,20 +750,110 @@ ShaderProgram::GenerateVertexInputProperties(GenericVertexAttributes *genericVer
         assert(vboLocationBindings.find(location) != vboLocationBindings.end());
         const uint32_t binding = vboLocationBindings.at(location);
 
+        // generic vertex attribute values are constant for all vertices
+        const bool generic  = !genericVertAttribs->GetVertexAttribActive(location);
+        const bool streamed = generic || !genericVertAttribs->GetVertexAttribVbo(location);
+
+        bool converted = false;
+        const VkFormat format = generic ? VkIntFormatToVkFloatFormat(GlAttribTypeToVkFormat(mShaderResourceInterface.GetAttributeType(i))) :
+                                          GetVertexAttribVkFormat(genericVertAttribs, location, &converted);
+
+        /// Streamed attributes are converted into the ring buffer, attributes in buffer objects
+        /// have been bound to the converted copy of their buffer, unless it could not be allocated
+        if(streamed) {
+            mConvertedVertexAttribs[location] = converted;
+        }
+
         mVkVertexInputBinding[binding].binding = binding;
         mVkVertexInputBinding[binding].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-        mVkVertexInputBinding[binding].stride = genericVertAttribs->GetVertexAttribStride(location);
+        mVkVertexInputBinding[binding].stride = generic                           ? 0 :
+                                                mConvertedVertexAttribs[location] ? genericVertAttribs->GetVertexAttribSize(location) * sizeof(glsl_float_t) :
+                                                                                    genericVertAttribs->GetVertexAttribDataStride(location);
 
         mVkVertexInputAttribute[i].binding = binding;
-        mVkVertexInputAttribute[i].format = VkIntFormatToVkFloatFormat(genericVertAttribs->GetVertexAttribFormat(location));
+        mVkVertexInputAttribute[i].format = format;
         mVkVertexInputAttribute[i].location = location;
-        mVkVertexInputAttribute[i].offset = genericVertAttribs->GetVertexAttribOffset(location);
+        mVkVertexInputAttribute[i].offset = (streamed || mConvertedVertexAttribs[location]) ? 0 : genericVertAttribs->GetVertexAttribOffset(location);
     }
 
     mVkPipelineVertexInput.vertexBindingDescriptionCount = mActiveVertexVkBuffersCount;
     mVkPipelineVertexInput.vertexAttributeDescriptionCount = mShaderResourceInterface.GetLiveAttributes();
 }
 
+VkFormat
+ShaderProgram::GetVertexAttribVkFormat(const GenericVertexAttributes *genericVertAttribs, uint32_t location, bool *converted) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    const VkFormat format       = genericVertAttribs->GetVertexAttribFormat(location);
+    const VkFormat nativeFormat = VkIntFormatToVkNativeFormat(format, genericVertAttribs->GetVertexAttribNormalized(location));
+
+    /// formats that the device reads natively are used as they are, the rest are converted to floats
+    if(nativeFormat != VK_FORMAT_UNDEFINED && VkFormatIsVertexBufferSupported(mVkContext->vkGpus[0], nativeFormat)) {
+        *converted = false;
+        return nativeFormat;
+    }
+
+    const VkFormat floatFormat = VkIntFormatToVkFloatFormat(format);
+    *converted = (floatFormat != format);
+
+    return floatFormat;
+}
+
+bool
+ShaderProgram::UpdateVertexAttribData(uint32_t vertCount, uint32_t firstVertex, const GenericVertexAttributes *genericVertAttribs, vulkanAPI::RingBuffer *ringBuffer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// Client arrays may be modified between draws without notice, so their data are copied for every draw
+    for(const auto& iter : mStreamedVertexAttribs) {
+        const uint32_t location = iter.first;
+        const uint32_t binding  = iter.second;
+
+        VkDeviceSize offset;
+        if(genericVertAttribs->GetVertexAttribActive(location)) {
+            const bool converted       = mConvertedVertexAttribs[location];
+            const uint32_t nComponents = genericVertAttribs->GetVertexAttribSize(location);
+            const size_t srcStride     = genericVertAttribs->GetVertexAttribDataStride(location);
+            const size_t dstStride     = converted ? nComponents * sizeof(glsl_float_t) : srcStride;
+            const VkDeviceSize size    = (firstVertex + vertCount) * dstStride;
+            const void *srcData = (const void *)genericVertAttribs->GetVertexAttribPointer(location);
+
+            uint8_t *pData = ringBuffer->Allocate(size, &offset);
+            if(!pData) {
+                return false;
+            }
+
+            if(srcData && converted) {
+                vulkanAPI::Memory::CopyVertexData(genericVertAttribs->GetVertexAttribFormat(location),
+                                                  genericVertAttribs->GetVertexAttribNormalized(location),
+                                                  nComponents, srcStride, firstVertex + vertCount, srcData, pData);
+            } else if(srcData) {
+                memcpy(pData, srcData, size);
+            } else {
+                memset(pData, 0x0, size);
+            }
+            ringBuffer->Flush(size, offset);
+        } else {
+            float genericValue[4];
+            genericVertAttribs->GetGenericVertexAttribute(location, genericValue);
+
+            uint8_t *pData = ringBuffer->Allocate(sizeof(genericValue), &offset);
+            if(!pData) {
+                return false;
+            }
+
+            memcpy(pData, genericValue, sizeof(genericValue));
+            ringBuffer->Flush(sizeof(genericValue), offset);
+        }
+
+        mActiveVertexVkBuffers[binding] = ringBuffer->GetVkBuffer();
+        mActiveVertexVkOffsets[binding] = offset;
+    }
+
+    return true;
+}
+
 bool
 ShaderProgram::CreateVkPipelineCache(const void *initialData, size_t initialDataSize)
 {
@@ -596,6 +878,7 @@ ShaderProgram::UsePrecompiledBinary(const void *binary, size_t binarySize)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     mLinked = true;
+    mVkPipelineCacheDataValid = false;
 
     ResetVulkanVertexInput();
 
@@ -604,11 +887,9 @@ ShaderProgram::UsePrecompiledBinary(const void *binary, size_t binarySize)
     const uint8_t *vulkanDataPtr = reinterpret_cast<const uint8_t *>(binary) + reflectionOffset + spirvOffset;
 
     BuildShaderResourceInterface();
+    AllocateVkResources();
 
-    if(mVkPipelineCache != VK_NULL_HANDLE) {
-        vkDestroyPipelineCache(mVkContext->vkDevice, mVkPipelineCache, nullptr);
-        mVkPipelineCache = VK_NULL_HANDLE;
-    }
+    ReleaseVkPipelineCache();
 
     CreateVkPipelineCache(vulkanDataPtr, binarySize - reflectionOffset);
 
@@ -620,20 +901,24 @@ ShaderProgram::GetBinaryData(void *binary, GLsizei *binarySize)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    /// The data is the one GetBinaryLength() reported, it is taken here only if it has not been queried
+    if(!mVkPipelineCacheDataValid) {
+        GetBinaryLength();
+    }
+
     uint32_t reflectionOffset = mShaderCompiler->SerializeReflection(binary);
 
     uint8_t *spirvDataPtr = reinterpret_cast<uint8_t *>(binary) + reflectionOffset;
     uint32_t spirvOffset = SerializeShadersSpirv(spirvDataPtr);
 
     uint8_t *vulkanDataPtr = reinterpret_cast<uint8_t *>(binary) + reflectionOffset + spirvOffset;
-    size_t vulkanDataSize = *binarySize;
-
-    if(mVkPipelineCache) {
-        vkGetPipelineCacheData(mVkContext->vkDevice, mVkPipelineCache, &vulkanDataSize, reinterpret_cast<void *>(vulkanDataPtr));
-        *binarySize = vulkanDataSize + reflectionOffset + spirvOffset;
-    } else {
-        *binarySize = 0;
+    if(!mVkPipelineCacheData.empty()) {
+        memcpy(vulkanDataPtr, mVkPipelineCacheData.data(), mVkPipelineCacheData.size());
     }
+    *binarySize = mVkPipelineCacheData.size() + reflectionOffset + spirvOffset;
+
+    mVkPipelineCacheData.clear();
+    mVkPipelineCacheDataValid = false;
 }
 
 GLsizei
@@ -641,14 +926,28 @@ ShaderProgram::GetBinaryLength(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    size_t vkPipelineCacheDataLength = 0;
     uint32_t spirvSize = 2 * sizeof(uint32_t) + 4 * (mShaderSPVsize[0] + mShaderSPVsize[1]);
 
-    if(mVkPipelineCache) {
-        vkGetPipelineCacheData(mVkContext->vkDevice, mVkPipelineCache, &vkPipelineCacheDataLength, nullptr);
+    /// The process-wide cache keeps growing as other programs link, so its data is
+    /// taken once and kept until GetBinaryData() returns it
+    if(!mVkPipelineCacheDataValid) {
+        mVkPipelineCacheData.clear();
+
+        size_t vkPipelineCacheDataLength = 0;
+        VkPipelineCache pipelineCache = GetVkPipelineCache();
+        if(pipelineCache &&
+           vkGetPipelineCacheData(mVkContext->vkDevice, pipelineCache, &vkPipelineCacheDataLength, nullptr) == VK_SUCCESS) {
+            mVkPipelineCacheData.resize(vkPipelineCacheDataLength);
+
+            /// Entries added in between do not fit, the ones returned still form a valid cache
+            VkResult err = vkGetPipelineCacheData(mVkContext->vkDevice, pipelineCache, &vkPipelineCacheDataLength, mVkPipelineCacheData.data());
+            mVkPipelineCacheData.resize((err == VK_SUCCESS || err == VK_INCOMPLETE) ? vkPipelineCacheDataLength : 0);
+        }
+
+        mVkPipelineCacheDataValid = true;
     }
 
-    return vkPipelineCacheDataLength + mShaderResourceInterface.GetReflectionSize() + spirvSize;
+    return mVkPipelineCacheData.size() + mShaderResourceInterface.GetReflectionSize() + spirvSize;
 }
 
 char *
@@ -659,11 +958,10 @@ ShaderProgram::GetInfoLog(void) const
     char *log = NULL;
 
     if(mShaderCompiler) {
-        uint32_t len = strlen(mShaderCompiler->GetProgramInfoLog()) + 1;
+        uint32_t len = mInfoLog.length() + 1;
         log = new char[len];
 
-        memcpy(log, mShaderCompiler->GetProgramInfoLog(), len);
-        log[len - 1] = '\0';
+        memcpy(log, mInfoLog.c_str(), len);
     }
 
     return log;
@@ -708,31 +1006,34 @@ ShaderProgram::ReleaseVkObjects(void)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     if(mVkPipelineLayout != VK_NULL_HANDLE) {
-        mVkContext->mCommandBufferManager->UnrefResouce(mVkPipelineLayout);
+        mVkContext->mRetirementQueue->UnrefResouce(mVkPipelineLayout, RESOURCE_TYPE_PIPELINE_LAYOUT);
         mVkPipelineLayout = VK_NULL_HANDLE;
     }
 
     if(mVkDescSetLayout != VK_NULL_HANDLE) {
-        mVkContext->mCommandBufferManager->UnrefResouce(mVkDescSetLayout);
+        mVkContext->mRetirementQueue->UnrefResouce(mVkDescSetLayout, RESOURCE_TYPE_DESC_SET_LAYOUT);
         mVkDescSetLayout = VK_NULL_HANDLE;
     }
 
-    if(mVkDescSet != VK_NULL_HANDLE) {
-        vkFreeDescriptorSets(mVkContext->vkDevice, mVkDescPool, 1, &mVkDescSet);
-        mVkDescSet = VK_NULL_HANDLE;
-    }
+    /// The set may still be used by pending draws, it is freed along with its pool.
+    /// Sets allocated from descriptor arenas are recycled along with their frames.
+    mVkDescSet            = VK_NULL_HANDLE;
+    mVkActiveDescSet      = VK_NULL_HANDLE;
+    mDescSetArena         = nullptr;
+    mDescSetUniformBuffer = VK_NULL_HANDLE;
+    mVkActiveDescSetUsed  = false;
 
     if(mVkDescPool != VK_NULL_HANDLE) {
-        mVkContext->mCommandBufferManager->UnrefResouce(mVkDescPool);
+        mVkContext->mRetirementQueue->UnrefResouce(mVkDescPool, RESOURCE_TYPE_DESC_POOL);
         mVkDescPool = VK_NULL_HANDLE;
     }
 
     if(mVkShaderModules[0] != VK_NULL_HANDLE) {
-        mVkContext->mCommandBufferManager->UnrefResouce(mVkShaderModules[0]);
+        mVkContext->mRetirementQueue->UnrefResouce(mVkShaderModules[0], RESOURCE_TYPE_SHADER);
         mVkShaderModules[0] = VK_NULL_HANDLE;
     }
     if(mVkShaderModules[1] != VK_NULL_HANDLE) {
-        mVkContext->mCommandBufferManager->UnrefResouce(mVkShaderModules[1]);
+        mVkContext->mRetirementQueue->UnrefResouce(mVkShaderModules[1], RESOURCE_TYPE_SHADER);
         mVkShaderModules[1] = VK_NULL_HANDLE;
     }
 }
@@ -743,7 +1044,15 @@ ShaderProgram::ReleaseVkPipelineCache(void)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     if(mVkPipelineCache != VK_NULL_HANDLE) {
-        vkDestroyPipelineCache(mVkContext->vkDevice, mVkPipelineCache, nullptr);
+        /// Keep the pipelines of precompiled programs for the process-wide cache, other
+        /// threads may be creating pipelines with it, so it is not merged into right away
+        if(mVkContext->vkPipelineCache != VK_NULL_HANDLE) {
+            std::lock_guard<std::mutex> lock(mVkContext->mReleasedPipelineCachesMutex);
+            mVkContext->vkReleasedPipelineCaches.push_back(mVkPipelineCache);
+        } else {
+            vkDestroyPipelineCache(mVkContext->vkDevice, mVkPipelineCache, nullptr);
+        }
+
         mVkPipelineCache = VK_NULL_HANDLE;
     }
 }
@@ -764,7 +1073,7 @@ ShaderProgram::CreateDescriptorSetLayout(uint32_t nLiveUniformBlocks)
 
         for(uint32_t i = 0; i < mShaderResourceInterface.GetLiveUniformBlocks(); ++i) {
             mVkDescSetLayoutBind[i].binding = mShaderResourceInterface.GetUniformBlockBinding(i);
-            mVkDescSetLayoutBind[i].descriptorType = mShaderResourceInterface.IsUniformBlockOpaque(i) ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            mVkDescSetLayoutBind[i].descriptorType = mShaderResourceInterface.IsUniformBlockOpaque(i) ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
             mVkDescSetLayoutBind[i].descriptorCount = 1;
             mVkDescSetLayoutBind[i].stageFlags = mShaderResourceInterface.GetUniformBlockBlockStage(i) == (SHADER_TYPE_VERTEX | SHADER_TYPE_FRAGMENT) ? VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT :
                                                  mShaderResourceInterface.GetUniformBlockBlockStage(i) == SHADER_TYPE_VERTEX ? VK_SHADER_STAGE_VERTEX_BIT : VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -786,7 +1095,7 @@ ShaderProgram::CreateDescriptorSetLayout(uint32_t nLiveUniformBlocks)
     }
     assert(mVkDescSetLayout != VK_NULL_HANDLE);
 
-    mVkContext->mCommandBufferManager->RefResource(mVkDescSetLayout, RESOURCE_TYPE_DESC_SET_LAYOUT);
+    mVkContext->mRetirementQueue->RefResource(mVkDescSetLayout, RESOURCE_TYPE_DESC_SET_LAYOUT);
 
     VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo;
     memset((void *) &pipelineLayoutCreateInfo, 0, sizeof(pipelineLayoutCreateInfo));
@@ -804,7 +1113,7 @@ ShaderProgram::CreateDescriptorSetLayout(uint32_t nLiveUniformBlocks)
     }
     assert(mVkPipelineLayout != VK_NULL_HANDLE);
 
-    mVkContext->mCommandBufferManager->RefResource(mVkPipelineLayout, RESOURCE_TYPE_PIPELINE_LAYOUT);
+    mVkContext->mRetirementQueue->RefResource(mVkPipelineLayout, RESOURCE_TYPE_PIPELINE_LAYOUT);
 
     return true;
 }
@@ -820,7 +1129,7 @@ ShaderProgram::CreateDescriptorPool(uint32_t nLiveUniformBlocks)
 
     for(uint32_t i = 0; i < mShaderResourceInterface.GetLiveUniformBlocks(); ++i) {
         descTypeCounts[i].descriptorCount = 1;
-        descTypeCounts[i].type = mShaderResourceInterface.IsUniformBlockOpaque(i) ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        descTypeCounts[i].type = mShaderResourceInterface.IsUniformBlockOpaque(i) ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         assert(descTypeCounts[i].type == mVkDescSetLayoutBind[i].descriptorType);
     }
 
@@ -839,7 +1148,7 @@ ShaderProgram::CreateDescriptorPool(uint32_t nLiveUniformBlocks)
     }
     assert(mVkDescPool != VK_NULL_HANDLE);
 
-    mVkContext->mCommandBufferManager->RefResource(mVkDescPool, RESOURCE_TYPE_DESC_POOL);
+    mVkContext->mRetirementQueue->RefResource(mVkDescPool, RESOURCE_TYPE_DESC_POOL);
 
     delete[] descTypeCounts;
 
@@ -865,6 +1174,11 @@ ShaderProgram::CreateDescriptorSet(void)
     }
     assert(mVkDescSet != VK_NULL_HANDLE);
 
+    mVkActiveDescSet      = mVkDescSet;
+    mDescSetArena         = nullptr;
+    mDescSetUniformBuffer = VK_NULL_HANDLE;
+    mVkActiveDescSetUsed  = false;
+
     return true;
 }
 
@@ -929,8 +1243,28 @@ ShaderProgram::UpdateBuiltInUniformData(float minDepthRange, float maxDepthRange
     }
 }
 
-void
-ShaderProgram::UpdateDescriptorSet(void)
+bool
+ShaderProgram::UpdateUniformBufferData(vulkanAPI::RingBuffer *ringBuffer, uniformStatistics_t *statistics)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mShaderResourceInterface.GetLiveUniformBlocks() == 0) {
+        return true;
+    }
+
+    /// Transfer any new local uniform data into the uniform blocks
+    if(mUpdateDescriptorData) {
+        mShaderResourceInterface.UpdateUniformBlockData();
+        mUpdateDescriptorData = false;
+    }
+
+    /// Stream the blocks to the ring buffer. The descriptor set stays untouched,
+    /// only the dynamic offsets bound with it change.
+    return mShaderResourceInterface.UploadUniformBlockData(ringBuffer, statistics);
+}
+
+bool
+ShaderProgram::UpdateDescriptorSet(VkBuffer uniformBuffer)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
@@ -939,29 +1273,46 @@ ShaderProgram::UpdateDescriptorSet(void)
     assert(mVkContext);
 
     if(mShaderResourceInterface.GetLiveUniformBlocks() == 0) {
-        return;
+        return true;
     }
 
-    /// Transfer any new local uniform data into the buffer objects
-    if(mUpdateDescriptorData) {
-        mShaderResourceInterface.UpdateUniformBufferData();
-        mUpdateDescriptorData = false;
-    }
+    /// A set from a descriptor arena is valid only within the frame it was allocated for
+    const CommandBufferManager *cbManager = mVkContext->mCommandBufferManager;
+    const bool expired = (mDescSetArena &&
+                          (mDescSetArena != cbManager || mDescSetFrameSerial != cbManager->GetActiveFrameSerial())) ||
+                         mDescSetUniformBuffer != uniformBuffer;
 
     /// This can be true only in three occasions:
     /// 1. This is a freshly linked shader. So the descriptor sets need to be created
     /// 2. There has been an update in a sampler via the glUniform1i()
     /// 3. glBindTexture has been called
-    if(!mUpdateDescriptorSets) {
-        return;
+    if(!mUpdateDescriptorSets && !expired) {
+        return true;
     }
 
-    UpdateSamplerDescriptors();
+    /// Draws recorded with the active set may still be pending or in flight, so instead
+    /// of updating it in place, a new set is allocated for the frame being recorded
+    if(mVkActiveDescSetUsed) {
+        VkDescriptorSet descSet = mVkContext->mCommandBufferManager->AllocateVkDescriptorSet(mVkDescSetLayout);
+        if(descSet == VK_NULL_HANDLE) {
+            return false;
+        }
+
+        mVkActiveDescSet    = descSet;
+        mDescSetArena       = cbManager;
+        mDescSetFrameSerial = cbManager->GetActiveFrameSerial();
+    }
 
+    UpdateSamplerDescriptors(uniformBuffer);
+
+    mDescSetUniformBuffer = uniformBuffer;
+    mVkActiveDescSetUsed  = true;
     mUpdateDescriptorSets = false;
+
+    return true;
 }
 
-void ShaderProgram::UpdateSamplerDescriptors()
+void ShaderProgram::UpdateSamplerDescriptors(VkBuffer uniformBuffer)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
@@ -985,22 +1336,10 @@ void ShaderProgram::UpdateSamplerDescriptors()
                 for(int32_t j = 0; j < mShaderResourceInterface.GetUniformArraySize(i); ++j) {
                     const glsl_sampler_t textureUnit = *(glsl_sampler_t *)mShaderResourceInterface.GetUniformClientData(i);
 
-                    /// Sampler might need an update
-                    Texture *activeTexture = ((Context *)mGlContext)->GetStateManager()->GetActiveObjectsState()->GetActiveTexture(
+                    /// Sampler might need an update, incomplete textures are replaced by an opaque black one
+                    Texture *activeTexture = ((Context *)mGlContext)->GetSampledTexture(
                     mShaderResourceInterface.GetUniformType(i) == GL_SAMPLER_2D ? GL_TEXTURE_2D : GL_TEXTURE_CUBE_MAP, textureUnit); // TODO remove mGlContext
 
-                    if( !activeTexture->IsCompleted() ) {
-                        uint8_t pixels[4] = {0,0,0,255};
-                        //activeTexture->SetVkImageUsage(VK_IMAGE_USAGE_SAMPLED_BIT);
-                        //activeTexture->SetVkImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-                        for(GLint layer = 0; layer < activeTexture->GetLayersCount(); ++layer) {
-                            for(GLint level = 0; level < activeTexture->GetMipLevelsCount(); ++level) {
-                                /// TODO:: how we handle this case should be investigated further
-                                activeTexture->SetState(1, 1, level, layer, GL_RGBA, GL_UNSIGNED_BYTE, Texture::GetDefaultInternalAlignment(), pixels);
-                            }
-                        }
-                        activeTexture->Allocate();
-                    }
                     activeTexture->CreateVkSampler();
 
                     textureDescriptors[samp].sampler     = activeTexture->GetVkSampler();
@@ -1015,12 +1354,13 @@ void ShaderProgram::UpdateSamplerDescriptors()
     assert(samp == nSamplers);
 
     samp = 0;
+    VkDescriptorBufferInfo *bufferDescriptors = new VkDescriptorBufferInfo[nLiveUniformBlocks];
     VkWriteDescriptorSet *writes = new VkWriteDescriptorSet[nLiveUniformBlocks];
     memset((void*)writes, 0, nLiveUniformBlocks * sizeof(*writes));
     for(uint32_t i = 0; i < nLiveUniformBlocks; ++i) {
         writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         writes[i].pNext = NULL;
-        writes[i].dstSet = mVkDescSet;
+        writes[i].dstSet = mVkActiveDescSet;
         writes[i].dstBinding = mShaderResourceInterface.GetUniformBlockBinding(i);
 
         if(mShaderResourceInterface.IsUniformBlockOpaque(i)) {
@@ -1029,10 +1369,14 @@ void ShaderProgram::UpdateSamplerDescriptors()
             writes[i].descriptorCount = mShaderResourceInterface.GetUniformArraySize(i);
             samp += mShaderResourceInterface.GetUniformArraySize(i);
         } else {
+            /// The actual offset in the buffer is provided when the set is bound
+            bufferDescriptors[i].buffer = uniformBuffer;
+            bufferDescriptors[i].offset = 0;
+            bufferDescriptors[i].range  = mShaderResourceInterface.GetUniformBlockSize(i);
+
             writes[i].descriptorCount = 1;
-            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            UniformBufferObject* pBufferObject = mShaderResourceInterface.GetUniformBufferObject(i);
-            writes[i].pBufferInfo = pBufferObject->GetBufferDescInfo();
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            writes[i].pBufferInfo = &bufferDescriptors[i];
         }
     }
     assert(samp == nSamplers);
@@ -1040,11 +1384,54 @@ void ShaderProgram::UpdateSamplerDescriptors()
     vkUpdateDescriptorSets(mVkContext->vkDevice, nLiveUniformBlocks, writes, 0, NULL);
 
     delete[] writes;
+    delete[] bufferDescriptors;
     delete[] textureDescriptors;
 
     mUpdateDescriptorSets = false;
 }
 
+uint64_t
+ShaderProgram::GetSampledUploadSerial(void) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// The latest upload serial among the textures bound to the samplers of the program
+    uint64_t serial = 0;
+    for(uint32_t i = 0; i < mShaderResourceInterface.GetLiveUniforms(); ++i) {
+        if(mShaderResourceInterface.GetUniformType(i) == GL_SAMPLER_2D || mShaderResourceInterface.GetUniformType(i) == GL_SAMPLER_CUBE) {
+            for(int32_t j = 0; j < mShaderResourceInterface.GetUniformArraySize(i); ++j) {
+                const glsl_sampler_t textureUnit = ((const glsl_sampler_t *)mShaderResourceInterface.GetUniformClientData(i))[j];
+
+                const Texture *activeTexture = ((Context *)mGlContext)->GetSampledTexture(
+                mShaderResourceInterface.GetUniformType(i) == GL_SAMPLER_2D ? GL_TEXTURE_2D : GL_TEXTURE_CUBE_MAP, textureUnit);
+
+                serial = std::max(serial, activeTexture->GetUploadSerial());
+            }
+        }
+    }
+
+    return serial;
+}
+
+void
+ShaderProgram::GetSampledTextures(vector<Texture *> &textures) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// The textures bound to the samplers of the program, a texture bound to several samplers is listed once per sampler
+    textures.clear();
+    for(uint32_t i = 0; i < mShaderResourceInterface.GetLiveUniforms(); ++i) {
+        if(mShaderResourceInterface.GetUniformType(i) == GL_SAMPLER_2D || mShaderResourceInterface.GetUniformType(i) == GL_SAMPLER_CUBE) {
+            for(int32_t j = 0; j < mShaderResourceInterface.GetUniformArraySize(i); ++j) {
+                const glsl_sampler_t textureUnit = ((const glsl_sampler_t *)mShaderResourceInterface.GetUniformClientData(i))[j];
+
+                textures.push_back(((Context *)mGlContext)->GetSampledTexture(
+                mShaderResourceInterface.GetUniformType(i) == GL_SAMPLER_2D ? GL_TEXTURE_2D : GL_TEXTURE_CUBE_MAP, textureUnit));
+            }
+        }
+    }
+}
+
 void
 ShaderProgram::ResetVulkanVertexInput(void)
 {
@@ -1054,6 +1441,8 @@ ShaderProgram::ResetVulkanVertexInput(void)
     mVkPipelineVertexInput.vertexBindingDescriptionCount = 0;
     mActiveVertexVkBuffersCount = 0;
     memset((void *)mActiveVertexVkBuffers, 0, sizeof(mActiveVertexVkBuffers));
+    memset((void *)mActiveVertexVkOffsets, 0, sizeof(mActiveVertexVkOffsets));
+    mStreamedVertexAttribs.clear();
 }
 
 void
@@ -1076,10 +1465,16 @@ ShaderProgram::BuildShaderResourceInterface(void)
     mShaderResourceInterface.CreateInterface();
     mShaderResourceInterface.SetReflection(nullptr);
     mShaderResourceInterface.AllocateUniformClientData();
-    mShaderResourceInterface.AllocateUniformBufferObjects(mVkContext);
+    mShaderResourceInterface.AllocateUniformBlockData();
 
     mShaderResourceInterface.SetActiveUniformMaxLength();
     mShaderResourceInterface.SetActiveAttributeMaxLength();
+}
+
+void
+ShaderProgram::AllocateVkResources(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
 
     AllocateVkDescriptoSet();
     mUpdateDescriptorSets = true;
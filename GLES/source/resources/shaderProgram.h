@@ -28,6 +28,8 @@
 #include "shaderResourceInterface.h"
 #include "genericVertexAttributes.h"
 
+class Texture;
+
 class ShaderProgram {
 private:
     const Context *                                     mGlContext;
@@ -36,8 +38,20 @@ private:
     VkDescriptorSetLayoutBinding *                      mVkDescSetLayoutBind;
     VkDescriptorPool                                    mVkDescPool;
     VkDescriptorSet                                     mVkDescSet;
+    /// Once the own set has been bound, updated sets are allocated from the
+    /// descriptor arena of the frame being recorded, see UpdateDescriptorSet()
+    VkDescriptorSet                                     mVkActiveDescSet;
+    const CommandBufferManager *                        mDescSetArena;
+    uint64_t                                            mDescSetFrameSerial;
+    /// The uniform ring buffer may be replaced by a larger one
+    VkBuffer                                            mDescSetUniformBuffer;
+    bool                                                mVkActiveDescSetUsed;
     VkPipelineLayout                                    mVkPipelineLayout;
     VkPipelineCache                                     mVkPipelineCache;
+    /// Pipeline cache data of the program binary, taken once so that its
+    /// reported length and returned contents agree
+    std::vector<uint8_t>                                mVkPipelineCacheData;
+    bool                                                mVkPipelineCacheDataValid;
 
     VkPipelineVertexInputStateCreateInfo                mVkPipelineVertexInput;
     VkVertexInputBindingDescription                     mVkVertexInputBinding[GLOVE_MAX_VERTEX_ATTRIBS];
@@ -45,11 +59,15 @@ private:
 
     uint32_t                                            mActiveVertexVkBuffersCount;
     VkBuffer                                            mActiveVertexVkBuffers[GLOVE_MAX_VERTEX_ATTRIBS];
+    VkDeviceSize                                        mActiveVertexVkOffsets[GLOVE_MAX_VERTEX_ATTRIBS];
+    std::vector<std::pair<uint32_t, uint32_t>>          mStreamedVertexAttribs;
+    bool                                                mConvertedVertexAttribs[GLOVE_MAX_VERTEX_ATTRIBS];
 
     bool                                                mUpdateDescriptorSets;
     bool                                                mUpdateDescriptorData;
     bool                                                mMarkForDeletion;
     bool                                                mLinked;
+    bool                                                mLinkPending;
     bool                                                mIsPrecompiled;
     bool                                                mValidated;
 
@@ -65,16 +83,25 @@ private:
     int                                                 mStagesIDs[2];
 
     ShaderCompiler *                                    mShaderCompiler;
+    TaskQueue *                                         mCompileQueue;
+    uint64_t                                            mLinkSerial;
+    ShaderCache *                                       mShaderCache;
+    string                                              mInfoLog;
     ShaderResourceInterface                             mShaderResourceInterface;
 
     void                                                DumpGloveShaderVertexInputInterface(void);
     bool                                                ValidateProgram(void);
+    bool                                                Link(void);
+    bool                                                LinkSource(void);
+    bool                                                LinkFromCache(const string &digest);
+    void                                                StoreToCache(const string &digest);
+    string                                              GetCacheDigest(void)                        const;
     void                                                ReleaseVkObjects(void);
     bool                                                AllocateVkDescriptoSet(void);
     bool                                                CreateDescriptorSetLayout(uint32_t nLiveUniformBlocks);
     bool                                                CreateDescriptorPool(uint32_t nLiveUniformBlocks);
     bool                                                CreateDescriptorSet(void);
-    void                                                UpdateSamplerDescriptors(void);
+    void                                                UpdateSamplerDescriptors(VkBuffer uniformBuffer);
 
     uint32_t                                            SerializeShadersSpirv(void *binary);
     uint32_t                                            DeserializeShadersSpirv(const void *binary);
@@ -83,8 +110,10 @@ private:
     void                                                ResetVulkanVertexInput(void);
     void                                                UpdateAttributeInterface(void);
     void                                                BuildShaderResourceInterface(void);
-    void                                                GenerateVertexAttribProperties(size_t vertCount, uint32_t firstVertex, GenericVertexAttributes *genericVertAttribs, std::map<uint32_t, uint32_t>& vboLocationBindings);
+    void                                                AllocateVkResources(void);
+    void                                                GenerateVertexAttribProperties(GenericVertexAttributes *genericVertAttribs, std::map<uint32_t, uint32_t>& vboLocationBindings);
     void                                                GenerateVertexInputProperties(GenericVertexAttributes *genericVertAttribs, const std::map<uint32_t, uint32_t>& vboLocationBindings);
+    VkFormat                                            GetVertexAttribVkFormat(const GenericVertexAttributes *genericVertAttribs, uint32_t location, bool *converted) const;
 
 public:
     ShaderProgram(const vkContext_t *vkContext = NULL);
@@ -92,13 +121,17 @@ public:
 
     bool                                                SetPipelineShaderStage(uint32_t &pipelineShaderStageCount, int *pipelineStagesIDs, VkPipelineShaderStageCreateInfo *pipelineShaderStages);
     void                                                SetPipelineVertexInputStateInfo(void);
-    void                                                PrepareVertexAttribBufferObjects(size_t vertCount, uint32_t firstVertex, GenericVertexAttributes *genericVertAttribs);
+    void                                                PrepareVertexAttribBufferObjects(GenericVertexAttributes *genericVertAttribs);
+    bool                                                UpdateVertexAttribData(uint32_t vertCount, uint32_t firstVertex, const GenericVertexAttributes *genericVertAttribs, vulkanAPI::RingBuffer *ringBuffer);
+    uint64_t                                            GetSampledUploadSerial(void) const;
+    void                                                GetSampledTextures(vector<Texture *> &textures) const;
     Shader *                                            IsShaderAttached(Shader *shader);
     void                                                AttachShader(Shader *shader);
     void                                                DetachShader(Shader *shader);
     int                                                 GetInfoLogLength(void) const;
     char *                                              GetInfoLog(void) const;
-    bool                                                LinkProgram();
+    void                                                LinkProgram(void);
+    void                                                Synchronize(void);
 
     void                                                DetachAndDeleteShaders(void);
 
@@ -127,20 +160,25 @@ public:
     VkPipelineVertexInputStateCreateInfo *              GetVkPipelineVertexInput(void)                      { FUN_ENTRY(GL_LOG_TRACE); return &mVkPipelineVertexInput; }
     VkPipelineLayout                                    GetVkPipelineLayout(void)                   const   { FUN_ENTRY(GL_LOG_TRACE); return mVkPipelineLayout; }
     int                                                 GetStagesIDs(uint32_t index)                const   { FUN_ENTRY(GL_LOG_TRACE); return mStagesIDs[index]; }
-    const VkDescriptorSet *                             GetVkDescSet(void)                          const   { FUN_ENTRY(GL_LOG_TRACE); return &mVkDescSet; }
+    const VkDescriptorSet *                             GetVkDescSet(void)                          const   { FUN_ENTRY(GL_LOG_TRACE); return &mVkActiveDescSet; }
+    const vector<uint32_t> &                            GetDynamicOffsets(void)                     const   { FUN_ENTRY(GL_LOG_TRACE); return mShaderResourceInterface.GetDynamicOffsets(); }
     uint32_t                                            GetActiveVertexVkBuffersCount(void)         const   { FUN_ENTRY(GL_LOG_TRACE); return mActiveVertexVkBuffersCount; }
     const VkBuffer *                                    GetActiveVertexVkBuffers(void)              const   { FUN_ENTRY(GL_LOG_TRACE); return mActiveVertexVkBuffers; }
+    const VkDeviceSize *                                GetActiveVertexVkOffsets(void)              const   { FUN_ENTRY(GL_LOG_TRACE); return mActiveVertexVkOffsets; }
 
     void                                                SetVkContext(const vkContext_t *vkContext)          { FUN_ENTRY(GL_LOG_TRACE); assert(!mVkContext); mVkContext = vkContext; }
     void                                                SetGlContext(const Context *context)                { FUN_ENTRY(GL_LOG_TRACE); assert(context); mGlContext = context; }
     void                                                SetShaderCompiler(ShaderCompiler* shaderCompiler)   { FUN_ENTRY(GL_LOG_TRACE); assert(shaderCompiler != NULL); mShaderCompiler = shaderCompiler; }
+    void                                                SetCompileQueue(TaskQueue *queue)                   { FUN_ENTRY(GL_LOG_TRACE); assert(queue != NULL); mCompileQueue = queue; }
+    void                                                SetShaderCache(ShaderCache *cache)                  { FUN_ENTRY(GL_LOG_TRACE); mShaderCache = cache; }
     void                                                SetStagesIDs(uint32_t index, uint32_t id)           { FUN_ENTRY(GL_LOG_TRACE); mStagesIDs[index] = id; }
 
     void                                                SetCustomAttribsLayout(const char *name, int index) { FUN_ENTRY(GL_LOG_TRACE); mShaderResourceInterface.SetCustomAttribsLayout(name, index); }
     void                                                SetUniformData(uint32_t location, size_t size, const void *ptr);
     void                                                GetUniformData(uint32_t location, size_t size, void *ptr) const;
     void                                                SetSampler(uint32_t location, int count, const int *textureUnit);
-    void                                                UpdateDescriptorSet(void);
+    bool                                                UpdateUniformBufferData(vulkanAPI::RingBuffer *ringBuffer, uniformStatistics_t *statistics);
+    bool                                                UpdateDescriptorSet(VkBuffer uniformBuffer);
     void                                                UpdateBuiltInUniformData(float minDepthRange, float maxDepthRange);
 
     uint32_t                                            GetNumberOfActiveAttributes(void) const;
@@ -161,6 +199,7 @@ public:
     bool                                                HasStages(void)                             const   { FUN_ENTRY(GL_LOG_TRACE); return mStageCount; }
     bool                                                HasStagesUpdated(int stageIDs[2])           const   { FUN_ENTRY(GL_LOG_TRACE); return (stageIDs[0] != GetStagesIDs(0) || stageIDs[1] != GetStagesIDs(1)) ? true : false; }
     bool                                                IsLinked(void)                              const   { FUN_ENTRY(GL_LOG_TRACE); return mLinked; }
+    bool                                                IsLinkCompleted(void)                       const   { FUN_ENTRY(GL_LOG_TRACE); return !mLinkPending || mCompileQueue->IsCompleted(mLinkSerial); }
     bool                                                IsPrecompiled(void)                         const   { FUN_ENTRY(GL_LOG_TRACE); return mIsPrecompiled; }
     bool                                                IsValidated(void)                           const   { FUN_ENTRY(GL_LOG_TRACE); return mValidated; }
 };
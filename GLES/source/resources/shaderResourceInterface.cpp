@@ -28,6 +28,7 @@
 #include "shaderResourceInterface.h"
 #include "utils/glUtils.h"
 #include "utils/glLogger.h"
+#include <algorithm>
 
 ShaderResourceInterface::ShaderResourceInterface()
 : mLiveAttributes(0), mLiveUniforms(0), mLiveUniformBlocks(0),
@@ -55,6 +56,10 @@ ShaderResourceInterface::CleanUp(void)
     mAttributeInterface.clear();
     mUniformInterface.clear();
     mUniformBlockInterface.clear();
+    mUniformDataInterface.clear();
+    mUniformBlockDataInterface.clear();
+    mUniformLocations.clear();
+    mDirtyUniforms.clear();
 }
 
 void
@@ -102,72 +107,209 @@ ShaderResourceInterface::AllocateUniformClientData(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    for(auto& uni : mUniformInterface) {
-        size_t clientDataSize = uni.arraySize * GlslTypeToSize(uni.glType);
-        uint8_t* clientData = new uint8_t[clientDataSize];
-        memset((void *)clientData, 0, clientDataSize);
+    mUniformDataInterface.assign(mUniformInterface.size(), uniformData());
+    mUniformLocations.clear();
 
-        mUniformDataInterface.insert(make_pair(uni.reflectionName, uniformData()));
-        map<std::string, uniformData>::iterator it = mUniformDataInterface.find(uni.reflectionName);
-        assert(it != mUniformDataInterface.end());
-        it->second.pClientData = clientData;
+    size_t clientDataSize = 0;
+    uint32_t nLocations = 0;
+    for(uint32_t i = 0; i < mUniformInterface.size(); ++i) {
+        const uniform &uni = mUniformInterface[i];
+        mUniformDataInterface[i].size = uni.arraySize * GlslTypeToSize(uni.glType);
+        clientDataSize += mUniformDataInterface[i].size;
+        nLocations = std::max(nLocations, uni.location + uni.arraySize);
     }
+
+    mUniformClientStorage.assign(clientDataSize, 0);
+
+    /// Locations are dense, every element of a uniform array has a location of its own
+    mUniformLocations.reserve(nLocations);
+    for(uint32_t location = 0; location < nLocations; ++location) {
+        mUniformLocations.emplace_back(UINT32_MAX, nullptr);
+    }
+
+    uint8_t *pClientData = mUniformClientStorage.data();
+    for(uint32_t i = 0; i < mUniformInterface.size(); ++i) {
+        const uniform &uni = mUniformInterface[i];
+        const size_t elementSize = GlslTypeToSize(uni.glType);
+
+        mUniformDataInterface[i].pClientData = pClientData;
+        for(int32_t element = 0; element < uni.arraySize; ++element) {
+            mUniformLocations[uni.location + element].index       = i;
+            mUniformLocations[uni.location + element].pClientData = pClientData + element * elementSize;
+        }
+        pClientData += mUniformDataInterface[i].size;
+    }
+
+    mDirtyUniforms.assign((mUniformInterface.size() + 63) / 64, 0);
 }
 
-bool
-ShaderResourceInterface::AllocateUniformBufferObjects(const vkContext_t *vkContext)
+void
+ShaderResourceInterface::AllocateUniformBlockData(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    for(auto &uniBlock : mUniformBlockInterface) {
+    mUniformBlockDataInterface.assign(mUniformBlockInterface.size(), uniformBlockData());
+    mDynamicUniformBlocks.clear();
+
+    size_t blockDataSize = 0;
+    for(const auto &uniBlock : mUniformBlockInterface) {
         if(!uniBlock.isOpaque) {
             assert(uniBlock.blockSize);
+            blockDataSize += uniBlock.blockSize;
+        }
+    }
 
-            mUniformBlockDataInterface.insert(make_pair(uniBlock.glslBlockName, uniformBlockData()));
-            map<std::string, uniformBlockData>::iterator it = mUniformBlockDataInterface.find(uniBlock.glslBlockName);
-            assert(it != mUniformBlockDataInterface.end());
-            it->second.pBufferObject = new UniformBufferObject(vkContext);
-            it->second.pBufferObject->BufferObject::Allocate(uniBlock.blockSize, NULL);
+    mUniformBlockStorage.assign(blockDataSize, 0);
+
+    uint8_t *pBlockData = mUniformBlockStorage.data();
+    for(uint32_t i = 0; i < mUniformBlockInterface.size(); ++i) {
+        const uniformBlock &uniBlock = mUniformBlockInterface[i];
+        if(!uniBlock.isOpaque) {
+            mUniformBlockDataInterface[i].pBlockData = pBlockData;
+            pBlockData += uniBlock.blockSize;
+
+            mDynamicUniformBlocks.push_back(i);
         }
     }
 
-    return true;
+    /// Dynamic offsets are consumed in binding order
+    std::sort(mDynamicUniformBlocks.begin(), mDynamicUniformBlocks.end(),
+              [this](uint32_t a, uint32_t b) { return mUniformBlockInterface[a].binding < mUniformBlockInterface[b].binding; });
+    mDynamicOffsets.assign(mDynamicUniformBlocks.size(), 0);
+
+    /// Point each uniform to its place in its block, samplers live in opaque blocks and have none
+    for(uint32_t i = 0; i < mUniformInterface.size(); ++i) {
+        const uniform &uni = mUniformInterface[i];
+        uint8_t *pBlock = mUniformBlockDataInterface[uni.blockIndex].pBlockData;
+
+        assert(!pBlock || uni.offset + mUniformDataInterface[i].size <= mUniformBlockInterface[uni.blockIndex].blockSize);
+        mUniformDataInterface[i].pBlockData = pBlock ? pBlock + uni.offset : nullptr;
+    }
+
+    /// Blocks are filled from the client data on the next update
+    std::fill(mDirtyUniforms.begin(), mDirtyUniforms.end(), ~(uint64_t)0);
 }
 
-UniformBufferObject *
-ShaderResourceInterface::GetUniformBufferObject(uint32_t index) const
+void
+ShaderResourceInterface::UpdateUniformBlockData(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    map<std::string, uniformBlockData>::const_iterator itBlock = mUniformBlockDataInterface.find(mUniformBlockInterface[index].glslBlockName);
-    return itBlock->second.pBufferObject;
+    for(uint32_t word = 0; word < mDirtyUniforms.size(); ++word) {
+        uint64_t dirty = mDirtyUniforms[word];
+        mDirtyUniforms[word] = 0;
+
+        while(dirty) {
+            const uint32_t index = word * 64 + __builtin_ctzll(dirty);
+            dirty &= dirty - 1;
+
+            if(index >= mUniformDataInterface.size()) {
+                break;
+            }
+
+            const uniformData &uniData = mUniformDataInterface[index];
+            if(!uniData.pBlockData) {
+                continue;
+            }
+
+            const uniform &uni = mUniformInterface[index];
+            memcpy(uniData.pBlockData, uniData.pClientData, uniData.size);
+            AddDirtyRange(&mUniformBlockDataInterface[uni.blockIndex], static_cast<uint32_t>(uni.offset), static_cast<uint32_t>(uni.offset + uniData.size));
+        }
+    }
+}
+
+void
+ShaderResourceInterface::AddDirtyRange(uniformBlockData *blockData, uint32_t begin, uint32_t end)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    blockData->blockDataDirty = true;
+
+    /// Uniforms are visited in index order, which mostly follows their block
+    /// offsets, so neighbouring ranges are merged here already
+    if(!blockData->dirtyRanges.empty()) {
+        uniformDirtyRange &last = blockData->dirtyRanges.back();
+        if(begin <= last.second && end >= last.first) {
+            last.first  = std::min(last.first,  begin);
+            last.second = std::max(last.second, end);
+            return;
+        }
+    }
+
+    blockData->dirtyRanges.push_back(uniformDirtyRange(begin, end));
+}
+
+VkDeviceSize
+ShaderResourceInterface::CoalesceDirtyRanges(uniformBlockData *blockData)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    vector<uniformDirtyRange> &ranges = blockData->dirtyRanges;
+    if(ranges.empty()) {
+        return 0;
+    }
+
+    /// Merge overlapping and adjacent ranges into the minimal set of contiguous spans
+    std::sort(ranges.begin(), ranges.end());
+
+    size_t spans = 0;
+    for(size_t i = 1; i < ranges.size(); ++i) {
+        if(ranges[i].first <= ranges[spans].second) {
+            ranges[spans].second = std::max(ranges[spans].second, ranges[i].second);
+        } else {
+            ranges[++spans] = ranges[i];
+        }
+    }
+    ranges.resize(spans + 1);
+
+    VkDeviceSize modifiedBytes = 0;
+    for(const auto &range : ranges) {
+        modifiedBytes += range.second - range.first;
+    }
+
+    return modifiedBytes;
 }
 
 bool
-ShaderResourceInterface::UpdateUniformBufferData(void)
+ShaderResourceInterface::UploadUniformBlockData(vulkanAPI::RingBuffer *ringBuffer, uniformStatistics_t *statistics)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    map<std::string, uniformData>::iterator itUni;
-    map<std::string, uniformBlockData>::iterator itBlock;
+    ringBuffer->UpdateRegion();
 
-    for(auto& uniform : mUniformInterface) {
-        itUni = mUniformDataInterface.find(uniform.reflectionName);
-        if(!itUni->second.clientDataDirty) {
+    for(uint32_t i = 0; i < mDynamicUniformBlocks.size(); ++i) {
+        const uniformBlock &uniBlock = mUniformBlockInterface[mDynamicUniformBlocks[i]];
+        uniformBlockData &blockData  = mUniformBlockDataInterface[mDynamicUniformBlocks[i]];
+
+        /// A block is appended again when it has been modified, or when the ring
+        /// buffer region that holds its previous copy is going to be reused
+        if(!blockData.blockDataDirty && blockData.ringBufferGeneration == ringBuffer->GetGeneration()) {
             continue;
         }
 
-        const uniformBlock *pBlock = &mUniformBlockInterface[uniform.blockIndex];
-        itBlock = mUniformBlockDataInterface.find(pBlock->glslBlockName);
-        size_t size = uniform.arraySize * GlslTypeToSize(uniform.glType);
+        /// Earlier copies of the block may still be read by draws in flight, so the
+        /// dirty spans cannot be patched in place. Every block is written with a
+        /// single allocation and copy, the spans only account the bytes modified.
+        statistics->modifiedBytes += CoalesceDirtyRanges(&blockData);
+        blockData.dirtyRanges.clear();
+
+        VkDeviceSize offset;
+        uint8_t *pData = ringBuffer->Allocate(uniBlock.blockSize, &offset);
+        if(!pData) {
+            return false;
+        }
 
+        memcpy(pData, blockData.pBlockData, uniBlock.blockSize);
+        ringBuffer->Flush(uniBlock.blockSize, offset);
 
-        assert(pBlock);
-        assert(uniform.offset + size <= pBlock->blockSize);
-        assert(itBlock->second.pBufferObject);
+        ++statistics->uploadedBlocks;
+        statistics->uploadedBytes     += uniBlock.blockSize;
 
-        itBlock->second.pBufferObject->UpdateData(size, uniform.offset, (void *)itUni->second.pClientData);
-        itUni->second.clientDataDirty = false;
+        blockData.blockDataDirty       = false;
+        blockData.ringBufferOffset     = static_cast<uint32_t>(offset);
+        blockData.ringBufferGeneration = ringBuffer->GetGeneration();
+        mDynamicOffsets[i]             = blockData.ringBufferOffset;
     }
 
     return true;
@@ -176,15 +318,13 @@ ShaderResourceInterface::UpdateUniformBufferData(void)
 const ShaderResourceInterface::uniform *
 ShaderResourceInterface::GetUniformAtLocation(uint32_t location) const
 {
-    FUN_ENTRY(GL_LOG_DEBUG);
+    FUN_ENTRY(GL_LOG_TRACE);
 
-    for(const auto &uniform : mUniformInterface) {
-        if(location >= (uint32_t)uniform.location && location < (uint32_t)(uniform.location + uniform.arraySize)) {
-            return &uniform;
-        }
+    if(location >= mUniformLocations.size() || mUniformLocations[location].index >= mUniformInterface.size()) {
+        return nullptr;
     }
 
-    return nullptr;
+    return &mUniformInterface[mUniformLocations[location].index];
 }
 
 int
@@ -229,22 +369,14 @@ ShaderResourceInterface::SetUniformClientData(uint32_t location, size_t size, co
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    ShaderResourceInterface::uniform *uniform = nullptr;
-    for(auto &uni: mUniformInterface) {
-        if(location >= (uint32_t)uni.location && location < (uint32_t)(uni.location + uni.arraySize)) {
-            uniform = &uni;
-            break;
-        }
-    }
-    assert(uniform);
-    assert(uniform->location <= location);
+    assert(location < mUniformLocations.size());
 
-    size_t arrayOffset = (location - uniform->location) * GlslTypeToSize(uniform->glType);
-    assert(arrayOffset + size <= uniform->arraySize * GlslTypeToSize(uniform->glType));
+    const uniformLocation &uniLocation = mUniformLocations[location];
+    const uniformData &uniData = mUniformDataInterface[uniLocation.index];
+    assert(uniLocation.pClientData + size <= uniData.pClientData + uniData.size);
 
-    map<std::string, uniformData>::iterator it = mUniformDataInterface.find(uniform->reflectionName);
-    memcpy((void *)(it->second.pClientData + arrayOffset), ptr, size);
-    it->second.clientDataDirty = true;
+    memcpy(uniLocation.pClientData, ptr, size);
+    SetUniformDirty(uniLocation.index);
 }
 
 void
@@ -252,23 +384,21 @@ ShaderResourceInterface::SetSampler(uint32_t location, int count, const int *tex
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    assert(location + count <= mUniformLocations.size());
+
+    glsl_sampler_t *pClientData = reinterpret_cast<glsl_sampler_t *>(mUniformLocations[location].pClientData);
     while(count--) {
         assert((*textureUnit >= GL_TEXTURE0 && *textureUnit < GL_TEXTURE0 + GLOVE_MAX_COMBINED_TEXTURE_IMAGE_UNITS) ||
                (*textureUnit >= 0 && *textureUnit < GLOVE_MAX_COMBINED_TEXTURE_IMAGE_UNITS));
 
-        const ShaderResourceInterface::uniform *uniformSampler = GetUniformAtLocation(location + count);
-        map<std::string, uniformData>::iterator it = mUniformDataInterface.find(uniformSampler->reflectionName);
-
-        assert(uniformSampler->location <= location);
-        size_t arrayOffset = (location - uniformSampler->location) * GlslTypeToSize(uniformSampler->glType);
-
         /// Make sure textureUnit is inside [0, GLOVE_MAX_COMBINED_TEXTURE_IMAGE_UNITS)
         if(*textureUnit >= GL_TEXTURE0 && *textureUnit < GL_TEXTURE0 + GLOVE_MAX_COMBINED_TEXTURE_IMAGE_UNITS) {
-            *((glsl_sampler_t *)(it->second.pClientData + arrayOffset)) = (glsl_sampler_t)(*textureUnit - GL_TEXTURE0);
+            *pClientData = (glsl_sampler_t)(*textureUnit - GL_TEXTURE0);
         } else {
-            *((glsl_sampler_t *)(it->second.pClientData + arrayOffset)) = (glsl_sampler_t)(*textureUnit);
+            *pClientData = (glsl_sampler_t)(*textureUnit);
         }
 
+        ++pClientData;
         ++textureUnit;
     }
 }
@@ -278,8 +408,7 @@ ShaderResourceInterface::GetUniformClientData(uint32_t index) const
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    map<std::string, uniformData>::const_iterator it = mUniformDataInterface.find(mUniformInterface[index].reflectionName);
-    return it->second.pClientData;
+    return mUniformDataInterface[index].pClientData;
 }
 
 void
@@ -287,15 +416,13 @@ ShaderResourceInterface::GetUniformClientData(uint32_t location, size_t size, vo
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    const ShaderResourceInterface::uniform *uniform = GetUniformAtLocation(location);
-    assert(uniform);
-    assert(uniform->location <= location);
+    assert(location < mUniformLocations.size());
 
-    size_t arrayOffset = (location - uniform->location) * GlslTypeToSize(uniform->glType);
-    assert(arrayOffset + size <= uniform->arraySize * GlslTypeToSize(uniform->glType));
+    const uniformLocation &uniLocation = mUniformLocations[location];
+    const uniformData &uniData = mUniformDataInterface[uniLocation.index];
+    assert(uniLocation.pClientData + size <= uniData.pClientData + uniData.size);
 
-    map<std::string, uniformData>::const_iterator it = mUniformDataInterface.find(uniform->reflectionName);
-    memcpy(ptr, (void *)(it->second.pClientData + arrayOffset), size);
+    memcpy(ptr, uniLocation.pClientData, size);
 }
 
 void
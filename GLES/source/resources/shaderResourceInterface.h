@@ -26,6 +26,15 @@
 
 #include "shaderReflection.h"
 #include "bufferObject.h"
+#include "vulkan/ringBuffer.h"
+
+typedef struct uniformStatistics_t {
+    uint32_t                        uploadedBlocks;
+    VkDeviceSize                    uploadedBytes;
+    VkDeviceSize                    modifiedBytes;
+
+    uniformStatistics_t() : uploadedBlocks(0), uploadedBytes(0), modifiedBytes(0) { FUN_ENTRY(GL_LOG_TRACE); }
+} uniformStatistics_t;
 
 class ShaderResourceInterface {
 public:
@@ -68,28 +77,34 @@ public:
     typedef vector<uniform>         uniformInterface;
 
     struct uniformData {
-        const uint8_t *             pClientData;
-        bool                        clientDataDirty;
+        uint8_t *                   pClientData;
+        uint8_t *                   pBlockData;
+        size_t                      size;
 
         uniformData()
          : pClientData(nullptr),
-           clientDataDirty(false)
+           pBlockData(nullptr),
+           size(0)
         {
             FUN_ENTRY(GL_LOG_TRACE);
         }
+    };
+    typedef struct uniformData uniformData;
+    typedef vector<uniformData>     uniformDataInterface;
+
+    struct uniformLocation {
+        uint32_t                    index;
+        uint8_t *                   pClientData;
 
-        ~uniformData()
+        uniformLocation(uint32_t idx, uint8_t *clientData)
+         : index(idx),
+           pClientData(clientData)
         {
             FUN_ENTRY(GL_LOG_TRACE);
-
-            if(pClientData) {
-                delete[] pClientData;
-                pClientData = nullptr;
-            }
         }
     };
-    typedef struct uniformData uniformData;
-    typedef map<string, uniformData> uniformDataInterface;
+    typedef struct uniformLocation  uniformLocation;
+    typedef vector<uniformLocation> uniformLocationInterface;
 
     struct uniformBlock {
         string                      glslBlockName;
@@ -111,27 +126,26 @@ public:
     typedef struct uniformBlock uniformBlock;
     typedef vector<uniformBlock>    uniformBlockInterface;
 
+    typedef std::pair<uint32_t, uint32_t> uniformDirtyRange;
+
     struct uniformBlockData {
-        UniformBufferObject *       pBufferObject;
+        uint8_t *                   pBlockData;
+        bool                        blockDataDirty;
+        vector<uniformDirtyRange>   dirtyRanges;
+        uint32_t                    ringBufferOffset;
+        uint32_t                    ringBufferGeneration;
 
         uniformBlockData()
-         : pBufferObject(nullptr)
-        {
-            FUN_ENTRY(GL_LOG_TRACE);
-        }
-
-        ~uniformBlockData()
+         : pBlockData(nullptr),
+           blockDataDirty(true),
+           ringBufferOffset(0),
+           ringBufferGeneration(0)
         {
             FUN_ENTRY(GL_LOG_TRACE);
-
-            if(pBufferObject) {
-                delete pBufferObject;
-                pBufferObject = nullptr;
-            }
         }
     };
     typedef struct uniformBlockData uniformBlockData;
-    typedef map<string, uniformBlockData> uniformBlockDataInterface;
+    typedef vector<uniformBlockData> uniformBlockDataInterface;
 
     typedef map<string, uint32_t>   attribsLayout_t;
 
@@ -154,11 +168,28 @@ private:
     uniformBlockInterface mUniformBlockInterface;
     uniformBlockDataInterface mUniformBlockDataInterface;
 
+    /// Client and block data of all uniforms, indexed through the tables above
+    vector<uint8_t> mUniformClientStorage;
+    vector<uint8_t> mUniformBlockStorage;
+
+    /// Uniforms indexed by GL location, and a bit per uniform whose client data are not copied to their block yet
+    uniformLocationInterface mUniformLocations;
+    vector<uint64_t> mDirtyUniforms;
+
+    /// Indices of the uniform buffer blocks and their dynamic offsets, in binding order
+    vector<uint32_t> mDynamicUniformBlocks;
+    vector<uint32_t> mDynamicOffsets;
+
     attribsLayout_t mCustomAttributesLayout;
 
     uint32_t OccupiedLocationsPerType(GLenum type);
     void CleanUp(void);
 
+    void AddDirtyRange(uniformBlockData *blockData, uint32_t begin, uint32_t end);
+    VkDeviceSize CoalesceDirtyRanges(uniformBlockData *blockData);
+
+    inline void SetUniformDirty(uint32_t index)                                       { FUN_ENTRY(GL_LOG_TRACE); mDirtyUniforms[index >> 6] |= (uint64_t)1 << (index & 63); }
+
 public:
     ShaderResourceInterface();
     ~ShaderResourceInterface();
@@ -171,6 +202,7 @@ public:
     inline size_t GetActiveAttribMaxLen(void)                                   const { FUN_ENTRY(GL_LOG_TRACE); return mActiveAttributeMaxLength; }
 
     inline uint32_t GetReflectionSize(void)                                     const { FUN_ENTRY(GL_LOG_TRACE); return mReflectionSize; }
+    inline const attribsLayout_t &GetCustomAttribsLayout(void)                  const { FUN_ENTRY(GL_LOG_TRACE); return mCustomAttributesLayout; }
 
     int GetAttributeLocation(const char *name) const;
     inline int GetAttributeLocation(uint32_t index)                             const { FUN_ENTRY(GL_LOG_TRACE); return mAttributeInterface[index].location; }
@@ -182,7 +214,8 @@ public:
     inline GLenum GetUniformType(uint32_t index)                                const { FUN_ENTRY(GL_LOG_TRACE); return mUniformInterface[index].glType; }
     void GetUniformClientData(uint32_t location, size_t size, void *ptr) const;
 	  const uint8_t* GetUniformClientData(uint32_t index) const;
-	  UniformBufferObject * GetUniformBufferObject(uint32_t index) const;
+    inline size_t GetUniformBlockSize(uint32_t index)                           const { FUN_ENTRY(GL_LOG_TRACE); return mUniformBlockInterface[index].blockSize; }
+    inline const vector<uint32_t> & GetDynamicOffsets(void)                     const { FUN_ENTRY(GL_LOG_TRACE); return mDynamicOffsets; }
     int GetUniformLocation(const char *name) const;
 
     inline uint32_t GetUniformBlockBinding(uint32_t index)                      const { FUN_ENTRY(GL_LOG_TRACE); return mUniformBlockInterface[index].binding; }
@@ -203,8 +236,9 @@ public:
 	  void SetSampler(uint32_t location, int count, const int *textureUnit);
 
     void AllocateUniformClientData(void);
-	  bool AllocateUniformBufferObjects(const vkContext_t *vkContext);
-	  bool UpdateUniformBufferData(void);
+    void AllocateUniformBlockData(void);
+    void UpdateUniformBlockData(void);
+    bool UploadUniformBlockData(vulkanAPI::RingBuffer *ringBuffer, uniformStatistics_t *statistics);
 
     void UpdateAttributeInterface(void);
     void CreateInterface(void);
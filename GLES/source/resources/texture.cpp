@@ -30,16 +30,17 @@
 #include "texture.h"
 #include "utils/VkToGlConverter.h"
 #include "utils/glUtils.h"
+#include "vulkan/uploadQueue.h"
 
 #define NUMBER_OF_MIP_LEVELS(w, h)                      (std::floor(std::log2(std::max((w),(h)))) + 1)
 
 // TODO:: this needs to be further discussed
 int Texture::mDefaultInternalAlignment = 1;
 
-Texture::Texture(const vkContext_t *vkContext, const VkFlags vkFlags)
+Texture::Texture(const vkContext_t *vkContext)
 : mFormat(GL_INVALID_VALUE), mTarget(GL_INVALID_VALUE), mType(GL_INVALID_VALUE), mInternalFormat(GL_INVALID_VALUE),
 mExplicitType(GL_INVALID_VALUE), mExplicitInternalFormat(GL_INVALID_VALUE),
-mMipLevelsCount(1), mLayersCount(1)
+mMipLevelsCount(1), mLayersCount(1), mUploadSerial(0), mUploadSerialQueue(nullptr)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
@@ -48,7 +49,8 @@ mMipLevelsCount(1), mLayersCount(1)
     mState     = NULL;
     mImage     = new vulkanAPI::Image(vkContext);
     mImageView = new vulkanAPI::ImageView(vkContext);
-    mMemory    = new vulkanAPI::Memory(vkContext, vkFlags);
+    mAttachmentImageView = new vulkanAPI::ImageView(vkContext);
+    mMemory    = new vulkanAPI::Memory(vkContext, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
     mSampler   = new vulkanAPI::Sampler(vkContext);
 }
 
@@ -58,6 +60,7 @@ Texture::~Texture()
 
     delete mSampler;
     delete mImageView;
+    delete mAttachmentImageView;
     delete mImage;
     delete mMemory;
 
@@ -116,6 +119,65 @@ Texture::IsCompleted(void)
     return true;
 }
 
+bool
+Texture::IsReadbackRequired(void) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // levels that only live in the image are lost with it, unless the image
+    // that replaces it has them too, see Allocate()
+    for(GLint layer = 0; layer < mLayersCount; ++layer) {
+        for(const auto &it : mState[layer]) {
+            if(it.second.resident && static_cast<GLint>(it.first) >= mMipLevelsCount) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool
+Texture::IsReadbackRequired(const Rect *rect, GLint level, GLint layer) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the rest of a level that only lives in the image is needed to update part of it
+    const auto it = mState[layer].find(level);
+    return it != mState[layer].end() && it->second.resident &&
+           (rect->x || rect->y || rect->width < it->second.width || rect->height < it->second.height);
+}
+
+size_t
+Texture::GetStateDataSize(const State_t *state) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    ImageRect rect(0, 0, state->width, state->height,
+                   GlInternalFormatTypeToNumElements(state->dataFormat, state->dataType),
+                   GlTypeToElementSize(state->dataType),
+                   Texture::GetDefaultInternalAlignment());
+    return rect.GetRectBufferSize();
+}
+
+size_t
+Texture::GetHostMemorySize(void) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // only the contents that are waiting for the texture to become complete are kept on the host
+    size_t size = 0;
+    for(GLint layer = 0; mState && layer < mLayersCount; ++layer) {
+        for(const auto &it : mState[layer]) {
+            if(it.second.data) {
+                size += GetStateDataSize(&it.second);
+            }
+        }
+    }
+
+    return size;
+}
+
 void
 Texture::ReleaseVkResources(void)
 {
@@ -123,19 +185,76 @@ Texture::ReleaseVkResources(void)
 
     mSampler->Release();
     mImageView->Release();
+    mAttachmentImageView->Release();
     mImage->Release();
     mMemory->Release();
 }
 
+bool
+Texture::IsLinearTilingPreferred(void) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the limit is read once, so that both layouts can be compared without rebuilding
+    static const uint64_t maxTexels = getenv("GLOVE_LINEAR_TEXTURE_MAX_TEXELS") ?
+                                      strtoull(getenv("GLOVE_LINEAR_TEXTURE_MAX_TEXELS"), NULL, 10) :
+                                      GLOVE_LINEAR_TEXTURE_MAX_TEXELS;
+
+    // attachments and textures with several subresources always use optimal tiling
+    const VkImageUsageFlags usage = mImage->GetImageUsage();
+    if(!(usage & VK_IMAGE_USAGE_SAMPLED_BIT)                    ||
+        (usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)   ||
+       mMipLevelsCount > 1 || mLayersCount > 1                 ||
+       static_cast<uint64_t>(GetWidth()) * GetHeight() > maxTexels) {
+        return false;
+    }
+
+    VkFormatFeatureFlags features = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+    if(usage & VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT) {
+        features |= VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT;
+    }
+
+    return VkFormatIsLinearTilingSupported(mVkContext->vkGpus[0], mImage->GetFormat(), features);
+}
+
+bool
+Texture::IsFormatFeatureSupported(const vulkanAPI::Image *image, VkFormatFeatureFlags features) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    return image->GetImageTiling() == VK_IMAGE_TILING_OPTIMAL ?
+           VkFormatIsOptimalTilingSupported(mVkContext->vkGpus[0], image->GetFormat(), features) :
+           VkFormatIsLinearTilingSupported (mVkContext->vkGpus[0], image->GetFormat(), features);
+}
+
+bool
+Texture::IsBlitSupported(const Texture *srcTexture) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    return IsFormatFeatureSupported(srcTexture->mImage, VK_FORMAT_FEATURE_BLIT_SRC_BIT) &&
+           IsFormatFeatureSupported(mImage,             VK_FORMAT_FEATURE_BLIT_DST_BIT);
+}
+
 bool
 Texture::CreateVkImage(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    // images are filled only through copies from staging buffers, so their memory does not have to be host visible
+    if(IsLinearTilingPreferred()) {
+        mImage->SetImageTiling(VK_IMAGE_TILING_LINEAR);
+        mMemory->SetFlags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    } else {
+        mImage->SetImageTiling(VK_IMAGE_TILING_OPTIMAL);
+        mMemory->SetFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
+
     mImage->SetWidth(GetWidth());
     mImage->SetHeight(GetHeight());
     mImage->SetMipLevels(mMipLevelsCount);
     mImage->SetImageLayout(VK_IMAGE_LAYOUT_UNDEFINED);
+    mImage->SetSharingMode(mVkContext->vkTransferQueueNodeIndex != mVkContext->vkGraphicsQueueNodeIndex ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE);
 
     mSampler->SetMaxLod((mParameters.GetMinFilter() == GL_NEAREST || mParameters.GetMinFilter() == GL_LINEAR) ? 0.0 : static_cast<float>(mMipLevelsCount-1));
     return mImage->Create();
@@ -146,12 +265,44 @@ Texture::AllocateVkMemory(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    mMemory->GetImageMemoryRequirements(mImage->GetImage());
+    mMemory->GetImageMemoryRequirements(mImage->GetImage(), mImage->GetImageTiling());
 
     return  mMemory->Allocate() &&
             mMemory->BindImageMemory(mImage->GetImage());
 }
 
+bool
+Texture::CreateVkImageView(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // all color textures are stored as RGBA, the channels that their base format does not
+    // have are given by the swizzles of the sampled view, so that blits may write anything there
+    VkComponentMapping mapping = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A };
+    switch(GetFormat()) {
+    case GL_ALPHA:           mapping = { VK_COMPONENT_SWIZZLE_ZERO, VK_COMPONENT_SWIZZLE_ZERO, VK_COMPONENT_SWIZZLE_ZERO, VK_COMPONENT_SWIZZLE_A   }; break;
+    case GL_LUMINANCE:       mapping = { VK_COMPONENT_SWIZZLE_R,    VK_COMPONENT_SWIZZLE_R,    VK_COMPONENT_SWIZZLE_R,    VK_COMPONENT_SWIZZLE_ONE }; break;
+    case GL_LUMINANCE_ALPHA: mapping = { VK_COMPONENT_SWIZZLE_R,    VK_COMPONENT_SWIZZLE_R,    VK_COMPONENT_SWIZZLE_R,    VK_COMPONENT_SWIZZLE_A   }; break;
+    case GL_RGB:             mapping = { VK_COMPONENT_SWIZZLE_R,    VK_COMPONENT_SWIZZLE_G,    VK_COMPONENT_SWIZZLE_B,    VK_COMPONENT_SWIZZLE_ONE }; break;
+    default: break;
+    }
+
+    mImageView->SetComponentMapping(mapping);
+    if(!mImageView->Create(mImage)) {
+        return false;
+    }
+
+    // framebuffer attachments must not be swizzled
+    const bool swizzled = mapping.r != VK_COMPONENT_SWIZZLE_R || mapping.g != VK_COMPONENT_SWIZZLE_G ||
+                          mapping.b != VK_COMPONENT_SWIZZLE_B || mapping.a != VK_COMPONENT_SWIZZLE_A;
+    if(swizzled && (mImage->GetImageUsage() & VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT) && !mAttachmentImageView->Create(mImage)) {
+        mImageView->Release();
+        return false;
+    }
+
+    return true;
+}
+
 bool
 Texture::CreateVkTexture(void)
 {
@@ -192,13 +343,49 @@ Texture::Allocate(void)
     mExplicitInternalFormat = VkFormatToGlInternalformat(mImage->GetFormat());
     mExplicitType           = GlInternalFormatToGlType(mExplicitInternalFormat);
 
+    // levels that only live in the previous image are copied over to the new one on the
+    // device, the ones that the new image does not have are read back and kept on the host
+    bool copyResidentLevels = false;
+    for(GLint layer = 0; layer < mLayersCount; ++layer) {
+        for(auto &it : mState[layer]) {
+            if(!it.second.resident) {
+                continue;
+            }
+
+            if(static_cast<GLint>(it.first) < mMipLevelsCount) {
+                copyResidentLevels = true;
+            } else {
+                ReadbackState(it.first, layer);
+            }
+        }
+    }
+
+    // the copies are recorded into the draw command buffer, which begins before the previous
+    // image is retired, so that the image stays alive until the copies have completed
+    vulkanAPI::Image *previousImage = nullptr;
+    if(copyResidentLevels) {
+        mVkContext->mCommandBufferManager->BeginVkDrawCommandBuffer();
+
+        previousImage = mImage;
+        mImage        = new vulkanAPI::Image(mVkContext);
+        mImage->SetFormat(previousImage->GetFormat());
+        mImage->SetImageUsage(previousImage->GetImageUsage());
+        mImage->SetImageTarget(previousImage->GetImageTarget());
+    }
+
     if(!CreateVkTexture()) {
+        // the contents that only lived in the previous image are lost
+        for(GLint layer = 0; layer < mLayersCount; ++layer) {
+            for(auto &it : mState[layer]) {
+                it.second.resident = false;
+            }
+        }
+        delete previousImage;
         return false;
     }
 
     // NOTE:: there is an implicit convertion of all textures to GL_RGBA
     // TODO:: this should definitely NOT be the case
-    GLenum srcInternalFormat = mInternalFormat;
     GLenum dstInternalFormat = mExplicitInternalFormat;
     GLenum dstType = mExplicitType;
     for(GLint layer = 0; layer < mLayersCount; ++layer) {
@@ -206,55 +393,147 @@ Texture::Allocate(void)
             state = &mState[layer][level];
             if(state->data) {
                 ImageRect srcRect(0, 0, state->width, state->height,
-                                  GlInternalFormatTypeToNumElements(srcInternalFormat, state->type),
-                                  GlTypeToElementSize(state->type),
+                                  GlInternalFormatTypeToNumElements(state->dataFormat, state->dataType),
+                                  GlTypeToElementSize(state->dataType),
                                   Texture::GetDefaultInternalAlignment());
                 ImageRect dstRect(0, 0, state->width, state->height,
                                   GlInternalFormatTypeToNumElements(dstInternalFormat, dstType),
                                   GlTypeToElementSize(dstType),
                                   Texture::GetDefaultInternalAlignment());
-                CopyPixelsFromHost(&srcRect, &dstRect, level, layer, srcInternalFormat, (void *)state->data);
+                CopyPixelsFromHost(&srcRect, &dstRect, level, layer, state->dataFormat, (void *)state->data);
+
+                // the staging copy is all that is needed from now on
+                delete [] (uint8_t *)state->data;
+                state->data = NULL;
             }
         }
     }
 
+    if(previousImage) {
+        CopyResidentLevels(previousImage);
+        delete previousImage;
+    }
+
+    // every level of the image is now the only copy of its contents
+    for(GLint layer = 0; layer < mLayersCount; ++layer) {
+        for(GLint level = 0; level < mMipLevelsCount; ++level) {
+            mState[layer][level].resident = true;
+        }
+    }
+
     return true;
 }
 
 void
-Texture::SetState(GLsizei width, GLsizei height, GLint level, GLint layer, GLenum format, GLenum type, GLint unpackAlignment, const void *pixels)
+Texture::CopyResidentLevels(vulkanAPI::Image *srcImage)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkCommandBuffer cmdBuffer = mVkContext->mCommandBufferManager->GetActiveCommandBuffer();
+
+    srcImage->CreateImageSubresourceRange();
+    mImage->CreateImageSubresourceRange();
+
+    VkImageCopy imageCopy;
+    memset((void *)&imageCopy, 0, sizeof(imageCopy));
+    imageCopy.srcSubresource.aspectMask = mImage->GetImageSubresourceRange().aspectMask;
+    imageCopy.srcSubresource.layerCount = 1;
+    imageCopy.dstSubresource.aspectMask = mImage->GetImageSubresourceRange().aspectMask;
+    imageCopy.dstSubresource.layerCount = 1;
+    imageCopy.extent.depth              = 1;
+
+    for(GLint layer = 0; layer < mLayersCount; ++layer) {
+        for(GLint level = 0; level < mMipLevelsCount; ++level) {
+            const State_t *state = &mState[layer][level];
+            if(!state->resident) {
+                continue;
+            }
+
+            srcImage->ModifyImageSubresourceRange(level, 1, layer, 1);
+            mImage->ModifyImageSubresourceRange(level, 1, layer, 1);
+
+            // the level is left as the uploads leave the rest of the image
+            VkImageLayout imageLayout = mImage->GetImageLayout();
+            if(imageLayout == VK_IMAGE_LAYOUT_UNDEFINED || imageLayout == VK_IMAGE_LAYOUT_PREINITIALIZED) {
+                imageLayout = (mImage->GetImageUsage() & VK_IMAGE_USAGE_SAMPLED_BIT) ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+            }
+
+            srcImage->ModifyImageLayout(&cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+            mImage->ModifyImageLayout(&cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+            imageCopy.srcSubresource.mipLevel       = level;
+            imageCopy.srcSubresource.baseArrayLayer = layer;
+            imageCopy.dstSubresource.mipLevel       = level;
+            imageCopy.dstSubresource.baseArrayLayer = layer;
+            imageCopy.extent.width                  = state->width;
+            imageCopy.extent.height                 = state->height;
+            srcImage->CopyImage(&cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                            mImage->GetImage(),
+                                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                            &imageCopy);
+
+            mImage->ModifyImageLayout(&cmdBuffer, imageLayout);
+        }
+    }
+}
+
+void
+Texture::ReadbackState(GLint level, GLint layer)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    mState[layer][level].width  = width;
-    mState[layer][level].height = height;
-    mState[layer][level].format = format;
-    mState[layer][level].type   = type;
+    // the caller has waited for the rendering that may have written to the level
+    State_t *state = &mState[layer][level];
+    ImageRect rect(0, 0, state->width, state->height,
+                   GlInternalFormatTypeToNumElements(mExplicitInternalFormat, mExplicitType),
+                   GlTypeToElementSize(mExplicitType),
+                   Texture::GetDefaultInternalAlignment());
+
+    state->data       = new uint8_t[rect.GetRectBufferSize()];
+    state->dataFormat = mExplicitInternalFormat;
+    state->dataType   = mExplicitType;
+    state->resident   = false;
+
+    // the rows are read back bottom up, as for glReadPixels()
+    CopyPixelsToHost(&rect, &rect, level, layer, mExplicitInternalFormat, state->data);
+    InvertImageYAxis(static_cast<uint8_t *>(state->data), &rect);
+}
+
+void
+Texture::SetState(GLsizei width, GLsizei height, GLint level, GLint layer, GLenum format, GLenum type, GLint unpackAlignment, const void *pixels)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mState[layer][level].data) {
-        delete [] (uint8_t *)mState[layer][level].data;
-        mState[layer][level].data = NULL;
+    State_t *state = &mState[layer][level];
+    state->width      = width;
+    state->height     = height;
+    state->format     = format;
+    state->type       = type;
+    state->dataFormat = GlFormatToGlInternalFormat(format, type);
+    state->dataType   = type;
+    state->resident   = false;
+
+    if(state->data) {
+        delete [] (uint8_t *)state->data;
+        state->data = NULL;
     }
 
     if(pixels) {
         // convert the pixel buffers to the internal alignment
         // so that they can cooperate with any subsequent subimage calls
-        // even if a texture is not complete
-        GLenum srcInternalFormat = GlFormatToGlInternalFormat(format, type);
+        // until the texture is complete and they are uploaded
         ImageRect srcRect(0, 0, width, height,
-                          GlInternalFormatTypeToNumElements(srcInternalFormat, type),
+                          GlInternalFormatTypeToNumElements(state->dataFormat, type),
                           GlTypeToElementSize(type),
                           unpackAlignment);
         ImageRect dstRect(0, 0, width, height,
-                          GlInternalFormatTypeToNumElements(srcInternalFormat, type),
+                          GlInternalFormatTypeToNumElements(state->dataFormat, type),
                           GlTypeToElementSize(type),
                           Texture::GetDefaultInternalAlignment());
-        size_t size       = dstRect.GetRectBufferSize();
-        mState[layer][level].data = new uint8_t[size];
-        void *data = mState[layer][level].data;
-        ConvertPixels(srcInternalFormat, srcInternalFormat,
+        state->data = new uint8_t[dstRect.GetRectBufferSize()];
+        ConvertPixels(state->dataFormat, state->dataFormat,
                       &srcRect, pixels,
-                      &dstRect, data);
+                      &dstRect, state->data);
     }
 }
 
@@ -263,43 +542,48 @@ Texture::SetSubState(ImageRect *srcRect, ImageRect *dstRect, GLint level, GLint
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mState[layer][level].data == nullptr) {
-        ImageRect srcRect(0, 0, mState[layer][level].width, mState[layer][level].height,
-                          GlInternalFormatTypeToNumElements(GetInternalFormat(), GetType()),
-                          GlTypeToElementSize(GetType()),
-                          Texture::GetDefaultInternalAlignment());
-        size_t size        = srcRect.GetRectBufferSize();
-        mState[layer][level].data = new uint8_t[size];
+    // a level that only lives in the image is read back first, unless all of it is
+    // replaced, the caller has waited for the rendering that may have written to it
+    State_t *state = &mState[layer][level];
+    if(IsReadbackRequired(dstRect, level, layer)) {
+        ReadbackState(level, layer);
+    } else if(state->data == nullptr) {
+        state->data = new uint8_t[GetStateDataSize(state)];
     }
+    state->resident = false;
 
     if(srcData) {
-        const GLenum dstFormat = mInternalFormat;
+        // the subrectangle in the format and alignment of the pending contents
+        ImageRect levelRect(dstRect->x, dstRect->y, dstRect->width, dstRect->height,
+                            GlInternalFormatTypeToNumElements(state->dataFormat, state->dataType),
+                            GlTypeToElementSize(state->dataType),
+                            Texture::GetDefaultInternalAlignment());
 
         // create a buffer at the size of the requested subrectangle
-        const size_t dstSize = dstRect->GetRectBufferSize();
+        const size_t dstSize = levelRect.GetRectBufferSize();
         uint8_t *dstData = new uint8_t[dstSize];
 
-        // convert the source buffer to the internal format and alignment
+        // convert the source buffer to the format and alignment of the level
         // both buffers here are in the subtexture dimensions but may differ
         // in format and alignment
         ImageRect tmp_srcRect = *srcRect;
-        ImageRect tmp_dstRect = *dstRect;
+        ImageRect tmp_dstRect = levelRect;
         tmp_srcRect.x = 0; tmp_srcRect.y = 0;
         tmp_dstRect.x = 0; tmp_dstRect.y = 0;
-        ConvertPixels(srcFormat, dstFormat,
+        ConvertPixels(srcFormat, state->dataFormat,
                       &tmp_srcRect, srcData,
                       &tmp_dstRect, dstData);
 
-        // copy the converted buffer (containing the subtexture) to the target texture
+        // copy the converted buffer (containing the subtexture) to the level
         // both buffers are now in the same format and alignment
-        tmp_srcRect = *srcRect;
-        tmp_dstRect = *dstRect;
-        tmp_srcRect.mAlignment = Texture::GetDefaultInternalAlignment();
-        tmp_dstRect.width = mState[layer][level].width;
-        tmp_dstRect.height = mState[layer][level].height;
+        tmp_srcRect = levelRect;
+        tmp_dstRect = levelRect;
+        tmp_srcRect.x = 0; tmp_srcRect.y = 0;
+        tmp_dstRect.width  = state->width;
+        tmp_dstRect.height = state->height;
 
         CopyPixelsNoConvertion(&tmp_srcRect, dstData,
-                              &tmp_dstRect, mState[layer][level].data);
+                               &tmp_dstRect, state->data);
         delete[] dstData;
     }
 }
@@ -341,9 +625,12 @@ void Texture::CopyPixelsFromHost(ImageRect *srcRect, ImageRect *dstRect, GLint m
 
     const GLenum dstFormat = mExplicitInternalFormat;
 
-    // create a buffer at the size of the requested subrectangle
+    // convert straight into the staging memory of the upload queue, unless the
+    // requested subrectangle does not fit in it
     const size_t dstSize   = dstRect->GetRectBufferSize();
-    uint8_t *dstData = new uint8_t[dstSize];
+    VkDeviceSize stagingOffset = 0;
+    uint8_t *stagingData = mVkContext->mUploadQueue->AllocateStaging(dstSize, &stagingOffset);
+    uint8_t *dstData     = stagingData ? stagingData : new uint8_t[dstSize];
 
     // convert the destination buffer (both are similar dimensions) to the internal format
     ImageRect tmp_srcRect = *srcRect;
@@ -354,14 +641,18 @@ void Texture::CopyPixelsFromHost(ImageRect *srcRect, ImageRect *dstRect, GLint m
                   &tmp_srcRect, srcData,
                   &tmp_dstRect, dstData);
 
-    BufferObject *tbo = new TransferSrcBufferObject(mVkContext);
-    tbo->Allocate(dstSize, dstData);
-
     // use the global rect offsets for transfering the subpixels to Vulkan
-    SubmitCopyPixels(dstRect, tbo, miplevel, layer, dstFormat, true);
+    if(stagingData) {
+        SubmitUploadPixels(dstRect, stagingOffset, miplevel, layer);
+    } else {
+        BufferObject *tbo = new TransferSrcBufferObject(mVkContext);
+        tbo->Allocate(dstSize, dstData);
 
-    delete    tbo;
-    delete[]  dstData;
+        SubmitCopyPixels(dstRect, tbo, miplevel, layer, dstFormat, true);
+
+        delete    tbo;
+        delete[]  dstData;
+    }
 
 #if GLOVE_SAVE_TEXTURES_TO_FILE == true
     // TODO:: adjust for lod levels
@@ -384,10 +675,181 @@ void Texture::CopyPixelsFromHost(ImageRect *srcRect, ImageRect *dstRect, GLint m
  #endif
 }
 
+void Texture::SubmitUploadPixels(const Rect *rect, VkDeviceSize stagingOffset, GLint miplevel, GLint layer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    UploadQueue *uploadQueue = mVkContext->mUploadQueue;
+
+    // new images are left ready for sampling, as that is what most textures are used for
+    VkImageLayout finalImageLayout = mImage->GetImageLayout();
+    if(finalImageLayout == VK_IMAGE_LAYOUT_UNDEFINED || finalImageLayout == VK_IMAGE_LAYOUT_PREINITIALIZED) {
+        finalImageLayout = (mImage->GetImageUsage() & VK_IMAGE_USAGE_SAMPLED_BIT) ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+    }
+
+    // the whole image is transitioned once per upload batch
+    mImage->CreateImageSubresourceRange();
+    VkCommandBuffer cmdBuffer = uploadQueue->BeginImageUpload(mImage->GetImage(), mImage->GetImageSubresourceRange(),
+                                                              mImage->GetImageLayout(), finalImageLayout);
+
+    mImage->SetImageLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    mImage->CreateBufferImageCopy(rect->x, rect->y, rect->width, rect->height, miplevel, layer, 1, stagingOffset);
+    mImage->CopyBufferToImage(&cmdBuffer, uploadQueue->GetStagingBuffer());
+    mImage->SetImageLayout(finalImageLayout);
+
+    mUploadSerial      = uploadQueue->GetSerial();
+    mUploadSerialQueue = uploadQueue;
+}
+
+bool Texture::UpdatePixelsFromHost(ImageRect *srcRect, ImageRect *dstRect, GLint miplevel, GLint layer, GLenum srcFormat, const void *srcData, vulkanAPI::RingBuffer *ringBuffer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the subrectangle can only be copied in place into an image that has been
+    // created for the current dimensions and mip levels of the texture
+    const State_t *state = &mState[layer][miplevel];
+    if(mImage->GetImage() == VK_NULL_HANDLE                           ||
+       static_cast<GLint>(mImage->GetMipLevels()) != mMipLevelsCount  ||
+       miplevel >= mMipLevelsCount                                    ||
+       !state->resident                                               ||
+       dstRect->x + dstRect->width  > state->width                    ||
+       dstRect->y + dstRect->height > state->height) {
+        return false;
+    }
+
+    if(!dstRect->width || !dstRect->height) {
+        return true;
+    }
+
+    const GLenum dstFormat = mExplicitInternalFormat;
+    ImageRect stagingRect(dstRect->x, dstRect->y, dstRect->width, dstRect->height,
+                          GlInternalFormatTypeToNumElements(dstFormat, mExplicitType),
+                          GlTypeToElementSize(mExplicitType),
+                          Texture::GetDefaultInternalAlignment());
+
+    // the copy is recorded into the draw command buffer, after the draws that sampled
+    // the previous contents of the image, so the staging memory is taken from the
+    // region of the ring buffer that belongs to the frame being recorded
+    mVkContext->mCommandBufferManager->BeginVkDrawCommandBuffer();
+
+    const size_t stagingSize   = stagingRect.GetRectBufferSize();
+    VkDeviceSize stagingOffset = 0;
+    uint8_t *stagingData = ringBuffer->Allocate(stagingSize, &stagingOffset);
+    if(!stagingData) {
+        return false;
+    }
+
+    ImageRect tmp_srcRect = *srcRect;
+    ImageRect tmp_dstRect = stagingRect;
+    tmp_srcRect.x = 0; tmp_srcRect.y = 0;
+    tmp_dstRect.x = 0; tmp_dstRect.y = 0;
+    ConvertPixels(srcFormat, dstFormat,
+                  &tmp_srcRect, srcData,
+                  &tmp_dstRect, stagingData);
+    ringBuffer->Flush(stagingSize, stagingOffset);
+
+    VkCommandBuffer cmdBuffer = mVkContext->mCommandBufferManager->GetActiveCommandBuffer();
+
+    // only the updated subresource is transitioned, and it is left in the layout it was
+    // in, so that the descriptors that refer to the image remain valid
+    mImage->CreateImageSubresourceRange();
+    mImage->ModifyImageSubresourceRange(miplevel, 1, layer, 1);
+
+    VkImageLayout imageLayout = mImage->GetImageLayout();
+    if(imageLayout == VK_IMAGE_LAYOUT_UNDEFINED || imageLayout == VK_IMAGE_LAYOUT_PREINITIALIZED) {
+        imageLayout = (mImage->GetImageUsage() & VK_IMAGE_USAGE_SAMPLED_BIT) ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+    }
+
+    mImage->ModifyImageLayout(&cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    mImage->CreateBufferImageCopy(stagingRect.x, stagingRect.y, stagingRect.width, stagingRect.height, miplevel, layer, 1, stagingOffset);
+    mImage->CopyBufferToImage(&cmdBuffer, ringBuffer->GetVkBuffer());
+    mImage->ModifyImageLayout(&cmdBuffer, imageLayout);
+
+    return true;
+}
+
+bool Texture::BlitPixelsFromTexture(Texture *srcTexture, const Rect *srcRect, GLint srcMiplevel, GLint srcLayer, const Rect *dstRect, GLint miplevel, GLint layer, bool invertYAxis)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the subrectangle can only be blitted in place into an image that has been
+    // created for the current dimensions and mip levels of the texture
+    const State_t *state = &mState[layer][miplevel];
+    vulkanAPI::Image *srcImage = srcTexture->mImage;
+    if(mImage->GetImage() == VK_NULL_HANDLE                           ||
+       srcImage->GetImage() == VK_NULL_HANDLE                         ||
+       static_cast<GLint>(mImage->GetMipLevels()) != mMipLevelsCount  ||
+       miplevel >= mMipLevelsCount                                    ||
+       !state->resident                                               ||
+       dstRect->x + dstRect->width  > state->width                    ||
+       dstRect->y + dstRect->height > state->height                   ||
+       !IsBlitSupported(srcTexture)) {
+        return false;
+    }
+
+    if(!dstRect->width || !dstRect->height) {
+        return true;
+    }
+
+    // blits convert between formats and flip the rows when the offsets of the source are swapped
+    VkImageBlit imageBlit;
+    memset((void *)&imageBlit, 0, sizeof(imageBlit));
+    imageBlit.srcSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    imageBlit.srcSubresource.mipLevel       = srcMiplevel;
+    imageBlit.srcSubresource.baseArrayLayer = srcLayer;
+    imageBlit.srcSubresource.layerCount     = 1;
+    imageBlit.srcOffsets[0].x               = srcRect->x;
+    imageBlit.srcOffsets[0].y               = invertYAxis ? srcRect->y + srcRect->height : srcRect->y;
+    imageBlit.srcOffsets[1].x               = srcRect->x + srcRect->width;
+    imageBlit.srcOffsets[1].y               = invertYAxis ? srcRect->y : srcRect->y + srcRect->height;
+    imageBlit.srcOffsets[1].z               = 1;
+
+    imageBlit.dstSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    imageBlit.dstSubresource.mipLevel       = miplevel;
+    imageBlit.dstSubresource.baseArrayLayer = layer;
+    imageBlit.dstSubresource.layerCount     = 1;
+    imageBlit.dstOffsets[0].x               = dstRect->x;
+    imageBlit.dstOffsets[0].y               = dstRect->y;
+    imageBlit.dstOffsets[1].x               = dstRect->x + dstRect->width;
+    imageBlit.dstOffsets[1].y               = dstRect->y + dstRect->height;
+    imageBlit.dstOffsets[1].z               = 1;
+
+    // the blit is recorded into the draw command buffer, after the rendering to the source
+    // and the draws that sampled the previous contents of the destination
+    mVkContext->mCommandBufferManager->BeginVkDrawCommandBuffer();
+    VkCommandBuffer cmdBuffer = mVkContext->mCommandBufferManager->GetActiveCommandBuffer();
+
+    // the source is left for transfers, it is transitioned again before it is rendered
+    // to or sampled, the destination is left in the layout it was in, so that the
+    // descriptors that refer to the image remain valid
+    srcImage->CreateImageSubresourceRange();
+    srcImage->ModifyImageSubresourceRange(srcMiplevel, 1, srcLayer, 1);
+    mImage->CreateImageSubresourceRange();
+    mImage->ModifyImageSubresourceRange(miplevel, 1, layer, 1);
+
+    VkImageLayout imageLayout = mImage->GetImageLayout();
+    if(imageLayout == VK_IMAGE_LAYOUT_UNDEFINED || imageLayout == VK_IMAGE_LAYOUT_PREINITIALIZED) {
+        imageLayout = (mImage->GetImageUsage() & VK_IMAGE_USAGE_SAMPLED_BIT) ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+    }
+
+    srcImage->ModifyImageLayout(&cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    mImage->ModifyImageLayout  (&cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    srcImage->BlitImage(&cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                    mImage->GetImage(),
+                                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                    &imageBlit, VK_FILTER_NEAREST);
+    mImage->ModifyImageLayout  (&cmdBuffer, imageLayout);
+
+    return true;
+}
+
 void Texture::SubmitCopyPixels(const Rect *rect, BufferObject *tbo, GLint miplevel, GLint layer, GLenum srcFormat, bool copyToImage)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    // pending uploads to the image have to land first
+    mVkContext->mUploadQueue->Wait(GetUploadSerial());
+
     mImage->CreateBufferImageCopy(rect->x, rect->y, rect->width, rect->height, miplevel, layer, 1);
     mImage->ModifyImageSubresourceRange(miplevel, 1, layer, 1);
 
@@ -416,14 +878,17 @@ Texture::PrepareVkImageLayout(VkImageLayout newImageLayout)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    mVkContext->mCommandBufferManager->BeginVkAuxCommandBuffer();
-    VkCommandBuffer cmdBuffer = mVkContext->mCommandBufferManager->GetAuxCommandBuffer();
+    if(mImage->GetImage() == VK_NULL_HANDLE) {
+        return;
+    }
 
-    mImage->ModifyImageLayout(&cmdBuffer, newImageLayout);
+    // the barrier is recorded outside of a render pass into the draw command buffer,
+    // which the caller submits after the pending uploads of the texture
+    mVkContext->mCommandBufferManager->BeginVkDrawCommandBuffer();
+    VkCommandBuffer cmdBuffer = mVkContext->mCommandBufferManager->GetActiveCommandBuffer();
 
-    mVkContext->mCommandBufferManager->EndVkAuxCommandBuffer();
-    mVkContext->mCommandBufferManager->SubmitVkAuxCommandBuffer();
-    mVkContext->mCommandBufferManager->WaitVkAuxCommandBuffer();
+    mImage->CreateImageSubresourceRange();
+    mImage->ModifyImageLayout(&cmdBuffer, newImageLayout);
 }
 
 void
@@ -431,31 +896,45 @@ Texture::GenerateMipmaps(GLenum hintMipmapMode)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    int numElements = GlInternalFormatTypeToNumElements(GetExplicitInternalFormat(), GetExplicitType());
-    int sizeElement = GlTypeToElementSize(GetExplicitType());
-    int alignment   = Texture::GetDefaultInternalAlignment();
-    ImageRect srcRect(0, 0, GetWidth(), GetHeight(), numElements, sizeElement, alignment);
-    ImageRect dstRect(0, 0, GetWidth(), GetHeight(), numElements, sizeElement, alignment);
-
-    const size_t     baseLevel  = 0;
-    const size_t     baseSize   = dstRect.GetRectBufferSize();
-          uint8_t   *basePixels[mLayersCount];
+    // the rest of the levels are specified after the base level and replace any previous contents
+    const State_t *baseState = &mState[0][0];
+    const GLint    levels    = NUMBER_OF_MIP_LEVELS(baseState->width, baseState->height);
     for(GLint layer = 0; layer < mLayersCount; ++layer) {
-        basePixels[layer] = new uint8_t[baseSize];
-        CopyPixelsToHost(&srcRect, &dstRect, baseLevel, layer, GetExplicitInternalFormat(), basePixels[layer]);
+        for(GLint level = 1; level < levels; ++level) {
+            State_t *state = &mState[layer][level];
+            if(state->data) {
+                delete [] (uint8_t *)state->data;
+                state->data = NULL;
+            }
+            state->width      = std::max(baseState->width  >> level, 1);
+            state->height     = std::max(baseState->height >> level, 1);
+            state->format     = baseState->format;
+            state->type       = baseState->type;
+            state->dataFormat = GlFormatToGlInternalFormat(baseState->format, baseState->type);
+            state->dataType   = baseState->type;
+            state->resident   = false;
+        }
     }
 
-    // create Mipmapped Texture
-    mMipLevelsCount = NUMBER_OF_MIP_LEVELS(GetWidth(), GetHeight());
-    CreateVkTexture();
+    if(!IsCompleted()) {
+        return;
+    }
 
-    // set back base mipLevel for all layers
+    // the chain is built in place when the image has it already, otherwise the image is
+    // created again with it and the base level is copied over, or uploaded, by Allocate()
+    bool allocate = mImage->GetImage() == VK_NULL_HANDLE || static_cast<GLint>(mImage->GetMipLevels()) != mMipLevelsCount;
     for(GLint layer = 0; layer < mLayersCount; ++layer) {
-        InvertImageYAxis(static_cast<uint8_t *>(basePixels[layer]), &srcRect);
-        CopyPixelsFromHost(&srcRect, &dstRect, baseLevel, layer, GetExplicitInternalFormat(), basePixels[layer]);
-        delete[] basePixels[layer];
+        allocate |= !mState[layer][0].resident;
+    }
+
+    if(allocate && !Allocate()) {
+        return;
     }
 
+    // linear filtering of the blits is optional for formats other than the ones GL textures are stored in
+    const bool linearFilter = hintMipmapMode != GL_FASTEST && IsFormatFeatureSupported(mImage, VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+    const VkFilter filter = linearFilter ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+
     // Blit LoD Level '0' to rest layers
     VkImageBlit imageBlit;
     memset((void *)&imageBlit, 0, sizeof(imageBlit));
@@ -475,11 +954,17 @@ Texture::GenerateMipmaps(GLenum hintMipmapMode)
     imageBlit.dstOffsets[1].y               = static_cast<int32_t>(std::max(std::floor(imageBlit.srcOffsets[1].y >> 1), 1.0));
     imageBlit.dstOffsets[1].z               = 1;
 
-    mVkContext->mCommandBufferManager->BeginVkAuxCommandBuffer();
-    VkCommandBuffer activeCmdBuffer = mVkContext->mCommandBufferManager->GetAuxCommandBuffer();
+    // the blits are recorded into the draw command buffer, after the rendering to the base
+    // level and the copy or the upload of it, which the caller submits the buffer after
+    mVkContext->mCommandBufferManager->BeginVkDrawCommandBuffer();
+    VkCommandBuffer activeCmdBuffer = mVkContext->mCommandBufferManager->GetActiveCommandBuffer();
     {
-        VkFilter      filter         = hintMipmapMode == GL_FASTEST ? VK_FILTER_NEAREST : VK_FILTER_LINEAR;
-        VkImageLayout oldImageLayout = mImage->GetImageLayout();
+        mImage->CreateImageSubresourceRange();
+        VkImageLayout imageLayout = mImage->GetImageLayout();
+        if(imageLayout == VK_IMAGE_LAYOUT_UNDEFINED || imageLayout == VK_IMAGE_LAYOUT_PREINITIALIZED) {
+            imageLayout = (mImage->GetImageUsage() & VK_IMAGE_USAGE_SAMPLED_BIT) ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+        }
+
         mImage->ModifyImageSubresourceRange(0, 1, 0, mLayersCount);
         mImage->ModifyImageLayout(&activeCmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
         for(GLint mipLevel = 1; mipLevel < mMipLevelsCount; ++mipLevel) {
@@ -500,11 +985,13 @@ Texture::GenerateMipmaps(GLenum hintMipmapMode)
             imageBlit.dstOffsets[1].y = static_cast<int32_t>(std::max(std::floor(imageBlit.srcOffsets[1].y >> 1), 1.0));
         }
         mImage->ModifyImageSubresourceRange(0, mMipLevelsCount, 0, mLayersCount);
-        mImage->ModifyImageLayout(&activeCmdBuffer, oldImageLayout);
+        mImage->ModifyImageLayout(&activeCmdBuffer, imageLayout);
     }
-    mVkContext->mCommandBufferManager->EndVkAuxCommandBuffer();
-    mVkContext->mCommandBufferManager->SubmitVkAuxCommandBuffer();
-    mVkContext->mCommandBufferManager->WaitVkAuxCommandBuffer();
 
-    // TODO: Fill the 'State_t' with the rest mipLevels
+    // the generated levels only live in the image
+    for(GLint layer = 0; layer < mLayersCount; ++layer) {
+        for(GLint level = 0; level < mMipLevelsCount; ++level) {
+            mState[layer][level].resident = true;
+        }
+    }
 }
@@ -30,6 +30,7 @@
 #include "vulkan/sampler.h"
 #include "vulkan/imageView.h"
 #include "vulkan/cbManager.h"
+#include "vulkan/ringBuffer.h"
 #include "utils/GlToVkConverter.h"
 
 class Texture {
@@ -39,10 +40,15 @@ class Texture {
         GLint                      height;
         GLenum                     format;
         GLenum                     type;
+        /// Contents that have not been uploaded to the image yet, freed once they have been
         void                       *data;
+        GLenum                     dataFormat;
+        GLenum                     dataType;
+        /// The contents of the level are kept only in the image
+        bool                       resident;
 
         State() : width(-1), height(-1), format(GL_INVALID_VALUE), type(GL_INVALID_VALUE),
-            data(NULL) { FUN_ENTRY(GL_LOG_TRACE); }
+            data(NULL), dataFormat(GL_INVALID_VALUE), dataType(GL_INVALID_VALUE), resident(false) { FUN_ENTRY(GL_LOG_TRACE); }
         ~State() { FUN_ENTRY(GL_LOG_TRACE); if(data) {delete [] (uint8_t *)data; data = NULL;}}
     };
     typedef State                  State_t;
@@ -71,15 +77,27 @@ private:
     vulkanAPI::Memory*          mMemory;
     vulkanAPI::Sampler*         mSampler;
     vulkanAPI::ImageView*       mImageView;
+    /// Views that are sampled give the channels of the base format, whatever the image
+    /// holds in the others. Attachments need views without swizzles, see CreateVkImageView().
+    vulkanAPI::ImageView*       mAttachmentImageView;
+
+    /// Serials are local to the upload queue of the context that recorded the upload.
+    /// Uploads of other contexts must be synchronized by the application.
+    uint64_t                    mUploadSerial;
+    const UploadQueue*          mUploadSerialQueue;
 
     static int                  mDefaultInternalAlignment;
 
     bool                        AllocateVkMemory(void);
+    bool                        IsLinearTilingPreferred(void)           const;
+    bool                        IsFormatFeatureSupported(const vulkanAPI::Image *image, VkFormatFeatureFlags features) const;
     void                        ReleaseVkResources(void);
+    void                        ReadbackState(GLint level, GLint layer);
+    void                        CopyResidentLevels(vulkanAPI::Image *srcImage);
+    size_t                      GetStateDataSize(const State_t *state)  const;
 
 public:
-    Texture(const vkContext_t  *vkContext = nullptr,
-            const VkFlags       vkFlags   = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    Texture(const vkContext_t  *vkContext = nullptr);
     ~Texture();
 
 // Generate Functions
@@ -96,11 +114,12 @@ public:
     static int              GetDefaultInternalAlignment()                       { FUN_ENTRY(GL_LOG_TRACE); return mDefaultInternalAlignment; }
     inline float            GetInvertedYOrigin(const Rect* rect)                { FUN_ENTRY(GL_LOG_TRACE); return mDims.height - rect->height - rect->y; }
     void                    PrepareVkImageLayout(VkImageLayout newImageLayout);
+    bool                    IsBlitSupported(const Texture *srcTexture)  const;
 
 // Create Functions
     bool                    CreateVkTexture(void);
     bool                    CreateVkImage(void);
-    bool                    CreateVkImageView(void)                             { FUN_ENTRY(GL_LOG_TRACE); return mImageView->Create(mImage); }
+    bool                    CreateVkImageView(void);
     bool                    CreateVkSampler(void)                               { FUN_ENTRY(GL_LOG_TRACE); return mSampler->Create(); }
     void                    CreateVkImageSubResourceRange(void)                 { FUN_ENTRY(GL_LOG_TRACE); return mImage->CreateImageSubresourceRange(); }
 
@@ -108,6 +127,9 @@ public:
      void                   CopyPixelsFromHost (ImageRect *srcRect, ImageRect *dstRect, GLint miplevel, GLint layer, GLenum srcFormat, const void *srcData);
      void                   CopyPixelsToHost   (ImageRect *srcRect, ImageRect *dstRect, GLint miplevel, GLint layer, GLenum dstFormat, void *dstData);
      void                   SubmitCopyPixels   (const Rect *rect, BufferObject *tbo, GLint miplevel, GLint layer, GLenum dstFormat, bool copyToImage);
+     void                   SubmitUploadPixels (const Rect *rect, VkDeviceSize stagingOffset, GLint miplevel, GLint layer);
+     bool                   UpdatePixelsFromHost(ImageRect *srcRect, ImageRect *dstRect, GLint miplevel, GLint layer, GLenum srcFormat, const void *srcData, vulkanAPI::RingBuffer *ringBuffer);
+     bool                   BlitPixelsFromTexture(Texture *srcTexture, const Rect *srcRect, GLint srcMiplevel, GLint srcLayer, const Rect *dstRect, GLint miplevel, GLint layer, bool invertYAxis);
 
 // Get Functions
     inline GLenum           GetWrapS(void)                              const   { FUN_ENTRY(GL_LOG_TRACE); return mParameters.GetWrapS(); }
@@ -124,6 +146,9 @@ public:
     inline GLenum           GetExplicitInternalFormat(void)             const   { FUN_ENTRY(GL_LOG_TRACE); return mExplicitInternalFormat; }
     inline GLint            GetLayersCount(void)                        const   { FUN_ENTRY(GL_LOG_TRACE); return mLayersCount; }
     inline GLint            GetMipLevelsCount(void)                     const   { FUN_ENTRY(GL_LOG_TRACE); return mMipLevelsCount; }
+    inline uint64_t         GetUploadSerial(void)                       const   { FUN_ENTRY(GL_LOG_TRACE); return mUploadSerialQueue == mVkContext->mUploadQueue ? mUploadSerial : 0; }
+           size_t           GetHostMemorySize(void)                     const;
+    inline VkDeviceSize     GetDeviceMemorySize(void)                   const   { FUN_ENTRY(GL_LOG_TRACE); return mMemory->GetSize(); }
 
     inline vulkanAPI::Image* GetImage(void)                                     { FUN_ENTRY(GL_LOG_TRACE); return mImage; }
 
@@ -131,12 +156,15 @@ public:
     inline VkFormat         GetVkFormat(void)                           const   { FUN_ENTRY(GL_LOG_TRACE); return mImage->GetFormat(); }
     inline VkImageLayout    GetVkImageLayout(void)                      const   { FUN_ENTRY(GL_LOG_TRACE); return mImage->GetImageLayout(); }
     inline VkImageView      GetVkImageView(void)                        const   { FUN_ENTRY(GL_LOG_TRACE); return mImageView->GetImageView(); }
+    inline VkImageView      GetVkAttachmentImageView(void)              const   { FUN_ENTRY(GL_LOG_TRACE); return mAttachmentImageView->GetImageView() != VK_NULL_HANDLE ?
+                                                                                                       mAttachmentImageView->GetImageView() : mImageView->GetImageView(); }
 
 // Set Functions
     inline void             SetVkContext(const vkContext_t *vkContext)          { FUN_ENTRY(GL_LOG_TRACE); mVkContext = vkContext;
                                                                                                        mMemory->SetContext(vkContext);
                                                                                                        mSampler->SetContext(vkContext);
                                                                                                        mImageView->SetContext(vkContext);
+                                                                                                       mAttachmentImageView->SetContext(vkContext);
                                                                                                        mImage->SetContext(vkContext); }
     inline void             SetWrapS(GLenum mode)                               { FUN_ENTRY(GL_LOG_TRACE); if(mParameters.UpdateWrapS(mode)) { \
                                                                                                        mSampler->SetAddressModeU(GlTexAddressToVkTexAddress(mode));}}
@@ -163,7 +191,6 @@ public:
     inline void             SetVkImage(VkImage image)                           { FUN_ENTRY(GL_LOG_TRACE); mImage->SetImage(image);        }
     inline void             SetVkImageUsage(VkImageUsageFlagBits usage)         { FUN_ENTRY(GL_LOG_TRACE); mImage->SetImageUsage(usage);   }
     inline void             SetVkImageLayout(VkImageLayout layout)              { FUN_ENTRY(GL_LOG_TRACE); mImage->SetImageLayout(layout); }
-    inline void             SetVkImageTiling(VkImageTiling tiling)              { FUN_ENTRY(GL_LOG_TRACE); mImage->SetImageTiling(tiling); }
     inline void             SetVkImageTarget(vulkanAPI::Image::VkImageTarget
                                                                      target)    { FUN_ENTRY(GL_LOG_TRACE); mImage->SetImageTarget(target); }
 
@@ -176,6 +203,8 @@ public:
                                                                                                                mFormat != GL_LUMINANCE_ALPHA &&
                                                                                                                mFormat != GL_BGRA8_EXT); }
            bool             IsCompleted(void);
+           bool             IsReadbackRequired(void)                    const;
+           bool             IsReadbackRequired(const Rect *rect, GLint level, GLint layer) const;
 
 };
 
@@ -379,20 +379,20 @@ GlAttribPointerToVkFormat(size_t nElements, GLenum type)
 
     case GL_BYTE:
         switch(nElements) {
-        case 1:                             return VK_FORMAT_R8_SNORM;
-        case 2:                             return VK_FORMAT_R8G8_SNORM;
-        case 3:                             return VK_FORMAT_R8G8B8_SNORM;
-        case 4:                             return VK_FORMAT_R8G8B8A8_SNORM;
+        case 1:                             return VK_FORMAT_R8_SINT;
+        case 2:                             return VK_FORMAT_R8G8_SINT;
+        case 3:                             return VK_FORMAT_R8G8B8_SINT;
+        case 4:                             return VK_FORMAT_R8G8B8A8_SINT;
         default: { NOT_REACHED();           return VK_FORMAT_UNDEFINED; }
         }
     break;
 
     case GL_UNSIGNED_BYTE:
         switch(nElements) {
-        case 1:                             return VK_FORMAT_R8_UNORM;
-        case 2:                             return VK_FORMAT_R8G8_UNORM;
-        case 3:                             return VK_FORMAT_R8G8B8_UNORM;
-        case 4:                             return VK_FORMAT_R8G8B8A8_UNORM;
+        case 1:                             return VK_FORMAT_R8_UINT;
+        case 2:                             return VK_FORMAT_R8G8_UINT;
+        case 3:                             return VK_FORMAT_R8G8B8_UINT;
+        case 4:                             return VK_FORMAT_R8G8B8A8_UINT;
         default: { NOT_REACHED();           return VK_FORMAT_UNDEFINED; }
         }
     break;
@@ -29,6 +29,7 @@
 #include <fstream>
 #include <iostream>
 #include <vector>
+#include <mutex>
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
@@ -86,8 +87,19 @@ using namespace std;
 #define GLOVE_MAX_CUBE_MAP_TEXTURE_SIZE                 4096
 #define GLOVE_MAX_RENDERBUFFER_SIZE                     4096
 
-#define GLOVE_NO_BUFFER_TO_WAIT                         0x7FFFFFFF
-#define GLOVE_NUM_VK_COMMAND_BUFFERS                    2
+#define GLOVE_NUM_FRAMES_IN_FLIGHT                      3     // 2 to 4
+#define GLOVE_FRAME_DESCRIPTOR_SETS                     256   // per frame
+#define GLOVE_FRAME_UNIFORM_BUFFER_DESCRIPTORS          512   // per frame
+#define GLOVE_FRAME_SAMPLER_DESCRIPTORS                 1024  // per frame
+#define GLOVE_MAX_CACHED_PIPELINES                      256
+#define GLOVE_MEMORY_BLOCK_SIZE                         (16 * 1024 * 1024)
+/// Ring buffers are created on first use and grow for data larger than a region. Their initial
+/// sizes can be overridden by environment variables of the same names.
+#define GLOVE_UNIFORM_RING_BUFFER_SIZE                  (1024 * 1024) // per frame
+#define GLOVE_VERTEX_RING_BUFFER_SIZE                   (16 * 1024 * 1024) // per frame
+#define GLOVE_TEXTURE_RING_BUFFER_SIZE                  (4 * 1024 * 1024) // per frame
+#define GLOVE_NUM_UPLOAD_BATCHES                        2
+#define GLOVE_UPLOAD_STAGING_BUFFER_SIZE                (16 * 1024 * 1024) // per upload batch
 
 #define GLOVE_NUM_SHADER_BINARY_FORMATS                 0
 #define GLOVE_NUM_PROGRAM_BINARY_FORMATS                1
@@ -112,8 +124,43 @@ using namespace std;
 #define GLOVE_DUMP_ORIGINAL_SHADER_SOURCE               false
 #define GLOVE_DUMP_PROCESSED_SHADER_SOURCE              false
 
+#define GLOVE_DUMP_FRAME_STATISTICS                     false
+#define GLOVE_DUMP_SHADER_COMPILE_TIMES                 false
+#define GLOVE_DUMP_MEMORY_STATISTICS                    false
+
 #define GLOVE_VK_VALIDATION_LAYERS                      false
 
+/// Shaders are compiled and programs are linked on a worker thread. GL calls that
+/// need the results wait for them, GL_COMPLETION_STATUS_KHR polls them.
+#define GLOVE_BACKGROUND_SHADER_COMPILATION             true
+
+/// Texture uploads are executed on a transfer only queue family, if the device exposes one
+#define GLOVE_USE_DEDICATED_TRANSFER_QUEUE              true
+
+/// Textures are stored with optimal tiling in device local memory. Sampled textures with a single level
+/// of at most GLOVE_LINEAR_TEXTURE_MAX_TEXELS texels are stored with linear tiling in host visible memory
+/// instead, which pays off only where device memory is scarce or the tiling of small images is costly.
+/// The limit can be overridden by the GLOVE_LINEAR_TEXTURE_MAX_TEXELS environment variable.
+#define GLOVE_LINEAR_TEXTURE_MAX_TEXELS                 0
+
+/// The pipeline cache is stored in the directory set by the GLOVE_PIPELINE_CACHE_DIR environment
+/// variable, or in the GLOVE_PIPELINE_CACHE_DIRECTORY subdirectory of $XDG_CACHE_HOME (or $HOME/.cache)
+#define GLOVE_PERSISTENT_PIPELINE_CACHE                 true
+#define GLOVE_PIPELINE_CACHE_DIRECTORY                  "glove"
+#define GLOVE_PIPELINE_CACHE_FILENAME                   "glove_pipeline_cache.bin"
+
+/// Compiled shaders and linked programs are cached by a digest of their sources. The persistent
+/// entries are stored in the directory set by the GLOVE_SHADER_CACHE_DIR environment variable, or in
+/// the GLOVE_SHADER_CACHE_DIRECTORY subdirectory of $XDG_CACHE_HOME (or $HOME/.cache) if it is not set.
+/// GLOVE_SHADER_CACHE_VERSION must be bumped whenever the shader converter or glslang change the
+/// generated SPIR-V.
+#define GLOVE_SHADER_CACHE                              true
+#define GLOVE_PERSISTENT_SHADER_CACHE                   true
+#define GLOVE_SHADER_CACHE_VERSION                      2
+#define GLOVE_SHADER_CACHE_DIRECTORY                    "glove/shaders"
+#define GLOVE_SHADER_CACHE_MEMORY_SIZE                  (8 * 1024 * 1024)
+#define GLOVE_SHADER_CACHE_DISK_SIZE                    (64 * 1024 * 1024)
+
 #define GLOVE_FENCE_WAIT_TIMEOUT                        UINT64_MAX
 #define GLOVE_INVALID_OFFSET                            UINT32_MAX
 
@@ -129,23 +176,46 @@ using namespace std;
 // TODO : remove
 class Context;
 class CommandBufferManager;
+class MemoryAllocator;
+class UploadQueue;
+class RetirementQueue;
 
 typedef struct vkContext_t {
     vkContext_t() {
         vkInstance            = VK_NULL_HANDLE;
         vkQueue               = VK_NULL_HANDLE;
+        vkTransferQueue       = VK_NULL_HANDLE;
         vkDevice              = VK_NULL_HANDLE;
-        mCommandBufferManager = nullptr;
+        vkPipelineCache       = VK_NULL_HANDLE;
+        mMemoryAllocator      = nullptr;
+        mRetirementQueue      = nullptr;
     }
 
     VkInstance                                          vkInstance;
     vector<VkPhysicalDevice>                            vkGpus;
     VkQueue                                             vkQueue;
     uint32_t                                            vkGraphicsQueueNodeIndex;
+    VkQueue                                             vkTransferQueue;
+    uint32_t                                            vkTransferQueueNodeIndex;
     VkDevice                                            vkDevice;
     VkPhysicalDeviceMemoryProperties                    vkDeviceMemoryProperties;
     vkSyncItems_t                                       *vkSyncItems;
-    CommandBufferManager                                *mCommandBufferManager;
+    VkPipelineCache                                     vkPipelineCache;
+    MemoryAllocator                                     *mMemoryAllocator;
+    RetirementQueue                                     *mRetirementQueue;
+
+    /// vkQueue and vkTransferQueue are used by the contexts of all threads
+    mutable std::mutex                                  mQueueMutex;
+
+    /// Caches of precompiled programs that have been released. Merging requires exclusive access
+    /// to vkPipelineCache, so they are merged into it only when it is stored at termination.
+    mutable vector<VkPipelineCache>                     vkReleasedPipelineCaches;
+    mutable std::mutex                                  mReleasedPipelineCachesMutex;
+
+    /// Commands are recorded and uploads are batched by the context that is
+    /// current on the calling thread, see SetCurrentContext()
+    static thread_local CommandBufferManager            *mCommandBufferManager;
+    static thread_local UploadQueue                     *mUploadQueue;
 } vkContext_t;
 
 template<typename T>
@@ -0,0 +1,660 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       pixelKernels.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Row Kernels for Pixel Convertions in GLOVE
+ *
+ *  @scope
+ *
+ *  A row kernel converts a whole row of pixels between two formats. The
+ *  conversions that are hit on every texture upload and glReadPixels call
+ *  have vectorized kernels for SSE2, SSSE3 and AVX2 on x86 and for NEON on
+ *  ARM. The instruction set is detected once at runtime and the best kernel
+ *  available is returned for each conversion. The pixels that do not fill a
+ *  whole vector, as well as CPUs without any of the above, are handled by
+ *  the scalar kernels, which produce bit-exact the same results.
+ *
+ */
+
+#include "pixelKernels.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#   define GLOVE_PIXEL_KERNELS_X86
+#   include <immintrin.h>
+#   define TARGET_SSE2                                  __attribute__((target("sse2")))
+#   define TARGET_SSSE3                                 __attribute__((target("ssse3")))
+#   define TARGET_AVX2                                  __attribute__((target("avx2")))
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define GLOVE_PIXEL_KERNELS_NEON
+#   include <arm_neon.h>
+#endif
+
+// scalar kernels
+static const pixelRowKernel_t ScalarSwapRB8888       = &ConvertPixelRow<&Color::FromBGRA,           &Color::ConvertToRGBA, 4, 4>;
+static const pixelRowKernel_t ScalarRGBToRGBA        = &ConvertPixelRow<&Color::FromRGB,            &Color::ConvertToRGBA, 3, 4>;
+static const pixelRowKernel_t ScalarRGBAToRGB        = &ConvertPixelRow<&Color::FromRGBA,           &Color::ConvertToRGB,  4, 3>;
+static const pixelRowKernel_t ScalarLuminanceToRGBA  = &ConvertPixelRow<&Color::FromLuminance,      &Color::ConvertToRGBA, 1, 4>;
+static const pixelRowKernel_t ScalarLumAlphaToRGBA   = &ConvertPixelRow<&Color::FromLuminanceAlpha, &Color::ConvertToRGBA, 2, 4>;
+static const pixelRowKernel_t ScalarAlphaToRGBA      = &ConvertPixelRow<&Color::FromAlpha,          &Color::ConvertToRGBA, 1, 4>;
+static const pixelRowKernel_t Scalar4444ToRGBA       = &ConvertPixelRow<&Color::From4444,           &Color::ConvertToRGBA, 2, 4>;
+static const pixelRowKernel_t Scalar5551ToRGBA       = &ConvertPixelRow<&Color::From5551,           &Color::ConvertToRGBA, 2, 4>;
+static const pixelRowKernel_t Scalar565ToRGBA        = &ConvertPixelRow<&Color::From565,            &Color::ConvertToRGBA, 2, 4>;
+
+#ifdef GLOVE_PIXEL_KERNELS_X86
+
+// SSE2 kernels
+TARGET_SSE2 static void
+SSE2SwapRB8888(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const __m128i ga = _mm_set1_epi32(0xFF00FF00);
+
+    uint32_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        const __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 4 * i));
+        const __m128i rb = _mm_andnot_si128(ga, v);
+        const __m128i br = _mm_or_si128(_mm_srli_epi32(rb, 16), _mm_slli_epi32(rb, 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 4 * i), _mm_or_si128(_mm_and_si128(v, ga), br));
+    }
+    ScalarSwapRB8888(src + 4 * i, dst + 4 * i, count - i);
+}
+
+TARGET_SSE2 static void
+SSE2LuminanceToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const __m128i ff = _mm_set1_epi8(static_cast<char>(0xFF));
+
+    uint32_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        const __m128i l    = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i llLo = _mm_unpacklo_epi8(l, l);
+        const __m128i llHi = _mm_unpackhi_epi8(l, l);
+        const __m128i lfLo = _mm_unpacklo_epi8(l, ff);
+        const __m128i lfHi = _mm_unpackhi_epi8(l, ff);
+        __m128i *out = reinterpret_cast<__m128i *>(dst + 4 * i);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(llLo, lfLo));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(llLo, lfLo));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(llHi, lfHi));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(llHi, lfHi));
+    }
+    ScalarLuminanceToRGBA(src + i, dst + 4 * i, count - i);
+}
+
+TARGET_SSE2 static void
+SSE2LumAlphaToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const __m128i lMask = _mm_set1_epi16(0x00FF);
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const __m128i la = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+        const __m128i l  = _mm_and_si128(la, lMask);
+        const __m128i ll = _mm_or_si128(l, _mm_slli_epi16(l, 8));
+        __m128i *out = reinterpret_cast<__m128i *>(dst + 4 * i);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(ll, la));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(ll, la));
+    }
+    ScalarLumAlphaToRGBA(src + 2 * i, dst + 4 * i, count - i);
+}
+
+TARGET_SSE2 static void
+SSE2AlphaToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    uint32_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        const __m128i a    = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i zaLo = _mm_unpacklo_epi8(zero, a);
+        const __m128i zaHi = _mm_unpackhi_epi8(zero, a);
+        __m128i *out = reinterpret_cast<__m128i *>(dst + 4 * i);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(zero, zaLo));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(zero, zaLo));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(zero, zaHi));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(zero, zaHi));
+    }
+    ScalarAlphaToRGBA(src + i, dst + 4 * i, count - i);
+}
+
+// interleaves 8 pixels held as 16-bit r, g, b and a lanes into RGBA8888
+TARGET_SSE2 static void
+SSE2StoreRGBA16(uint8_t *dst, __m128i r, __m128i g, __m128i b, __m128i a)
+{
+    const __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+    const __m128i ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+    __m128i *out = reinterpret_cast<__m128i *>(dst);
+    _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(rg, ba));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(rg, ba));
+}
+
+TARGET_SSE2 static void
+SSE24444ToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const __m128i nibble = _mm_set1_epi16(0x000F);
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+        __m128i r = _mm_srli_epi16(v, 12);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(v, 8), nibble);
+        __m128i b = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+        __m128i a = _mm_and_si128(v, nibble);
+        r = _mm_or_si128(r, _mm_slli_epi16(r, 4));
+        g = _mm_or_si128(g, _mm_slli_epi16(g, 4));
+        b = _mm_or_si128(b, _mm_slli_epi16(b, 4));
+        a = _mm_or_si128(a, _mm_slli_epi16(a, 4));
+        SSE2StoreRGBA16(dst + 4 * i, r, g, b, a);
+    }
+    Scalar4444ToRGBA(src + 2 * i, dst + 4 * i, count - i);
+}
+
+TARGET_SSE2 static void
+SSE25551ToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const __m128i top5 = _mm_set1_epi16(0x00F8);
+    const __m128i one  = _mm_set1_epi16(0x0001);
+    const __m128i ff   = _mm_set1_epi16(0x00FF);
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+        __m128i r = _mm_and_si128(_mm_srli_epi16(v, 8), top5);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(v, 3), top5);
+        __m128i b = _mm_and_si128(_mm_slli_epi16(v, 2), top5);
+        __m128i a = _mm_mullo_epi16(_mm_and_si128(v, one), ff);
+        r = _mm_or_si128(r, _mm_srli_epi16(r, 5));
+        g = _mm_or_si128(g, _mm_srli_epi16(g, 5));
+        b = _mm_or_si128(b, _mm_srli_epi16(b, 5));
+        SSE2StoreRGBA16(dst + 4 * i, r, g, b, a);
+    }
+    Scalar5551ToRGBA(src + 2 * i, dst + 4 * i, count - i);
+}
+
+TARGET_SSE2 static void
+SSE2565ToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const __m128i top5 = _mm_set1_epi16(0x00F8);
+    const __m128i top6 = _mm_set1_epi16(0x00FC);
+    const __m128i ff   = _mm_set1_epi16(0x00FF);
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+        __m128i r = _mm_and_si128(_mm_srli_epi16(v, 8), top5);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(v, 3), top6);
+        __m128i b = _mm_and_si128(_mm_slli_epi16(v, 3), top5);
+        r = _mm_or_si128(r, _mm_srli_epi16(r, 5));
+        g = _mm_or_si128(g, _mm_srli_epi16(g, 6));
+        b = _mm_or_si128(b, _mm_srli_epi16(b, 5));
+        SSE2StoreRGBA16(dst + 4 * i, r, g, b, ff);
+    }
+    Scalar565ToRGBA(src + 2 * i, dst + 4 * i, count - i);
+}
+
+// SSSE3 kernels
+TARGET_SSSE3 static void
+SSSE3RGBToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha   = _mm_set1_epi32(0xFF000000);
+
+    // a 16 byte load covers 4 pixels and reads ahead into the 2 that follow
+    uint32_t i = 0;
+    for(; i + 6 <= count; i += 4) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 3 * i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 4 * i), _mm_or_si128(_mm_shuffle_epi8(v, shuffle), alpha));
+    }
+    ScalarRGBToRGBA(src + 3 * i, dst + 4 * i, count - i);
+}
+
+TARGET_SSSE3 static void
+SSSE3RGBAToRGB(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+    uint32_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        const __m128i v   = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 4 * i));
+        const __m128i rgb = _mm_shuffle_epi8(v, shuffle);
+        uint8_t *out = dst + 3 * i;
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(out), rgb);
+        const int32_t last = _mm_cvtsi128_si32(_mm_srli_si128(rgb, 8));
+        memcpy(out + 8, &last, sizeof(last));
+    }
+    ScalarRGBAToRGB(src + 4 * i, dst + 3 * i, count - i);
+}
+
+// AVX2 kernels
+TARGET_AVX2 static void
+AVX2SwapRB8888(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                             2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 4 * i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 4 * i), _mm256_shuffle_epi8(v, shuffle));
+    }
+    ScalarSwapRB8888(src + 4 * i, dst + 4 * i, count - i);
+}
+
+TARGET_AVX2 static void
+AVX2RGBToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const __m256i permute = _mm256_setr_epi32(0, 1, 2, 0, 3, 4, 5, 0);
+    const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                             0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i alpha   = _mm256_set1_epi32(0xFF000000);
+
+    // a 32 byte load covers 8 pixels and reads ahead into the 3 that follow
+    uint32_t i = 0;
+    for(; i + 11 <= count; i += 8) {
+        const __m256i v = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 3 * i)), permute);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 4 * i), _mm256_or_si256(_mm256_shuffle_epi8(v, shuffle), alpha));
+    }
+    SSSE3RGBToRGBA(src + 3 * i, dst + 4 * i, count - i);
+}
+
+TARGET_AVX2 static void
+AVX2RGBAToRGB(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                             0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    const __m256i permute = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const __m256i v   = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 4 * i));
+        const __m256i rgb = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(v, shuffle), permute);
+        uint8_t *out = dst + 3 * i;
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm256_castsi256_si128(rgb));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(out + 16), _mm256_extracti128_si256(rgb, 1));
+    }
+    SSSE3RGBAToRGB(src + 4 * i, dst + 3 * i, count - i);
+}
+
+TARGET_AVX2 static void
+AVX2LuminanceToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const __m256i lll   = _mm256_set1_epi32(0x00010101);
+    const __m256i alpha = _mm256_set1_epi32(0xFF000000);
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const __m256i l = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 4 * i), _mm256_or_si256(_mm256_mullo_epi32(l, lll), alpha));
+    }
+    ScalarLuminanceToRGBA(src + i, dst + 4 * i, count - i);
+}
+
+TARGET_AVX2 static void
+AVX2LumAlphaToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const __m256i lll   = _mm256_set1_epi32(0x00010101);
+    const __m256i lMask = _mm256_set1_epi32(0x000000FF);
+    const __m256i aMask = _mm256_set1_epi32(0x0000FF00);
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const __m256i la = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i)));
+        const __m256i l  = _mm256_mullo_epi32(_mm256_and_si256(la, lMask), lll);
+        const __m256i a  = _mm256_slli_epi32(_mm256_and_si256(la, aMask), 16);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 4 * i), _mm256_or_si256(l, a));
+    }
+    ScalarLumAlphaToRGBA(src + 2 * i, dst + 4 * i, count - i);
+}
+
+TARGET_AVX2 static void
+AVX2AlphaToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const __m256i a = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 4 * i), _mm256_slli_epi32(a, 24));
+    }
+    ScalarAlphaToRGBA(src + i, dst + 4 * i, count - i);
+}
+
+// packs 8 pixels held as 32-bit r, g, b and a lanes into RGBA8888
+TARGET_AVX2 static void
+AVX2StoreRGBA32(uint8_t *dst, __m256i r, __m256i g, __m256i b, __m256i a)
+{
+    const __m256i rg = _mm256_or_si256(r, _mm256_slli_epi32(g, 8));
+    const __m256i ba = _mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_slli_epi32(a, 24));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), _mm256_or_si256(rg, ba));
+}
+
+TARGET_AVX2 static void
+AVX24444ToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const __m256i nibble = _mm256_set1_epi32(0x0000000F);
+    const __m256i repeat = _mm256_set1_epi32(0x00000011);
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i)));
+        const __m256i r = _mm256_mullo_epi32(_mm256_srli_epi32(v, 12), repeat);
+        const __m256i g = _mm256_mullo_epi32(_mm256_and_si256(_mm256_srli_epi32(v, 8), nibble), repeat);
+        const __m256i b = _mm256_mullo_epi32(_mm256_and_si256(_mm256_srli_epi32(v, 4), nibble), repeat);
+        const __m256i a = _mm256_mullo_epi32(_mm256_and_si256(v, nibble), repeat);
+        AVX2StoreRGBA32(dst + 4 * i, r, g, b, a);
+    }
+    Scalar4444ToRGBA(src + 2 * i, dst + 4 * i, count - i);
+}
+
+TARGET_AVX2 static void
+AVX25551ToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const __m256i top5 = _mm256_set1_epi32(0x000000F8);
+    const __m256i one  = _mm256_set1_epi32(0x00000001);
+    const __m256i ff   = _mm256_set1_epi32(0x000000FF);
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i)));
+        __m256i r = _mm256_and_si256(_mm256_srli_epi32(v, 8), top5);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi32(v, 3), top5);
+        __m256i b = _mm256_and_si256(_mm256_slli_epi32(v, 2), top5);
+        __m256i a = _mm256_mullo_epi32(_mm256_and_si256(v, one), ff);
+        r = _mm256_or_si256(r, _mm256_srli_epi32(r, 5));
+        g = _mm256_or_si256(g, _mm256_srli_epi32(g, 5));
+        b = _mm256_or_si256(b, _mm256_srli_epi32(b, 5));
+        AVX2StoreRGBA32(dst + 4 * i, r, g, b, a);
+    }
+    Scalar5551ToRGBA(src + 2 * i, dst + 4 * i, count - i);
+}
+
+TARGET_AVX2 static void
+AVX2565ToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const __m256i top5 = _mm256_set1_epi32(0x000000F8);
+    const __m256i top6 = _mm256_set1_epi32(0x000000FC);
+    const __m256i ff   = _mm256_set1_epi32(0x000000FF);
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i)));
+        __m256i r = _mm256_and_si256(_mm256_srli_epi32(v, 8), top5);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi32(v, 3), top6);
+        __m256i b = _mm256_and_si256(_mm256_slli_epi32(v, 3), top5);
+        r = _mm256_or_si256(r, _mm256_srli_epi32(r, 5));
+        g = _mm256_or_si256(g, _mm256_srli_epi32(g, 6));
+        b = _mm256_or_si256(b, _mm256_srli_epi32(b, 5));
+        AVX2StoreRGBA32(dst + 4 * i, r, g, b, ff);
+    }
+    Scalar565ToRGBA(src + 2 * i, dst + 4 * i, count - i);
+}
+
+#endif // GLOVE_PIXEL_KERNELS_X86
+
+#ifdef GLOVE_PIXEL_KERNELS_NEON
+
+// NEON kernels
+static void
+NEONSwapRB8888(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    uint32_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        uint8x16x4_t v = vld4q_u8(src + 4 * i);
+        const uint8x16_t r = v.val[0];
+        v.val[0] = v.val[2];
+        v.val[2] = r;
+        vst4q_u8(dst + 4 * i, v);
+    }
+    ScalarSwapRB8888(src + 4 * i, dst + 4 * i, count - i);
+}
+
+static void
+NEONRGBToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    uint32_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        const uint8x16x3_t v = vld3q_u8(src + 3 * i);
+        uint8x16x4_t rgba;
+        rgba.val[0] = v.val[0];
+        rgba.val[1] = v.val[1];
+        rgba.val[2] = v.val[2];
+        rgba.val[3] = vdupq_n_u8(0xFF);
+        vst4q_u8(dst + 4 * i, rgba);
+    }
+    ScalarRGBToRGBA(src + 3 * i, dst + 4 * i, count - i);
+}
+
+static void
+NEONRGBAToRGB(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    uint32_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        const uint8x16x4_t v = vld4q_u8(src + 4 * i);
+        uint8x16x3_t rgb;
+        rgb.val[0] = v.val[0];
+        rgb.val[1] = v.val[1];
+        rgb.val[2] = v.val[2];
+        vst3q_u8(dst + 3 * i, rgb);
+    }
+    ScalarRGBAToRGB(src + 4 * i, dst + 3 * i, count - i);
+}
+
+static void
+NEONLuminanceToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    uint32_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        const uint8x16_t l = vld1q_u8(src + i);
+        uint8x16x4_t rgba;
+        rgba.val[0] = l;
+        rgba.val[1] = l;
+        rgba.val[2] = l;
+        rgba.val[3] = vdupq_n_u8(0xFF);
+        vst4q_u8(dst + 4 * i, rgba);
+    }
+    ScalarLuminanceToRGBA(src + i, dst + 4 * i, count - i);
+}
+
+static void
+NEONLumAlphaToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    uint32_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        const uint8x16x2_t la = vld2q_u8(src + 2 * i);
+        uint8x16x4_t rgba;
+        rgba.val[0] = la.val[0];
+        rgba.val[1] = la.val[0];
+        rgba.val[2] = la.val[0];
+        rgba.val[3] = la.val[1];
+        vst4q_u8(dst + 4 * i, rgba);
+    }
+    ScalarLumAlphaToRGBA(src + 2 * i, dst + 4 * i, count - i);
+}
+
+static void
+NEONAlphaToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    uint32_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        uint8x16x4_t rgba;
+        rgba.val[0] = vdupq_n_u8(0);
+        rgba.val[1] = vdupq_n_u8(0);
+        rgba.val[2] = vdupq_n_u8(0);
+        rgba.val[3] = vld1q_u8(src + i);
+        vst4q_u8(dst + 4 * i, rgba);
+    }
+    ScalarAlphaToRGBA(src + i, dst + 4 * i, count - i);
+}
+
+static void
+NEON4444ToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const uint8x8_t nibble = vdup_n_u8(0x0F);
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const uint16x8_t v = vld1q_u16(reinterpret_cast<const uint16_t *>(src + 2 * i));
+        const uint8x8_t r = vmovn_u16(vshrq_n_u16(v, 12));
+        const uint8x8_t g = vand_u8(vmovn_u16(vshrq_n_u16(v, 8)), nibble);
+        const uint8x8_t b = vand_u8(vmovn_u16(vshrq_n_u16(v, 4)), nibble);
+        const uint8x8_t a = vand_u8(vmovn_u16(v), nibble);
+        uint8x8x4_t rgba;
+        rgba.val[0] = vorr_u8(r, vshl_n_u8(r, 4));
+        rgba.val[1] = vorr_u8(g, vshl_n_u8(g, 4));
+        rgba.val[2] = vorr_u8(b, vshl_n_u8(b, 4));
+        rgba.val[3] = vorr_u8(a, vshl_n_u8(a, 4));
+        vst4_u8(dst + 4 * i, rgba);
+    }
+    Scalar4444ToRGBA(src + 2 * i, dst + 4 * i, count - i);
+}
+
+static void
+NEON5551ToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const uint8x8_t top5 = vdup_n_u8(0xF8);
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const uint16x8_t v = vld1q_u16(reinterpret_cast<const uint16_t *>(src + 2 * i));
+        const uint8x8_t r = vand_u8(vmovn_u16(vshrq_n_u16(v, 8)), top5);
+        const uint8x8_t g = vand_u8(vmovn_u16(vshrq_n_u16(v, 3)), top5);
+        const uint8x8_t b = vand_u8(vmovn_u16(vshlq_n_u16(v, 2)), top5);
+        uint8x8x4_t rgba;
+        rgba.val[0] = vorr_u8(r, vshr_n_u8(r, 5));
+        rgba.val[1] = vorr_u8(g, vshr_n_u8(g, 5));
+        rgba.val[2] = vorr_u8(b, vshr_n_u8(b, 5));
+        rgba.val[3] = vtst_u8(vmovn_u16(v), vdup_n_u8(0x01));
+        vst4_u8(dst + 4 * i, rgba);
+    }
+    Scalar5551ToRGBA(src + 2 * i, dst + 4 * i, count - i);
+}
+
+static void
+NEON565ToRGBA(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    const uint8x8_t top5 = vdup_n_u8(0xF8);
+    const uint8x8_t top6 = vdup_n_u8(0xFC);
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const uint16x8_t v = vld1q_u16(reinterpret_cast<const uint16_t *>(src + 2 * i));
+        const uint8x8_t r = vand_u8(vmovn_u16(vshrq_n_u16(v, 8)), top5);
+        const uint8x8_t g = vand_u8(vmovn_u16(vshrq_n_u16(v, 3)), top6);
+        const uint8x8_t b = vand_u8(vmovn_u16(vshlq_n_u16(v, 3)), top5);
+        uint8x8x4_t rgba;
+        rgba.val[0] = vorr_u8(r, vshr_n_u8(r, 5));
+        rgba.val[1] = vorr_u8(g, vshr_n_u8(g, 6));
+        rgba.val[2] = vorr_u8(b, vshr_n_u8(b, 5));
+        rgba.val[3] = vdup_n_u8(0xFF);
+        vst4_u8(dst + 4 * i, rgba);
+    }
+    Scalar565ToRGBA(src + 2 * i, dst + 4 * i, count - i);
+}
+
+#endif // GLOVE_PIXEL_KERNELS_NEON
+
+// kernels per instruction set, a missing kernel falls back to the previous instruction set of the same family
+static const pixelRowKernel_t pixelRowKernels[PIXEL_KERNEL_ISA_MAX][PIXEL_KERNEL_MAX] = {
+    { ScalarSwapRB8888, ScalarRGBToRGBA, ScalarRGBAToRGB, ScalarLuminanceToRGBA, ScalarLumAlphaToRGBA,
+      ScalarAlphaToRGBA, Scalar4444ToRGBA, Scalar5551ToRGBA, Scalar565ToRGBA },
+#ifdef GLOVE_PIXEL_KERNELS_X86
+    { SSE2SwapRB8888, nullptr, nullptr, SSE2LuminanceToRGBA, SSE2LumAlphaToRGBA,
+      SSE2AlphaToRGBA, SSE24444ToRGBA, SSE25551ToRGBA, SSE2565ToRGBA },
+    { nullptr, SSSE3RGBToRGBA, SSSE3RGBAToRGB, nullptr, nullptr,
+      nullptr, nullptr, nullptr, nullptr },
+    { AVX2SwapRB8888, AVX2RGBToRGBA, AVX2RGBAToRGB, AVX2LuminanceToRGBA, AVX2LumAlphaToRGBA,
+      AVX2AlphaToRGBA, AVX24444ToRGBA, AVX25551ToRGBA, AVX2565ToRGBA },
+#else
+    { }, { }, { },
+#endif
+#ifdef GLOVE_PIXEL_KERNELS_NEON
+    { NEONSwapRB8888, NEONRGBToRGBA, NEONRGBAToRGB, NEONLuminanceToRGBA, NEONLumAlphaToRGBA,
+      NEONAlphaToRGBA, NEON4444ToRGBA, NEON5551ToRGBA, NEON565ToRGBA },
+#else
+    { },
+#endif
+};
+
+static pixelKernelIsa_t
+DetectPixelKernelIsa(void)
+{
+#if defined(GLOVE_PIXEL_KERNELS_X86)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) {
+        return PIXEL_KERNEL_ISA_AVX2;
+    }
+    if(__builtin_cpu_supports("ssse3")) {
+        return PIXEL_KERNEL_ISA_SSSE3;
+    }
+    if(__builtin_cpu_supports("sse2")) {
+        return PIXEL_KERNEL_ISA_SSE2;
+    }
+#elif defined(GLOVE_PIXEL_KERNELS_NEON)
+    return PIXEL_KERNEL_ISA_NEON;
+#endif
+    return PIXEL_KERNEL_ISA_SCALAR;
+}
+
+pixelKernelIsa_t
+GetPixelKernelIsa(void)
+{
+    static const pixelKernelIsa_t isa = DetectPixelKernelIsa();
+    return isa;
+}
+
+const char *
+GetPixelKernelIsaName(pixelKernelIsa_t isa)
+{
+    static const char *names[PIXEL_KERNEL_ISA_MAX] = { "scalar", "sse2", "ssse3", "avx2", "neon" };
+    return isa < PIXEL_KERNEL_ISA_MAX ? names[isa] : "unknown";
+}
+
+const char *
+GetPixelKernelName(pixelKernel_t kernel)
+{
+    static const char *names[PIXEL_KERNEL_MAX] = { "BGRA8888 <-> RGBA8888", "RGB888 -> RGBA8888", "RGBA8888 -> RGB888",
+                                                   "L8 -> RGBA8888", "LA88 -> RGBA8888", "A8 -> RGBA8888",
+                                                   "RGBA4444 -> RGBA8888", "RGBA5551 -> RGBA8888", "RGB565 -> RGBA8888" };
+    return kernel < PIXEL_KERNEL_MAX ? names[kernel] : "unknown";
+}
+
+pixelRowKernel_t
+GetPixelRowKernel(pixelKernel_t kernel, pixelKernelIsa_t isa)
+{
+    const pixelKernelIsa_t cpuIsa = GetPixelKernelIsa();
+
+    // instruction sets of another family, or newer than the ones of the CPU, are not available
+    if(isa != PIXEL_KERNEL_ISA_SCALAR &&
+      (isa > cpuIsa || (isa == PIXEL_KERNEL_ISA_NEON) != (cpuIsa == PIXEL_KERNEL_ISA_NEON))) {
+        return nullptr;
+    }
+
+    for(int i = isa; i > PIXEL_KERNEL_ISA_SCALAR; --i) {
+        if(pixelRowKernels[i][kernel]) {
+            return pixelRowKernels[i][kernel];
+        }
+        if(i == PIXEL_KERNEL_ISA_NEON) {
+            break;
+        }
+    }
+
+    return pixelRowKernels[PIXEL_KERNEL_ISA_SCALAR][kernel];
+}
+
+pixelRowKernel_t
+GetPixelRowKernel(pixelKernel_t kernel)
+{
+    return GetPixelRowKernel(kernel, GetPixelKernelIsa());
+}
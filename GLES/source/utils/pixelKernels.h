@@ -0,0 +1,74 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       pixelKernels.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Row Kernels for Pixel Convertions in GLOVE
+ *
+ */
+
+#ifndef __PIXELKERNELS_H__
+#define __PIXELKERNELS_H__
+
+#include <stdint.h>
+#include "color.hpp"
+
+typedef void (*pixelRowKernel_t)(const uint8_t *src, uint8_t *dst, uint32_t count);
+
+typedef enum {
+    PIXEL_KERNEL_SWAP_RB_8888 = 0,
+    PIXEL_KERNEL_RGB_TO_RGBA,
+    PIXEL_KERNEL_RGBA_TO_RGB,
+    PIXEL_KERNEL_LUMINANCE_TO_RGBA,
+    PIXEL_KERNEL_LUMINANCE_ALPHA_TO_RGBA,
+    PIXEL_KERNEL_ALPHA_TO_RGBA,
+    PIXEL_KERNEL_4444_TO_RGBA,
+    PIXEL_KERNEL_5551_TO_RGBA,
+    PIXEL_KERNEL_565_TO_RGBA,
+    PIXEL_KERNEL_MAX
+} pixelKernel_t;
+
+typedef enum {
+    PIXEL_KERNEL_ISA_SCALAR = 0,
+    PIXEL_KERNEL_ISA_SSE2,
+    PIXEL_KERNEL_ISA_SSSE3,
+    PIXEL_KERNEL_ISA_AVX2,
+    PIXEL_KERNEL_ISA_NEON,
+    PIXEL_KERNEL_ISA_MAX
+} pixelKernelIsa_t;
+
+// converts a row of pixels one at a time through the Color conversion functions.
+// Conversions that have no vectorized kernel use it directly, the rest for the
+// pixels that do not fill a whole vector.
+template<Color (*FromColor)(const uint8_t *), void (*ToColor)(Color &, uint8_t *), uint32_t srcPixelSize, uint32_t dstPixelSize>
+void ConvertPixelRow(const uint8_t *src, uint8_t *dst, uint32_t count)
+{
+    for(uint32_t i = 0; i < count; ++i) {
+        Color color = FromColor(src);
+        ToColor(color, dst);
+        src += srcPixelSize;
+        dst += dstPixelSize;
+    }
+}
+
+pixelKernelIsa_t        GetPixelKernelIsa(void);
+const char *            GetPixelKernelIsaName(pixelKernelIsa_t isa);
+const char *            GetPixelKernelName(pixelKernel_t kernel);
+pixelRowKernel_t        GetPixelRowKernel(pixelKernel_t kernel);
+pixelRowKernel_t        GetPixelRowKernel(pixelKernel_t kernel, pixelKernelIsa_t isa);
+
+#endif // __PIXELKERNELS_H__
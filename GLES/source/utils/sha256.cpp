@@ -0,0 +1,195 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       sha256.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      SHA-256 Message Digest
+ *
+ *  @section
+ *
+ *  SHA-256 as specified in FIPS 180-4. It names content addressed data, such
+ *  as cached shader binaries, where a collision would silently hand back the
+ *  wrong data, so a cryptographic digest is used instead of a fast hash.
+ *
+ */
+
+#include "sha256.h"
+#include <string.h>
+
+static const uint32_t sha256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t
+RotateRight(uint32_t x, uint32_t n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+Sha256::Sha256()
+: mBlockSize(0), mMessageSize(0)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    mState[0] = 0x6a09e667;
+    mState[1] = 0xbb67ae85;
+    mState[2] = 0x3c6ef372;
+    mState[3] = 0xa54ff53a;
+    mState[4] = 0x510e527f;
+    mState[5] = 0x9b05688c;
+    mState[6] = 0x1f83d9ab;
+    mState[7] = 0x5be0cd19;
+}
+
+void
+Sha256::Transform(const uint8_t *block)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    uint32_t w[64];
+    for(uint32_t i = 0; i < 16; ++i) {
+        w[i] = ((uint32_t)block[4 * i] << 24) | ((uint32_t)block[4 * i + 1] << 16) |
+               ((uint32_t)block[4 * i + 2] << 8) | (uint32_t)block[4 * i + 3];
+    }
+    for(uint32_t i = 16; i < 64; ++i) {
+        const uint32_t s0 = RotateRight(w[i - 15], 7) ^ RotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const uint32_t s1 = RotateRight(w[i - 2], 17) ^ RotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = mState[0], b = mState[1], c = mState[2], d = mState[3];
+    uint32_t e = mState[4], f = mState[5], g = mState[6], h = mState[7];
+
+    for(uint32_t i = 0; i < 64; ++i) {
+        const uint32_t s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+        const uint32_t ch = (e & f) ^ (~e & g);
+        const uint32_t t1 = h + s1 + ch + sha256K[i] + w[i];
+        const uint32_t s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+        const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        const uint32_t t2 = s0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    mState[0] += a; mState[1] += b; mState[2] += c; mState[3] += d;
+    mState[4] += e; mState[5] += f; mState[6] += g; mState[7] += h;
+}
+
+void
+Sha256::Update(const void *data, size_t size)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data);
+    mMessageSize += size;
+
+    while(size) {
+        const size_t count = (size < 64 - mBlockSize) ? size : 64 - mBlockSize;
+        memcpy(mBlock + mBlockSize, bytes, count);
+        mBlockSize += count;
+        bytes      += count;
+        size       -= count;
+
+        if(mBlockSize == 64) {
+            Transform(mBlock);
+            mBlockSize = 0;
+        }
+    }
+}
+
+void
+Sha256::Update(const std::string &str)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    /// The length is hashed too, so that consecutive strings cannot be
+    /// shifted into each other and produce the same message. Use the raw
+    /// overload for the plain digest of the characters.
+    Update((uint32_t)str.size());
+    Update(str.data(), str.size());
+}
+
+void
+Sha256::Update(uint32_t value)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    const uint8_t bytes[4] = { (uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value };
+    Update(bytes, sizeof(bytes));
+}
+
+void
+Sha256::Finalize(uint8_t digest[DIGEST_SIZE])
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    const uint64_t messageBits = mMessageSize * 8;
+
+    /// Pad with a single set bit and zeros up to the 64-bit message length
+    const uint8_t pad = 0x80;
+    const uint8_t zero = 0x00;
+    Update(&pad, 1);
+    while(mBlockSize != 56) {
+        Update(&zero, 1);
+    }
+
+    uint8_t length[8];
+    for(uint32_t i = 0; i < 8; ++i) {
+        length[i] = (uint8_t)(messageBits >> (56 - 8 * i));
+    }
+    Update(length, sizeof(length));
+
+    for(uint32_t i = 0; i < 8; ++i) {
+        digest[4 * i]     = (uint8_t)(mState[i] >> 24);
+        digest[4 * i + 1] = (uint8_t)(mState[i] >> 16);
+        digest[4 * i + 2] = (uint8_t)(mState[i] >> 8);
+        digest[4 * i + 3] = (uint8_t)mState[i];
+    }
+}
+
+std::string
+Sha256::FinalizeHex(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    static const char hexDigits[] = "0123456789abcdef";
+
+    uint8_t digest[DIGEST_SIZE];
+    Finalize(digest);
+
+    std::string hex(2 * DIGEST_SIZE, '0');
+    for(uint32_t i = 0; i < DIGEST_SIZE; ++i) {
+        hex[2 * i]     = hexDigits[digest[i] >> 4];
+        hex[2 * i + 1] = hexDigits[digest[i] & 0xf];
+    }
+
+    return hex;
+}
@@ -0,0 +1,60 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       sha256.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      SHA-256 Message Digest
+ *
+ */
+
+#ifndef __SHA256_H__
+#define __SHA256_H__
+
+#include "glLogger.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+class Sha256 {
+public:
+    static const uint32_t               DIGEST_SIZE = 32;
+
+private:
+    uint32_t                            mState[8];
+    uint8_t                             mBlock[64];
+    uint32_t                            mBlockSize;
+    uint64_t                            mMessageSize;
+
+    void                                Transform(const uint8_t *block);
+
+public:
+// Constructor
+    Sha256();
+
+// Update Functions
+    void                                Update(const void *data, size_t size);
+    /// Hashes the length of the string ahead of its characters, so the digest
+    /// is intentionally not the plain SHA-256 of the characters
+    void                                Update(const std::string &str);
+    void                                Update(uint32_t value);
+
+// Finalize Functions
+    void                                Finalize(uint8_t digest[DIGEST_SIZE]);
+    std::string                         FinalizeHex(void);
+};
+
+#endif // __SHA256_H__
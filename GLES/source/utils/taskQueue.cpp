@@ -0,0 +1,150 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       taskQueue.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Ordered Execution of Tasks on a Worker Thread
+ *
+ *  @section
+ *
+ *  A task queue executes the tasks submitted to it on a worker thread, one
+ *  after the other and in submission order, so that tasks operating on
+ *  shared state observe each other's results exactly as if they were called
+ *  in place. Every task is tagged with a serial. Callers keep the serial of
+ *  the last task that uses an object and wait for it only when they need
+ *  its results.
+ *
+ *  A synchronous queue executes the tasks in place, after the ones that are
+ *  still pending. The worker thread of an asynchronous queue is started with
+ *  its first task.
+ *
+ */
+
+#include "taskQueue.h"
+
+TaskQueue::TaskQueue(bool asynchronous)
+: mNextSerial(1), mCompletedSerial(0), mAsynchronous(false), mTerminate(false)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    SetAsynchronous(asynchronous);
+}
+
+TaskQueue::~TaskQueue()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mTerminate = true;
+    }
+    mSubmitted.notify_all();
+
+    if(mWorker.joinable()) {
+        mWorker.join();
+    }
+}
+
+void
+TaskQueue::Run(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while(true) {
+        mSubmitted.wait(lock, [this] { return mTerminate || !mTasks.empty(); });
+
+        /// Pending tasks are drained before terminating, as their
+        /// submitters may be waiting on them
+        if(mTasks.empty()) {
+            return;
+        }
+
+        task_t task = mTasks.front();
+        lock.unlock();
+        task();
+        lock.lock();
+
+        mTasks.pop_front();
+        ++mCompletedSerial;
+        mCompleted.notify_all();
+    }
+}
+
+uint64_t
+TaskQueue::Submit(task_t task)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mAsynchronous) {
+        WaitIdle();
+        task();
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCompletedSerial = mNextSerial;
+        return mNextSerial++;
+    }
+
+    if(!mWorker.joinable()) {
+        mWorker = std::thread(&TaskQueue::Run, this);
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mTasks.push_back(task);
+    const uint64_t serial = mNextSerial++;
+    lock.unlock();
+
+    mSubmitted.notify_one();
+
+    return serial;
+}
+
+bool
+TaskQueue::IsCompleted(uint64_t serial)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    return serial <= mCompletedSerial;
+}
+
+void
+TaskQueue::Wait(uint64_t serial)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCompleted.wait(lock, [this, serial] { return serial <= mCompletedSerial; });
+}
+
+void
+TaskQueue::WaitIdle(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCompleted.wait(lock, [this] { return mTasks.empty(); });
+}
+
+void
+TaskQueue::SetAsynchronous(bool asynchronous)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mAsynchronous = asynchronous;
+}
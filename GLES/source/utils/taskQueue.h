@@ -0,0 +1,75 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       taskQueue.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Ordered Execution of Tasks on a Worker Thread
+ *
+ */
+
+#ifndef __TASKQUEUE_H__
+#define __TASKQUEUE_H__
+
+#include "glLogger.h"
+#include <stdint.h>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+class TaskQueue {
+public:
+    typedef std::function<void(void)> task_t;
+
+private:
+    std::thread                         mWorker;
+    std::mutex                          mMutex;
+    std::condition_variable             mSubmitted;
+    std::condition_variable             mCompleted;
+
+    std::deque<task_t>                  mTasks;
+    uint64_t                            mNextSerial;
+    uint64_t                            mCompletedSerial;
+    bool                                mAsynchronous;
+    bool                                mTerminate;
+
+    void                                Run(void);
+
+public:
+// Constructor
+    TaskQueue(bool asynchronous);
+
+// Destructor
+    ~TaskQueue();
+
+// Submit Functions
+    uint64_t                            Submit(task_t task);
+
+// Wait Functions
+    void                                Wait(uint64_t serial);
+    void                                WaitIdle(void);
+
+// Is Functions
+    bool                                IsCompleted(uint64_t serial);
+    inline bool                         IsAsynchronous(void)            const { FUN_ENTRY(GL_LOG_TRACE); return mAsynchronous; }
+
+// Set Functions
+    void                                SetAsynchronous(bool asynchronous);
+};
+
+#endif // __TASKQUEUE_H__
@@ -0,0 +1,400 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       vertexKernels.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Kernels for Vertex Attribute Convertions in GLOVE
+ *
+ *  @scope
+ *
+ *  A vertex kernel converts a run of vertex attribute components of an
+ *  integer or fixed point type to floats, for the attribute formats that
+ *  the device cannot read natively. There are SSE2 and AVX2 kernels on x86
+ *  and NEON kernels on ARM, selected with the same instruction set detection
+ *  as the pixel kernels. The components that do not fill a whole vector are
+ *  handled by the scalar kernels.
+ *
+ */
+
+#include "vertexKernels.h"
+#include "GLES2/gl2.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#   define GLOVE_VERTEX_KERNELS_X86
+#   include <immintrin.h>
+#   define TARGET_SSE2                                  __attribute__((target("sse2")))
+#   define TARGET_AVX2                                  __attribute__((target("avx2")))
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define GLOVE_VERTEX_KERNELS_NEON
+#   include <arm_neon.h>
+#endif
+
+// GL_FIXED is a signed 16.16 fixed point number
+static const float fixedToFloatScale = 1.0f / 65536.0f;
+
+static void
+ConvertFixedComponents(const uint8_t *src, float *dst, uint32_t count)
+{
+    const GLfixed *pSrc = reinterpret_cast<const GLfixed *>(src);
+
+    for(uint32_t i = 0; i < count; ++i) {
+        dst[i] = static_cast<float>(pSrc[i]) * fixedToFloatScale;
+    }
+}
+
+// scalar kernels
+static const vertexKernel_t ScalarByte              = &ConvertVertexComponents<int8_t,   false>;
+static const vertexKernel_t ScalarByteNorm          = &ConvertVertexComponents<int8_t,   true>;
+static const vertexKernel_t ScalarUByte             = &ConvertVertexComponents<uint8_t,  false>;
+static const vertexKernel_t ScalarUByteNorm         = &ConvertVertexComponents<uint8_t,  true>;
+static const vertexKernel_t ScalarShort             = &ConvertVertexComponents<int16_t,  false>;
+static const vertexKernel_t ScalarShortNorm         = &ConvertVertexComponents<int16_t,  true>;
+static const vertexKernel_t ScalarUShort            = &ConvertVertexComponents<uint16_t, false>;
+static const vertexKernel_t ScalarUShortNorm        = &ConvertVertexComponents<uint16_t, true>;
+static const vertexKernel_t ScalarInt               = &ConvertVertexComponents<int32_t,  false>;
+static const vertexKernel_t ScalarIntNorm           = &ConvertVertexComponents<int32_t,  true>;
+static const vertexKernel_t ScalarUInt              = &ConvertVertexComponents<uint32_t, false>;
+static const vertexKernel_t ScalarUIntNorm          = &ConvertVertexComponents<uint32_t, true>;
+static const vertexKernel_t ScalarFixed             = &ConvertFixedComponents;
+
+#ifdef GLOVE_VERTEX_KERNELS_X86
+
+// SSE2 kernels
+// scales and stores 4 components converted to 32-bit integers
+template<bool normalize, bool clamp>
+TARGET_SSE2 static void
+SSE2Store(float *dst, __m128i v, __m128 scale)
+{
+    __m128 f = _mm_cvtepi32_ps(v);
+    if(normalize) {
+        f = _mm_mul_ps(f, scale);
+    }
+    if(clamp) {
+        f = _mm_max_ps(f, _mm_set1_ps(-1.0f));
+    }
+    _mm_storeu_ps(dst, f);
+}
+
+template<bool isSigned, bool normalize>
+TARGET_SSE2 static void
+SSE2Byte(const uint8_t *src, float *dst, uint32_t count)
+{
+    const __m128 scale = _mm_set1_ps(1.0f / (isSigned ? 127.0f : 255.0f));
+    const __m128i zero = _mm_setzero_si128();
+
+    uint32_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i lo, hi;
+        if(isSigned) {
+            lo = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+            hi = _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+            SSE2Store<normalize, normalize>(dst + i +  0, _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16), scale);
+            SSE2Store<normalize, normalize>(dst + i +  4, _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16), scale);
+            SSE2Store<normalize, normalize>(dst + i +  8, _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16), scale);
+            SSE2Store<normalize, normalize>(dst + i + 12, _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16), scale);
+        } else {
+            lo = _mm_unpacklo_epi8(v, zero);
+            hi = _mm_unpackhi_epi8(v, zero);
+            SSE2Store<normalize, false>(dst + i +  0, _mm_unpacklo_epi16(lo, zero), scale);
+            SSE2Store<normalize, false>(dst + i +  4, _mm_unpackhi_epi16(lo, zero), scale);
+            SSE2Store<normalize, false>(dst + i +  8, _mm_unpacklo_epi16(hi, zero), scale);
+            SSE2Store<normalize, false>(dst + i + 12, _mm_unpackhi_epi16(hi, zero), scale);
+        }
+    }
+
+    if(isSigned) {
+        ConvertVertexComponents<int8_t, normalize>(src + i, dst + i, count - i);
+    } else {
+        ConvertVertexComponents<uint8_t, normalize>(src + i, dst + i, count - i);
+    }
+}
+
+template<bool isSigned, bool normalize>
+TARGET_SSE2 static void
+SSE2Short(const uint8_t *src, float *dst, uint32_t count)
+{
+    const __m128 scale = _mm_set1_ps(1.0f / (isSigned ? 32767.0f : 65535.0f));
+    const __m128i zero = _mm_setzero_si128();
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+        if(isSigned) {
+            SSE2Store<normalize, normalize>(dst + i + 0, _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16), scale);
+            SSE2Store<normalize, normalize>(dst + i + 4, _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16), scale);
+        } else {
+            SSE2Store<normalize, false>(dst + i + 0, _mm_unpacklo_epi16(v, zero), scale);
+            SSE2Store<normalize, false>(dst + i + 4, _mm_unpackhi_epi16(v, zero), scale);
+        }
+    }
+
+    if(isSigned) {
+        ConvertVertexComponents<int16_t, normalize>(src + 2 * i, dst + i, count - i);
+    } else {
+        ConvertVertexComponents<uint16_t, normalize>(src + 2 * i, dst + i, count - i);
+    }
+}
+
+template<bool fixed>
+TARGET_SSE2 static void
+SSE2Int(const uint8_t *src, float *dst, uint32_t count)
+{
+    const __m128 scale = _mm_set1_ps(fixedToFloatScale);
+
+    uint32_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 4 * i));
+        SSE2Store<fixed, false>(dst + i, v, scale);
+    }
+
+    if(fixed) {
+        ScalarFixed(src + 4 * i, dst + i, count - i);
+    } else {
+        ScalarInt(src + 4 * i, dst + i, count - i);
+    }
+}
+
+// AVX2 kernels
+template<bool normalize, bool clamp>
+TARGET_AVX2 static void
+AVX2Store(float *dst, __m256i v, __m256 scale)
+{
+    __m256 f = _mm256_cvtepi32_ps(v);
+    if(normalize) {
+        f = _mm256_mul_ps(f, scale);
+    }
+    if(clamp) {
+        f = _mm256_max_ps(f, _mm256_set1_ps(-1.0f));
+    }
+    _mm256_storeu_ps(dst, f);
+}
+
+template<bool isSigned, bool normalize>
+TARGET_AVX2 static void
+AVX2Byte(const uint8_t *src, float *dst, uint32_t count)
+{
+    const __m256 scale = _mm256_set1_ps(1.0f / (isSigned ? 127.0f : 255.0f));
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i));
+        if(isSigned) {
+            AVX2Store<normalize, normalize>(dst + i, _mm256_cvtepi8_epi32(v), scale);
+        } else {
+            AVX2Store<normalize, false>(dst + i, _mm256_cvtepu8_epi32(v), scale);
+        }
+    }
+
+    if(isSigned) {
+        ConvertVertexComponents<int8_t, normalize>(src + i, dst + i, count - i);
+    } else {
+        ConvertVertexComponents<uint8_t, normalize>(src + i, dst + i, count - i);
+    }
+}
+
+template<bool isSigned, bool normalize>
+TARGET_AVX2 static void
+AVX2Short(const uint8_t *src, float *dst, uint32_t count)
+{
+    const __m256 scale = _mm256_set1_ps(1.0f / (isSigned ? 32767.0f : 65535.0f));
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+        if(isSigned) {
+            AVX2Store<normalize, normalize>(dst + i, _mm256_cvtepi16_epi32(v), scale);
+        } else {
+            AVX2Store<normalize, false>(dst + i, _mm256_cvtepu16_epi32(v), scale);
+        }
+    }
+
+    if(isSigned) {
+        ConvertVertexComponents<int16_t, normalize>(src + 2 * i, dst + i, count - i);
+    } else {
+        ConvertVertexComponents<uint16_t, normalize>(src + 2 * i, dst + i, count - i);
+    }
+}
+
+template<bool fixed>
+TARGET_AVX2 static void
+AVX2Int(const uint8_t *src, float *dst, uint32_t count)
+{
+    const __m256 scale = _mm256_set1_ps(fixedToFloatScale);
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 4 * i));
+        AVX2Store<fixed, false>(dst + i, v, scale);
+    }
+
+    if(fixed) {
+        ScalarFixed(src + 4 * i, dst + i, count - i);
+    } else {
+        ScalarInt(src + 4 * i, dst + i, count - i);
+    }
+}
+
+#endif // GLOVE_VERTEX_KERNELS_X86
+
+#ifdef GLOVE_VERTEX_KERNELS_NEON
+
+// NEON kernels
+template<bool normalize, bool clamp>
+static void
+NEONStore(float *dst, float32x4_t f, float scale)
+{
+    if(normalize) {
+        f = vmulq_n_f32(f, scale);
+    }
+    if(clamp) {
+        f = vmaxq_f32(f, vdupq_n_f32(-1.0f));
+    }
+    vst1q_f32(dst, f);
+}
+
+template<bool normalize>
+static void
+NEONByte(const uint8_t *src, float *dst, uint32_t count)
+{
+    const float scale = 1.0f / 127.0f;
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const int16x8_t v = vmovl_s8(vld1_s8(reinterpret_cast<const int8_t *>(src + i)));
+        NEONStore<normalize, normalize>(dst + i + 0, vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))),  scale);
+        NEONStore<normalize, normalize>(dst + i + 4, vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale);
+    }
+    ConvertVertexComponents<int8_t, normalize>(src + i, dst + i, count - i);
+}
+
+template<bool normalize>
+static void
+NEONUByte(const uint8_t *src, float *dst, uint32_t count)
+{
+    const float scale = 1.0f / 255.0f;
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const uint16x8_t v = vmovl_u8(vld1_u8(src + i));
+        NEONStore<normalize, false>(dst + i + 0, vcvtq_f32_u32(vmovl_u16(vget_low_u16(v))),  scale);
+        NEONStore<normalize, false>(dst + i + 4, vcvtq_f32_u32(vmovl_u16(vget_high_u16(v))), scale);
+    }
+    ConvertVertexComponents<uint8_t, normalize>(src + i, dst + i, count - i);
+}
+
+template<bool normalize>
+static void
+NEONShort(const uint8_t *src, float *dst, uint32_t count)
+{
+    const float scale = 1.0f / 32767.0f;
+
+    uint32_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        const int16x4_t v = vld1_s16(reinterpret_cast<const int16_t *>(src + 2 * i));
+        NEONStore<normalize, normalize>(dst + i, vcvtq_f32_s32(vmovl_s16(v)), scale);
+    }
+    ConvertVertexComponents<int16_t, normalize>(src + 2 * i, dst + i, count - i);
+}
+
+template<bool normalize>
+static void
+NEONUShort(const uint8_t *src, float *dst, uint32_t count)
+{
+    const float scale = 1.0f / 65535.0f;
+
+    uint32_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        const uint16x4_t v = vld1_u16(reinterpret_cast<const uint16_t *>(src + 2 * i));
+        NEONStore<normalize, false>(dst + i, vcvtq_f32_u32(vmovl_u16(v)), scale);
+    }
+    ConvertVertexComponents<uint16_t, normalize>(src + 2 * i, dst + i, count - i);
+}
+
+template<bool fixed>
+static void
+NEONInt(const uint8_t *src, float *dst, uint32_t count)
+{
+    const float scale = fixedToFloatScale;
+
+    uint32_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        const int32x4_t v = vld1q_s32(reinterpret_cast<const int32_t *>(src + 4 * i));
+        NEONStore<fixed, false>(dst + i, vcvtq_f32_s32(v), scale);
+    }
+
+    if(fixed) {
+        ScalarFixed(src + 4 * i, dst + i, count - i);
+    } else {
+        ScalarInt(src + 4 * i, dst + i, count - i);
+    }
+}
+
+#endif // GLOVE_VERTEX_KERNELS_NEON
+
+// kernels per instruction set, a missing kernel falls back to the previous instruction set of the same family
+static const vertexKernel_t vertexKernels[PIXEL_KERNEL_ISA_MAX][VERTEX_KERNEL_MAX] = {
+    { ScalarByte, ScalarByteNorm, ScalarUByte, ScalarUByteNorm, ScalarShort, ScalarShortNorm, ScalarUShort, ScalarUShortNorm,
+      ScalarInt, ScalarIntNorm, ScalarUInt, ScalarUIntNorm, ScalarFixed },
+#ifdef GLOVE_VERTEX_KERNELS_X86
+    { SSE2Byte<true, false>, SSE2Byte<true, true>, SSE2Byte<false, false>, SSE2Byte<false, true>,
+      SSE2Short<true, false>, SSE2Short<true, true>, SSE2Short<false, false>, SSE2Short<false, true>,
+      SSE2Int<false>, nullptr, nullptr, nullptr, SSE2Int<true> },
+    { },
+    { AVX2Byte<true, false>, AVX2Byte<true, true>, AVX2Byte<false, false>, AVX2Byte<false, true>,
+      AVX2Short<true, false>, AVX2Short<true, true>, AVX2Short<false, false>, AVX2Short<false, true>,
+      AVX2Int<false>, nullptr, nullptr, nullptr, AVX2Int<true> },
+#else
+    { }, { }, { },
+#endif
+#ifdef GLOVE_VERTEX_KERNELS_NEON
+    { NEONByte<false>, NEONByte<true>, NEONUByte<false>, NEONUByte<true>,
+      NEONShort<false>, NEONShort<true>, NEONUShort<false>, NEONUShort<true>,
+      NEONInt<false>, nullptr, nullptr, nullptr, NEONInt<true> },
+#else
+    { },
+#endif
+};
+
+vertexKernel_t
+GetVertexKernel(vertexKernelType_t kernel, pixelKernelIsa_t isa)
+{
+    const pixelKernelIsa_t cpuIsa = GetPixelKernelIsa();
+
+    // instruction sets of another family, or newer than the ones of the CPU, are not available
+    if(isa != PIXEL_KERNEL_ISA_SCALAR &&
+      (isa > cpuIsa || (isa == PIXEL_KERNEL_ISA_NEON) != (cpuIsa == PIXEL_KERNEL_ISA_NEON))) {
+        return nullptr;
+    }
+
+    for(int i = isa; i > PIXEL_KERNEL_ISA_SCALAR; --i) {
+        if(vertexKernels[i][kernel]) {
+            return vertexKernels[i][kernel];
+        }
+        if(i == PIXEL_KERNEL_ISA_NEON) {
+            break;
+        }
+    }
+
+    return vertexKernels[PIXEL_KERNEL_ISA_SCALAR][kernel];
+}
+
+vertexKernel_t
+GetVertexKernel(vertexKernelType_t kernel)
+{
+    return GetVertexKernel(kernel, GetPixelKernelIsa());
+}
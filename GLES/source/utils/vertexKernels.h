@@ -0,0 +1,72 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       vertexKernels.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Kernels for Vertex Attribute Convertions in GLOVE
+ *
+ */
+
+#ifndef __VERTEXKERNELS_H__
+#define __VERTEXKERNELS_H__
+
+#include "pixelKernels.h"
+#include <limits>
+
+typedef void (*vertexKernel_t)(const uint8_t *src, float *dst, uint32_t count);
+
+typedef enum {
+    VERTEX_KERNEL_BYTE = 0,
+    VERTEX_KERNEL_BYTE_NORM,
+    VERTEX_KERNEL_UNSIGNED_BYTE,
+    VERTEX_KERNEL_UNSIGNED_BYTE_NORM,
+    VERTEX_KERNEL_SHORT,
+    VERTEX_KERNEL_SHORT_NORM,
+    VERTEX_KERNEL_UNSIGNED_SHORT,
+    VERTEX_KERNEL_UNSIGNED_SHORT_NORM,
+    VERTEX_KERNEL_INT,
+    VERTEX_KERNEL_INT_NORM,
+    VERTEX_KERNEL_UNSIGNED_INT,
+    VERTEX_KERNEL_UNSIGNED_INT_NORM,
+    VERTEX_KERNEL_FIXED,
+    VERTEX_KERNEL_MAX
+} vertexKernelType_t;
+
+// converts vertex attribute components one at a time to floats. Normalized signed
+// components are mapped to [-1, 1] and unsigned ones to [0, 1], as in Vulkan's
+// SNORM and UNORM formats. The reciprocal is multiplied, rather than divided,
+// so that the vectorized kernels produce bit-exact the same results.
+template<typename T, bool normalize>
+void ConvertVertexComponents(const uint8_t *src, float *dst, uint32_t count)
+{
+    const T *pSrc = reinterpret_cast<const T *>(src);
+    const float scale = 1.0f / static_cast<float>(std::numeric_limits<T>::max());
+
+    for(uint32_t i = 0; i < count; ++i) {
+        if(normalize) {
+            const float value = static_cast<float>(pSrc[i]) * scale;
+            dst[i] = value < -1.0f ? -1.0f : value;
+        } else {
+            dst[i] = static_cast<float>(pSrc[i]);
+        }
+    }
+}
+
+vertexKernel_t          GetVertexKernel(vertexKernelType_t kernel);
+vertexKernel_t          GetVertexKernel(vertexKernelType_t kernel, pixelKernelIsa_t isa);
+
+#endif // __VERTEXKERNELS_H__
@@ -30,6 +30,7 @@
  */
 
 #include "buffer.h"
+#include "retirementQueue.h"
 
 namespace vulkanAPI {
 
@@ -55,7 +56,7 @@ Buffer::Release(void)
 
     mVkSize = 0;
     if(mVkBuffer != VK_NULL_HANDLE) {
-        vkDestroyBuffer(mVkContext->vkDevice, mVkBuffer, NULL);
+        mVkContext->mRetirementQueue->RetireResource(mVkBuffer, RESOURCE_TYPE_BUFFER);
         mVkBuffer = VK_NULL_HANDLE;
     }
 }
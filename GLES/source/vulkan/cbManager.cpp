@@ -29,59 +29,89 @@
  *  buffers, and which are not directly submitted to queues.
  *  Command buffers are represented by VkCommandBuffer.
  *
+ *  Every context owns a command buffer manager, so that contexts current on
+ *  different threads record their commands independently. Submissions to the
+ *  queues, which are shared by all contexts, are serialized.
+ *
+ *  Draw commands are recorded into a ring of GLOVE_NUM_FRAMES_IN_FLIGHT
+ *  frames, so that the CPU records the next frame while the GPU executes the
+ *  previous ones. Each frame owns a command pool, a fence and a descriptor
+ *  pool, and the regions of the ring buffers with the same index. When the
+ *  ring wraps around, the fence of the next frame is waited for and its pools
+ *  are reset as a whole, instead of resetting every command buffer. Objects
+ *  retired by GL are destroyed as soon as the frames that may reference them
+ *  have completed, instead of after a full wait.
+ *
+ *  Frames record the CPU time from the start of their recording to their
+ *  submission, and the GPU time between two timestamps written at their
+ *  start and end, when the graphics queue supports timestamps.
+ *
  */
 
 #include "cbManager.h"
+#include <algorithm>
 
-CommandBufferManager *CommandBufferManager::mInstance = nullptr;
+#if GLOVE_NUM_FRAMES_IN_FLIGHT < 2 || GLOVE_NUM_FRAMES_IN_FLIGHT > 4
+#   error "GLOVE_NUM_FRAMES_IN_FLIGHT must be between 2 and 4"
+#endif
 
-CommandBufferManager::CommandBufferManager(vkContext_t *context)
+CommandBufferManager::CommandBufferManager(const vkContext_t *context)
 : mVkContext(context)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    mActiveCmdBuffer    = 0;
-    mLastSubmittedBuffer= GLOVE_NO_BUFFER_TO_WAIT;
+    memset((void *)mFrames, 0, sizeof(mFrames));
+    for(uint32_t i = 0; i < GLOVE_NUM_FRAMES_IN_FLIGHT; ++i) {
+        mFrames[i].commandBufferState = CMD_BUFFER_INITIAL_STATE;
+    }
+    mActiveFrame        = 0;
+    mFrameSerial        = 0;
 
     mVkCmdPool          = VK_NULL_HANDLE;
     mVkAuxCommandBuffer = VK_NULL_HANDLE;
     mVkAuxFence         = VK_NULL_HANDLE;
-}
+    mVkAuxCommandBufferState = CMD_BUFFER_INITIAL_STATE;
+    mVkAuxEpoch         = 0;
 
-CommandBufferManager::~CommandBufferManager()
-{
-    FUN_ENTRY(GL_LOG_TRACE);
+    mVkTimestampQueryPool = VK_NULL_HANDLE;
+    mTimestampPeriod    = 0.0;
+    mTimestampMask      = 0;
 
-    assert(this == mInstance);
+    mFrameSubmitCount    = 0;
+    mFrameFenceWaitCount = 0;
+    mFrameCpuTime        = 0.0;
+    mFrameGpuTime        = 0.0;
+    mLastFrameCpuTime    = 0.0;
+    mLastFrameGpuTime    = 0.0;
 
-    for(uint32_t i = 0; i < mReferencedResources.size(); ++i) {
-        mReferencedResources[i]->mRefCount = 0;
-    }
+    memset((void *)&mPrivateSyncItems, 0, sizeof(mPrivateSyncItems));
+    mVkSyncItems        = &mPrivateSyncItems;
 
-    FreeResources();
+    mVkContext->mRetirementQueue->AddSubmitter(this);
+}
 
-    mReferencedResources.clear();
+CommandBufferManager::~CommandBufferManager()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
 
     if(mVkContext->vkDevice != VK_NULL_HANDLE ) {
 
-        vkDeviceWaitIdle(mVkContext->vkDevice);
+        /// Only the work of this manager has to complete, other contexts may still be rendering
+        for(uint32_t i = 0; i < GLOVE_NUM_FRAMES_IN_FLIGHT; ++i) {
+            WaitFrame(i);
+        }
+        if(mVkAuxCommandBufferState == CMD_BUFFER_SUBMITED_STATE) {
+            vkWaitForFences(mVkContext->vkDevice, 1, &mVkAuxFence, VK_TRUE, GLOVE_FENCE_WAIT_TIMEOUT);
+        }
 
-        for(uint32_t i = 0; i < mVkCommandBuffers.fence.size(); ++i) {
-            if(mVkCommandBuffers.fence[i] != VK_NULL_HANDLE) {
-                vkDestroyFence(mVkContext->vkDevice, mVkCommandBuffers.fence[i], NULL);
-            }
+        for(uint32_t i = 0; i < GLOVE_NUM_FRAMES_IN_FLIGHT; ++i) {
+            DestroyVkFrame(&mFrames[i]);
         }
 
         if(mVkAuxFence != VK_NULL_HANDLE) {
             vkDestroyFence(mVkContext->vkDevice, mVkAuxFence, NULL);
         }
 
-        vkFreeCommandBuffers(mVkContext->vkDevice, mVkCmdPool, mVkCommandBuffers.commandBuffer.size(), mVkCommandBuffers.commandBuffer.data());
-        mVkCommandBuffers.commandBuffer.clear();
-        mVkCommandBuffers.commandBufferState.clear();
-        mVkCommandBuffers.fence.clear();
-        memset((void *)&mVkCommandBuffers, 0, mVkCommandBuffers.commandBuffer.size()*sizeof(State));
-
         if(mVkAuxCommandBuffer != VK_NULL_HANDLE) {
             vkFreeCommandBuffers(mVkContext->vkDevice, mVkCmdPool, 1, &mVkAuxCommandBuffer);
             mVkAuxCommandBuffer = VK_NULL_HANDLE;
@@ -91,71 +121,244 @@ CommandBufferManager::~CommandBufferManager()
             vkDestroyCommandPool(mVkContext->vkDevice, mVkCmdPool, NULL);
             mVkCmdPool = VK_NULL_HANDLE;
         }
+
+        if(mVkTimestampQueryPool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(mVkContext->vkDevice, mVkTimestampQueryPool, NULL);
+            mVkTimestampQueryPool = VK_NULL_HANDLE;
+        }
+
+        if(mPrivateSyncItems.vkDrawSemaphore != VK_NULL_HANDLE) {
+            vkDestroySemaphore(mVkContext->vkDevice, mPrivateSyncItems.vkDrawSemaphore, NULL);
+        }
+        if(mPrivateSyncItems.vkAuxSemaphore != VK_NULL_HANDLE) {
+            vkDestroySemaphore(mVkContext->vkDevice, mPrivateSyncItems.vkAuxSemaphore, NULL);
+        }
     }
+
+    mVkContext->mRetirementQueue->RemoveSubmitter(this);
 }
 
-CommandBufferManager *
-CommandBufferManager::GetCommandBufferManager(vkContext_t *context)
+bool
+CommandBufferManager::CreateVkSemaphores(void)
 {
-    FUN_ENTRY(GL_LOG_TRACE);
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo;
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreCreateInfo.pNext = NULL;
+    semaphoreCreateInfo.flags = 0;
+
+    /// Surfaces other than windows are never acquired, so no acquire semaphore is needed
+    VkResult err = vkCreateSemaphore(mVkContext->vkDevice, &semaphoreCreateInfo, NULL, &mPrivateSyncItems.vkDrawSemaphore);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    err = vkCreateSemaphore(mVkContext->vkDevice, &semaphoreCreateInfo, NULL, &mPrivateSyncItems.vkAuxSemaphore);
+    assert(!err);
 
-    if(mInstance == nullptr) {
-        mInstance = new CommandBufferManager(context);
+    if(err != VK_SUCCESS) {
+        return false;
     }
 
-    return mInstance;
+    mPrivateSyncItems.acquireSemaphoreFlag = false;
+    mPrivateSyncItems.drawSemaphoreFlag    = false;
+    mPrivateSyncItems.auxSemaphoreFlag     = false;
+
+    return true;
 }
 
-void
-CommandBufferManager::ResetCommandBufferManager(void)
+bool
+CommandBufferManager::CreateVkTimestampQueryPool(void)
 {
-    FUN_ENTRY(GL_LOG_TRACE);
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(mVkContext->vkGpus[0], &queueFamilyCount, NULL);
+    vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(mVkContext->vkGpus[0], &queueFamilyCount, queueFamilyProperties.data());
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(mVkContext->vkGpus[0], &properties);
 
-    delete mInstance;
+    /// GPU timing is optional, frames are recorded the same way without it
+    const uint32_t validBits = mVkContext->vkGraphicsQueueNodeIndex < queueFamilyCount ?
+                               queueFamilyProperties[mVkContext->vkGraphicsQueueNodeIndex].timestampValidBits : 0;
+    if(!validBits || properties.limits.timestampPeriod <= 0.0f) {
+        return true;
+    }
+
+    mTimestampPeriod = properties.limits.timestampPeriod;
+    mTimestampMask   = validBits >= 64 ? UINT64_MAX : (1ULL << validBits) - 1;
+
+    VkQueryPoolCreateInfo queryPoolInfo;
+    memset((void *)&queryPoolInfo, 0, sizeof(queryPoolInfo));
+    queryPoolInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.pNext      = NULL;
+    queryPoolInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = 2 * GLOVE_NUM_FRAMES_IN_FLIGHT;
 
-    mInstance = nullptr;
+    if(vkCreateQueryPool(mVkContext->vkDevice, &queryPoolInfo, NULL, &mVkTimestampQueryPool) != VK_SUCCESS) {
+        mVkTimestampQueryPool = VK_NULL_HANDLE;
+    }
+
+    return true;
 }
 
 bool
-CommandBufferManager::AllocateVkCmdBuffers(void)
+CommandBufferManager::CreateVkFrame(frame_t *frame)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
     VkResult err;
 
+    /// Command buffers of a frame are only ever reset together with their pool
     VkCommandPoolCreateInfo cmdPoolInfo;
     memset((void *)&cmdPoolInfo, 0 ,sizeof(cmdPoolInfo));
     cmdPoolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     cmdPoolInfo.pNext            = NULL;
-    cmdPoolInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    cmdPoolInfo.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
     cmdPoolInfo.queueFamilyIndex = mVkContext->vkGraphicsQueueNodeIndex;
 
-    err = vkCreateCommandPool(mVkContext->vkDevice, &cmdPoolInfo, NULL, &mVkCmdPool);
+    err = vkCreateCommandPool(mVkContext->vkDevice, &cmdPoolInfo, NULL, &frame->commandPool);
     assert(!err);
 
     if(err != VK_SUCCESS) {
         return false;
     }
 
-    mVkCommandBuffers.commandBuffer.resize(GLOVE_NUM_VK_COMMAND_BUFFERS);
-    mVkCommandBuffers.commandBufferState.resize(GLOVE_NUM_VK_COMMAND_BUFFERS);
-    mVkCommandBuffers.fence.resize(GLOVE_NUM_VK_COMMAND_BUFFERS);
-
     VkCommandBufferAllocateInfo cmdAllocInfo;
     cmdAllocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     cmdAllocInfo.pNext              = NULL;
-    cmdAllocInfo.commandPool        = mVkCmdPool;
+    cmdAllocInfo.commandPool        = frame->commandPool;
     cmdAllocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    cmdAllocInfo.commandBufferCount = GLOVE_NUM_VK_COMMAND_BUFFERS;
+    cmdAllocInfo.commandBufferCount = 1;
 
-    err = vkAllocateCommandBuffers(mVkContext->vkDevice, &cmdAllocInfo, mVkCommandBuffers.commandBuffer.data());
+    err = vkAllocateCommandBuffers(mVkContext->vkDevice, &cmdAllocInfo, &frame->commandBuffer);
     assert(!err);
 
     if(err != VK_SUCCESS) {
         return false;
     }
 
+    VkFenceCreateInfo fenceInfo;
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.pNext = NULL;
+    fenceInfo.flags = 0;
+
+    err = vkCreateFence(mVkContext->vkDevice, &fenceInfo, NULL, &frame->fence);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo;
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreCreateInfo.pNext = NULL;
+    semaphoreCreateInfo.flags = 0;
+
+    err = vkCreateSemaphore(mVkContext->vkDevice, &semaphoreCreateInfo, NULL, &frame->acquireSemaphore);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    /// Descriptor sets that change while earlier frames may still use the
+    /// previous ones are allocated from the arena of the recording frame
+    VkDescriptorPoolSize poolSizes[2];
+    poolSizes[0].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    poolSizes[0].descriptorCount = GLOVE_FRAME_UNIFORM_BUFFER_DESCRIPTORS;
+    poolSizes[1].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[1].descriptorCount = GLOVE_FRAME_SAMPLER_DESCRIPTORS;
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo;
+    memset((void *)&descriptorPoolInfo, 0, sizeof(descriptorPoolInfo));
+    descriptorPoolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptorPoolInfo.pNext         = NULL;
+    descriptorPoolInfo.flags         = 0;
+    descriptorPoolInfo.maxSets       = GLOVE_FRAME_DESCRIPTOR_SETS;
+    descriptorPoolInfo.poolSizeCount = 2;
+    descriptorPoolInfo.pPoolSizes    = poolSizes;
+
+    err = vkCreateDescriptorPool(mVkContext->vkDevice, &descriptorPoolInfo, NULL, &frame->descriptorPool);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    frame->commandBufferState = CMD_BUFFER_INITIAL_STATE;
+
+    return true;
+}
+
+void
+CommandBufferManager::DestroyVkFrame(frame_t *frame)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(frame->descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(mVkContext->vkDevice, frame->descriptorPool, NULL);
+        frame->descriptorPool = VK_NULL_HANDLE;
+    }
+
+    if(frame->fence != VK_NULL_HANDLE) {
+        vkDestroyFence(mVkContext->vkDevice, frame->fence, NULL);
+        frame->fence = VK_NULL_HANDLE;
+    }
+
+    if(frame->acquireSemaphore != VK_NULL_HANDLE) {
+        vkDestroySemaphore(mVkContext->vkDevice, frame->acquireSemaphore, NULL);
+        frame->acquireSemaphore = VK_NULL_HANDLE;
+    }
+
+    /// Command buffers are freed along with their pool
+    if(frame->commandPool != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(mVkContext->vkDevice, frame->commandPool, NULL);
+        frame->commandPool   = VK_NULL_HANDLE;
+        frame->commandBuffer = VK_NULL_HANDLE;
+    }
+}
+
+bool
+CommandBufferManager::AllocateVkCmdBuffers(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkResult err;
+
+    for(uint32_t i = 0; i < GLOVE_NUM_FRAMES_IN_FLIGHT; ++i) {
+        if(!CreateVkFrame(&mFrames[i])) {
+            return false;
+        }
+    }
+
+    /// The aux command buffer is reset whenever it begins, so it gets a pool of its own
+    VkCommandPoolCreateInfo cmdPoolInfo;
+    memset((void *)&cmdPoolInfo, 0 ,sizeof(cmdPoolInfo));
+    cmdPoolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    cmdPoolInfo.pNext            = NULL;
+    cmdPoolInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    cmdPoolInfo.queueFamilyIndex = mVkContext->vkGraphicsQueueNodeIndex;
+
+    err = vkCreateCommandPool(mVkContext->vkDevice, &cmdPoolInfo, NULL, &mVkCmdPool);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    VkCommandBufferAllocateInfo cmdAllocInfo;
+    cmdAllocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.pNext              = NULL;
+    cmdAllocInfo.commandPool        = mVkCmdPool;
+    cmdAllocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
     cmdAllocInfo.commandBufferCount = 1;
+
     err = vkAllocateCommandBuffers(mVkContext->vkDevice, &cmdAllocInfo, &mVkAuxCommandBuffer);
     assert(!err);
 
@@ -170,17 +373,6 @@ CommandBufferManager::AllocateVkCmdBuffers(void)
     fenceInfo.pNext = NULL;
     fenceInfo.flags = 0;
 
-    for(uint32_t i = 0; i < GLOVE_NUM_VK_COMMAND_BUFFERS; ++i) {
-        mVkCommandBuffers.commandBufferState[i] = CMD_BUFFER_INITIAL_STATE;
-
-        err = vkCreateFence(mVkContext->vkDevice, &fenceInfo, NULL, &mVkCommandBuffers.fence[i]);
-        assert(!err);
-
-        if(err != VK_SUCCESS) {
-            return false;
-        }
-    }
-
     err = vkCreateFence(mVkContext->vkDevice, &fenceInfo, NULL, &mVkAuxFence);
     assert(!err);
 
@@ -188,43 +380,32 @@ CommandBufferManager::AllocateVkCmdBuffers(void)
         return false;
     }
 
-    return true;
+    mActiveFrame = 0;
+    mFrames[mActiveFrame].serial = ++mFrameSerial;
+
+    return CreateVkTimestampQueryPool() && CreateVkSemaphores();
 }
 
-void
-CommandBufferManager::FreeResources(void)
+VkDescriptorSet
+CommandBufferManager::AllocateVkDescriptorSet(VkDescriptorSetLayout layout)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    for(std::vector<resourceBase_t *>::iterator it = mReferencedResources.begin(); it != mReferencedResources.end();) {
-        const resourceBase_t *resourceBase = *it;
-        if(!resourceBase->mRefCount) {
-            switch(resourceBase->mType) {
-            case RESOURCE_TYPE_SHADER: {
-                referencedResource_t<VkShaderModule> *resource = (referencedResource_t<VkShaderModule> *)resourceBase;
-                vkDestroyShaderModule(mVkContext->vkDevice, resource->mResourcePtr, NULL);
-                } break;
-            case RESOURCE_TYPE_PIPELINE_LAYOUT: {
-                referencedResource_t<VkPipelineLayout> *resource = (referencedResource_t<VkPipelineLayout> *)resourceBase;
-                vkDestroyPipelineLayout(mVkContext->vkDevice, resource->mResourcePtr, NULL);
-                } break;
-            case RESOURCE_TYPE_DESC_POOL: {
-                referencedResource_t<VkDescriptorPool> *resource = (referencedResource_t<VkDescriptorPool> *)resourceBase;
-                vkDestroyDescriptorPool(mVkContext->vkDevice, resource->mResourcePtr, NULL);
-                } break;
-            case RESOURCE_TYPE_DESC_SET_LAYOUT: {
-                referencedResource_t<VkDescriptorSetLayout> *resource = (referencedResource_t<VkDescriptorSetLayout> *)resourceBase;
-                vkDestroyDescriptorSetLayout(mVkContext->vkDevice, resource->mResourcePtr, NULL);
-                } break;
-            default: NOT_REACHED(); break;
-            }
-
-            delete *it;
-            it = mReferencedResources.erase(it);
-        } else {
-            ++it;
-        }
+    VkDescriptorSetAllocateInfo descAllocInfo;
+    memset((void *)&descAllocInfo, 0, sizeof(descAllocInfo));
+    descAllocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    descAllocInfo.pNext              = NULL;
+    descAllocInfo.descriptorPool     = mFrames[mActiveFrame].descriptorPool;
+    descAllocInfo.descriptorSetCount = 1;
+    descAllocInfo.pSetLayouts        = &layout;
+
+    /// An exhausted arena is not an error, the caller moves on to the next frame
+    VkDescriptorSet descSet = VK_NULL_HANDLE;
+    if(vkAllocateDescriptorSets(mVkContext->vkDevice, &descAllocInfo, &descSet) != VK_SUCCESS) {
+        return VK_NULL_HANDLE;
     }
+
+    return descSet;
 }
 
 bool
@@ -232,27 +413,35 @@ CommandBufferManager::BeginVkDrawCommandBuffer(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] == CMD_BUFFER_RECORDING_STATE) {
+    frame_t *frame = &mFrames[mActiveFrame];
+
+    if(frame->commandBufferState == CMD_BUFFER_RECORDING_STATE) {
         return true;
     }
 
-    assert(mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] == CMD_BUFFER_INITIAL_STATE ||
-           mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] == CMD_BUFFER_SUBMITED_STATE);
+    assert(frame->commandBufferState == CMD_BUFFER_INITIAL_STATE);
 
     VkCommandBufferBeginInfo cmdBeginInfo;
     cmdBeginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     cmdBeginInfo.pNext            = NULL;
-    cmdBeginInfo.flags            = 0;
+    cmdBeginInfo.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     cmdBeginInfo.pInheritanceInfo = NULL;
 
-    VkResult err = vkBeginCommandBuffer(mVkCommandBuffers.commandBuffer[mActiveCmdBuffer], &cmdBeginInfo);
+    VkResult err = vkBeginCommandBuffer(frame->commandBuffer, &cmdBeginInfo);
     assert(!err);
 
     if(err != VK_SUCCESS) {
         return false;
     }
 
-    mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] = CMD_BUFFER_RECORDING_STATE;
+    if(mVkTimestampQueryPool != VK_NULL_HANDLE) {
+        vkCmdResetQueryPool(frame->commandBuffer, mVkTimestampQueryPool, 2 * mActiveFrame, 2);
+        vkCmdWriteTimestamp(frame->commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, mVkTimestampQueryPool, 2 * mActiveFrame);
+    }
+
+    frame->epoch              = mVkContext->mRetirementQueue->SetSubmitterBusy(this);
+    frame->cpuBegin           = frameClock_t::now();
+    frame->commandBufferState = CMD_BUFFER_RECORDING_STATE;
 
     return true;
 }
@@ -262,16 +451,22 @@ CommandBufferManager::EndVkDrawCommandBuffer(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] == CMD_BUFFER_EXECUTABLE_STATE ||
-       mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] == CMD_BUFFER_INITIAL_STATE) {
+    frame_t *frame = &mFrames[mActiveFrame];
+
+    if(frame->commandBufferState == CMD_BUFFER_EXECUTABLE_STATE ||
+       frame->commandBufferState == CMD_BUFFER_INITIAL_STATE) {
         return;
     }
 
-    assert(mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] == CMD_BUFFER_RECORDING_STATE);
+    assert(frame->commandBufferState == CMD_BUFFER_RECORDING_STATE);
 
-    vkEndCommandBuffer(mVkCommandBuffers.commandBuffer[mActiveCmdBuffer]);
+    if(mVkTimestampQueryPool != VK_NULL_HANDLE) {
+        vkCmdWriteTimestamp(frame->commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mVkTimestampQueryPool, 2 * mActiveFrame + 1);
+    }
+
+    vkEndCommandBuffer(frame->commandBuffer);
 
-    mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] = CMD_BUFFER_EXECUTABLE_STATE;
+    frame->commandBufferState = CMD_BUFFER_EXECUTABLE_STATE;
 }
 
 bool
@@ -279,24 +474,29 @@ CommandBufferManager::SubmitVkDrawCommandBuffer(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] == CMD_BUFFER_INITIAL_STATE) {
+    frame_t *frame = &mFrames[mActiveFrame];
+
+    if(frame->commandBufferState == CMD_BUFFER_INITIAL_STATE) {
         return true;
     }
 
-    assert(mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] == CMD_BUFFER_EXECUTABLE_STATE);
+    assert(frame->commandBufferState == CMD_BUFFER_EXECUTABLE_STATE);
 
     vector<VkSemaphore> pSems;
     vector<VkPipelineStageFlags> pFlags;
-    if(mVkContext->vkSyncItems->auxSemaphoreFlag) {
-        pSems.push_back(mVkContext->vkSyncItems->vkAuxSemaphore);
+    if(mVkSyncItems->auxSemaphoreFlag) {
+        pSems.push_back(mVkSyncItems->vkAuxSemaphore);
         pFlags.push_back(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
     }
-    if(mVkContext->vkSyncItems->acquireSemaphoreFlag) {
-        pSems.push_back(mVkContext->vkSyncItems->vkAcquireSemaphore);
-        pFlags.push_back(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    /// Only the writes to the acquired image have to wait for the presentation engine,
+    /// its layout transition is recorded with the same source stage
+    const bool acquireWait = mVkSyncItems->acquireSemaphoreFlag;
+    if(acquireWait) {
+        pSems.push_back(mVkSyncItems->vkAcquireSemaphore);
+        pFlags.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
     }
-    if(mVkContext->vkSyncItems->drawSemaphoreFlag) {
-        pSems.push_back(mVkContext->vkSyncItems->vkDrawSemaphore);
+    if(mVkSyncItems->drawSemaphoreFlag) {
+        pSems.push_back(mVkSyncItems->vkDrawSemaphore);
         pFlags.push_back(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
     }
 
@@ -305,64 +505,181 @@ CommandBufferManager::SubmitVkDrawCommandBuffer(void)
     submitInfo.pNext                = NULL;
     submitInfo.pWaitDstStageMask    = pFlags.data();
     submitInfo.commandBufferCount   = 1;
-    submitInfo.pCommandBuffers      = &mVkCommandBuffers.commandBuffer[mActiveCmdBuffer];
+    submitInfo.pCommandBuffers      = &frame->commandBuffer;
     submitInfo.waitSemaphoreCount   = pSems.size();
     submitInfo.pWaitSemaphores      = pSems.data();
     submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores    = &mVkContext->vkSyncItems->vkDrawSemaphore;
+    submitInfo.pSignalSemaphores    = &mVkSyncItems->vkDrawSemaphore;
 
-    mVkContext->vkSyncItems->drawSemaphoreFlag    = true;
-    mVkContext->vkSyncItems->auxSemaphoreFlag     = false;
-    mVkContext->vkSyncItems->acquireSemaphoreFlag = false;
+    mVkSyncItems->drawSemaphoreFlag    = true;
+    mVkSyncItems->auxSemaphoreFlag     = false;
+    mVkSyncItems->acquireSemaphoreFlag = false;
 
-    VkResult err = vkQueueSubmit(mVkContext->vkQueue, 1, &submitInfo, mVkCommandBuffers.fence[mActiveCmdBuffer]);
+    VkResult err;
+    {
+        std::lock_guard<std::mutex> lock(mVkContext->mQueueMutex);
+        err = vkQueueSubmit(mVkContext->vkQueue, 1, &submitInfo, frame->fence);
+    }
     assert(!err);
 
     if(err != VK_SUCCESS) {
         return false;
     }
 
-    mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] = CMD_BUFFER_SUBMITED_STATE;
+    frame->commandBufferState = CMD_BUFFER_SUBMITED_STATE;
+    ++mFrameSubmitCount;
+
+    /// The next image is acquired into the semaphore the frame waited on the last time it was
+    /// submitted, which is known to be unsignaled since its fence has been waited for
+    if(acquireWait) {
+        std::swap(frame->acquireSemaphore, mVkSyncItems->vkAcquireSemaphore);
+    }
 
-    mLastSubmittedBuffer = mActiveCmdBuffer;
-    mActiveCmdBuffer = (mActiveCmdBuffer + 1) % GLOVE_NUM_VK_COMMAND_BUFFERS;
+    mLastFrameCpuTime = std::chrono::duration<double, std::milli>(frameClock_t::now() - frame->cpuBegin).count();
+    mFrameCpuTime    += mLastFrameCpuTime;
 
-    mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] = CMD_BUFFER_INITIAL_STATE;
+    /// Recording moves on to the next frame, which is recycled once the GPU is done with it
+    return BeginFrame((mActiveFrame + 1) % GLOVE_NUM_FRAMES_IN_FLIGHT);
+}
+
+bool
+CommandBufferManager::BeginFrame(uint32_t index)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!WaitFrame(index)) {
+        return false;
+    }
+
+    frame_t *frame = &mFrames[index];
+
+    VkResult err = vkResetCommandPool(mVkContext->vkDevice, frame->commandPool, 0);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    err = vkResetDescriptorPool(mVkContext->vkDevice, frame->descriptorPool, 0);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    /// Descriptor sets and ring buffer offsets of the previous use of the frame are invalidated by the new serial
+    frame->serial = ++mFrameSerial;
+    mActiveFrame  = index;
 
     return true;
 }
 
 bool
-CommandBufferManager::WaitLastSubmition(void)
+CommandBufferManager::WaitFrame(uint32_t index)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    VkResult err;
+    frame_t *frame = &mFrames[index];
 
-    if(mLastSubmittedBuffer != GLOVE_NO_BUFFER_TO_WAIT) {
+    if(frame->commandBufferState != CMD_BUFFER_SUBMITED_STATE) {
+        return true;
+    }
 
-        err = vkWaitForFences(mVkContext->vkDevice, 1, &mVkCommandBuffers.fence[mLastSubmittedBuffer], VK_TRUE, GLOVE_FENCE_WAIT_TIMEOUT);
-        assert(!err);
+    VkResult err = vkWaitForFences(mVkContext->vkDevice, 1, &frame->fence, VK_TRUE, GLOVE_FENCE_WAIT_TIMEOUT);
+    assert(!err);
+    ++mFrameFenceWaitCount;
 
-        if(err != VK_SUCCESS) {
-            return false;
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    err = vkResetFences(mVkContext->vkDevice, 1, &frame->fence);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    frame->commandBufferState = CMD_BUFFER_INITIAL_STATE;
+
+    ReadFrameTimestamps(index);
+    UpdateRetirementProgress();
+
+    return true;
+}
+
+void
+CommandBufferManager::ReadFrameTimestamps(uint32_t index)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mVkTimestampQueryPool == VK_NULL_HANDLE) {
+        return;
+    }
+
+    /// The fence of the frame has signaled, so its timestamps are available without waiting
+    uint64_t timestamps[2];
+    if(vkGetQueryPoolResults(mVkContext->vkDevice, mVkTimestampQueryPool, 2 * index, 2, sizeof(timestamps), timestamps,
+                             sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+        return;
+    }
+
+    const uint64_t ticks = ((timestamps[1] & mTimestampMask) - (timestamps[0] & mTimestampMask)) & mTimestampMask;
+    mLastFrameGpuTime = static_cast<double>(ticks) * mTimestampPeriod / 1000000.0;
+    mFrameGpuTime    += mLastFrameGpuTime;
+}
+
+void
+CommandBufferManager::UpdateRetirementProgress(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// Retired objects may be referenced by any frame that began before they were retired
+    bool busy = false;
+    uint64_t oldestEpoch = UINT64_MAX;
+    for(uint32_t i = 0; i < GLOVE_NUM_FRAMES_IN_FLIGHT; ++i) {
+        if(mFrames[i].commandBufferState != CMD_BUFFER_INITIAL_STATE) {
+            busy        = true;
+            oldestEpoch = std::min(oldestEpoch, mFrames[i].epoch);
         }
+    }
+    if(mVkAuxCommandBufferState != CMD_BUFFER_INITIAL_STATE) {
+        busy        = true;
+        oldestEpoch = std::min(oldestEpoch, mVkAuxEpoch);
+    }
 
-        FreeResources();
+    if(busy) {
+        mVkContext->mRetirementQueue->SetSubmitterProgress(this, oldestEpoch);
+    } else {
+        mVkContext->mRetirementQueue->SetSubmitterIdle(this);
+    }
+}
 
-        vkResetFences(mVkContext->vkDevice, 1, &mVkCommandBuffers.fence[mLastSubmittedBuffer]);
-        assert(!err);
+bool
+CommandBufferManager::WaitLastSubmition(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
 
-        if(err != VK_SUCCESS) {
+    for(uint32_t i = 0; i < GLOVE_NUM_FRAMES_IN_FLIGHT; ++i) {
+        if(!WaitFrame(i)) {
             return false;
         }
-
-        mLastSubmittedBuffer = GLOVE_NO_BUFFER_TO_WAIT;
     }
 
     return true;
 }
 
+void
+CommandBufferManager::ResetFrameStatistics(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mFrameSubmitCount    = 0;
+    mFrameFenceWaitCount = 0;
+    mFrameCpuTime        = 0.0;
+    mFrameGpuTime        = 0.0;
+}
+
 bool
 CommandBufferManager::BeginVkAuxCommandBuffer(void)
 {
@@ -376,6 +693,8 @@ CommandBufferManager::BeginVkAuxCommandBuffer(void)
     cmdBeginInfo.flags            = 0;
     cmdBeginInfo.pInheritanceInfo = NULL;
 
+    mVkAuxEpoch = mVkContext->mRetirementQueue->SetSubmitterBusy(this);
+
     VkResult err = vkBeginCommandBuffer(mVkAuxCommandBuffer, &cmdBeginInfo);
     assert(!err);
 
@@ -409,16 +728,16 @@ CommandBufferManager::SubmitVkAuxCommandBuffer(void)
     vector<VkSemaphore> pSems;
     vector<VkPipelineStageFlags> pFlags;
 
-    if(mVkContext->vkSyncItems->auxSemaphoreFlag) {
-        pSems.push_back(mVkContext->vkSyncItems->vkAuxSemaphore);
+    if(mVkSyncItems->auxSemaphoreFlag) {
+        pSems.push_back(mVkSyncItems->vkAuxSemaphore);
         pFlags.push_back(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
     }
-    if(mVkContext->vkSyncItems->acquireSemaphoreFlag) {
-        pSems.push_back(mVkContext->vkSyncItems->vkAcquireSemaphore);
+    if(mVkSyncItems->acquireSemaphoreFlag) {
+        pSems.push_back(mVkSyncItems->vkAcquireSemaphore);
         pFlags.push_back(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
     }
-    if(mVkContext->vkSyncItems->drawSemaphoreFlag) {
-        pSems.push_back(mVkContext->vkSyncItems->vkDrawSemaphore);
+    if(mVkSyncItems->drawSemaphoreFlag) {
+        pSems.push_back(mVkSyncItems->vkDrawSemaphore);
         pFlags.push_back(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
     }
 
@@ -431,19 +750,25 @@ CommandBufferManager::SubmitVkAuxCommandBuffer(void)
     submitInfo.waitSemaphoreCount     = pSems.size();
     submitInfo.pWaitSemaphores        = pSems.data();
     submitInfo.signalSemaphoreCount   = 1;
-    submitInfo.pSignalSemaphores      = &mVkContext->vkSyncItems->vkAuxSemaphore;
+    submitInfo.pSignalSemaphores      = &mVkSyncItems->vkAuxSemaphore;
 
-    mVkContext->vkSyncItems->auxSemaphoreFlag     = true;
-    mVkContext->vkSyncItems->drawSemaphoreFlag    = false;
-    mVkContext->vkSyncItems->acquireSemaphoreFlag = false;
+    mVkSyncItems->auxSemaphoreFlag     = true;
+    mVkSyncItems->drawSemaphoreFlag    = false;
+    mVkSyncItems->acquireSemaphoreFlag = false;
 
-    VkResult err = vkQueueSubmit(mVkContext->vkQueue, 1, &submitInfo, mVkAuxFence);
+    VkResult err;
+    {
+        std::lock_guard<std::mutex> lock(mVkContext->mQueueMutex);
+        err = vkQueueSubmit(mVkContext->vkQueue, 1, &submitInfo, mVkAuxFence);
+    }
     assert(!err);
 
     if(err != VK_SUCCESS) {
         return false;
     }
 
+    ++mFrameSubmitCount;
+
     mVkAuxCommandBufferState = CMD_BUFFER_SUBMITED_STATE;
 
     return true;
@@ -460,15 +785,12 @@ CommandBufferManager::WaitVkAuxCommandBuffer(void)
 
     err = vkWaitForFences(mVkContext->vkDevice, 1, &mVkAuxFence, VK_TRUE, GLOVE_FENCE_WAIT_TIMEOUT);
     assert(!err);
+    ++mFrameFenceWaitCount;
 
     if(err != VK_SUCCESS) {
         return false;
     }
 
-    FreeResources();
-
-    mVkAuxCommandBufferState = CMD_BUFFER_INITIAL_STATE;
-
     err = vkResetFences(mVkContext->vkDevice, 1, &mVkAuxFence);
     assert(!err);
 
@@ -476,5 +798,8 @@ CommandBufferManager::WaitVkAuxCommandBuffer(void)
         return false;
     }
 
+    mVkAuxCommandBufferState = CMD_BUFFER_INITIAL_STATE;
+    UpdateRetirementProgress();
+
     return true;
 }
@@ -25,6 +25,8 @@
 #define __VKCBMANAGER_H__
 
 #include "utils/globals.h"
+#include "retirementQueue.h"
+#include <chrono>
 
 typedef enum {
     CMD_BUFFER_INITIAL_STATE = 0,
@@ -33,79 +35,76 @@ typedef enum {
     CMD_BUFFER_SUBMITED_STATE
 } cmdBufferState_t;
 
-typedef enum {
-    RESOURCE_TYPE_SHADER = 0,
-    RESOURCE_TYPE_PIPELINE_LAYOUT,
-    RESOURCE_TYPE_DESC_POOL,
-    RESOURCE_TYPE_DESC_SET_LAYOUT,
-    RESOURCE_TYPE_DESC_SET,
-    RESOURCE_TYPE_LAST
-} resourceType_t;
-
-class resourceBase_t {
-public:
-
-    uint32_t                        mRefCount;
-    resourceType_t                  mType;
-
-    resourceBase_t(resourceType_t type) : mRefCount(1), mType(type)             { FUN_ENTRY(GL_LOG_TRACE); }
-    virtual ~resourceBase_t()                                                   { FUN_ENTRY(GL_LOG_TRACE); }
-};
-
-template<typename T>
-class referencedResource_t : public resourceBase_t {
-public:
-
-    T                               mResourcePtr;
-
-    referencedResource_t(T resourcePtr, resourceType_t type)
-    : resourceBase_t(type), mResourcePtr(resourcePtr)                           { FUN_ENTRY(GL_LOG_TRACE); }
-};
-
 class CommandBufferManager {
 private:
 
-    typedef struct State {
-        vector<VkCommandBuffer>         commandBuffer;
-        vector<cmdBufferState_t>        commandBufferState;
-        vector<VkFence>                 fence;
-
-        State()  { FUN_ENTRY(GL_LOG_TRACE); }
-        ~State() { FUN_ENTRY(GL_LOG_TRACE); }
-    } State;
+    typedef std::chrono::steady_clock frameClock_t;
+
+    /// Draw commands are recorded into a ring of frames. Every frame owns the
+    /// objects that are recycled once its fence has signaled.
+    typedef struct frame_t {
+        VkCommandPool                   commandPool;
+        VkCommandBuffer                 commandBuffer;
+        cmdBufferState_t                commandBufferState;
+        VkFence                         fence;
+        /// Exchanged with the acquire semaphore of the window surface whenever a submission
+        /// of the frame waits for it, so that no semaphore is acquired into while a wait on it is pending
+        VkSemaphore                     acquireSemaphore;
+        VkDescriptorPool                descriptorPool;
+        uint64_t                        serial;
+        uint64_t                        epoch;
+        frameClock_t::time_point        cpuBegin;
+    } frame_t;
 
-    static CommandBufferManager    *mInstance;
     VkCommandPool                   mVkCmdPool;
+    const
     vkContext_t                    *mVkContext;
 
-    uint32_t                        mActiveCmdBuffer;
-    int32_t                         mLastSubmittedBuffer;
-
-    State                           mVkCommandBuffers;
+    frame_t                         mFrames[GLOVE_NUM_FRAMES_IN_FLIGHT];
+    uint32_t                        mActiveFrame;
+    uint64_t                        mFrameSerial;
 
     VkCommandBuffer                 mVkAuxCommandBuffer;
     cmdBufferState_t                mVkAuxCommandBufferState;
     VkFence                         mVkAuxFence;
-
-    std::vector<resourceBase_t *>   mReferencedResources;
-
-    void FreeResources(void);
+    uint64_t                        mVkAuxEpoch;
+
+    /// Submissions are chained with the semaphores of the window surface while
+    /// rendering to it, and with semaphores private to the manager otherwise
+    vkSyncItems_t                   mPrivateSyncItems;
+    vkSyncItems_t                  *mVkSyncItems;
+
+    /// Two timestamps are written by every frame, if the graphics queue supports them
+    VkQueryPool                     mVkTimestampQueryPool;
+    double                          mTimestampPeriod;
+    uint64_t                        mTimestampMask;
+
+    uint32_t                        mFrameSubmitCount;
+    uint32_t                        mFrameFenceWaitCount;
+    double                          mFrameCpuTime;
+    double                          mFrameGpuTime;
+    double                          mLastFrameCpuTime;
+    double                          mLastFrameGpuTime;
+
+    bool CreateVkSemaphores(void);
+    bool CreateVkTimestampQueryPool(void);
+    bool CreateVkFrame(frame_t *frame);
+    void DestroyVkFrame(frame_t *frame);
+    bool BeginFrame(uint32_t index);
+    bool WaitFrame(uint32_t index);
+    void ReadFrameTimestamps(uint32_t index);
+    void UpdateRetirementProgress(void);
 
 public:
 // Constructor
-    CommandBufferManager(vkContext_t *context = nullptr);
+    CommandBufferManager(const vkContext_t *context);
 
 // Destructor
     ~CommandBufferManager();
 
-// Get Functions
-    static CommandBufferManager *GetCommandBufferManager(vkContext_t *context);
-
-// Reset Functions
-    static void                  ResetCommandBufferManager(void);
-
 // Allocate Functions
     bool AllocateVkCmdBuffers(void);
+    VkDescriptorSet AllocateVkDescriptorSet(VkDescriptorSetLayout layout);
 
 // Begin Functions
     bool BeginVkAuxCommandBuffer(void);
@@ -123,53 +122,27 @@ public:
     bool WaitLastSubmition(void);
     bool WaitVkAuxCommandBuffer(void);
 
+// Reset Functions
+    void ResetFrameStatistics(void);
+
+// Set Functions
+    inline void            SetVkSyncItems(vkSyncItems_t *syncItems)             { FUN_ENTRY(GL_LOG_TRACE); mVkSyncItems = syncItems ? syncItems : &mPrivateSyncItems; }
+
 // Get Functions
-    inline VkCommandBuffer GetActiveCommandBuffer(void)                   const { FUN_ENTRY(GL_LOG_TRACE); return mVkCommandBuffers.commandBuffer[mActiveCmdBuffer]; }
+    inline VkCommandBuffer GetActiveCommandBuffer(void)                   const { FUN_ENTRY(GL_LOG_TRACE); return mFrames[mActiveFrame].commandBuffer; }
+    inline uint32_t        GetActiveFrameIndex(void)                      const { FUN_ENTRY(GL_LOG_TRACE); return mActiveFrame; }
+    inline uint64_t        GetActiveFrameSerial(void)                     const { FUN_ENTRY(GL_LOG_TRACE); return mFrames[mActiveFrame].serial; }
     inline VkCommandBuffer GetAuxCommandBuffer(void)                      const { FUN_ENTRY(GL_LOG_TRACE); return mVkAuxCommandBuffer; }
-
-// Resource Functions
-    template<typename T>
-    void RefResource(T resource, resourceType_t type)
-    {
-        FUN_ENTRY(GL_LOG_TRACE);
-
-        int index = LocateResource(resource);
-        if(index == -1) {
-            mReferencedResources.push_back(new referencedResource_t<T>(resource, type));
-        } else {
-            ++mReferencedResources[index]->mRefCount;
-        }
-    }
-
-    template<typename T>
-    void UnrefResouce(T resource)
-    {
-        FUN_ENTRY(GL_LOG_TRACE);
-
-        int index = LocateResource(resource);
-        if(index != -1) {
-            assert(mReferencedResources[index]->mRefCount);
-            --mReferencedResources[index]->mRefCount;
-        }
-    }
-
-    template<typename T>
-    int LocateResource(T resource)
-    {
-        FUN_ENTRY(GL_LOG_TRACE);
-
-        assert(resource);
-
-        for(uint32_t i = 0; i < mReferencedResources.size(); ++i) {
-            referencedResource_t<T> *res = (referencedResource_t<T> *)mReferencedResources[i];
-            assert(res);
-            if(res->mResourcePtr == resource) {
-                return i;
-            }
-        }
-
-        return -1;
-    }
+    inline uint32_t        GetFrameSubmitCount(void)                      const { FUN_ENTRY(GL_LOG_TRACE); return mFrameSubmitCount; }
+    inline uint32_t        GetFrameFenceWaitCount(void)                   const { FUN_ENTRY(GL_LOG_TRACE); return mFrameFenceWaitCount; }
+    inline double          GetFrameCpuTime(void)                          const { FUN_ENTRY(GL_LOG_TRACE); return mFrameCpuTime; }
+    inline double          GetFrameGpuTime(void)                          const { FUN_ENTRY(GL_LOG_TRACE); return mFrameGpuTime; }
+    inline double          GetLastFrameCpuTime(void)                      const { FUN_ENTRY(GL_LOG_TRACE); return mLastFrameCpuTime; }
+    inline double          GetLastFrameGpuTime(void)                      const { FUN_ENTRY(GL_LOG_TRACE); return mLastFrameGpuTime; }
+
+// Is Functions
+    inline bool            IsDrawCommandBufferRecording(void)             const { FUN_ENTRY(GL_LOG_TRACE); return mFrames[mActiveFrame].commandBufferState == CMD_BUFFER_RECORDING_STATE; }
+    inline bool            IsGpuTimingSupported(void)                     const { FUN_ENTRY(GL_LOG_TRACE); return mVkTimestampQueryPool != VK_NULL_HANDLE; }
 };
 
 #endif // __VKCBMANAGER_H__
@@ -29,6 +29,10 @@
 
 #include "context.h"
 #include "cbManager.h"
+#include "memoryAllocator.h"
+#include "retirementQueue.h"
+#include <unistd.h>
+#include <sys/stat.h>
 
 namespace vulkanAPI {
 
@@ -45,6 +49,9 @@ static       char **enabledInstanceLayers           = NULL;
 
 static vkContext_t GloveVkContext;
 
+thread_local CommandBufferManager *vkContext_t::mCommandBufferManager = nullptr;
+thread_local UploadQueue          *vkContext_t::mUploadQueue          = nullptr;
+
 static bool InitVkLayers(uint32_t* nLayers);
 static bool CheckVkInstanceExtensions(void);
 static bool CheckVkDeviceExtensions(void);
@@ -52,8 +59,13 @@ static bool CreateVkInstance(void);
 static bool EnumerateVkGpus(void);
 static bool InitVkQueueFamilyIndex(void);
 static bool CreateVkDevice(void);
-static bool CreateVkCommandBuffers(void);
+static bool CreateVkMemoryAllocator(void);
+static bool CreateVkRetirementQueue(void);
 static bool CreateVkSemaphores(void);
+static bool CreateVkPipelineCache(void);
+static void DestroyVkPipelineCache(void);
+static bool ReadVkPipelineCacheData(const string &filename, vector<uint8_t> &data);
+static string GetVkPipelineCacheFilename(void);
 static void InitVkQueue(void);
 
 static bool
@@ -293,6 +305,21 @@ InitVkQueueFamilyIndex(void)
         }
     }
 
+    /// A transfer only family is usually backed by a DMA engine that runs alongside rendering.
+    /// Only families that can copy at texel granularity are considered, so that any region can be uploaded.
+    GloveVkContext.vkTransferQueueNodeIndex = GloveVkContext.vkGraphicsQueueNodeIndex;
+    if(GLOVE_USE_DEDICATED_TRANSFER_QUEUE) {
+        for(uint32_t j = 0; j < queueFamilyCount; ++j) {
+            const VkExtent3D &granularity = queueProperties[j].minImageTransferGranularity;
+            if((queueProperties[j].queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+              !(queueProperties[j].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) &&
+               granularity.width == 1 && granularity.height == 1 && granularity.depth == 1) {
+                GloveVkContext.vkTransferQueueNodeIndex = j;
+                break;
+            }
+        }
+    }
+
     delete[] queueProperties;
     return i < queueFamilyCount ? true : false;
 }
@@ -303,20 +330,23 @@ CreateVkDevice(void)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     float queue_priorities[1] = {0.0};
-    VkDeviceQueueCreateInfo queueInfo;
-    queueInfo.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    queueInfo.pNext            = NULL;
-    queueInfo.flags            = 0;
-    queueInfo.queueCount       = 1;
-    queueInfo.pQueuePriorities = queue_priorities;
-    queueInfo.queueFamilyIndex = GloveVkContext.vkGraphicsQueueNodeIndex;
+    VkDeviceQueueCreateInfo queueInfo[2];
+    queueInfo[0].sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueInfo[0].pNext            = NULL;
+    queueInfo[0].flags            = 0;
+    queueInfo[0].queueCount       = 1;
+    queueInfo[0].pQueuePriorities = queue_priorities;
+    queueInfo[0].queueFamilyIndex = GloveVkContext.vkGraphicsQueueNodeIndex;
+
+    queueInfo[1]                  = queueInfo[0];
+    queueInfo[1].queueFamilyIndex = GloveVkContext.vkTransferQueueNodeIndex;
 
     VkDeviceCreateInfo deviceInfo;
     deviceInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     deviceInfo.pNext                   = NULL;
     deviceInfo.flags                   = 0;
-    deviceInfo.queueCreateInfoCount    = 1;
-    deviceInfo.pQueueCreateInfos       = &queueInfo;
+    deviceInfo.queueCreateInfoCount    = GloveVkContext.vkTransferQueueNodeIndex != GloveVkContext.vkGraphicsQueueNodeIndex ? 2 : 1;
+    deviceInfo.pQueueCreateInfos       = queueInfo;
     deviceInfo.enabledLayerCount       = 0;
     deviceInfo.ppEnabledLayerNames     = NULL;
     deviceInfo.enabledExtensionCount   = ARRAY_SIZE(requiredDeviceExtensions);
@@ -330,20 +360,23 @@ CreateVkDevice(void)
 }
 
 static bool
-CreateVkCommandBuffers(void)
+CreateVkMemoryAllocator(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    GloveVkContext.mCommandBufferManager = CommandBufferManager::GetCommandBufferManager(&GloveVkContext);
-    if(!GloveVkContext.mCommandBufferManager) {
-        return false;
-    }
+    GloveVkContext.mMemoryAllocator = new MemoryAllocator(&GloveVkContext);
 
-    if(!GloveVkContext.mCommandBufferManager->AllocateVkCmdBuffers()) {
-        return false;
-    }
+    return GloveVkContext.mMemoryAllocator != nullptr;
+}
 
-    return true;
+static bool
+CreateVkRetirementQueue(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    GloveVkContext.mRetirementQueue = new RetirementQueue(&GloveVkContext);
+
+    return GloveVkContext.mRetirementQueue != nullptr;
 }
 
 static bool
@@ -388,6 +421,175 @@ CreateVkSemaphores(void)
     return true;
 }
 
+static string
+GetVkPipelineCacheFilename(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// Unless overridden, the cache is stored under the cache directory of the user,
+    /// as defined by the XDG base directory specification. Without one it is not stored.
+    const char *directory = getenv("GLOVE_PIPELINE_CACHE_DIR");
+    if(directory && *directory) {
+        return string(directory) + "/" + GLOVE_PIPELINE_CACHE_FILENAME;
+    }
+
+    string cacheHome;
+    const char *xdgCacheHome = getenv("XDG_CACHE_HOME");
+    const char *home         = getenv("HOME");
+    if(xdgCacheHome && *xdgCacheHome) {
+        cacheHome = xdgCacheHome;
+    } else if(home && *home) {
+        cacheHome = string(home) + "/.cache";
+    } else {
+        return string();
+    }
+
+    return cacheHome + "/" + GLOVE_PIPELINE_CACHE_DIRECTORY + "/" + GLOVE_PIPELINE_CACHE_FILENAME;
+}
+
+static void
+CreateVkPipelineCacheDirectories(const string &filename)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// Existing directories are fine, any other failure shows up as a failed write
+    for(size_t pos = filename.find('/', 1); pos != string::npos; pos = filename.find('/', pos + 1)) {
+        mkdir(filename.substr(0, pos).c_str(), 0755);
+    }
+}
+
+static bool
+ReadVkPipelineCacheData(const string &filename, vector<uint8_t> &data)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    data.clear();
+
+    ifstream file(filename, ios::in | ios::binary);
+    if(!file.is_open()) {
+        return false;
+    }
+    data.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+
+    /// Header of VK_PIPELINE_CACHE_HEADER_VERSION_ONE:
+    /// length, version, vendorID, deviceID and pipelineCacheUUID
+    const size_t headerSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+    if(data.size() < headerSize) {
+        data.clear();
+        return false;
+    }
+
+    uint32_t header[4];
+    memcpy(header, data.data(), sizeof(header));
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(GloveVkContext.vkGpus[0], &properties);
+
+    /// Data written by another device or driver version is discarded
+    if(header[0] < headerSize                               ||
+       header[1] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE    ||
+       header[2] != properties.vendorID                     ||
+       header[3] != properties.deviceID                     ||
+       memcmp(data.data() + sizeof(header), properties.pipelineCacheUUID, VK_UUID_SIZE)) {
+        data.clear();
+        return false;
+    }
+
+    return true;
+}
+
+static bool
+CreateVkPipelineCache(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    vector<uint8_t> data;
+    const string filename = GetVkPipelineCacheFilename();
+    if(GLOVE_PERSISTENT_PIPELINE_CACHE && !filename.empty()) {
+        ReadVkPipelineCacheData(filename, data);
+    }
+
+    VkPipelineCacheCreateInfo info;
+    info.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    info.pNext           = NULL;
+    info.flags           = 0;
+    info.initialDataSize = data.size();
+    info.pInitialData    = data.size() ? data.data() : NULL;
+
+    VkResult err = vkCreatePipelineCache(GloveVkContext.vkDevice, &info, NULL, &GloveVkContext.vkPipelineCache);
+    assert(!err);
+
+    return (err == VK_SUCCESS);
+}
+
+static void
+DestroyVkPipelineCache(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(GloveVkContext.vkPipelineCache == VK_NULL_HANDLE) {
+        return;
+    }
+
+    /// No pipelines are created anymore, so the caches of released precompiled programs can be merged
+    vector<VkPipelineCache> &releasedCaches = GloveVkContext.vkReleasedPipelineCaches;
+    if(!releasedCaches.empty()) {
+        vkMergePipelineCaches(GloveVkContext.vkDevice, GloveVkContext.vkPipelineCache,
+                              static_cast<uint32_t>(releasedCaches.size()), releasedCaches.data());
+        for(const auto &cache : releasedCaches) {
+            vkDestroyPipelineCache(GloveVkContext.vkDevice, cache, NULL);
+        }
+        releasedCaches.clear();
+    }
+
+    const string filename = GetVkPipelineCacheFilename();
+    if(GLOVE_PERSISTENT_PIPELINE_CACHE && !filename.empty()) {
+        /// Another process may have stored its pipelines in the meantime, keep them too
+        vector<uint8_t> data;
+        if(ReadVkPipelineCacheData(filename, data)) {
+            VkPipelineCacheCreateInfo info;
+            info.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+            info.pNext           = NULL;
+            info.flags           = 0;
+            info.initialDataSize = data.size();
+            info.pInitialData    = data.data();
+
+            VkPipelineCache storedCache;
+            if(vkCreatePipelineCache(GloveVkContext.vkDevice, &info, NULL, &storedCache) == VK_SUCCESS) {
+                vkMergePipelineCaches(GloveVkContext.vkDevice, GloveVkContext.vkPipelineCache, 1, &storedCache);
+                vkDestroyPipelineCache(GloveVkContext.vkDevice, storedCache, NULL);
+            }
+        }
+
+        size_t size = 0;
+        VkResult err = vkGetPipelineCacheData(GloveVkContext.vkDevice, GloveVkContext.vkPipelineCache, &size, NULL);
+        if(err == VK_SUCCESS && size) {
+            data.resize(size);
+            err = vkGetPipelineCacheData(GloveVkContext.vkDevice, GloveVkContext.vkPipelineCache, &size, data.data());
+        }
+
+        /// Write to a temporary file and rename it, so that readers never see a partial cache
+        if(err == VK_SUCCESS && size) {
+            CreateVkPipelineCacheDirectories(filename);
+
+            const string tmpFilename = filename + "." + to_string(getpid()) + ".tmp";
+
+            ofstream file(tmpFilename, ios::out | ios::binary | ios::trunc);
+            if(file.is_open()) {
+                file.write(reinterpret_cast<const char *>(data.data()), size);
+                file.close();
+
+                if(file.fail() || rename(tmpFilename.c_str(), filename.c_str())) {
+                    remove(tmpFilename.c_str());
+                }
+            }
+        }
+    }
+
+    vkDestroyPipelineCache(GloveVkContext.vkDevice, GloveVkContext.vkPipelineCache, NULL);
+    GloveVkContext.vkPipelineCache = VK_NULL_HANDLE;
+}
+
 static void
 InitVkQueue(void)
 {
@@ -397,6 +599,11 @@ InitVkQueue(void)
                      GloveVkContext.vkGraphicsQueueNodeIndex,
                      0,
                      &GloveVkContext.vkQueue);
+
+    vkGetDeviceQueue(GloveVkContext.vkDevice,
+                     GloveVkContext.vkTransferQueueNodeIndex,
+                     0,
+                     &GloveVkContext.vkTransferQueue);
 }
 
 vkContext_t *
@@ -418,7 +625,9 @@ InitContext()
         !InitVkQueueFamilyIndex()     ||
         !CheckVkDeviceExtensions()    ||
         !CreateVkDevice()             ||
-        !CreateVkCommandBuffers()     ||
+        !CreateVkPipelineCache()      ||
+        !CreateVkMemoryAllocator()    ||
+        !CreateVkRetirementQueue()    ||
         !CreateVkSemaphores()          ) {
           return false;
     }
@@ -432,8 +641,15 @@ TerminateContext()
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    GloveVkContext.mCommandBufferManager->ResetCommandBufferManager();
-    GloveVkContext.mCommandBufferManager = nullptr;
+    /// The command buffer managers and upload queues are owned by the contexts,
+    /// which are all destroyed by now. Retired allocations are returned to the
+    /// allocator by the retirement queue.
+    SafeDelete(GloveVkContext.mRetirementQueue);
+
+    if(GLOVE_DUMP_MEMORY_STATISTICS) {
+        GloveVkContext.mMemoryAllocator->DumpStatistics();
+    }
+    SafeDelete(GloveVkContext.mMemoryAllocator);
 
     if(GloveVkContext.vkSyncItems->vkAcquireSemaphore != VK_NULL_HANDLE) {
         vkDestroySemaphore(GloveVkContext.vkDevice, GloveVkContext.vkSyncItems->vkAcquireSemaphore, NULL);
@@ -452,6 +668,7 @@ TerminateContext()
 
     if(GloveVkContext.vkDevice != VK_NULL_HANDLE ) {
         vkDeviceWaitIdle(GloveVkContext.vkDevice);
+        DestroyVkPipelineCache();
         vkDestroyDevice(GloveVkContext.vkDevice, NULL);
         vkDestroyInstance(GloveVkContext.vkInstance, NULL);
     }
@@ -27,6 +27,7 @@
  */
 
 #include "framebuffer.h"
+#include "retirementQueue.h"
 
 namespace vulkanAPI {
 
@@ -50,7 +51,7 @@ Framebuffer::Release(void)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     if(mVkFramebuffer != VK_NULL_HANDLE) {
-        vkDestroyFramebuffer(mVkContext->vkDevice, mVkFramebuffer, NULL);
+        mVkContext->mRetirementQueue->RetireResource(mVkFramebuffer, RESOURCE_TYPE_FRAMEBUFFER);
         mVkFramebuffer = VK_NULL_HANDLE;
     }
 }
@@ -27,17 +27,27 @@
  *  them as parameters to certain commands.
  *  Images are represented by VkImage handles.
  *
+ *  The layout of every subresource is tracked along with its pending writes
+ *  and the stages that last accessed it, so that layout transitions are
+ *  recorded as barriers into the command buffer that uses the image, with
+ *  the exact source scope, and only for subresources that actually need one.
+ *
  */
 
 #include "image.h"
 #include "context/context.h"
+#include "retirementQueue.h"
 
 namespace vulkanAPI {
 
+static const VkAccessFlags writeAccessFlags = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                              VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+                                              VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
 Image::Image(const vkContext_t *vkContext)
 : mVkContext(vkContext), mVkImage(VK_NULL_HANDLE), mVkFormat(VK_FORMAT_UNDEFINED), mVkImageType(VK_IMAGE_TYPE_2D),
 mVkImageUsage(VK_IMAGE_USAGE_FLAG_BITS_MAX_ENUM), mVkImageLayout(VK_IMAGE_LAYOUT_UNDEFINED),
-mVkImageTiling(VK_IMAGE_TILING_LINEAR), mVkImageTarget(VK_IMAGE_TARGET_2D),
+mVkImageTiling(VK_IMAGE_TILING_OPTIMAL), mVkImageTarget(VK_IMAGE_TARGET_2D),
 mVkSampleCount(VK_SAMPLE_COUNT_1_BIT), mVkSharingMode(VK_SHARING_MODE_EXCLUSIVE),
 mWidth(0), mHeight(0), mMipLevels(1), mLayers(1), mDelete(true)
 {
@@ -59,7 +69,7 @@ Image::Release(void)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     if(mVkImage != VK_NULL_HANDLE) {
-        vkDestroyImage(mVkContext->vkDevice, mVkImage, NULL);
+        mVkContext->mRetirementQueue->RetireResource(mVkImage, RESOURCE_TYPE_IMAGE);
         mVkImage = VK_NULL_HANDLE;
     }
 
@@ -68,6 +78,8 @@ Image::Release(void)
     mMipLevels  = 1;
     mLayers     = 1;
     mDelete     = true;
+
+    mSubresourceStates.clear();
 }
 
 bool
@@ -92,8 +104,10 @@ Image::Create()
     info.sharingMode    = mVkSharingMode;
     info.initialLayout  = mVkImageLayout;
 
-    info.queueFamilyIndexCount = 0;
-    info.pQueueFamilyIndices   = NULL;
+    /// Concurrent images are shared between the graphics and the transfer queue families
+    const uint32_t queueFamilyIndices[2] = { mVkContext->vkGraphicsQueueNodeIndex, mVkContext->vkTransferQueueNodeIndex };
+    info.queueFamilyIndexCount = mVkSharingMode == VK_SHARING_MODE_CONCURRENT ? 2 : 0;
+    info.pQueueFamilyIndices   = mVkSharingMode == VK_SHARING_MODE_CONCURRENT ? queueFamilyIndices : NULL;
 
     VkResult err = vkCreateImage(mVkContext->vkDevice, &info, NULL, &mVkImage);
     assert(!err);
@@ -102,12 +116,13 @@ Image::Create()
     mLayers = info.arrayLayers;
 
     CreateImageSubresourceRange();
+    InitSubresourceStates();
 
     return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
 }
 
 void
-Image::CreateBufferImageCopy(int32_t offsetX, int32_t offsetY, uint32_t extentWidth, uint32_t extentHeight, uint32_t miplevel, uint32_t layer, uint32_t layerCount)
+Image::CreateBufferImageCopy(int32_t offsetX, int32_t offsetY, uint32_t extentWidth, uint32_t extentHeight, uint32_t miplevel, uint32_t layer, uint32_t layerCount, VkDeviceSize bufferOffset)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
@@ -121,7 +136,7 @@ Image::CreateBufferImageCopy(int32_t offsetX, int32_t offsetY, uint32_t extentWi
     mVkBufferImageCopy.imageExtent.width               = extentWidth;
     mVkBufferImageCopy.imageExtent.height              = extentHeight;
     mVkBufferImageCopy.imageExtent.depth               = 1;
-    mVkBufferImageCopy.bufferOffset                    = 0;
+    mVkBufferImageCopy.bufferOffset                    = bufferOffset;
     mVkBufferImageCopy.bufferRowLength                 = 0;
     mVkBufferImageCopy.bufferImageHeight               = 0;
 }
@@ -131,7 +146,8 @@ Image::CopyBufferToImage(VkCommandBuffer *activeCmdBuffer, VkBuffer srcBuffer)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    vkCmdCopyBufferToImage(*activeCmdBuffer, srcBuffer, mVkImage, mVkImageLayout, 1, &mVkBufferImageCopy);
+    const subresourceState_t *state = &mSubresourceStates[mVkBufferImageCopy.imageSubresource.baseArrayLayer * mMipLevels + mVkBufferImageCopy.imageSubresource.mipLevel];
+    vkCmdCopyBufferToImage(*activeCmdBuffer, srcBuffer, mVkImage, state->layout, 1, &mVkBufferImageCopy);
 }
 
 void
@@ -139,7 +155,8 @@ Image::CopyImageToBuffer(VkCommandBuffer *activeCmdBuffer, VkBuffer srcBuffer)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    vkCmdCopyImageToBuffer(*activeCmdBuffer, mVkImage, mVkImageLayout, srcBuffer, 1, &mVkBufferImageCopy);
+    const subresourceState_t *state = &mSubresourceStates[mVkBufferImageCopy.imageSubresource.baseArrayLayer * mMipLevels + mVkBufferImageCopy.imageSubresource.mipLevel];
+    vkCmdCopyImageToBuffer(*activeCmdBuffer, mVkImage, state->layout, srcBuffer, 1, &mVkBufferImageCopy);
 }
 
 void
@@ -150,6 +167,14 @@ Image::BlitImage(VkCommandBuffer *activeCmdBuffer, VkImageLayout srcImageLayout,
     vkCmdBlitImage(*activeCmdBuffer, GetImage(), srcImageLayout, dstImage, dstImageLayout, 1, imageBlit, imageFilter);
 }
 
+void
+Image::CopyImage(VkCommandBuffer *activeCmdBuffer, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout, const VkImageCopy* imageCopy)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    vkCmdCopyImage(*activeCmdBuffer, GetImage(), srcImageLayout, dstImage, dstImageLayout, 1, imageCopy);
+}
+
 void
 Image::CreateImageSubresourceRange()
 {
@@ -186,129 +211,193 @@ Image::ModifyImageSubresourceRange(uint32_t baseMipLevel, uint32_t levelCount, u
 }
 
 void
-Image::ModifyImageLayout(VkCommandBuffer *activeCmdBuffer, VkImageLayout newImageLayout)
+Image::InitSubresourceStates(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    VkImageLayout oldImageLayout = mVkImageLayout;
-
-    VkImageMemoryBarrier imageMemoryBarrier;
-    imageMemoryBarrier.sType                = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    imageMemoryBarrier.pNext                = NULL;
-    imageMemoryBarrier.oldLayout            = oldImageLayout;
-    imageMemoryBarrier.newLayout            = newImageLayout;
-    imageMemoryBarrier.srcQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
-    imageMemoryBarrier.dstQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
-    imageMemoryBarrier.image                = mVkImage;
-    imageMemoryBarrier.subresourceRange     = mVkImageSubresourceRange;
-
-    // Source layouts (old)
-    // Source access mask controls actions that have to be finished on the old layout
-    // before it will be transitioned to the new layout
-    switch(oldImageLayout) {
-    case VK_IMAGE_LAYOUT_PREINITIALIZED:
-            // Image is preinitialized
-            // Only valid as initial layout for linear images, preserves memory contents
-            // Make sure host writes have been finished
-            imageMemoryBarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
-            break;
-
-    case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
-            // Image is a color attachment
-            // Make sure any writes to the color buffer have been finished
-            imageMemoryBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-            break;
-
-    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
-            // Image is a depth/stencil attachment
-            // Make sure any writes to the depth/stencil buffer have been finished
-            imageMemoryBarrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-            break;
+    subresourceState_t state;
+    state.layout = mVkImageLayout;
+    GetLayoutUsage(mVkImageLayout, &state.access, &state.stages);
+    state.access &= writeAccessFlags;
 
-    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
-            // Image is a transfer source
-            // Make sure any reads from the image have been finished
-            imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-            break;
+    /// Images of the presentation engine are acquired with a semaphore that is waited
+    /// for at the color attachment output stage, their first transition chains with it
+    if(!mDelete) {
+        state.stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    }
 
-    case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
-            // Image is a transfer destination
-            // Make sure any writes to the image have been finished
-            imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            break;
+    mSubresourceStates.assign(mMipLevels * mLayers, state);
+}
 
-    case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
-            // Image is read by a shader
-            // Make sure any shader reads from the image have been finished
-            imageMemoryBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-            break;
+void
+Image::GetLayoutUsage(VkImageLayout layout, VkAccessFlags *access, VkPipelineStageFlags *stages)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
 
+    switch(layout) {
     case VK_IMAGE_LAYOUT_UNDEFINED:
-    default:
-            // Image layout is undefined (or does not matter)
-            // Only valid as initial layout
-            // No flags required, listed only for completeness
-            imageMemoryBarrier.srcAccessMask = 0;
-            break;
-    }
-
-    // Target layouts (new)
-    // Destination access mask controls the dependency for the new image layout
-    switch(newImageLayout) {
-    case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
-        // Image will be used as a transfer destination
-        // Make sure any writes to the image have been finished
-        imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        *access = 0;
+        *stages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
         break;
-
-    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
-        // Image will be used as a transfer source
-        // Make sure any reads from and writes to the image have been finished
-        imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    case VK_IMAGE_LAYOUT_PREINITIALIZED:
+        *access = VK_ACCESS_HOST_WRITE_BIT;
+        *stages = VK_PIPELINE_STAGE_HOST_BIT;
         break;
-
     case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
-        // Image will be used as a color attachment
-        // Make sure any writes to the color buffer have been finished
-        imageMemoryBarrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        *access = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        *stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
         break;
-
     case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
-        // Image layout will be used as a depth/stencil attachment
-        // Make sure any writes to depth/stencil buffer have been finished
-        imageMemoryBarrier.dstAccessMask = imageMemoryBarrier.dstAccessMask | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        *access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        *stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
         break;
-
     case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
-        // Image will be read in a shader (sampler, input attachment)
-        // Make sure any writes to the image have been finished
-        if(imageMemoryBarrier.srcAccessMask == 0) {
-            imageMemoryBarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
-        }
-        imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        *access = VK_ACCESS_SHADER_READ_BIT;
+        *stages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        break;
+    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+        *access = VK_ACCESS_TRANSFER_READ_BIT;
+        *stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        break;
+    case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+        *access = VK_ACCESS_TRANSFER_WRITE_BIT;
+        *stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
         break;
-
     case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
-        imageMemoryBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        *access = 0;
+        *stages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
         break;
-
     case VK_IMAGE_LAYOUT_GENERAL:
-        // Image layout supports all operations
-        imageMemoryBarrier.dstAccessMask = 0;
+        *access = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+        *stages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
         break;
-
     default:
         NOT_REACHED();
+        *access = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+        *stages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
         break;
     }
+}
+
+VkImageLayout
+Image::GetImageLayout(void) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(mSubresourceStates.empty()) {
+        return mVkImageLayout;
+    }
+
+    return mSubresourceStates[mVkImageSubresourceRange.baseArrayLayer * mMipLevels + mVkImageSubresourceRange.baseMipLevel].layout;
+}
+
+void
+Image::SetImage(VkImage image)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    mVkImage = image;
+    mDelete  = false;
+
+    InitSubresourceStates();
+}
+
+void
+Image::SetImageLayout(VkImageLayout layout)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    mVkImageLayout = layout;
+
+    if(mSubresourceStates.empty()) {
+        return;
+    }
+
+    /// The layout has been set by commands recorded elsewhere, which make their
+    /// writes available to all commands that are submitted after them
+    const uint32_t lastLayer = mVkImageSubresourceRange.baseArrayLayer + mVkImageSubresourceRange.layerCount;
+    const uint32_t lastLevel = mVkImageSubresourceRange.baseMipLevel   + mVkImageSubresourceRange.levelCount;
+    assert(lastLayer <= mLayers && lastLevel <= mMipLevels);
+
+    for(uint32_t layer = mVkImageSubresourceRange.baseArrayLayer; layer < lastLayer; ++layer) {
+        for(uint32_t level = mVkImageSubresourceRange.baseMipLevel; level < lastLevel; ++level) {
+            subresourceState_t *state = &mSubresourceStates[layer * mMipLevels + level];
+            state->layout = layout;
+            state->access = 0;
+            state->stages = layout == VK_IMAGE_LAYOUT_UNDEFINED ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        }
+    }
+}
+
+void
+Image::ModifyImageLayout(VkCommandBuffer *activeCmdBuffer, VkImageLayout newImageLayout)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkAccessFlags        dstAccess;
+    VkPipelineStageFlags dstStages;
+    GetLayoutUsage(newImageLayout, &dstAccess, &dstStages);
+
+    const uint32_t lastLayer = mVkImageSubresourceRange.baseArrayLayer + mVkImageSubresourceRange.layerCount;
+    const uint32_t lastLevel = mVkImageSubresourceRange.baseMipLevel   + mVkImageSubresourceRange.levelCount;
+    assert(lastLayer <= mLayers && lastLevel <= mMipLevels);
 
-    // Put barrier on top
-    VkPipelineStageFlags srcStages  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-    VkPipelineStageFlags destStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    VkImageMemoryBarrier imageMemoryBarrier;
+    imageMemoryBarrier.sType                = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageMemoryBarrier.pNext                = NULL;
+    imageMemoryBarrier.newLayout            = newImageLayout;
+    imageMemoryBarrier.dstAccessMask        = dstAccess;
+    imageMemoryBarrier.srcQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.dstQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.image                = mVkImage;
+    imageMemoryBarrier.subresourceRange     = mVkImageSubresourceRange;
+
+    /// Subresources that are already in the new layout without pending writes are left
+    /// alone, consecutive mip levels in the same state share a barrier
+    vector<VkImageMemoryBarrier> imageMemoryBarriers;
+    VkPipelineStageFlags srcStages = 0;
+    for(uint32_t layer = mVkImageSubresourceRange.baseArrayLayer; layer < lastLayer; ++layer) {
+        for(uint32_t level = mVkImageSubresourceRange.baseMipLevel; level < lastLevel; ++level) {
+            subresourceState_t *state = &mSubresourceStates[layer * mMipLevels + level];
+            if(state->layout == newImageLayout && !state->access) {
+                continue;
+            }
+
+            srcStages |= state->stages;
+
+            VkImageMemoryBarrier *last = imageMemoryBarriers.empty() ? NULL : &imageMemoryBarriers.back();
+            if(last && last->oldLayout                        == state->layout &&
+                       last->srcAccessMask                    == state->access &&
+                       last->subresourceRange.baseArrayLayer  == layer         &&
+                       last->subresourceRange.baseMipLevel + last->subresourceRange.levelCount == level) {
+                ++last->subresourceRange.levelCount;
+            } else {
+                imageMemoryBarrier.oldLayout                       = state->layout;
+                imageMemoryBarrier.srcAccessMask                   = state->access;
+                imageMemoryBarrier.subresourceRange.baseMipLevel   = level;
+                imageMemoryBarrier.subresourceRange.levelCount     = 1;
+                imageMemoryBarrier.subresourceRange.baseArrayLayer = layer;
+                imageMemoryBarrier.subresourceRange.layerCount     = 1;
+                imageMemoryBarriers.push_back(imageMemoryBarrier);
+            }
+
+            state->layout = newImageLayout;
+            state->access = dstAccess & writeAccessFlags;
+            state->stages = dstStages;
+
+            /// Presented images are acquired again with a semaphore waited for at the color attachment output stage
+            if(newImageLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR) {
+                state->stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            }
+        }
+    }
 
-    vkCmdPipelineBarrier(*activeCmdBuffer, srcStages, destStages, 0, 0, NULL, 0, NULL, 1, &imageMemoryBarrier);
+    if(imageMemoryBarriers.empty()) {
+        return;
+    }
 
-    mVkImageLayout = newImageLayout;
+    vkCmdPipelineBarrier(*activeCmdBuffer, srcStages, dstStages, 0, 0, NULL, 0, NULL,
+                         imageMemoryBarriers.size(), imageMemoryBarriers.data());
 }
 
 }
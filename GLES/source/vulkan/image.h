@@ -43,6 +43,14 @@ public:
 
 private:
 
+    /// Layout of a subresource, along with the writes that have not been made available
+    /// yet and the pipeline stages of its last accesses
+    typedef struct subresourceState_t {
+        VkImageLayout                 layout;
+        VkAccessFlags                 access;
+        VkPipelineStageFlags          stages;
+    } subresourceState_t;
+
     const
     vkContext_t *                     mVkContext;
 
@@ -64,6 +72,12 @@ private:
     uint32_t                          mLayers;
     VkBool32                          mDelete;
 
+    /// Indexed by layer * mMipLevels + mip level
+    vector<subresourceState_t>        mSubresourceStates;
+
+    void                              InitSubresourceStates(void);
+    static void                       GetLayoutUsage(VkImageLayout layout, VkAccessFlags *access, VkPipelineStageFlags *stages);
+
 public:
 // Constructor
     Image(const vkContext_t *vkContext = nullptr);
@@ -75,11 +89,14 @@ public:
     void                              BlitImage(        VkCommandBuffer *activeCmdBuffer, VkImageLayout srcImageLayout,
                                                         VkImage          dstImage,        VkImageLayout dstImageLayout,
                                                   const VkImageBlit*     imageBlit,       VkFilter      imageFilter);
+    void                              CopyImage(        VkCommandBuffer *activeCmdBuffer, VkImageLayout srcImageLayout,
+                                                        VkImage          dstImage,        VkImageLayout dstImageLayout,
+                                                  const VkImageCopy*     imageCopy);
 
 // Create Functions
     bool                              Create(void);
     void                              CreateImageSubresourceRange(void);
-    void                              CreateBufferImageCopy(int32_t offsetX, int32_t offsetY, uint32_t extentWidth, uint32_t extentHeight, uint32_t miplevel, uint32_t layer, uint32_t layerCount);
+    void                              CreateBufferImageCopy(int32_t offsetX, int32_t offsetY, uint32_t extentWidth, uint32_t extentHeight, uint32_t miplevel, uint32_t layer, uint32_t layerCount, VkDeviceSize bufferOffset = 0);
 
 // Copy Functions
     void                              CopyBufferToImage(VkCommandBuffer *activeCmdBuffer, VkBuffer srcBuffer);
@@ -96,7 +113,9 @@ public:
     inline VkImage &                  GetImage(void)                            { FUN_ENTRY(GL_LOG_TRACE); return mVkImage;          }
     inline VkFormat                   GetFormat(void)                     const { FUN_ENTRY(GL_LOG_TRACE); return mVkFormat;         }
     inline VkImageTarget              GetImageTarget(void)                const { FUN_ENTRY(GL_LOG_TRACE); return mVkImageTarget;    }
-    inline VkImageLayout              GetImageLayout(void)                const { FUN_ENTRY(GL_LOG_TRACE); return mVkImageLayout;    }
+    inline VkImageUsageFlagBits       GetImageUsage(void)                 const { FUN_ENTRY(GL_LOG_TRACE); return mVkImageUsage;     }
+    VkImageLayout                     GetImageLayout(void)                const;
+    inline VkImageTiling              GetImageTiling(void)                const { FUN_ENTRY(GL_LOG_TRACE); return mVkImageTiling;    }
     inline VkBufferImageCopy *        GetBufferImageCopy(void)                  { FUN_ENTRY(GL_LOG_TRACE); return &mVkBufferImageCopy;      }
     inline VkImageSubresourceRange    GetImageSubresourceRange(void)      const { FUN_ENTRY(GL_LOG_TRACE); return mVkImageSubresourceRange; }
     inline uint32_t                   GetMipLevels(void)                  const { FUN_ENTRY(GL_LOG_TRACE); return mMipLevels;        }
@@ -105,12 +124,12 @@ public:
 // Set Functions
     inline void                       SetContext(const vkContext_t *vkContext)  { FUN_ENTRY(GL_LOG_TRACE); mVkContext     = vkContext; }
     inline void                       SetFormat(VkFormat format)                { FUN_ENTRY(GL_LOG_TRACE); mVkFormat      = format;    }
-    inline void                       SetImage(VkImage image)                   { FUN_ENTRY(GL_LOG_TRACE); mVkImage       = image;
-                                                                                                       mDelete        = false;     }
+    void                              SetImage(VkImage image);
     inline void                       SetImageUsage(VkImageUsageFlagBits usage) { FUN_ENTRY(GL_LOG_TRACE); mVkImageUsage  = usage;     }
     inline void                       SetImageTarget(VkImageTarget target)      { FUN_ENTRY(GL_LOG_TRACE); mVkImageTarget = target;    }
     inline void                       SetImageTiling(VkImageTiling tiling)      { FUN_ENTRY(GL_LOG_TRACE); mVkImageTiling = tiling;    }
-    inline void                       SetImageLayout(VkImageLayout layout)      { FUN_ENTRY(GL_LOG_TRACE); mVkImageLayout = layout;    }
+    void                              SetImageLayout(VkImageLayout layout);
+    inline void                       SetSharingMode(VkSharingMode mode)        { FUN_ENTRY(GL_LOG_TRACE); mVkSharingMode = mode;      }
     inline void                       SetWidth(uint32_t width)                  { FUN_ENTRY(GL_LOG_TRACE); mWidth         = width;     }
     inline void                       SetHeight(uint32_t height)                { FUN_ENTRY(GL_LOG_TRACE); mHeight        = height;    }
     inline void                       SetMipLevels(uint32_t levels)             { FUN_ENTRY(GL_LOG_TRACE); mMipLevels     = levels;    }
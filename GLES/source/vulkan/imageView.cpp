@@ -31,6 +31,7 @@
  */
 
 #include "imageView.h"
+#include "retirementQueue.h"
 
 namespace vulkanAPI {
 
@@ -38,6 +39,11 @@ ImageView::ImageView(const vkContext_t *vkContext)
 : mVkContext(vkContext), mVkImageView(VK_NULL_HANDLE)
 {
     FUN_ENTRY(GL_LOG_TRACE);
+
+    mVkComponentMapping.r = VK_COMPONENT_SWIZZLE_R;
+    mVkComponentMapping.g = VK_COMPONENT_SWIZZLE_G;
+    mVkComponentMapping.b = VK_COMPONENT_SWIZZLE_B;
+    mVkComponentMapping.a = VK_COMPONENT_SWIZZLE_A;
 }
 
 ImageView::~ImageView()
@@ -53,7 +59,7 @@ ImageView::Release(void)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     if(mVkImageView != VK_NULL_HANDLE) {
-        vkDestroyImageView(mVkContext->vkDevice, mVkImageView, NULL);
+        mVkContext->mRetirementQueue->RetireResource(mVkImageView, RESOURCE_TYPE_IMAGE_VIEW);
         mVkImageView = VK_NULL_HANDLE;
     }
 }
@@ -70,10 +76,7 @@ ImageView::Create(vulkanAPI::Image *image)
     info.viewType         = (image->GetImageTarget() == Image::VK_IMAGE_TARGET_2D) ? VK_IMAGE_VIEW_TYPE_2D : VK_IMAGE_VIEW_TYPE_CUBE;
     info.image            = image->GetImage();
     info.format           = image->GetFormat();
-    info.components.r     = VK_COMPONENT_SWIZZLE_R;
-    info.components.g     = VK_COMPONENT_SWIZZLE_G;
-    info.components.b     = VK_COMPONENT_SWIZZLE_B;
-    info.components.a     = VK_COMPONENT_SWIZZLE_A;
+    info.components       = mVkComponentMapping;
     info.subresourceRange = image->GetImageSubresourceRange();
 
     VkResult err = vkCreateImageView(mVkContext->vkDevice, &info, 0, &mVkImageView);
@@ -37,6 +37,7 @@ private:
     vkContext_t *                     mVkContext;
 
     VkImageView                       mVkImageView;
+    VkComponentMapping                mVkComponentMapping;
 
 public:
 // Constructor
@@ -56,6 +57,7 @@ public:
 
 // Set Functions
     inline void                       SetContext(const vkContext_t *vkContext)  { FUN_ENTRY(GL_LOG_TRACE); mVkContext = vkContext; }
+    inline void                       SetComponentMapping(const VkComponentMapping &mapping) { FUN_ENTRY(GL_LOG_TRACE); mVkComponentMapping = mapping; }
 };
 
 }
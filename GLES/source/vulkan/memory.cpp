@@ -30,11 +30,13 @@
 
 #include "memory.h"
 #include "context/context.h"
+#include "retirementQueue.h"
+#include "utils/vertexKernels.h"
 
 namespace vulkanAPI {
 
 Memory::Memory(const vkContext_t *vkContext, VkFlags flags)
-: mVkContext(vkContext), mVkMemory (VK_NULL_HANDLE), mVkMemoryFlags(0), mVkFlags(flags)
+: mVkContext(vkContext), mLinear(true), mVkFlags(flags)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 }
@@ -51,9 +53,9 @@ Memory::Release(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mVkMemory != VK_NULL_HANDLE) {
-        vkFreeMemory(mVkContext->vkDevice, mVkMemory, NULL);
-        mVkMemory = VK_NULL_HANDLE;
+    if(mAllocation.memory != VK_NULL_HANDLE) {
+        mVkContext->mRetirementQueue->RetireResource(mAllocation, RESOURCE_TYPE_MEMORY);
+        mAllocation = memoryAllocation_t();
     }
 }
 
@@ -62,18 +64,16 @@ Memory::GetData(VkDeviceSize size, VkDeviceSize offset, void *data) const
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    void *pData;
-    VkResult err = vkMapMemory(mVkContext->vkDevice, mVkMemory, offset, size, mVkMemoryFlags, &pData);
-    assert(!err);
-
-    if(err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY && err != VK_ERROR_MEMORY_MAP_FAILED)
-    {
-        memcpy(data, pData, size);
-        vkUnmapMemory(mVkContext->vkDevice, mVkMemory);
+    assert(mAllocation.mapped);
 
-        return true;
+    if(!mAllocation.mapped) {
+        return false;
     }
-    return false;
+
+    mVkContext->mMemoryAllocator->InvalidateMappedRange(mAllocation, offset, size);
+    memcpy(data, mAllocation.mapped + offset, size);
+
+    return true;
 }
 
 void
@@ -84,97 +84,122 @@ Memory::UpdateData(VkDeviceSize size, VkDeviceSize offset, const void *data)
     SetData(VK_FORMAT_UNDEFINED, false, size, offset, data);
 }
 
+void
+Memory::FlushData(VkDeviceSize size, VkDeviceSize offset) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mVkContext->mMemoryAllocator->FlushMappedRange(mAllocation, offset, size);
+}
+
+/// GL_FIXED attributes are tagged with the SSCALED formats
+static bool
+IsFixedVkFormat(VkFormat format)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    return format == VK_FORMAT_R16_SSCALED       ||
+           format == VK_FORMAT_R16G16_SSCALED    ||
+           format == VK_FORMAT_R16G16B16_SSCALED ||
+           format == VK_FORMAT_R16G16B16A16_SSCALED;
+}
+
+static vertexKernel_t
+GetVertexKernelFromVkFormat(VkFormat format, bool normalize)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    /// fixed point values are never normalized
+    if(IsFixedVkFormat(format)) {
+        return GetVertexKernel(VERTEX_KERNEL_FIXED);
+    }
+
+    bool isUnsigned;
+    vertexKernelType_t kernel;
+    switch(nBytesOfVkIntFormat(format, &isUnsigned)) {
+    case 1: kernel = isUnsigned ? VERTEX_KERNEL_UNSIGNED_BYTE  : VERTEX_KERNEL_BYTE;  break;
+    case 2: kernel = isUnsigned ? VERTEX_KERNEL_UNSIGNED_SHORT : VERTEX_KERNEL_SHORT; break;
+    case 4: kernel = isUnsigned ? VERTEX_KERNEL_UNSIGNED_INT   : VERTEX_KERNEL_INT;   break;
+    default: { NOT_REACHED(); return nullptr; }
+    }
+
+    /// the normalized kernel of each type follows the non-normalized one
+    return GetVertexKernel(static_cast<vertexKernelType_t>(kernel + (normalize ? 1 : 0)));
+}
+
+void
+Memory::CopyData(VkFormat srcFormat, bool normalize, VkDeviceSize size, const void *srcData, void *dstData)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(srcFormat == VK_FORMAT_UNDEFINED  ||
+       srcFormat == VK_FORMAT_R32_SFLOAT ||
+       srcFormat == VK_FORMAT_R32G32_SFLOAT ||
+       srcFormat == VK_FORMAT_R32G32B32_SFLOAT ||
+       srcFormat == VK_FORMAT_R32G32B32A32_SFLOAT) {
+        /// data is already float
+        memcpy(dstData, srcData, size);
+        return;
+    }
+
+    /// for every component of the source, write the corresponding 4 byte float
+    const vertexKernel_t kernel = GetVertexKernelFromVkFormat(srcFormat, normalize);
+    if(kernel) {
+        kernel(static_cast<const uint8_t *>(srcData), static_cast<float *>(dstData), static_cast<uint32_t>(size / sizeof(float)));
+    }
+}
+
+void
+Memory::CopyVertexData(VkFormat srcFormat, bool normalize, uint32_t nComponents, size_t srcStride, uint32_t vertCount, const void *srcData, void *dstData)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const vertexKernel_t kernel = GetVertexKernelFromVkFormat(srcFormat, normalize);
+    if(!kernel) {
+        return;
+    }
+
+    bool isUnsigned;
+    const size_t componentSize = nBytesOfVkIntFormat(srcFormat, &isUnsigned);
+    const uint8_t *pSrc = static_cast<const uint8_t *>(srcData);
+    float *pDst = static_cast<float *>(dstData);
+
+    /// tightly packed vertices are converted in a single run
+    if(srcStride == nComponents * componentSize) {
+        kernel(pSrc, pDst, nComponents * vertCount);
+        return;
+    }
+
+    for(uint32_t i = 0; i < vertCount; ++i) {
+        kernel(pSrc, pDst, nComponents);
+        pSrc += srcStride;
+        pDst += nComponents;
+    }
+}
+
 bool
 Memory::SetData(VkFormat srcFormat, bool normalize, VkDeviceSize size, VkDeviceSize offset, const void *data)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    void *pData = NULL;
+    /// Host visible memory stays mapped for the lifetime of the allocation
+    assert(mAllocation.mapped);
 
-    VkResult err = vkMapMemory(mVkContext->vkDevice, mVkMemory, offset, size ? size : mVkRequirements.size, mVkMemoryFlags, &pData);
-    assert(!err);
+    if(!mAllocation.mapped) {
+        return false;
+    }
+
+    void *pData = mAllocation.mapped + offset;
 
     if(data) {
-        if(srcFormat == VK_FORMAT_UNDEFINED  ||
-           srcFormat == VK_FORMAT_R32_SFLOAT ||
-           srcFormat == VK_FORMAT_R32G32_SFLOAT ||
-           srcFormat == VK_FORMAT_R32G32B32_SFLOAT ||
-           srcFormat == VK_FORMAT_R32G32B32A32_SFLOAT) {
-            /// data is already float
-            memcpy(pData, data, size);
-        } else if(srcFormat == VK_FORMAT_R16_SSCALED ||
-                  srcFormat == VK_FORMAT_R16G16_SSCALED ||
-                  srcFormat == VK_FORMAT_R16G16B16_SSCALED ||
-                  srcFormat == VK_FORMAT_R16G16B16A16_SSCALED) {
-            /// fixed point to float conversion
-            float *pDst         = (float *)pData;
-            const GLfixed *pSrc = (GLfixed *)data;
-
-            for(size_t i = 0; i < floor(size / (float)sizeof(float)); ++i) {
-                pDst[i] = normalize ? GLOVE_FIXED_TO_FLOAT(pSrc[i]) / 255.0f : GLOVE_FIXED_TO_FLOAT(pSrc[i]);
-            }
-        } else {
-            bool isUnsigned;
-            float *pDst = (float *)pData;
-            const size_t nBytes = nBytesOfVkIntFormat(srcFormat, &isUnsigned);
-
-            /// if not float, the format will either be 1 or 2 bytes
-            /// for every nBytes bytes, copy the corresponding 4 byte float
-            switch(nBytes) {
-            case 1:
-                if(isUnsigned) {
-                    const uint8_t *pSrc = (uint8_t *)data;
-                    for(size_t i = 0; i < floor(size / (float)sizeof(float)); ++i) {
-                        pDst[i] = normalize ? (float)pSrc[i] / 255.0f : (float)pSrc[i];
-                    }
-                } else {
-                    const int8_t *pSrc = (int8_t *)data;
-                    for(size_t i = 0; i < floor(size / (float)sizeof(float)); ++i) {
-                        pDst[i] = normalize ? (float)pSrc[i] / 255.0f : (float)pSrc[i];
-                    }
-                }
-                break;
-
-            case 2:
-                if(isUnsigned) {
-                    const uint16_t *pSrc = (uint16_t *)data;
-                    for(size_t i = 0; i < floor(size / (float)sizeof(float)); ++i) {
-                        pDst[i] = normalize ? (float)pSrc[i] / 255.0f : (float)pSrc[i];
-                    }
-                } else {
-                    const int16_t *pSrc = (int16_t *)data;
-                    for(size_t i = 0; i < floor(size / (float)sizeof(float)); ++i) {
-                        pDst[i] = normalize ? (float)pSrc[i] / 255.0f : (float)pSrc[i];
-                    }
-                }
-                break;
-
-            case 4:
-                if(isUnsigned) {
-                    const uint32_t *pSrc = (uint32_t *)data;
-                    for(size_t i = 0; i < floor(size / (float)sizeof(float)); ++i) {
-                        pDst[i] = normalize ? (float)pSrc[i] / 255.0f : (float)pSrc[i];
-                    }
-                } else {
-                    const int32_t *pSrc = (int32_t *)data;
-                    for(size_t i = 0; i < floor(size / (float)sizeof(float)); ++i) {
-                        pDst[i] = normalize ? (float)pSrc[i] / 255.0f : (float)pSrc[i];
-                    }
-                }
-                break;
-
-            default:
-                NOT_REACHED();
-                break;
-            }
-        }
+        CopyData(srcFormat, normalize, size, data, pData);
     } else {
         memset(pData, 0x0, size);
     }
 
-    vkUnmapMemory(mVkContext->vkDevice, mVkMemory);
+    mVkContext->mMemoryAllocator->FlushMappedRange(mAllocation, offset, size ? size : mVkRequirements.size);
 
-    return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
+    return true;
 }
 
 bool
@@ -184,17 +209,19 @@ Memory::GetBufferMemoryRequirements(VkBuffer &buffer)
 
     memset((void *)&mVkRequirements, 0, sizeof(mVkRequirements));
     vkGetBufferMemoryRequirements(mVkContext->vkDevice, buffer, &mVkRequirements);
+    mLinear = true;
 
     return true;
 }
 
 void
-Memory::GetImageMemoryRequirements(VkImage &image)
+Memory::GetImageMemoryRequirements(VkImage &image, VkImageTiling tiling)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
     memset((void *)&mVkRequirements, 0, sizeof(mVkRequirements));
     vkGetImageMemoryRequirements(mVkContext->vkDevice, image, &mVkRequirements);
+    mLinear = (tiling == VK_IMAGE_TILING_LINEAR);
 }
 
 VkResult
@@ -239,7 +266,7 @@ Memory::BindBufferMemory(VkBuffer &buffer)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    VkResult err = vkBindBufferMemory(mVkContext->vkDevice, buffer, mVkMemory, 0);
+    VkResult err = vkBindBufferMemory(mVkContext->vkDevice, buffer, mAllocation.memory, mAllocation.offset);
     assert(!err);
 
     return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
@@ -250,7 +277,7 @@ Memory::BindImageMemory(VkImage &image)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    VkResult err = vkBindImageMemory(mVkContext->vkDevice, image, mVkMemory, 0);
+    VkResult err = vkBindImageMemory(mVkContext->vkDevice, image, mAllocation.memory, mAllocation.offset);
     assert(!err);
 
     return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
@@ -261,19 +288,17 @@ Memory::Allocate()
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    VkMemoryAllocateInfo allocInfo;
-    allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.pNext           = NULL;
-    allocInfo.memoryTypeIndex = 0;
-    allocInfo.allocationSize  = mVkRequirements.size;
+    Release();
 
-    VkResult err;
-    err = GetMemoryTypeIndexFromProperties(&allocInfo.memoryTypeIndex);
-    assert(!err);
-    err = vkAllocateMemory(mVkContext->vkDevice, &allocInfo, NULL, &mVkMemory);
+    uint32_t memoryTypeIndex = 0;
+    VkResult err = GetMemoryTypeIndexFromProperties(&memoryTypeIndex);
     assert(!err);
 
-    return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    return mVkContext->mMemoryAllocator->Allocate(memoryTypeIndex, mVkRequirements, mLinear, &mAllocation);
 }
 
 }
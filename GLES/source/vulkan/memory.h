@@ -26,6 +26,7 @@
 
 #include "utils/globals.h"
 #include "utils.h"
+#include "memoryAllocator.h"
 
 namespace vulkanAPI {
 
@@ -36,9 +37,8 @@ private:
     const
     vkContext_t *                     mVkContext;
 
-    VkDeviceMemory                    mVkMemory;
-    const
-    VkMemoryMapFlags                  mVkMemoryFlags;
+    memoryAllocation_t                mAllocation;
+    bool                              mLinear;
     VkFlags                           mVkFlags;
     VkMemoryRequirements              mVkRequirements;
 
@@ -60,14 +60,24 @@ public:
     bool                              BindImageMemory(VkImage &image);
 
 // Get Functions
-    void                              GetImageMemoryRequirements(VkImage &image);
+    void                              GetImageMemoryRequirements(VkImage &image, VkImageTiling tiling);
     bool                              GetBufferMemoryRequirements(VkBuffer &buffer);
     bool                              GetData(VkDeviceSize size, VkDeviceSize offset, void *data) const;
     VkResult                          GetMemoryTypeIndexFromProperties(uint32_t *typeIndex);
+    inline uint8_t *                  GetMappedData(void)                 const { FUN_ENTRY(GL_LOG_TRACE); return mAllocation.mapped; }
+    inline VkDeviceSize               GetSize(void)                       const { FUN_ENTRY(GL_LOG_TRACE); return mAllocation.size;   }
 
 // Set/Update Functions
     bool                              SetData(VkFormat srcFormat, bool normalize, VkDeviceSize size, VkDeviceSize offset, const void *data);
     void                              UpdateData(VkDeviceSize size, VkDeviceSize offset, const void *data);
+    inline void                       SetFlags(VkFlags flags)                   { FUN_ENTRY(GL_LOG_TRACE); mVkFlags = flags; }
+
+// Copy Functions
+    static void                       CopyData(VkFormat srcFormat, bool normalize, VkDeviceSize size, const void *srcData, void *dstData);
+    static void                       CopyVertexData(VkFormat srcFormat, bool normalize, uint32_t nComponents, size_t srcStride, uint32_t vertCount, const void *srcData, void *dstData);
+
+// Flush Functions
+    void                              FlushData(VkDeviceSize size, VkDeviceSize offset) const;
 
     inline void                       SetContext(const vkContext_t *vkContext)  { FUN_ENTRY(GL_LOG_TRACE); mVkContext = vkContext; }
 };
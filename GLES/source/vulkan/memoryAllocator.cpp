@@ -0,0 +1,440 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       memoryAllocator.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Device Memory Sub-Allocation Functionality in Vulkan
+ *
+ *  @section
+ *
+ *  Implementations limit the number of simultaneous device memory allocations
+ *  (maxMemoryAllocationCount) and vkAllocateMemory is an expensive call.
+ *  Device memory is therefore reserved in large blocks per memory type and
+ *  buffers and images are placed inside them at suitably aligned offsets,
+ *  using a best fit search over an offset ordered free list that coalesces
+ *  neighbouring ranges on release. Resources larger than half a block get a
+ *  dedicated allocation.
+ *
+ *  Linear (buffers, linear images) and non-linear (optimal images) resources
+ *  are kept in separate blocks when the device reports a bufferImageGranularity
+ *  larger than 1, so neighbouring resources never alias the same page.
+ *
+ *  Host visible memory is mapped once, when its block or dedicated allocation
+ *  is created, and stays mapped until it is freed. Writes and reads go through
+ *  the persistent pointer, and only non-coherent memory types need explicit
+ *  flushes and invalidations, aligned to nonCoherentAtomSize.
+ *
+ */
+
+#include "memoryAllocator.h"
+#include <algorithm>
+
+struct memoryBlock_t {
+    VkDeviceMemory                  memory;
+    VkDeviceSize                    size;
+    VkDeviceSize                    usedSize;
+    uint32_t                        allocationCount;
+    uint32_t                        memoryTypeIndex;
+    bool                            linear;
+    uint8_t                        *mapped;
+    map<VkDeviceSize, VkDeviceSize> freeRanges;
+};
+
+MemoryAllocator::MemoryAllocator(const vkContext_t *vkContext)
+: mVkContext(vkContext)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(mVkContext->vkGpus[0], &properties);
+    mBufferImageGranularity = properties.limits.bufferImageGranularity;
+    mNonCoherentAtomSize    = properties.limits.nonCoherentAtomSize ? properties.limits.nonCoherentAtomSize : 1;
+
+    memset(mDedicatedCount, 0, sizeof(mDedicatedCount));
+    memset(mDedicatedSize , 0, sizeof(mDedicatedSize));
+}
+
+MemoryAllocator::~MemoryAllocator()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(uint32_t i = 0; i < VK_MAX_MEMORY_TYPES; ++i) {
+        for(auto block : mBlocks[i]) {
+            DestroyBlock(block);
+        }
+        mBlocks[i].clear();
+    }
+}
+
+memoryBlock_t *
+MemoryAllocator::CreateBlock(uint32_t memoryTypeIndex, bool linear)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkMemoryAllocateInfo allocInfo;
+    allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.pNext           = NULL;
+    allocInfo.memoryTypeIndex = memoryTypeIndex;
+    allocInfo.allocationSize  = GLOVE_MEMORY_BLOCK_SIZE;
+
+    VkDeviceMemory memory;
+    VkResult err = vkAllocateMemory(mVkContext->vkDevice, &allocInfo, NULL, &memory);
+    if(err != VK_SUCCESS) {
+        return nullptr;
+    }
+
+    uint8_t *mapped = nullptr;
+    if(IsHostVisible(memoryTypeIndex)) {
+        mapped = MapMemory(memoryTypeIndex, memory);
+        if(!mapped) {
+            vkFreeMemory(mVkContext->vkDevice, memory, NULL);
+            return nullptr;
+        }
+    }
+
+    memoryBlock_t *block   = new memoryBlock_t;
+    block->memory          = memory;
+    block->size            = GLOVE_MEMORY_BLOCK_SIZE;
+    block->usedSize        = 0;
+    block->allocationCount = 0;
+    block->memoryTypeIndex = memoryTypeIndex;
+    block->linear          = linear;
+    block->mapped          = mapped;
+    block->freeRanges[0]   = block->size;
+
+    mBlocks[memoryTypeIndex].push_back(block);
+
+    return block;
+}
+
+void
+MemoryAllocator::DestroyBlock(memoryBlock_t *block)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(block->mapped) {
+        vkUnmapMemory(mVkContext->vkDevice, block->memory);
+    }
+    vkFreeMemory(mVkContext->vkDevice, block->memory, NULL);
+    delete block;
+}
+
+bool
+MemoryAllocator::AllocateFromBlock(memoryBlock_t *block, const VkMemoryRequirements &requirements, memoryAllocation_t *allocation)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const VkDeviceSize alignment = requirements.alignment ? requirements.alignment : 1;
+
+    map<VkDeviceSize, VkDeviceSize>::iterator best = block->freeRanges.end();
+    VkDeviceSize bestOffset = 0;
+
+    for(map<VkDeviceSize, VkDeviceSize>::iterator it = block->freeRanges.begin(); it != block->freeRanges.end(); ++it) {
+        VkDeviceSize offset = (it->first + alignment - 1) / alignment * alignment;
+        if(offset + requirements.size > it->first + it->second) {
+            continue;
+        }
+
+        if(best == block->freeRanges.end() || it->second < best->second) {
+            best       = it;
+            bestOffset = offset;
+        }
+    }
+
+    if(best == block->freeRanges.end()) {
+        return false;
+    }
+
+    const VkDeviceSize rangeOffset = best->first;
+    const VkDeviceSize rangeEnd    = best->first + best->second;
+    const VkDeviceSize end         = bestOffset + requirements.size;
+    block->freeRanges.erase(best);
+
+    if(bestOffset > rangeOffset) {
+        block->freeRanges[rangeOffset] = bestOffset - rangeOffset;
+    }
+    if(end < rangeEnd) {
+        block->freeRanges[end] = rangeEnd - end;
+    }
+
+    block->usedSize += requirements.size;
+    ++block->allocationCount;
+
+    allocation->memory          = block->memory;
+    allocation->offset          = bestOffset;
+    allocation->size            = requirements.size;
+    allocation->memoryTypeIndex = block->memoryTypeIndex;
+    allocation->block           = block;
+    allocation->mapped          = block->mapped ? block->mapped + bestOffset : nullptr;
+
+    return true;
+}
+
+bool
+MemoryAllocator::AllocateDedicated(uint32_t memoryTypeIndex, VkDeviceSize size, memoryAllocation_t *allocation)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkMemoryAllocateInfo allocInfo;
+    allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.pNext           = NULL;
+    allocInfo.memoryTypeIndex = memoryTypeIndex;
+    allocInfo.allocationSize  = size;
+
+    VkResult err = vkAllocateMemory(mVkContext->vkDevice, &allocInfo, NULL, &allocation->memory);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        allocation->memory = VK_NULL_HANDLE;
+        return false;
+    }
+
+    allocation->mapped = nullptr;
+    if(IsHostVisible(memoryTypeIndex)) {
+        allocation->mapped = MapMemory(memoryTypeIndex, allocation->memory);
+        if(!allocation->mapped) {
+            vkFreeMemory(mVkContext->vkDevice, allocation->memory, NULL);
+            allocation->memory = VK_NULL_HANDLE;
+            return false;
+        }
+    }
+
+    allocation->offset          = 0;
+    allocation->size            = size;
+    allocation->memoryTypeIndex = memoryTypeIndex;
+    allocation->block           = nullptr;
+
+    ++mDedicatedCount[memoryTypeIndex];
+    mDedicatedSize[memoryTypeIndex] += size;
+
+    return true;
+}
+
+uint8_t *
+MemoryAllocator::MapMemory(uint32_t memoryTypeIndex, VkDeviceMemory memory)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    assert(IsHostVisible(memoryTypeIndex));
+
+    void *pData = nullptr;
+    VkResult err = vkMapMemory(mVkContext->vkDevice, memory, 0, VK_WHOLE_SIZE, 0, &pData);
+    assert(!err);
+
+    return err == VK_SUCCESS ? (uint8_t *)pData : nullptr;
+}
+
+bool
+MemoryAllocator::Allocate(uint32_t memoryTypeIndex, const VkMemoryRequirements &requirements, bool linear, memoryAllocation_t *allocation)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    assert(memoryTypeIndex < VK_MAX_MEMORY_TYPES);
+    assert(allocation->memory == VK_NULL_HANDLE);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if(requirements.size > GLOVE_MEMORY_BLOCK_SIZE / 2) {
+        return AllocateDedicated(memoryTypeIndex, requirements.size, allocation);
+    }
+
+    /// Without a granularity restriction all resources can share the same blocks
+    if(mBufferImageGranularity <= 1) {
+        linear = true;
+    }
+
+    for(auto block : mBlocks[memoryTypeIndex]) {
+        if(block->linear == linear && AllocateFromBlock(block, requirements, allocation)) {
+            return true;
+        }
+    }
+
+    memoryBlock_t *block = CreateBlock(memoryTypeIndex, linear);
+    if(block && AllocateFromBlock(block, requirements, allocation)) {
+        return true;
+    }
+
+    /// There might still be room for a smaller allocation
+    return AllocateDedicated(memoryTypeIndex, requirements.size, allocation);
+}
+
+void
+MemoryAllocator::Free(memoryAllocation_t *allocation)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(allocation->memory == VK_NULL_HANDLE) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    memoryBlock_t *block = allocation->block;
+
+    if(!block) {
+        if(allocation->mapped) {
+            vkUnmapMemory(mVkContext->vkDevice, allocation->memory);
+        }
+        vkFreeMemory(mVkContext->vkDevice, allocation->memory, NULL);
+        --mDedicatedCount[allocation->memoryTypeIndex];
+        mDedicatedSize[allocation->memoryTypeIndex] -= allocation->size;
+        *allocation = memoryAllocation_t();
+        return;
+    }
+
+    VkDeviceSize offset = allocation->offset;
+    VkDeviceSize size   = allocation->size;
+
+    /// Coalesce with the following and the preceding free ranges
+    map<VkDeviceSize, VkDeviceSize>::iterator next = block->freeRanges.lower_bound(offset);
+    if(next != block->freeRanges.end() && offset + size == next->first) {
+        size += next->second;
+        next  = block->freeRanges.erase(next);
+    }
+
+    bool merged = false;
+    if(next != block->freeRanges.begin()) {
+        map<VkDeviceSize, VkDeviceSize>::iterator prev = std::prev(next);
+        if(prev->first + prev->second == offset) {
+            prev->second += size;
+            merged = true;
+        }
+    }
+
+    if(!merged) {
+        block->freeRanges[offset] = size;
+    }
+
+    block->usedSize -= allocation->size;
+    --block->allocationCount;
+    *allocation = memoryAllocation_t();
+
+    /// Return empty blocks to the driver, but keep one around to avoid reallocations
+    if(!block->allocationCount) {
+        vector<memoryBlock_t *> &blocks = mBlocks[block->memoryTypeIndex];
+
+        uint32_t sameKindBlocks = 0;
+        for(auto b : blocks) {
+            sameKindBlocks += (b->linear == block->linear);
+        }
+
+        if(sameKindBlocks > 1) {
+            blocks.erase(std::find(blocks.begin(), blocks.end(), block));
+            DestroyBlock(block);
+        }
+    }
+}
+
+void
+MemoryAllocator::GetMappedRange(const memoryAllocation_t &allocation, VkDeviceSize offset, VkDeviceSize size, VkMappedMemoryRange *range) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const VkDeviceSize memorySize = allocation.block ? allocation.block->size : allocation.size;
+    const VkDeviceSize begin      = (allocation.offset + offset) / mNonCoherentAtomSize * mNonCoherentAtomSize;
+    const VkDeviceSize end        = (allocation.offset + offset + size + mNonCoherentAtomSize - 1) / mNonCoherentAtomSize * mNonCoherentAtomSize;
+
+    range->sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range->pNext  = NULL;
+    range->memory = allocation.memory;
+    range->offset = begin;
+    range->size   = end >= memorySize ? VK_WHOLE_SIZE : end - begin;
+}
+
+void
+MemoryAllocator::FlushMappedRange(const memoryAllocation_t &allocation, VkDeviceSize offset, VkDeviceSize size) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!allocation.mapped || IsHostCoherent(allocation.memoryTypeIndex)) {
+        return;
+    }
+
+    VkMappedMemoryRange range;
+    GetMappedRange(allocation, offset, size, &range);
+
+    VkResult err = vkFlushMappedMemoryRanges(mVkContext->vkDevice, 1, &range);
+    assert(!err);
+}
+
+void
+MemoryAllocator::InvalidateMappedRange(const memoryAllocation_t &allocation, VkDeviceSize offset, VkDeviceSize size) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!allocation.mapped || IsHostCoherent(allocation.memoryTypeIndex)) {
+        return;
+    }
+
+    VkMappedMemoryRange range;
+    GetMappedRange(allocation, offset, size, &range);
+
+    VkResult err = vkInvalidateMappedMemoryRanges(mVkContext->vkDevice, 1, &range);
+    assert(!err);
+}
+
+void
+MemoryAllocator::GetStatistics(uint32_t memoryTypeIndex, memoryStatistics_t *statistics) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    assert(memoryTypeIndex < VK_MAX_MEMORY_TYPES);
+
+    memset(statistics, 0, sizeof(memoryStatistics_t));
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    statistics->dedicatedCount  = mDedicatedCount[memoryTypeIndex];
+    statistics->allocationCount = mDedicatedCount[memoryTypeIndex];
+    statistics->reservedSize    = mDedicatedSize[memoryTypeIndex];
+    statistics->usedSize        = mDedicatedSize[memoryTypeIndex];
+
+    for(auto block : mBlocks[memoryTypeIndex]) {
+        ++statistics->blockCount;
+        statistics->allocationCount += block->allocationCount;
+        statistics->reservedSize    += block->size;
+        statistics->usedSize        += block->usedSize;
+
+        for(auto range : block->freeRanges) {
+            statistics->freeSize        += range.second;
+            statistics->largestFreeRange = std::max(statistics->largestFreeRange, range.second);
+        }
+    }
+
+    /// 0 when all free memory is contiguous, approaching 1 as it gets scattered
+    statistics->fragmentation = statistics->freeSize ? 1.0f - (float)statistics->largestFreeRange / (float)statistics->freeSize : 0.0f;
+}
+
+void
+MemoryAllocator::DumpStatistics(void) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    for(uint32_t i = 0; i < mVkContext->vkDeviceMemoryProperties.memoryTypeCount; ++i) {
+        memoryStatistics_t statistics;
+        GetStatistics(i, &statistics);
+
+        if(!statistics.reservedSize) {
+            continue;
+        }
+
+        printf("MEMORY TYPE %u: %u blocks, %u dedicated, %u allocations, %llu/%llu bytes used, fragmentation %.2f\n",
+               i, statistics.blockCount, statistics.dedicatedCount, statistics.allocationCount,
+               (unsigned long long)statistics.usedSize, (unsigned long long)statistics.reservedSize,
+               statistics.fragmentation);
+    }
+}
@@ -0,0 +1,102 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       memoryAllocator.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Device Memory Sub-Allocation Functionality in Vulkan
+ *
+ */
+
+#ifndef __VKMEMORYALLOCATOR_H__
+#define __VKMEMORYALLOCATOR_H__
+
+#include "utils/globals.h"
+
+struct memoryBlock_t;
+
+typedef struct memoryAllocation_t {
+    VkDeviceMemory                  memory;
+    VkDeviceSize                    offset;
+    VkDeviceSize                    size;
+    uint32_t                        memoryTypeIndex;
+    memoryBlock_t                  *block;
+    uint8_t                        *mapped;
+
+    memoryAllocation_t() : memory(VK_NULL_HANDLE), offset(0), size(0), memoryTypeIndex(0), block(nullptr), mapped(nullptr) { FUN_ENTRY(GL_LOG_TRACE); }
+} memoryAllocation_t;
+
+typedef struct memoryStatistics_t {
+    uint32_t                        blockCount;
+    uint32_t                        dedicatedCount;
+    uint32_t                        allocationCount;
+    VkDeviceSize                    reservedSize;
+    VkDeviceSize                    usedSize;
+    VkDeviceSize                    freeSize;
+    VkDeviceSize                    largestFreeRange;
+    float                           fragmentation;
+} memoryStatistics_t;
+
+class MemoryAllocator {
+private:
+
+    const
+    vkContext_t                    *mVkContext;
+    VkDeviceSize                    mBufferImageGranularity;
+    VkDeviceSize                    mNonCoherentAtomSize;
+
+    /// Objects of all contexts are allocated from the same blocks
+    mutable std::mutex              mMutex;
+
+    vector<memoryBlock_t *>         mBlocks[VK_MAX_MEMORY_TYPES];
+    uint32_t                        mDedicatedCount[VK_MAX_MEMORY_TYPES];
+    VkDeviceSize                    mDedicatedSize[VK_MAX_MEMORY_TYPES];
+
+    memoryBlock_t                  *CreateBlock(uint32_t memoryTypeIndex, bool linear);
+    void                            DestroyBlock(memoryBlock_t *block);
+    bool                            AllocateFromBlock(memoryBlock_t *block, const VkMemoryRequirements &requirements, memoryAllocation_t *allocation);
+    bool                            AllocateDedicated(uint32_t memoryTypeIndex, VkDeviceSize size, memoryAllocation_t *allocation);
+    uint8_t                        *MapMemory(uint32_t memoryTypeIndex, VkDeviceMemory memory);
+    void                            GetMappedRange(const memoryAllocation_t &allocation, VkDeviceSize offset, VkDeviceSize size, VkMappedMemoryRange *range) const;
+
+    inline bool                     IsHostVisible(uint32_t memoryTypeIndex)  const { FUN_ENTRY(GL_LOG_TRACE); return mVkContext->vkDeviceMemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;  }
+    inline bool                     IsHostCoherent(uint32_t memoryTypeIndex) const { FUN_ENTRY(GL_LOG_TRACE); return mVkContext->vkDeviceMemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT; }
+
+public:
+// Constructor
+    MemoryAllocator(const vkContext_t *vkContext);
+
+// Destructor
+    ~MemoryAllocator();
+
+// Allocate Functions
+    bool                            Allocate(uint32_t memoryTypeIndex, const VkMemoryRequirements &requirements, bool linear, memoryAllocation_t *allocation);
+
+// Free Functions
+    void                            Free(memoryAllocation_t *allocation);
+
+// Flush/Invalidate Functions
+    void                            FlushMappedRange(const memoryAllocation_t &allocation, VkDeviceSize offset, VkDeviceSize size) const;
+    void                            InvalidateMappedRange(const memoryAllocation_t &allocation, VkDeviceSize offset, VkDeviceSize size) const;
+
+// Get Functions
+    void                            GetStatistics(uint32_t memoryTypeIndex, memoryStatistics_t *statistics) const;
+
+// Dump Functions
+    void                            DumpStatistics(void) const;
+};
+
+#endif // __VKMEMORYALLOCATOR_H__
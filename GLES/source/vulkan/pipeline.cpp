@@ -32,7 +32,7 @@ namespace vulkanAPI {
 
 Pipeline::Pipeline(const vkContext_t *vkContext)
 : mVkContext(vkContext), mVkPipeline(VK_NULL_HANDLE), mVkPipelineLayout(VK_NULL_HANDLE),
-mVkPipelineCache(VK_NULL_HANDLE), mVkPipelineVertexInputState(VK_NULL_HANDLE), mVkPipelineShaderStageCount(0)
+mVkPipelineCache(VK_NULL_HANDLE), mPipelineObjectCache(vkContext), mVkPipelineVertexInputState(VK_NULL_HANDLE), mVkPipelineShaderStageCount(0)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
@@ -56,10 +56,9 @@ Pipeline::Destroy()
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mVkPipeline != VK_NULL_HANDLE) {
-        vkDestroyPipeline(mVkContext->vkDevice, mVkPipeline, NULL);
-        mVkPipeline = VK_NULL_HANDLE;
-    }
+    /// Pipelines are owned by the cache
+    mPipelineObjectCache.Release();
+    mVkPipeline = VK_NULL_HANDLE;
 }
 
 void
@@ -287,32 +286,122 @@ Pipeline::UpdateDynamicState(VkCommandBuffer *CmdBuffer, float lineWidth)
     vkCmdSetLineWidth (*CmdBuffer, lineWidth);
 }
 
+template<typename T>
+static inline void
+AppendToKey(vector<uint8_t> &key, const T &value)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+    key.insert(key.end(), bytes, bytes + sizeof(T));
+}
+
+void
+Pipeline::GetStateKey(RenderPass *renderPass, vector<uint8_t> &key) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    key.clear();
+
+    /// Render pass compatibility
+    AppendToKey(key, renderPass->GetColorFormat());
+    AppendToKey(key, renderPass->GetDepthStencilFormat());
+
+    /// Shader stages and pipeline layout
+    AppendToKey(key, mVkPipelineLayout);
+    AppendToKey(key, mVkPipelineShaderStageCount);
+    for(uint32_t i = 0; i < mVkPipelineShaderStageCount; ++i) {
+        AppendToKey(key, mVkPipelineShaderStages[i].stage);
+        AppendToKey(key, mVkPipelineShaderStages[i].module);
+    }
+
+    /// Vertex input
+    uint32_t bindingCount   = mVkPipelineVertexInputState ? mVkPipelineVertexInputState->vertexBindingDescriptionCount   : 0;
+    uint32_t attributeCount = mVkPipelineVertexInputState ? mVkPipelineVertexInputState->vertexAttributeDescriptionCount : 0;
+    AppendToKey(key, bindingCount);
+    for(uint32_t i = 0; i < bindingCount; ++i) {
+        AppendToKey(key, mVkPipelineVertexInputState->pVertexBindingDescriptions[i]);
+    }
+    AppendToKey(key, attributeCount);
+    for(uint32_t i = 0; i < attributeCount; ++i) {
+        AppendToKey(key, mVkPipelineVertexInputState->pVertexAttributeDescriptions[i]);
+    }
+
+    /// Input assembly
+    AppendToKey(key, mVkPipelineInputAssemblyState.topology);
+    AppendToKey(key, mVkPipelineInputAssemblyState.primitiveRestartEnable);
+
+    /// Rasterization
+    AppendToKey(key, mVkPipelineRasterizationState.depthClampEnable);
+    AppendToKey(key, mVkPipelineRasterizationState.rasterizerDiscardEnable);
+    AppendToKey(key, mVkPipelineRasterizationState.polygonMode);
+    AppendToKey(key, mVkPipelineRasterizationState.cullMode);
+    AppendToKey(key, mVkPipelineRasterizationState.frontFace);
+    AppendToKey(key, mVkPipelineRasterizationState.depthBiasEnable);
+    AppendToKey(key, mVkPipelineRasterizationState.depthBiasConstantFactor);
+    AppendToKey(key, mVkPipelineRasterizationState.depthBiasClamp);
+    AppendToKey(key, mVkPipelineRasterizationState.depthBiasSlopeFactor);
+
+    /// Multisample
+    AppendToKey(key, mVkPipelineMultisampleState.rasterizationSamples);
+    AppendToKey(key, mVkPipelineMultisampleState.sampleShadingEnable);
+    AppendToKey(key, mVkPipelineMultisampleState.minSampleShading);
+    AppendToKey(key, mVkPipelineMultisampleState.alphaToCoverageEnable);
+    AppendToKey(key, mVkPipelineMultisampleState.alphaToOneEnable);
+
+    /// Depth/stencil
+    AppendToKey(key, mVkPipelineDepthStencilState.depthTestEnable);
+    AppendToKey(key, mVkPipelineDepthStencilState.depthWriteEnable);
+    AppendToKey(key, mVkPipelineDepthStencilState.depthCompareOp);
+    AppendToKey(key, mVkPipelineDepthStencilState.depthBoundsTestEnable);
+    AppendToKey(key, mVkPipelineDepthStencilState.stencilTestEnable);
+    AppendToKey(key, mVkPipelineDepthStencilState.front);
+    AppendToKey(key, mVkPipelineDepthStencilState.back);
+    AppendToKey(key, mVkPipelineDepthStencilState.minDepthBounds);
+    AppendToKey(key, mVkPipelineDepthStencilState.maxDepthBounds);
+
+    /// Color blend
+    AppendToKey(key, mVkPipelineColorBlendState.logicOpEnable);
+    AppendToKey(key, mVkPipelineColorBlendState.logicOp);
+    AppendToKey(key, mVkPipelineColorBlendState.attachmentCount);
+    AppendToKey(key, mVkPipelineColorBlendAttachmentState);
+    AppendToKey(key, mVkPipelineColorBlendState.blendConstants);
+}
+
 void
-Pipeline::Create(VkRenderPass *renderpass)
+Pipeline::Create(RenderPass *renderPass)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
     if(mUpdateState.Pipeline) {
-        SetInfo(renderpass);
-        CreateGraphicsPipeline();
+        SetInfo(renderPass->GetRenderPass());
+        CreateGraphicsPipeline(renderPass);
     }
 }
 
 void
-Pipeline::CreateGraphicsPipeline(void)
+Pipeline::CreateGraphicsPipeline(RenderPass *renderPass)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    Destroy();
+    vector<uint8_t> key;
+    GetStateKey(renderPass, key);
+    uint64_t hash = PipelineObjectCache::Hash(key);
+
+    mVkPipeline = mPipelineObjectCache.Find(hash, key);
+    if(mVkPipeline != VK_NULL_HANDLE) {
+        mUpdateState.Pipeline = false;
+        return;
+    }
 
     VkResult err = vkCreateGraphicsPipelines(mVkContext->vkDevice, mVkPipelineCache, 1, &mVkPipelineInfo, NULL, &mVkPipeline);
     assert(!err);
 
     if(err) {
-        Destroy();
+        mVkPipeline = VK_NULL_HANDLE;
         return;
     }
 
+    mPipelineObjectCache.Insert(hash, key, mVkPipeline, &mVkPipelineInfo);
+
     mUpdateState.Pipeline = false;
 }
 
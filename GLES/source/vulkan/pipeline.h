@@ -25,6 +25,8 @@
 #define __VKPIPELINE_H__
 
 #include "utils/globals.h"
+#include "renderPass.h"
+#include "pipelineObjectCache.h"
 
 namespace vulkanAPI {
 
@@ -41,6 +43,7 @@ private:
     VkPipeline                                  mVkPipeline;
     VkPipelineLayout                            mVkPipelineLayout;
     VkPipelineCache                             mVkPipelineCache;
+    PipelineObjectCache                         mPipelineObjectCache;
 
     VkGraphicsPipelineCreateInfo                mVkPipelineInfo;
     VkPipelineInputAssemblyStateCreateInfo      mVkPipelineInputAssemblyState;
@@ -66,9 +69,10 @@ private:
     VkBool32                                    Viewport;
     }                                           mUpdateState;
 
-    void CreateGraphicsPipeline(void);
+    void CreateGraphicsPipeline(RenderPass *renderPass);
     void Destroy(void);
     void SetInfo(VkRenderPass *renderpass);
+    void GetStateKey(RenderPass *renderPass, vector<uint8_t> &key) const;
 
 public:
 // Constructor
@@ -84,6 +88,8 @@ public:
     inline bool GetUpdatePipelineState(void)                              const { FUN_ENTRY(GL_LOG_TRACE); return mUpdateState.Pipeline; }
     inline bool GetUpdateViewportState(void)                              const { FUN_ENTRY(GL_LOG_TRACE); return mUpdateState.Viewport; }
     inline bool GetUpdateVertexAttribVBOs(void)                           const { FUN_ENTRY(GL_LOG_TRACE); return mUpdateState.VertexAttribVBOs; }
+    inline uint32_t GetCacheHits(void)                                    const { FUN_ENTRY(GL_LOG_TRACE); return mPipelineObjectCache.GetHits(); }
+    inline uint32_t GetCacheMisses(void)                                  const { FUN_ENTRY(GL_LOG_TRACE); return mPipelineObjectCache.GetMisses(); }
 
 // Set Functions
     inline void SetUpdateVertexAttribVBOs(VkBool32 enable)                      { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.VertexAttribVBOs = enable; }
@@ -173,7 +179,7 @@ public:
           void Bind(VkCommandBuffer *CmdBuffer)                                 { FUN_ENTRY(GL_LOG_TRACE); vkCmdBindPipeline(*CmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mVkPipeline); }
 
 // Create Functions
-          void Create(VkRenderPass *renderpass);
+          void Create(RenderPass *renderPass);
 // Update Functions
           void UpdateDynamicState(VkCommandBuffer *CmdBuffer, float lineWidth);
 };
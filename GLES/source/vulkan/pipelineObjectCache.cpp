@@ -0,0 +1,153 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       pipelineObjectCache.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Graphics Pipeline Objects Cache Functionality in Vulkan
+ *
+ *  @section
+ *
+ *  Every change of the GL render state requires a different VkPipeline.
+ *  Pipelines are kept in a least recently used cache, indexed by a hash of
+ *  the state they were created with, so that returning to a previously
+ *  seen state does not trigger a new pipeline compilation.
+ *
+ *  Each cached pipeline holds a reference to its shader modules and pipeline
+ *  layout, so their handles cannot be recycled while the entry is alive.
+ *
+ */
+
+#include "pipelineObjectCache.h"
+#include "retirementQueue.h"
+
+namespace vulkanAPI {
+
+PipelineObjectCache::PipelineObjectCache(const vkContext_t *vkContext, uint32_t maxSize)
+: mVkContext(vkContext), mMaxSize(maxSize), mHits(0), mMisses(0)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    assert(mMaxSize);
+}
+
+PipelineObjectCache::~PipelineObjectCache()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    Release();
+}
+
+uint64_t
+PipelineObjectCache::Hash(const vector<uint8_t> &key)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    /// 64-bit FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(size_t i = 0; i < key.size(); ++i) {
+        hash ^= key[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+VkPipeline
+PipelineObjectCache::Find(uint64_t hash, const vector<uint8_t> &key)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::unordered_map<uint64_t, std::list<Entry>::iterator>::iterator it = mLookup.find(hash);
+    if(it == mLookup.end() || it->second->key != key) {
+        ++mMisses;
+        return VK_NULL_HANDLE;
+    }
+
+    mEntries.splice(mEntries.begin(), mEntries, it->second);
+    ++mHits;
+
+    return it->second->pipeline;
+}
+
+void
+PipelineObjectCache::Insert(uint64_t hash, const vector<uint8_t> &key, VkPipeline pipeline, const VkGraphicsPipelineCreateInfo *info)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    assert(pipeline != VK_NULL_HANDLE);
+
+    /// A hash collision replaces the older entry
+    std::unordered_map<uint64_t, std::list<Entry>::iterator>::iterator it = mLookup.find(hash);
+    if(it != mLookup.end()) {
+        Evict(it->second);
+    }
+
+    while(mEntries.size() >= mMaxSize) {
+        Evict(std::prev(mEntries.end()));
+    }
+
+    Entry entry;
+    entry.hash        = hash;
+    entry.key         = key;
+    entry.pipeline    = pipeline;
+    entry.layout      = info->layout;
+    entry.moduleCount = info->stageCount;
+
+    for(uint32_t i = 0; i < entry.moduleCount; ++i) {
+        entry.modules[i] = info->pStages[i].module;
+        mVkContext->mRetirementQueue->RefResource(entry.modules[i], RESOURCE_TYPE_SHADER);
+    }
+
+    if(entry.layout != VK_NULL_HANDLE) {
+        mVkContext->mRetirementQueue->RefResource(entry.layout, RESOURCE_TYPE_PIPELINE_LAYOUT);
+    }
+
+    mEntries.push_front(entry);
+    mLookup[hash] = mEntries.begin();
+}
+
+void
+PipelineObjectCache::Evict(std::list<Entry>::iterator it)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// The pipeline may still be used by recorded commands
+    mVkContext->mRetirementQueue->RetireResource(it->pipeline, RESOURCE_TYPE_PIPELINE);
+
+    for(uint32_t i = 0; i < it->moduleCount; ++i) {
+        mVkContext->mRetirementQueue->UnrefResouce(it->modules[i], RESOURCE_TYPE_SHADER);
+    }
+
+    if(it->layout != VK_NULL_HANDLE) {
+        mVkContext->mRetirementQueue->UnrefResouce(it->layout, RESOURCE_TYPE_PIPELINE_LAYOUT);
+    }
+
+    mLookup.erase(it->hash);
+    mEntries.erase(it);
+}
+
+void
+PipelineObjectCache::Release(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    while(!mEntries.empty()) {
+        Evict(mEntries.begin());
+    }
+}
+
+}
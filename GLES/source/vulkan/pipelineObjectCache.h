@@ -0,0 +1,84 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       pipelineObjectCache.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Graphics Pipeline Objects Cache Functionality in Vulkan
+ *
+ */
+
+#ifndef __VKPIPELINEOBJECTCACHE_H__
+#define __VKPIPELINEOBJECTCACHE_H__
+
+#include "utils/globals.h"
+#include <list>
+#include <unordered_map>
+
+namespace vulkanAPI {
+
+class PipelineObjectCache {
+
+private:
+
+    typedef struct Entry {
+        uint64_t                                hash;
+        vector<uint8_t>                         key;
+        VkPipeline                              pipeline;
+        VkPipelineLayout                        layout;
+        uint32_t                                moduleCount;
+        VkShaderModule                          modules[2];
+    } Entry;
+
+    const
+    vkContext_t *                               mVkContext;
+
+    /// Most recently used entries are kept at the front
+    std::list<Entry>                            mEntries;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> mLookup;
+
+    uint32_t                                    mMaxSize;
+    uint32_t                                    mHits;
+    uint32_t                                    mMisses;
+
+    void Evict(std::list<Entry>::iterator it);
+
+public:
+// Constructor
+    PipelineObjectCache(const vkContext_t *vkContext, uint32_t maxSize = GLOVE_MAX_CACHED_PIPELINES);
+
+// Destructor
+    ~PipelineObjectCache();
+
+// Hash Functions
+    static uint64_t Hash(const vector<uint8_t> &key);
+
+// Find/Insert Functions
+    VkPipeline      Find(uint64_t hash, const vector<uint8_t> &key);
+    void            Insert(uint64_t hash, const vector<uint8_t> &key, VkPipeline pipeline, const VkGraphicsPipelineCreateInfo *info);
+
+// Release Functions
+    void            Release(void);
+
+// Get Functions
+    inline uint32_t GetSize(void)                                         const { FUN_ENTRY(GL_LOG_TRACE); return (uint32_t)mEntries.size(); }
+    inline uint32_t GetHits(void)                                         const { FUN_ENTRY(GL_LOG_TRACE); return mHits;   }
+    inline uint32_t GetMisses(void)                                       const { FUN_ENTRY(GL_LOG_TRACE); return mMisses; }
+};
+
+}
+
+#endif // __VKPIPELINEOBJECTCACHE_H__
@@ -26,19 +26,30 @@
  *  are used over the course of the subpasses.
  *  Render passes are represented by VkRenderPass handles.
  *
+ *  Clears that precede the first draw of a render pass are folded into its
+ *  begin as clear load ops, and attachments that are not cleared are loaded.
+ *  Each combination of load/store ops is a separate, compatible render pass,
+ *  created on first use and kept until the attachment formats change.
+ *  All of them share an external dependency that orders the attachment
+ *  writes of earlier render passes before the ones of the new render pass.
+ *
  */
 
 #include "renderPass.h"
+#include "retirementQueue.h"
 
 namespace vulkanAPI {
 
 RenderPass::RenderPass(const vkContext_t *vkContext)
 : mVkContext(vkContext),
   mVkSubpassContents(VK_SUBPASS_CONTENTS_INLINE), mVkPipelineBindPoint(VK_PIPELINE_BIND_POINT_GRAPHICS),
-  mVkRenderPass(VK_NULL_HANDLE),
-  mDepthWriteEnabled(true), mStencilWriteEnabled(false), mStarted(false)
+  mVkRenderPass(VK_NULL_HANDLE), mColorFormat(VK_FORMAT_UNDEFINED), mDepthStencilFormat(VK_FORMAT_UNDEFINED),
+  mColorLoadOp(VK_ATTACHMENT_LOAD_OP_LOAD), mDepthLoadOp(VK_ATTACHMENT_LOAD_OP_LOAD), mStencilLoadOp(VK_ATTACHMENT_LOAD_OP_LOAD),
+  mDepthStoreOp(VK_ATTACHMENT_STORE_OP_STORE), mStencilStoreOp(VK_ATTACHMENT_STORE_OP_STORE), mStarted(false)
 {
     FUN_ENTRY(GL_LOG_TRACE);
+
+    memset(mVkClearValues, 0, sizeof(mVkClearValues));
 }
 
 RenderPass::~RenderPass()
@@ -53,10 +64,26 @@ RenderPass::Release(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mVkRenderPass != VK_NULL_HANDLE) {
-        vkDestroyRenderPass(mVkContext->vkDevice, mVkRenderPass, NULL);
-        mVkRenderPass = VK_NULL_HANDLE;
+    /// The compatible render pass is one of the variants
+    for(auto variant : mVkRenderPassVariants) {
+        mVkContext->mRetirementQueue->RetireResource(variant.second, RESOURCE_TYPE_RENDER_PASS);
     }
+    mVkRenderPassVariants.clear();
+    mVkRenderPass = VK_NULL_HANDLE;
+}
+
+uint32_t
+RenderPass::GetVariantKey(VkAttachmentLoadOp colorLoadOp,
+                          VkAttachmentLoadOp depthLoadOp, VkAttachmentLoadOp stencilLoadOp,
+                          VkAttachmentStoreOp depthStoreOp, VkAttachmentStoreOp stencilStoreOp)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    return  static_cast<uint32_t>(colorLoadOp)           |
+           (static_cast<uint32_t>(depthLoadOp)    << 2)  |
+           (static_cast<uint32_t>(stencilLoadOp)  << 4)  |
+           (static_cast<uint32_t>(depthStoreOp)   << 6)  |
+           (static_cast<uint32_t>(stencilStoreOp) << 8);
 }
 
 bool
@@ -66,20 +93,40 @@ RenderPass::Create(VkFormat colorFormat, VkFormat depthstencilFormat)
 
     Release();
 
+    mColorFormat        = colorFormat;
+    mDepthStencilFormat = depthstencilFormat;
+
+    /// Pipelines and framebuffers are created against the variant that loads and stores all
+    /// attachments. Variants with other load/store ops are compatible with it, so they are
+    /// only created when a render pass begins with them.
+    mVkRenderPass = CreateVariant(VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_LOAD_OP_LOAD,
+                                  VK_ATTACHMENT_STORE_OP_STORE, VK_ATTACHMENT_STORE_OP_STORE);
+
+    return mVkRenderPass != VK_NULL_HANDLE;
+}
+
+VkRenderPass
+RenderPass::CreateVariant(VkAttachmentLoadOp colorLoadOp,
+                          VkAttachmentLoadOp depthLoadOp, VkAttachmentLoadOp stencilLoadOp,
+                          VkAttachmentStoreOp depthStoreOp, VkAttachmentStoreOp stencilStoreOp)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
     VkAttachmentReference           color;
     VkAttachmentReference           depthstencil;
     vector<VkAttachmentDescription> attachments;
 
     /// Color attachment
+    /// Its contents are only preserved when loaded, otherwise the previous layout does not matter
     VkAttachmentDescription attachmentColor;
     attachmentColor.flags           = 0;
-    attachmentColor.format          = colorFormat;
+    attachmentColor.format          = mColorFormat;
     attachmentColor.samples         = VK_SAMPLE_COUNT_1_BIT;
-    attachmentColor.loadOp          = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachmentColor.loadOp          = colorLoadOp;
     attachmentColor.storeOp         = VK_ATTACHMENT_STORE_OP_STORE;
     attachmentColor.stencilLoadOp   = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     attachmentColor.stencilStoreOp  = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachmentColor.initialLayout   = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachmentColor.initialLayout   = colorLoadOp == VK_ATTACHMENT_LOAD_OP_LOAD ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
     attachmentColor.finalLayout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
     attachments.push_back(attachmentColor);
@@ -88,17 +135,20 @@ RenderPass::Create(VkFormat colorFormat, VkFormat depthstencilFormat)
     color.layout               = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
     /// Depth/Stencil attachment
-    if(depthstencilFormat != VK_FORMAT_UNDEFINED) {
+    if(mDepthStencilFormat != VK_FORMAT_UNDEFINED) {
         VkAttachmentDescription attachmentDepthStencil;
 
+        const bool preserved = depthLoadOp   == VK_ATTACHMENT_LOAD_OP_LOAD ||
+                               stencilLoadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
+
         attachmentDepthStencil.flags          = 0;
-        attachmentDepthStencil.format         = depthstencilFormat;
+        attachmentDepthStencil.format         = mDepthStencilFormat;
         attachmentDepthStencil.samples        = VK_SAMPLE_COUNT_1_BIT;
-        attachmentDepthStencil.loadOp         = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-        attachmentDepthStencil.storeOp        = mDepthWriteEnabled   ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        attachmentDepthStencil.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-        attachmentDepthStencil.stencilStoreOp = mStencilWriteEnabled ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        attachmentDepthStencil.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
+        attachmentDepthStencil.loadOp         = depthLoadOp;
+        attachmentDepthStencil.storeOp        = depthStoreOp;
+        attachmentDepthStencil.stencilLoadOp  = stencilLoadOp;
+        attachmentDepthStencil.stencilStoreOp = stencilStoreOp;
+        attachmentDepthStencil.initialLayout  = preserved ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
         attachmentDepthStencil.finalLayout    = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
         attachments.push_back(attachmentDepthStencil);
@@ -112,13 +162,27 @@ RenderPass::Create(VkFormat colorFormat, VkFormat depthstencilFormat)
     subpass.flags                   = 0;
     subpass.colorAttachmentCount    = 1;
     subpass.pColorAttachments       = &color;
-    subpass.pDepthStencilAttachment = depthstencilFormat != VK_FORMAT_UNDEFINED ? &depthstencil : NULL;
+    subpass.pDepthStencilAttachment = mDepthStencilFormat != VK_FORMAT_UNDEFINED ? &depthstencil : NULL;
     subpass.pResolveAttachments     = NULL;
     subpass.inputAttachmentCount    = 0;
     subpass.pInputAttachments       = NULL;
     subpass.preserveAttachmentCount = 0;
     subpass.pPreserveAttachments    = NULL;
 
+    /// Attachments stay in their attachment layouts between render passes, so the
+    /// writes of earlier render passes are ordered by this dependency instead of a barrier
+    VkSubpassDependency dependency;
+    dependency.srcSubpass      = VK_SUBPASS_EXTERNAL;
+    dependency.dstSubpass      = 0;
+    dependency.srcStageMask    = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                 VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependency.dstStageMask    = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                 VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependency.srcAccessMask   = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependency.dstAccessMask   = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT  | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                 VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependency.dependencyFlags = 0;
+
     VkRenderPassCreateInfo info;
     info.sType            = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     info.pNext            = NULL;
@@ -127,35 +191,84 @@ RenderPass::Create(VkFormat colorFormat, VkFormat depthstencilFormat)
     info.pAttachments     = attachments.data();
     info.subpassCount     = 1;
     info.pSubpasses       = &subpass;
-    info.dependencyCount  = 0;
-    info.pDependencies    = NULL;
+    info.dependencyCount  = 1;
+    info.pDependencies    = &dependency;
 
-    VkResult err = vkCreateRenderPass(mVkContext->vkDevice, &info, NULL, &mVkRenderPass);
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    VkResult err = vkCreateRenderPass(mVkContext->vkDevice, &info, NULL, &renderPass);
     assert(!err);
 
-    return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
+    if(err == VK_ERROR_OUT_OF_HOST_MEMORY || err == VK_ERROR_OUT_OF_DEVICE_MEMORY) {
+        return VK_NULL_HANDLE;
+    }
+
+    mVkRenderPassVariants[GetVariantKey(colorLoadOp, depthLoadOp, stencilLoadOp, depthStoreOp, stencilStoreOp)] = renderPass;
+
+    return renderPass;
 }
 
+void
+RenderPass::SetClearAttachment(const VkClearAttachment *clearAttachment)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(clearAttachment->aspectMask & VK_IMAGE_ASPECT_COLOR_BIT) {
+        mColorLoadOp                           = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        mVkClearValues[0].color                = clearAttachment->clearValue.color;
+    }
+
+    if(clearAttachment->aspectMask & VK_IMAGE_ASPECT_DEPTH_BIT) {
+        mDepthLoadOp                           = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        mVkClearValues[1].depthStencil.depth   = clearAttachment->clearValue.depthStencil.depth;
+    }
+
+    if(clearAttachment->aspectMask & VK_IMAGE_ASPECT_STENCIL_BIT) {
+        mStencilLoadOp                         = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        mVkClearValues[1].depthStencil.stencil = clearAttachment->clearValue.depthStencil.stencil;
+    }
+}
 
 void
 RenderPass::Begin(VkCommandBuffer *activeCmdBuffer, VkFramebuffer *framebuffer, uint32_t width, uint32_t height)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    VkRenderPass renderPass = mVkRenderPass;
+    auto it = mVkRenderPassVariants.find(GetVariantKey(mColorLoadOp, mDepthLoadOp, mStencilLoadOp, mDepthStoreOp, mStencilStoreOp));
+    if(it != mVkRenderPassVariants.end()) {
+        renderPass = it->second;
+    } else {
+        VkRenderPass variant = CreateVariant(mColorLoadOp, mDepthLoadOp, mStencilLoadOp, mDepthStoreOp, mStencilStoreOp);
+        if(variant != VK_NULL_HANDLE) {
+            renderPass = variant;
+        }
+    }
+
+    /// Clear values are indexed by attachment
+    uint32_t clearValueCount = 0;
+    if(HasPendingClears()) {
+        clearValueCount = mDepthStencilFormat != VK_FORMAT_UNDEFINED ? 2 : 1;
+    }
+
     VkRenderPassBeginInfo info;
     info.sType                     = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     info.pNext                     = NULL;
     info.framebuffer               = *framebuffer;
-    info.renderPass                = mVkRenderPass;
+    info.renderPass                = renderPass;
     info.renderArea.offset.x       = 0;
     info.renderArea.offset.y       = 0;
     info.renderArea.extent.width   = width;
     info.renderArea.extent.height  = height;
-    info.clearValueCount           = 0;
-    info.pClearValues              = NULL;
+    info.clearValueCount           = clearValueCount;
+    info.pClearValues              = clearValueCount ? mVkClearValues : NULL;
 
     vkCmdBeginRenderPass(*activeCmdBuffer, &info, mVkSubpassContents);
 
+    /// Attachments that are not cleared before the next render pass begins keep their contents
+    mColorLoadOp   = VK_ATTACHMENT_LOAD_OP_LOAD;
+    mDepthLoadOp   = VK_ATTACHMENT_LOAD_OP_LOAD;
+    mStencilLoadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+
     mStarted = true;
 }
 
@@ -40,11 +40,28 @@ private:
     const
     VkPipelineBindPoint     mVkPipelineBindPoint;
     VkRenderPass            mVkRenderPass;
+    VkFormat                mColorFormat;
+    VkFormat                mDepthStencilFormat;
+
+    /// Variants that differ only in their load/store ops, keyed by GetVariantKey()
+    map<uint32_t, VkRenderPass> mVkRenderPassVariants;
+
+    VkAttachmentLoadOp      mColorLoadOp;
+    VkAttachmentLoadOp      mDepthLoadOp;
+    VkAttachmentLoadOp      mStencilLoadOp;
+    VkAttachmentStoreOp     mDepthStoreOp;
+    VkAttachmentStoreOp     mStencilStoreOp;
+    VkClearValue            mVkClearValues[2];
 
-    VkBool32                mDepthWriteEnabled;
-    VkBool32                mStencilWriteEnabled;
     VkBool32                mStarted;
 
+    static uint32_t         GetVariantKey(VkAttachmentLoadOp colorLoadOp,
+                                          VkAttachmentLoadOp depthLoadOp, VkAttachmentLoadOp stencilLoadOp,
+                                          VkAttachmentStoreOp depthStoreOp, VkAttachmentStoreOp stencilStoreOp);
+    VkRenderPass            CreateVariant(VkAttachmentLoadOp colorLoadOp,
+                                          VkAttachmentLoadOp depthLoadOp, VkAttachmentLoadOp stencilLoadOp,
+                                          VkAttachmentStoreOp depthStoreOp, VkAttachmentStoreOp stencilStoreOp);
+
 public:
 
 // Constructor
@@ -64,17 +81,26 @@ public:
     void                    Release (void);
 
 // Get functions
-    inline VkBool32         GetDepthWriteEnabled(void)                    const { FUN_ENTRY(GL_LOG_TRACE); return mDepthWriteEnabled;   }
-    inline VkBool32         GetStencilWriteEnabled(void)                  const { FUN_ENTRY(GL_LOG_TRACE); return mStencilWriteEnabled; }
+    inline VkAttachmentLoadOp GetDepthLoadOp(void)                        const { FUN_ENTRY(GL_LOG_TRACE); return mDepthLoadOp;         }
+    inline VkAttachmentLoadOp GetStencilLoadOp(void)                      const { FUN_ENTRY(GL_LOG_TRACE); return mStencilLoadOp;       }
+    inline bool             HasPendingClears(void)                        const { FUN_ENTRY(GL_LOG_TRACE); return mColorLoadOp   == VK_ATTACHMENT_LOAD_OP_CLEAR ||
+                                                                                                                 mDepthLoadOp   == VK_ATTACHMENT_LOAD_OP_CLEAR ||
+                                                                                                                 mStencilLoadOp == VK_ATTACHMENT_LOAD_OP_CLEAR; }
+    inline VkBool32         GetStarted(void)                              const { FUN_ENTRY(GL_LOG_TRACE); return mStarted;             }
     inline VkRenderPass*    GetRenderPass(void)                                 { FUN_ENTRY(GL_LOG_TRACE); return &mVkRenderPass; }
+    inline VkFormat         GetColorFormat(void)                          const { FUN_ENTRY(GL_LOG_TRACE); return mColorFormat;         }
+    inline VkFormat         GetDepthStencilFormat(void)                   const { FUN_ENTRY(GL_LOG_TRACE); return mDepthStencilFormat;  }
 
 // Set Functions
-    inline void             SetDepthWriteEnabled(VkBool32 enable)               { FUN_ENTRY(GL_LOG_TRACE); mDepthWriteEnabled   = enable;    }
-    inline void             SetStencilWriteEnabled(VkBool32 enable)             { FUN_ENTRY(GL_LOG_TRACE); mStencilWriteEnabled = enable;    }
+           void             SetClearAttachment(const VkClearAttachment *clearAttachment);
+    inline void             SetDepthLoadOp(VkAttachmentLoadOp loadOp)           { FUN_ENTRY(GL_LOG_TRACE); mDepthLoadOp         = loadOp;    }
+    inline void             SetStencilLoadOp(VkAttachmentLoadOp loadOp)         { FUN_ENTRY(GL_LOG_TRACE); mStencilLoadOp       = loadOp;    }
+    inline void             SetDepthStoreOp(VkAttachmentStoreOp storeOp)        { FUN_ENTRY(GL_LOG_TRACE); mDepthStoreOp        = storeOp;   }
+    inline void             SetStencilStoreOp(VkAttachmentStoreOp storeOp)      { FUN_ENTRY(GL_LOG_TRACE); mStencilStoreOp      = storeOp;   }
     inline void             SetVkContext(const vkContext_t *vkContext)          { FUN_ENTRY(GL_LOG_TRACE); mVkContext           = vkContext; }
 
 };
 
 }
 
-#endif // __VKCLEARPASS_H__
+#endif // __VKRENDERPASS_H__
@@ -0,0 +1,221 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       retirementQueue.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Deferred Destruction of Vulkan Objects shared by all Contexts
+ *
+ *  @section
+ *
+ *  Vulkan objects that are released by GL may still be used by commands that
+ *  are being recorded or executed. Objects are shared by the contexts of a
+ *  share group and every context records and submits its own commands, so
+ *  they are retired to a single queue per device instead.
+ *
+ *  Every command buffer manager and upload queue is a submitter that reports
+ *  the epoch at which each piece of its work begins, and the epoch at which
+ *  its oldest pending work began whenever some of it completes. Each retired
+ *  object is stamped with an epoch, and it is destroyed once all work that
+ *  began before that epoch has completed.
+ *
+ *  Objects shared by several GL objects, such as shader modules and layouts,
+ *  are reference counted in a hash map and retired when their last reference
+ *  is dropped. Retired objects are kept in the order they were retired, so
+ *  completed work frees them in bulk from the front of the queue, and
+ *  releasing an object never waits for the device.
+ *
+ */
+
+#include "retirementQueue.h"
+#include "memoryAllocator.h"
+
+RetirementQueue::RetirementQueue(const vkContext_t *vkContext)
+: mVkContext(vkContext), mEpoch(0)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+}
+
+RetirementQueue::~RetirementQueue()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    assert(mSubmitters.empty());
+
+    for(auto resource : mRetiredResources) {
+        DestroyResource(resource);
+        delete resource;
+    }
+    mRetiredResources.clear();
+
+    for(auto resource : mReferencedResources) {
+        DestroyResource(resource.second);
+        delete resource.second;
+    }
+    mReferencedResources.clear();
+}
+
+void
+RetirementQueue::AddSubmitter(const void *submitter)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    submitterState_t state;
+    state.busy  = false;
+    state.epoch = mEpoch;
+    mSubmitters[submitter] = state;
+}
+
+void
+RetirementQueue::RemoveSubmitter(const void *submitter)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mSubmitters.erase(submitter);
+    FreeResources();
+}
+
+uint64_t
+RetirementQueue::SetSubmitterBusy(const void *submitter)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    assert(mSubmitters.find(submitter) != mSubmitters.end());
+    submitterState_t *state = &mSubmitters[submitter];
+    if(!state->busy) {
+        state->busy  = true;
+        state->epoch = mEpoch;
+    }
+
+    /// Work that begins now may reference any resource that has not been retired yet
+    return mEpoch;
+}
+
+void
+RetirementQueue::SetSubmitterProgress(const void *submitter, uint64_t epoch)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    assert(mSubmitters.find(submitter) != mSubmitters.end());
+    submitterState_t *state = &mSubmitters[submitter];
+    assert(state->busy && state->epoch <= epoch);
+    state->epoch = epoch;
+
+    FreeResources();
+}
+
+void
+RetirementQueue::SetSubmitterIdle(const void *submitter)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    assert(mSubmitters.find(submitter) != mSubmitters.end());
+    submitterState_t *state = &mSubmitters[submitter];
+    state->busy  = false;
+    state->epoch = mEpoch;
+
+    FreeResources();
+}
+
+void
+RetirementQueue::FreeResources(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// Resources retired up to the oldest pending work of the busy submitters
+    /// cannot be referenced by any of their commands
+    uint64_t safeEpoch = UINT64_MAX;
+    for(const auto &submitter : mSubmitters) {
+        if(submitter.second.busy && submitter.second.epoch < safeEpoch) {
+            safeEpoch = submitter.second.epoch;
+        }
+    }
+
+    while(!mRetiredResources.empty() && mRetiredResources.front()->mEpoch <= safeEpoch) {
+        DestroyResource(mRetiredResources.front());
+
+        delete mRetiredResources.front();
+        mRetiredResources.pop_front();
+    }
+}
+
+void
+RetirementQueue::DestroyResource(const resourceBase_t *resourceBase)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    switch(resourceBase->mType) {
+    case RESOURCE_TYPE_SHADER: {
+        referencedResource_t<VkShaderModule> *resource = (referencedResource_t<VkShaderModule> *)resourceBase;
+        vkDestroyShaderModule(mVkContext->vkDevice, resource->mResourcePtr, NULL);
+        } break;
+    case RESOURCE_TYPE_PIPELINE_LAYOUT: {
+        referencedResource_t<VkPipelineLayout> *resource = (referencedResource_t<VkPipelineLayout> *)resourceBase;
+        vkDestroyPipelineLayout(mVkContext->vkDevice, resource->mResourcePtr, NULL);
+        } break;
+    case RESOURCE_TYPE_DESC_POOL: {
+        referencedResource_t<VkDescriptorPool> *resource = (referencedResource_t<VkDescriptorPool> *)resourceBase;
+        vkDestroyDescriptorPool(mVkContext->vkDevice, resource->mResourcePtr, NULL);
+        } break;
+    case RESOURCE_TYPE_DESC_SET_LAYOUT: {
+        referencedResource_t<VkDescriptorSetLayout> *resource = (referencedResource_t<VkDescriptorSetLayout> *)resourceBase;
+        vkDestroyDescriptorSetLayout(mVkContext->vkDevice, resource->mResourcePtr, NULL);
+        } break;
+    case RESOURCE_TYPE_PIPELINE: {
+        referencedResource_t<VkPipeline> *resource = (referencedResource_t<VkPipeline> *)resourceBase;
+        vkDestroyPipeline(mVkContext->vkDevice, resource->mResourcePtr, NULL);
+        } break;
+    case RESOURCE_TYPE_BUFFER: {
+        referencedResource_t<VkBuffer> *resource = (referencedResource_t<VkBuffer> *)resourceBase;
+        vkDestroyBuffer(mVkContext->vkDevice, resource->mResourcePtr, NULL);
+        } break;
+    case RESOURCE_TYPE_MEMORY: {
+        referencedResource_t<memoryAllocation_t> *resource = (referencedResource_t<memoryAllocation_t> *)resourceBase;
+        mVkContext->mMemoryAllocator->Free(&resource->mResourcePtr);
+        } break;
+    case RESOURCE_TYPE_IMAGE: {
+        referencedResource_t<VkImage> *resource = (referencedResource_t<VkImage> *)resourceBase;
+        vkDestroyImage(mVkContext->vkDevice, resource->mResourcePtr, NULL);
+        } break;
+    case RESOURCE_TYPE_IMAGE_VIEW: {
+        referencedResource_t<VkImageView> *resource = (referencedResource_t<VkImageView> *)resourceBase;
+        vkDestroyImageView(mVkContext->vkDevice, resource->mResourcePtr, NULL);
+        } break;
+    case RESOURCE_TYPE_SAMPLER: {
+        referencedResource_t<VkSampler> *resource = (referencedResource_t<VkSampler> *)resourceBase;
+        vkDestroySampler(mVkContext->vkDevice, resource->mResourcePtr, NULL);
+        } break;
+    case RESOURCE_TYPE_FRAMEBUFFER: {
+        referencedResource_t<VkFramebuffer> *resource = (referencedResource_t<VkFramebuffer> *)resourceBase;
+        vkDestroyFramebuffer(mVkContext->vkDevice, resource->mResourcePtr, NULL);
+        } break;
+    case RESOURCE_TYPE_RENDER_PASS: {
+        referencedResource_t<VkRenderPass> *resource = (referencedResource_t<VkRenderPass> *)resourceBase;
+        vkDestroyRenderPass(mVkContext->vkDevice, resource->mResourcePtr, NULL);
+        } break;
+    default: NOT_REACHED(); break;
+    }
+}
@@ -0,0 +1,181 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       retirementQueue.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Deferred Destruction of Vulkan Objects shared by all Contexts
+ *
+ */
+
+#ifndef __VKRETIREMENTQUEUE_H__
+#define __VKRETIREMENTQUEUE_H__
+
+#include "utils/globals.h"
+#include <deque>
+#include <unordered_map>
+
+typedef enum {
+    RESOURCE_TYPE_SHADER = 0,
+    RESOURCE_TYPE_PIPELINE_LAYOUT,
+    RESOURCE_TYPE_DESC_POOL,
+    RESOURCE_TYPE_DESC_SET_LAYOUT,
+    RESOURCE_TYPE_PIPELINE,
+    RESOURCE_TYPE_BUFFER,
+    RESOURCE_TYPE_MEMORY,
+    RESOURCE_TYPE_IMAGE,
+    RESOURCE_TYPE_IMAGE_VIEW,
+    RESOURCE_TYPE_SAMPLER,
+    RESOURCE_TYPE_FRAMEBUFFER,
+    RESOURCE_TYPE_RENDER_PASS,
+    RESOURCE_TYPE_LAST
+} resourceType_t;
+
+class resourceBase_t {
+public:
+
+    uint32_t                        mRefCount;
+    resourceType_t                  mType;
+    uint64_t                        mEpoch;
+
+    resourceBase_t(resourceType_t type) : mRefCount(1), mType(type), mEpoch(0) { FUN_ENTRY(GL_LOG_TRACE); }
+    virtual ~resourceBase_t()                                                   { FUN_ENTRY(GL_LOG_TRACE); }
+};
+
+template<typename T>
+class referencedResource_t : public resourceBase_t {
+public:
+
+    T                               mResourcePtr;
+
+    referencedResource_t(T resourcePtr, resourceType_t type)
+    : resourceBase_t(type), mResourcePtr(resourcePtr)                           { FUN_ENTRY(GL_LOG_TRACE); }
+};
+
+class RetirementQueue {
+private:
+
+    typedef struct submitterState_t {
+        bool                        busy;
+        /// All work of the submitter that began before this epoch has completed
+        uint64_t                    epoch;
+    } submitterState_t;
+
+    /// Handles of different object types may have the same value
+    typedef std::pair<resourceType_t, uint64_t> resourceKey_t;
+
+    struct resourceKeyHash_t {
+        size_t operator()(const resourceKey_t &key) const { return std::hash<uint64_t>()(key.second ^ (static_cast<uint64_t>(key.first) << 58)); }
+    };
+
+    const
+    vkContext_t                    *mVkContext;
+
+    /// Guards the resources and the submitters, as objects are shared by the
+    /// contexts of a share group and released from any of their threads
+    std::mutex                      mMutex;
+
+    /// Reference counted objects that are still in use by GL objects
+    std::unordered_map<resourceKey_t, resourceBase_t *, resourceKeyHash_t> mReferencedResources;
+    /// Objects that are not used by GL objects anymore, in increasing epoch order
+    std::deque<resourceBase_t *>    mRetiredResources;
+    map<const void *, submitterState_t> mSubmitters;
+    uint64_t                        mEpoch;
+
+    void FreeResources(void);
+    void DestroyResource(const resourceBase_t *resourceBase);
+
+    template<typename T>
+    static resourceKey_t GetResourceKey(T resource, resourceType_t type)
+    {
+        FUN_ENTRY(GL_LOG_TRACE);
+
+        assert(resource);
+
+        /// Non-dispatchable handles are either pointers or 64-bit integers
+        return resourceKey_t(type, (uint64_t)(resource));
+    }
+
+    void Retire(resourceBase_t *resourceBase)
+    {
+        FUN_ENTRY(GL_LOG_TRACE);
+
+        resourceBase->mRefCount = 0;
+        resourceBase->mEpoch    = ++mEpoch;
+        mRetiredResources.push_back(resourceBase);
+    }
+
+public:
+// Constructor
+    RetirementQueue(const vkContext_t *vkContext);
+
+// Destructor
+    ~RetirementQueue();
+
+// Submitter Functions
+    void AddSubmitter(const void *submitter);
+    void RemoveSubmitter(const void *submitter);
+    uint64_t SetSubmitterBusy(const void *submitter);
+    void SetSubmitterProgress(const void *submitter, uint64_t epoch);
+    void SetSubmitterIdle(const void *submitter);
+
+// Resource Functions
+    template<typename T>
+    void RetireResource(T resource, resourceType_t type)
+    {
+        FUN_ENTRY(GL_LOG_TRACE);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        /// The resource may still be referenced by recorded or in-flight commands,
+        /// so it is destroyed only after all work that began before now has completed.
+        Retire(new referencedResource_t<T>(resource, type));
+    }
+
+    template<typename T>
+    void RefResource(T resource, resourceType_t type)
+    {
+        FUN_ENTRY(GL_LOG_TRACE);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        resourceBase_t *&res = mReferencedResources[GetResourceKey(resource, type)];
+        if(!res) {
+            res = new referencedResource_t<T>(resource, type);
+        } else {
+            ++res->mRefCount;
+        }
+    }
+
+    template<typename T>
+    void UnrefResouce(T resource, resourceType_t type)
+    {
+        FUN_ENTRY(GL_LOG_TRACE);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        auto it = mReferencedResources.find(GetResourceKey(resource, type));
+        if(it != mReferencedResources.end()) {
+            assert(it->second->mRefCount);
+            if(!--it->second->mRefCount) {
+                Retire(it->second);
+                mReferencedResources.erase(it);
+            }
+        }
+    }
+};
+
+#endif // __VKRETIREMENTQUEUE_H__
@@ -0,0 +1,163 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       ringBuffer.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Streaming Ring Buffer Functionality in Vulkan
+ *
+ *  @section
+ *
+ *  A ring buffer is a single persistently mapped buffer that is split in one
+ *  region per frame in flight. Data that changes from draw to draw is
+ *  appended to the region of the frame being recorded and accessed by the
+ *  device at the returned offset. A region is rewound only when its frame
+ *  begins again, which happens after the command buffer manager has waited
+ *  for the previous submission of the frame to complete.
+ *
+ *  Every rewind increases the generation of the ring buffer, so that users
+ *  can tell when offsets returned earlier must not be referenced any more.
+ *
+ *  The buffer is created on the first allocation, as many contexts, like the
+ *  ones of worker threads that only upload resources, never stream some
+ *  kinds of data.
+ *
+ *  Data larger than a whole region, like the client arrays of a big draw,
+ *  make the ring buffer grow. The previous buffer is retired, so the commands
+ *  recorded so far keep reading from it until they have completed, and the
+ *  generation is increased as well.
+ *
+ */
+
+#include "ringBuffer.h"
+#include "cbManager.h"
+#include <algorithm>
+
+namespace vulkanAPI {
+
+RingBuffer::RingBuffer(const vkContext_t *vkContext, VkBufferUsageFlags usage, VkDeviceSize regionSize)
+: mVkContext(vkContext), mRegionSize(regionSize), mAlignment(16), mRegion(0), mHead(0), mGeneration(0), mFrameSerial(0)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(mVkContext->vkGpus[0], &properties);
+        mAlignment = std::max(mAlignment, properties.limits.minUniformBufferOffsetAlignment);
+    }
+
+    mBuffer = new Buffer(vkContext, usage, VK_SHARING_MODE_EXCLUSIVE);
+    mMemory = new Memory(vkContext, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+}
+
+RingBuffer::~RingBuffer()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    delete mBuffer;
+    delete mMemory;
+}
+
+bool
+RingBuffer::Create(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mBuffer->SetSize(mRegionSize * GLOVE_NUM_FRAMES_IN_FLIGHT);
+
+    if(!mBuffer->CreateVkBuffer()                                    ||
+       !mMemory->GetBufferMemoryRequirements(mBuffer->GetVkBuffer()) ||
+       !mMemory->Allocate()                                          ||
+       !mMemory->BindBufferMemory(mBuffer->GetVkBuffer())            ||
+       !mMemory->GetMappedData()) {
+        mBuffer->Release();
+        mMemory->Release();
+        return false;
+    }
+
+    return true;
+}
+
+void
+RingBuffer::UpdateRegion(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// The region of a frame is reused only once the GPU has completed its previous use
+    const uint64_t frameSerial = mVkContext->mCommandBufferManager->GetActiveFrameSerial();
+    if(frameSerial != mFrameSerial) {
+        mFrameSerial = frameSerial;
+        mRegion      = mVkContext->mCommandBufferManager->GetActiveFrameIndex();
+        mHead        = 0;
+        ++mGeneration;
+    }
+}
+
+bool
+RingBuffer::Grow(VkDeviceSize size)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkDeviceSize regionSize = mRegionSize;
+    while(regionSize < size) {
+        regionSize *= 2;
+    }
+
+    mBuffer->Release();
+    mMemory->Release();
+
+    mRegionSize = regionSize;
+    mHead       = 0;
+    ++mGeneration;
+
+    return Create();
+}
+
+uint8_t *
+RingBuffer::Allocate(VkDeviceSize size, VkDeviceSize *offset)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    UpdateRegion();
+
+    if(mBuffer->GetVkBuffer() == VK_NULL_HANDLE && !Create()) {
+        return nullptr;
+    }
+
+    VkDeviceSize head = (mHead + mAlignment - 1) / mAlignment * mAlignment;
+    if(head + size > mRegionSize) {
+        /// Allocations that fit in a region are retried by the caller in the next one
+        if(size <= mRegionSize || !Grow(size)) {
+            return nullptr;
+        }
+        head = 0;
+    }
+
+    *offset = mRegion * mRegionSize + head;
+    mHead   = head + size;
+
+    return mMemory->GetMappedData() + *offset;
+}
+
+void
+RingBuffer::Flush(VkDeviceSize size, VkDeviceSize offset) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mMemory->FlushData(size, offset);
+}
+
+}
@@ -0,0 +1,76 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       ringBuffer.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Streaming Ring Buffer Functionality in Vulkan
+ *
+ */
+
+#ifndef __VKRINGBUFFER_H__
+#define __VKRINGBUFFER_H__
+
+#include "buffer.h"
+#include "memory.h"
+
+namespace vulkanAPI {
+
+class RingBuffer {
+
+private:
+
+    const
+    vkContext_t *                     mVkContext;
+
+    Buffer *                          mBuffer;
+    Memory *                          mMemory;
+
+    VkDeviceSize                      mRegionSize;
+    VkDeviceSize                      mAlignment;
+    uint32_t                          mRegion;
+    VkDeviceSize                      mHead;
+    uint32_t                          mGeneration;
+    uint64_t                          mFrameSerial;
+
+    bool                              Create(void);
+    bool                              Grow(VkDeviceSize size);
+
+public:
+// Constructor
+    RingBuffer(const vkContext_t *vkContext, VkBufferUsageFlags usage, VkDeviceSize regionSize);
+
+// Destructor
+    ~RingBuffer();
+
+// Allocate Functions
+    uint8_t *                         Allocate(VkDeviceSize size, VkDeviceSize *offset);
+
+// Update Functions
+    void                              UpdateRegion(void);
+
+// Flush Functions
+    void                              Flush(VkDeviceSize size, VkDeviceSize offset) const;
+
+// Get Functions
+    inline VkBuffer                   GetVkBuffer(void)                         { FUN_ENTRY(GL_LOG_TRACE); return mBuffer->GetVkBuffer(); }
+    inline VkDeviceSize               GetRegionSize(void)                 const { FUN_ENTRY(GL_LOG_TRACE); return mRegionSize;  }
+    inline uint32_t                   GetGeneration(void)                 const { FUN_ENTRY(GL_LOG_TRACE); return mGeneration;  }
+};
+
+}
+
+#endif // __VKRINGBUFFER_H__
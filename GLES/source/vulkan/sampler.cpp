@@ -28,6 +28,7 @@
  */
 
 #include "sampler.h"
+#include "retirementQueue.h"
 
 namespace vulkanAPI {
 
@@ -62,7 +63,7 @@ Sampler::Release(void)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     if(mVkSampler != VK_NULL_HANDLE) {
-        vkDestroySampler(mVkContext->vkDevice, mVkSampler, NULL);
+        mVkContext->mRetirementQueue->RetireResource(mVkSampler, RESOURCE_TYPE_SAMPLER);
         mVkSampler = VK_NULL_HANDLE;
     }
 
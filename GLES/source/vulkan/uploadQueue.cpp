@@ -0,0 +1,469 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       uploadQueue.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Batched Texture Upload Functionality in Vulkan
+ *
+ *  @section
+ *
+ *  The upload queue gathers the buffer to image copies of texture uploads
+ *  in batches. Each batch owns a command buffer, a fence and a region of a
+ *  persistently mapped staging buffer. Pixels are converted straight into
+ *  the staging region and the copies, together with one layout transition
+ *  per image on each side, are recorded in the batch command buffer. A batch
+ *  is submitted when its staging region is full or when a draw submission
+ *  samples one of its images, so many glTexImage2D calls end up in a single
+ *  submission without waiting for the device.
+ *
+ *  Every batch is tagged with a serial. Textures remember the serial of the
+ *  batch that carries their last upload, so that the device is waited on
+ *  only when an upload that is actually needed has not landed yet.
+ *
+ *  When the device exposes a transfer only queue family the batches are
+ *  executed there, and draw submissions wait on the batch fence before
+ *  sampling. Otherwise they share the graphics queue, where submission order
+ *  together with the final barrier of each batch is enough.
+ *
+ *  Every context owns an upload queue. The upload queue is a submitter of the
+ *  retirement queue on its own, so that images and buffers released while
+ *  uploads to them are pending are destroyed only after those complete.
+ *
+ */
+
+#include "uploadQueue.h"
+#include "retirementQueue.h"
+#include <algorithm>
+
+UploadQueue::UploadQueue(const vkContext_t *vkContext)
+: mVkContext(vkContext), mVkQueue(vkContext->vkTransferQueue), mVkCmdPool(VK_NULL_HANDLE),
+mDedicatedQueue(vkContext->vkTransferQueueNodeIndex != vkContext->vkGraphicsQueueNodeIndex),
+mActiveBatch(0), mNextSerial(1), mSubmittedSerial(0), mCompletedSerial(0)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(uint32_t i = 0; i < GLOVE_NUM_UPLOAD_BATCHES; ++i) {
+        mBatches[i].commandBuffer = VK_NULL_HANDLE;
+        mBatches[i].fence         = VK_NULL_HANDLE;
+        mBatches[i].state         = CMD_BUFFER_INITIAL_STATE;
+        mBatches[i].serial        = 0;
+        mBatches[i].head          = 0;
+    }
+
+    mStagingBuffer = new vulkanAPI::Buffer(vkContext, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_SHARING_MODE_EXCLUSIVE);
+    mStagingMemory = new vulkanAPI::Memory(vkContext, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    mVkContext->mRetirementQueue->AddSubmitter(this);
+}
+
+UploadQueue::~UploadQueue()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(mVkContext->vkDevice != VK_NULL_HANDLE) {
+
+        WaitIdle();
+
+        for(uint32_t i = 0; i < GLOVE_NUM_UPLOAD_BATCHES; ++i) {
+            if(mBatches[i].fence != VK_NULL_HANDLE) {
+                vkDestroyFence(mVkContext->vkDevice, mBatches[i].fence, NULL);
+            }
+            if(mBatches[i].commandBuffer != VK_NULL_HANDLE) {
+                vkFreeCommandBuffers(mVkContext->vkDevice, mVkCmdPool, 1, &mBatches[i].commandBuffer);
+            }
+        }
+
+        if(mVkCmdPool != VK_NULL_HANDLE) {
+            vkDestroyCommandPool(mVkContext->vkDevice, mVkCmdPool, NULL);
+        }
+    }
+
+    delete mStagingBuffer;
+    delete mStagingMemory;
+
+    mVkContext->mRetirementQueue->RemoveSubmitter(this);
+}
+
+bool
+UploadQueue::Create(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkResult err;
+
+    VkCommandPoolCreateInfo cmdPoolInfo;
+    memset((void *)&cmdPoolInfo, 0 ,sizeof(cmdPoolInfo));
+    cmdPoolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    cmdPoolInfo.pNext            = NULL;
+    cmdPoolInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    cmdPoolInfo.queueFamilyIndex = mVkContext->vkTransferQueueNodeIndex;
+
+    err = vkCreateCommandPool(mVkContext->vkDevice, &cmdPoolInfo, NULL, &mVkCmdPool);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    VkCommandBufferAllocateInfo cmdAllocInfo;
+    cmdAllocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.pNext              = NULL;
+    cmdAllocInfo.commandPool        = mVkCmdPool;
+    cmdAllocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdAllocInfo.commandBufferCount = 1;
+
+    VkFenceCreateInfo fenceInfo;
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.pNext = NULL;
+    fenceInfo.flags = 0;
+
+    for(uint32_t i = 0; i < GLOVE_NUM_UPLOAD_BATCHES; ++i) {
+        err = vkAllocateCommandBuffers(mVkContext->vkDevice, &cmdAllocInfo, &mBatches[i].commandBuffer);
+        assert(!err);
+
+        if(err != VK_SUCCESS) {
+            return false;
+        }
+
+        err = vkCreateFence(mVkContext->vkDevice, &fenceInfo, NULL, &mBatches[i].fence);
+        assert(!err);
+
+        if(err != VK_SUCCESS) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+UploadQueue::CreateStaging(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mStagingBuffer->SetSize(GLOVE_UPLOAD_STAGING_BUFFER_SIZE * GLOVE_NUM_UPLOAD_BATCHES);
+
+    if(!mStagingBuffer->CreateVkBuffer()                                         ||
+       !mStagingMemory->GetBufferMemoryRequirements(mStagingBuffer->GetVkBuffer()) ||
+       !mStagingMemory->Allocate()                                               ||
+       !mStagingMemory->BindBufferMemory(mStagingBuffer->GetVkBuffer())          ||
+       !mStagingMemory->GetMappedData()) {
+        mStagingBuffer->Release();
+        mStagingMemory->Release();
+        return false;
+    }
+
+    return true;
+}
+
+bool
+UploadQueue::BeginBatch(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    uploadBatch_t *batch = &mBatches[mActiveBatch];
+
+    if(batch->state == CMD_BUFFER_RECORDING_STATE) {
+        return true;
+    }
+
+    /// The staging region of the batch is still read by its previous submission
+    if(!WaitBatch(batch)) {
+        return false;
+    }
+
+    VkCommandBufferBeginInfo cmdBeginInfo;
+    cmdBeginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    cmdBeginInfo.pNext            = NULL;
+    cmdBeginInfo.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    cmdBeginInfo.pInheritanceInfo = NULL;
+
+    mVkContext->mRetirementQueue->SetSubmitterBusy(this);
+
+    VkResult err = vkBeginCommandBuffer(batch->commandBuffer, &cmdBeginInfo);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    batch->state  = CMD_BUFFER_RECORDING_STATE;
+    batch->serial = mNextSerial++;
+    batch->head   = 0;
+    batch->images.clear();
+
+    return true;
+}
+
+bool
+UploadQueue::WaitBatch(uploadBatch_t *batch)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(batch->state != CMD_BUFFER_SUBMITED_STATE) {
+        return true;
+    }
+
+    VkResult err = vkWaitForFences(mVkContext->vkDevice, 1, &batch->fence, VK_TRUE, GLOVE_FENCE_WAIT_TIMEOUT);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    err = vkResetFences(mVkContext->vkDevice, 1, &batch->fence);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    mCompletedSerial = std::max(mCompletedSerial, batch->serial);
+    batch->state     = CMD_BUFFER_INITIAL_STATE;
+
+    for(uint32_t i = 0; i < GLOVE_NUM_UPLOAD_BATCHES; ++i) {
+        if(mBatches[i].state != CMD_BUFFER_INITIAL_STATE) {
+            return true;
+        }
+    }
+    mVkContext->mRetirementQueue->SetSubmitterIdle(this);
+
+    return true;
+}
+
+uint8_t *
+UploadQueue::AllocateStaging(VkDeviceSize size, VkDeviceSize *offset)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(size > GLOVE_UPLOAD_STAGING_BUFFER_SIZE) {
+        return nullptr;
+    }
+
+    /// The staging buffer is created along with the first upload of the context
+    if((mStagingBuffer->GetVkBuffer() == VK_NULL_HANDLE && !CreateStaging()) || !BeginBatch()) {
+        return nullptr;
+    }
+
+    /// Buffer offsets of copies to images must be a multiple of the texel size
+    VkDeviceSize head = (mBatches[mActiveBatch].head + 15) & ~static_cast<VkDeviceSize>(15);
+    if(head + size > GLOVE_UPLOAD_STAGING_BUFFER_SIZE) {
+        if(!Submit() || !BeginBatch()) {
+            return nullptr;
+        }
+        head = 0;
+    }
+
+    *offset = mActiveBatch * GLOVE_UPLOAD_STAGING_BUFFER_SIZE + head;
+    mBatches[mActiveBatch].head = head + size;
+
+    return mStagingMemory->GetMappedData() + *offset;
+}
+
+VkCommandBuffer
+UploadQueue::BeginImageUpload(VkImage image, const VkImageSubresourceRange &range, VkImageLayout oldLayout, VkImageLayout finalLayout)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    uploadBatch_t *batch = &mBatches[mActiveBatch];
+    assert(batch->state == CMD_BUFFER_RECORDING_STATE);
+
+    for(const auto &upload : batch->images) {
+        if(upload.image == image) {
+            return batch->commandBuffer;
+        }
+    }
+
+    /// Images with contents may have been sampled by earlier draws or written by
+    /// earlier copies, both have to complete before the image is overwritten.
+    /// A transfer only queue family has no shader stages, there the draws that
+    /// sample the image are waited for by the context before the upload.
+    VkAccessFlags srcAccessMask        = VK_ACCESS_TRANSFER_WRITE_BIT;
+    VkPipelineStageFlags srcStageMask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    if(!mDedicatedQueue) {
+        srcAccessMask |= VK_ACCESS_SHADER_READ_BIT;
+        srcStageMask  |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    }
+
+    VkImageMemoryBarrier imageMemoryBarrier;
+    imageMemoryBarrier.sType                = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageMemoryBarrier.pNext                = NULL;
+    imageMemoryBarrier.srcAccessMask        = (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED) ? 0 : srcAccessMask;
+    imageMemoryBarrier.dstAccessMask        = VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageMemoryBarrier.oldLayout            = oldLayout;
+    imageMemoryBarrier.newLayout            = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    imageMemoryBarrier.srcQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.dstQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.image                = image;
+    imageMemoryBarrier.subresourceRange     = range;
+
+    vkCmdPipelineBarrier(batch->commandBuffer, srcStageMask, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, NULL, 0, NULL, 1, &imageMemoryBarrier);
+
+    imageUpload_t upload;
+    upload.image       = image;
+    upload.range       = range;
+    upload.finalLayout = finalLayout;
+    batch->images.push_back(upload);
+
+    return batch->commandBuffer;
+}
+
+bool
+UploadQueue::Submit(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    uploadBatch_t *batch = &mBatches[mActiveBatch];
+
+    if(batch->state != CMD_BUFFER_RECORDING_STATE) {
+        return true;
+    }
+
+    vector<VkImageMemoryBarrier> imageMemoryBarriers(batch->images.size());
+    for(uint32_t i = 0; i < batch->images.size(); ++i) {
+        VkImageMemoryBarrier *imageMemoryBarrier = &imageMemoryBarriers[i];
+        imageMemoryBarrier->sType                = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageMemoryBarrier->pNext                = NULL;
+        imageMemoryBarrier->srcAccessMask        = VK_ACCESS_TRANSFER_WRITE_BIT;
+        imageMemoryBarrier->dstAccessMask        = mDedicatedQueue ? 0 : VK_ACCESS_SHADER_READ_BIT            |
+                                                                     VK_ACCESS_COLOR_ATTACHMENT_READ_BIT  |
+                                                                     VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                                                     VK_ACCESS_TRANSFER_READ_BIT          |
+                                                                     VK_ACCESS_TRANSFER_WRITE_BIT;
+        imageMemoryBarrier->oldLayout            = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        imageMemoryBarrier->newLayout            = batch->images[i].finalLayout;
+        imageMemoryBarrier->srcQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
+        imageMemoryBarrier->dstQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
+        imageMemoryBarrier->image                = batch->images[i].image;
+        imageMemoryBarrier->subresourceRange     = batch->images[i].range;
+    }
+
+    /// On a dedicated queue the fence wait of the draw submission makes the
+    /// copies visible, otherwise the barrier covers later graphics submissions
+    VkPipelineStageFlags dstStages = mDedicatedQueue ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+    if(!imageMemoryBarriers.empty()) {
+        vkCmdPipelineBarrier(batch->commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStages,
+                             0, 0, NULL, 0, NULL, imageMemoryBarriers.size(), imageMemoryBarriers.data());
+    }
+
+    VkResult err = vkEndCommandBuffer(batch->commandBuffer);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    VkSubmitInfo submitInfo;
+    submitInfo.sType                  = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext                  = NULL;
+    submitInfo.waitSemaphoreCount     = 0;
+    submitInfo.pWaitSemaphores        = NULL;
+    submitInfo.pWaitDstStageMask      = NULL;
+    submitInfo.commandBufferCount     = 1;
+    submitInfo.pCommandBuffers        = &batch->commandBuffer;
+    submitInfo.signalSemaphoreCount   = 0;
+    submitInfo.pSignalSemaphores      = NULL;
+
+    {
+        std::lock_guard<std::mutex> lock(mVkContext->mQueueMutex);
+        err = vkQueueSubmit(mVkQueue, 1, &submitInfo, batch->fence);
+    }
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    batch->state     = CMD_BUFFER_SUBMITED_STATE;
+    mSubmittedSerial = batch->serial;
+    mActiveBatch     = (mActiveBatch + 1) % GLOVE_NUM_UPLOAD_BATCHES;
+
+    return true;
+}
+
+bool
+UploadQueue::IsCompleted(uint64_t serial)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(serial <= mCompletedSerial) {
+        return true;
+    }
+
+    for(uint32_t i = 0; i < GLOVE_NUM_UPLOAD_BATCHES; ++i) {
+        uploadBatch_t *batch = &mBatches[i];
+        if(batch->state == CMD_BUFFER_SUBMITED_STATE &&
+           vkGetFenceStatus(mVkContext->vkDevice, batch->fence) == VK_SUCCESS) {
+            WaitBatch(batch);
+        }
+    }
+
+    return serial <= mCompletedSerial;
+}
+
+bool
+UploadQueue::Wait(uint64_t serial)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(IsCompleted(serial)) {
+        return true;
+    }
+
+    if(serial > mSubmittedSerial && !Submit()) {
+        return false;
+    }
+
+    for(uint32_t i = 0; i < GLOVE_NUM_UPLOAD_BATCHES; ++i) {
+        if(mBatches[i].serial <= serial && !WaitBatch(&mBatches[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+UploadQueue::WaitIdle(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    return Wait(mBatches[mActiveBatch].state == CMD_BUFFER_RECORDING_STATE ? mBatches[mActiveBatch].serial : mSubmittedSerial);
+}
+
+bool
+UploadQueue::Synchronize(uint64_t serial)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// Uploads recorded so far are submitted ahead of the draws that follow
+    if(!Submit()) {
+        return false;
+    }
+
+    return !mDedicatedQueue || Wait(serial);
+}
+
+bool
+UploadQueue::IsIdle(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    return mBatches[mActiveBatch].state != CMD_BUFFER_RECORDING_STATE && IsCompleted(mSubmittedSerial);
+}
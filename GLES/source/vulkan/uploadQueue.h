@@ -0,0 +1,102 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       uploadQueue.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Batched Texture Upload Functionality in Vulkan
+ *
+ */
+
+#ifndef __VKUPLOADQUEUE_H__
+#define __VKUPLOADQUEUE_H__
+
+#include "cbManager.h"
+#include "buffer.h"
+#include "memory.h"
+
+class UploadQueue {
+private:
+
+    typedef struct imageUpload_t {
+        VkImage                         image;
+        VkImageSubresourceRange         range;
+        VkImageLayout                   finalLayout;
+    } imageUpload_t;
+
+    typedef struct uploadBatch_t {
+        VkCommandBuffer                 commandBuffer;
+        VkFence                         fence;
+        cmdBufferState_t                state;
+        uint64_t                        serial;
+        VkDeviceSize                    head;
+        vector<imageUpload_t>           images;
+    } uploadBatch_t;
+
+    const
+    vkContext_t                        *mVkContext;
+    VkQueue                             mVkQueue;
+    VkCommandPool                       mVkCmdPool;
+    bool                                mDedicatedQueue;
+
+    vulkanAPI::Buffer                  *mStagingBuffer;
+    vulkanAPI::Memory                  *mStagingMemory;
+
+    uploadBatch_t                       mBatches[GLOVE_NUM_UPLOAD_BATCHES];
+    uint32_t                            mActiveBatch;
+    uint64_t                            mNextSerial;
+    uint64_t                            mSubmittedSerial;
+    uint64_t                            mCompletedSerial;
+
+    bool                                CreateStaging(void);
+    bool                                BeginBatch(void);
+    bool                                WaitBatch(uploadBatch_t *batch);
+
+public:
+// Constructor
+    UploadQueue(const vkContext_t *vkContext);
+
+// Destructor
+    ~UploadQueue();
+
+// Create Functions
+    bool                                Create(void);
+
+// Allocate Functions
+    uint8_t                            *AllocateStaging(VkDeviceSize size, VkDeviceSize *offset);
+
+// Begin Functions
+    VkCommandBuffer                     BeginImageUpload(VkImage image, const VkImageSubresourceRange &range, VkImageLayout oldLayout, VkImageLayout finalLayout);
+
+// Submit Functions
+    bool                                Submit(void);
+
+// Wait Functions
+    bool                                Wait(uint64_t serial);
+    bool                                WaitIdle(void);
+    bool                                Synchronize(uint64_t serial);
+
+// Is Functions
+    bool                                IsCompleted(uint64_t serial);
+    bool                                IsIdle(void);
+    inline bool                         IsDedicatedQueue(void)          const { FUN_ENTRY(GL_LOG_TRACE); return mDedicatedQueue; }
+
+// Get Functions
+    inline VkBuffer                     GetStagingBuffer(void)                { FUN_ENTRY(GL_LOG_TRACE); return mStagingBuffer->GetVkBuffer(); }
+    inline uint64_t                     GetSerial(void)                 const { FUN_ENTRY(GL_LOG_TRACE); return mBatches[mActiveBatch].serial; }
+};
+
+#endif // __VKUPLOADQUEUE_H__
@@ -96,6 +96,72 @@ VkIntFormatToVkFloatFormat(VkFormat format)
     }
 }
 
+VkFormat
+VkIntFormatToVkNativeFormat(VkFormat format, bool normalized)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    switch(format) {
+    case VK_FORMAT_R32_SFLOAT:
+    case VK_FORMAT_R32G32_SFLOAT:
+    case VK_FORMAT_R32G32B32_SFLOAT:
+    case VK_FORMAT_R32G32B32A32_SFLOAT:     return format;
+
+    case VK_FORMAT_R8_SINT:                 return normalized ? VK_FORMAT_R8_SNORM           : VK_FORMAT_R8_SSCALED;
+    case VK_FORMAT_R8G8_SINT:               return normalized ? VK_FORMAT_R8G8_SNORM         : VK_FORMAT_R8G8_SSCALED;
+    case VK_FORMAT_R8G8B8_SINT:             return normalized ? VK_FORMAT_R8G8B8_SNORM       : VK_FORMAT_R8G8B8_SSCALED;
+    case VK_FORMAT_R8G8B8A8_SINT:           return normalized ? VK_FORMAT_R8G8B8A8_SNORM     : VK_FORMAT_R8G8B8A8_SSCALED;
+    case VK_FORMAT_R8_UINT:                 return normalized ? VK_FORMAT_R8_UNORM           : VK_FORMAT_R8_USCALED;
+    case VK_FORMAT_R8G8_UINT:               return normalized ? VK_FORMAT_R8G8_UNORM         : VK_FORMAT_R8G8_USCALED;
+    case VK_FORMAT_R8G8B8_UINT:             return normalized ? VK_FORMAT_R8G8B8_UNORM       : VK_FORMAT_R8G8B8_USCALED;
+    case VK_FORMAT_R8G8B8A8_UINT:           return normalized ? VK_FORMAT_R8G8B8A8_UNORM     : VK_FORMAT_R8G8B8A8_USCALED;
+    case VK_FORMAT_R16_SINT:                return normalized ? VK_FORMAT_R16_SNORM          : VK_FORMAT_R16_SSCALED;
+    case VK_FORMAT_R16G16_SINT:             return normalized ? VK_FORMAT_R16G16_SNORM       : VK_FORMAT_R16G16_SSCALED;
+    case VK_FORMAT_R16G16B16_SINT:          return normalized ? VK_FORMAT_R16G16B16_SNORM    : VK_FORMAT_R16G16B16_SSCALED;
+    case VK_FORMAT_R16G16B16A16_SINT:       return normalized ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R16G16B16A16_SSCALED;
+    case VK_FORMAT_R16_UINT:                return normalized ? VK_FORMAT_R16_UNORM          : VK_FORMAT_R16_USCALED;
+    case VK_FORMAT_R16G16_UINT:             return normalized ? VK_FORMAT_R16G16_UNORM       : VK_FORMAT_R16G16_USCALED;
+    case VK_FORMAT_R16G16B16_UINT:          return normalized ? VK_FORMAT_R16G16B16_UNORM    : VK_FORMAT_R16G16B16_USCALED;
+    case VK_FORMAT_R16G16B16A16_UINT:       return normalized ? VK_FORMAT_R16G16B16A16_UNORM : VK_FORMAT_R16G16B16A16_USCALED;
+
+    /// 32-bit integers and GL_FIXED have no floating point format of the same layout
+    default:                                return VK_FORMAT_UNDEFINED;
+    }
+}
+
+bool
+VkFormatIsVertexBufferSupported(VkPhysicalDevice gpu, VkFormat format)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(gpu, format, &properties);
+
+    return (properties.bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT) != 0;
+}
+
+bool
+VkFormatIsLinearTilingSupported(VkPhysicalDevice gpu, VkFormat format, VkFormatFeatureFlags features)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(gpu, format, &properties);
+
+    return (properties.linearTilingFeatures & features) == features;
+}
+
+bool
+VkFormatIsOptimalTilingSupported(VkPhysicalDevice gpu, VkFormat format, VkFormatFeatureFlags features)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(gpu, format, &properties);
+
+    return (properties.optimalTilingFeatures & features) == features;
+}
+
 bool
 VkFormatIsDepthStencil(VkFormat format)
 {
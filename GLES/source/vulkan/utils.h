@@ -28,6 +28,10 @@
 
 size_t                  nBytesOfVkIntFormat(VkFormat format, bool *unsigned_type);
 VkFormat                VkIntFormatToVkFloatFormat(VkFormat format);
+VkFormat                VkIntFormatToVkNativeFormat(VkFormat format, bool normalized);
+bool                    VkFormatIsVertexBufferSupported(VkPhysicalDevice gpu, VkFormat format);
+bool                    VkFormatIsLinearTilingSupported(VkPhysicalDevice gpu, VkFormat format, VkFormatFeatureFlags features);
+bool                    VkFormatIsOptimalTilingSupported(VkPhysicalDevice gpu, VkFormat format, VkFormatFeatureFlags features);
 bool                    VkFormatIsDepthStencil(VkFormat format);
 bool                    VkFormatIsDepth(VkFormat format);
 bool                    VkFormatIsStencil(VkFormat format);
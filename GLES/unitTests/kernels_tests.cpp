@@ -0,0 +1,166 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "kernels_tests.h"
+
+#include <cstring>
+#include <random>
+
+namespace Testing {
+
+// Every count up to MAX_TAIL_COUNT is converted, so that each vector width
+// is followed by every possible tail, then a few longer rows.
+static const uint32_t MAX_TAIL_COUNT = 70;
+static const uint32_t rowCounts[] = { 255, 1000 };
+static const uint32_t MAX_COUNT = 1000;
+
+static const uint32_t pixelDstSize[PIXEL_KERNEL_MAX] = { 4, 4, 3, 4, 4, 4, 4, 4, 4 };
+
+// Code here will be called immediately after the constructor (right
+// before each test).
+void KernelsTest::SetUp(void) {
+    std::mt19937 generator(0x474c4f56);
+
+    // one more byte, so that rows can also start unaligned
+    Source.resize(4 * MAX_COUNT + 1);
+    for(size_t i = 0; i < Source.size(); ++i) {
+        Source[i] = static_cast<uint8_t>(generator());
+    }
+}
+
+// Code here will be called immediately after each test (right
+// before the destructor).
+void KernelsTest::TearDown() {
+    Source.clear();
+}
+
+static void
+ComparePixelKernel(pixelKernel_t kernel, pixelKernelIsa_t isa, const uint8_t *src, uint32_t count)
+{
+    // the destinations are one pixel longer, to catch kernels writing past the row
+    const size_t dstSize = pixelDstSize[kernel] * (count + 1);
+    std::vector<uint8_t> expected(dstSize, 0xCD);
+    std::vector<uint8_t> result(dstSize, 0xCD);
+
+    GetPixelRowKernel(kernel, PIXEL_KERNEL_ISA_SCALAR)(src, expected.data(), count);
+    GetPixelRowKernel(kernel, isa)(src, result.data(), count);
+
+    ASSERT_EQ(0, memcmp(expected.data(), result.data(), dstSize))
+        << GetPixelKernelName(kernel) << " on " << GetPixelKernelIsaName(isa) << " with " << count << " pixels";
+}
+
+static void
+CompareVertexKernel(vertexKernelType_t kernel, pixelKernelIsa_t isa, const uint8_t *src, uint32_t count)
+{
+    std::vector<float> expected(count + 1, -2.0f);
+    std::vector<float> result(count + 1, -2.0f);
+
+    GetVertexKernel(kernel, PIXEL_KERNEL_ISA_SCALAR)(src, expected.data(), count);
+    GetVertexKernel(kernel, isa)(src, result.data(), count);
+
+    ASSERT_EQ(0, memcmp(expected.data(), result.data(), (count + 1) * sizeof(float)))
+        << "vertex kernel " << kernel << " on " << GetPixelKernelIsaName(isa) << " with " << count << " components";
+}
+
+TEST_F(KernelsTest, IsaAvailability)
+{
+    const pixelKernelIsa_t cpuIsa = GetPixelKernelIsa();
+
+    for(int isa = PIXEL_KERNEL_ISA_SCALAR; isa < PIXEL_KERNEL_ISA_MAX; ++isa) {
+        for(int kernel = 0; kernel < PIXEL_KERNEL_MAX; ++kernel) {
+            const bool available = GetPixelRowKernel(static_cast<pixelKernel_t>(kernel), static_cast<pixelKernelIsa_t>(isa)) != nullptr;
+            ASSERT_EQ(isa == PIXEL_KERNEL_ISA_SCALAR || isa == cpuIsa || (cpuIsa != PIXEL_KERNEL_ISA_NEON && isa < cpuIsa), available);
+        }
+        for(int kernel = 0; kernel < VERTEX_KERNEL_MAX; ++kernel) {
+            const bool available = GetVertexKernel(static_cast<vertexKernelType_t>(kernel), static_cast<pixelKernelIsa_t>(isa)) != nullptr;
+            ASSERT_EQ(isa == PIXEL_KERNEL_ISA_SCALAR || isa == cpuIsa || (cpuIsa != PIXEL_KERNEL_ISA_NEON && isa < cpuIsa), available);
+        }
+    }
+
+    ASSERT_EQ(GetPixelRowKernel(PIXEL_KERNEL_565_TO_RGBA, cpuIsa), GetPixelRowKernel(PIXEL_KERNEL_565_TO_RGBA));
+    ASSERT_EQ(GetVertexKernel(VERTEX_KERNEL_SHORT_NORM, cpuIsa), GetVertexKernel(VERTEX_KERNEL_SHORT_NORM));
+}
+
+TEST_F(KernelsTest, PixelKernelsMatchScalar)
+{
+    for(int isa = PIXEL_KERNEL_ISA_SCALAR + 1; isa < PIXEL_KERNEL_ISA_MAX; ++isa) {
+        for(int kernel = 0; kernel < PIXEL_KERNEL_MAX; ++kernel) {
+            if(!GetPixelRowKernel(static_cast<pixelKernel_t>(kernel), static_cast<pixelKernelIsa_t>(isa))) {
+                continue;
+            }
+
+            for(uint32_t count = 0; count <= MAX_TAIL_COUNT; ++count) {
+                ComparePixelKernel(static_cast<pixelKernel_t>(kernel), static_cast<pixelKernelIsa_t>(isa), Source.data(), count);
+                ComparePixelKernel(static_cast<pixelKernel_t>(kernel), static_cast<pixelKernelIsa_t>(isa), Source.data() + 1, count);
+            }
+            for(uint32_t count : rowCounts) {
+                ComparePixelKernel(static_cast<pixelKernel_t>(kernel), static_cast<pixelKernelIsa_t>(isa), Source.data(), count);
+            }
+        }
+    }
+}
+
+TEST_F(KernelsTest, VertexKernelsMatchScalar)
+{
+    for(int isa = PIXEL_KERNEL_ISA_SCALAR + 1; isa < PIXEL_KERNEL_ISA_MAX; ++isa) {
+        for(int kernel = 0; kernel < VERTEX_KERNEL_MAX; ++kernel) {
+            if(!GetVertexKernel(static_cast<vertexKernelType_t>(kernel), static_cast<pixelKernelIsa_t>(isa))) {
+                continue;
+            }
+
+            for(uint32_t count = 0; count <= MAX_TAIL_COUNT; ++count) {
+                CompareVertexKernel(static_cast<vertexKernelType_t>(kernel), static_cast<pixelKernelIsa_t>(isa), Source.data(), count);
+            }
+            for(uint32_t count : rowCounts) {
+                CompareVertexKernel(static_cast<vertexKernelType_t>(kernel), static_cast<pixelKernelIsa_t>(isa), Source.data(), count);
+            }
+        }
+    }
+}
+
+TEST_F(KernelsTest, VertexKernelsNormalize)
+{
+    const int8_t    bytes[]          = { -128, -127, 0, 127 };
+    const uint16_t  unsignedShorts[] = { 0, 65535 };
+    const float     signedNorm[]     = { -1.0f, -1.0f, 0.0f, 1.0f };
+    const float     unsignedNorm[]   = { 0.0f, 1.0f };
+    float           dst[4];
+
+    for(int isa = PIXEL_KERNEL_ISA_SCALAR; isa < PIXEL_KERNEL_ISA_MAX; ++isa) {
+        if(!GetVertexKernel(VERTEX_KERNEL_BYTE, static_cast<pixelKernelIsa_t>(isa))) {
+            continue;
+        }
+
+        GetVertexKernel(VERTEX_KERNEL_BYTE_NORM, static_cast<pixelKernelIsa_t>(isa))(reinterpret_cast<const uint8_t *>(bytes), dst, 4);
+        for(int i = 0; i < 4; ++i) {
+            ASSERT_EQ(signedNorm[i], dst[i]) << GetPixelKernelIsaName(static_cast<pixelKernelIsa_t>(isa));
+        }
+
+        GetVertexKernel(VERTEX_KERNEL_BYTE, static_cast<pixelKernelIsa_t>(isa))(reinterpret_cast<const uint8_t *>(bytes), dst, 4);
+        for(int i = 0; i < 4; ++i) {
+            ASSERT_EQ(static_cast<float>(bytes[i]), dst[i]) << GetPixelKernelIsaName(static_cast<pixelKernelIsa_t>(isa));
+        }
+
+        GetVertexKernel(VERTEX_KERNEL_UNSIGNED_SHORT_NORM, static_cast<pixelKernelIsa_t>(isa))(reinterpret_cast<const uint8_t *>(unsignedShorts), dst, 2);
+        for(int i = 0; i < 2; ++i) {
+            ASSERT_EQ(unsignedNorm[i], dst[i]) << GetPixelKernelIsaName(static_cast<pixelKernelIsa_t>(isa));
+        }
+
+        GetVertexKernel(VERTEX_KERNEL_UNSIGNED_SHORT, static_cast<pixelKernelIsa_t>(isa))(reinterpret_cast<const uint8_t *>(unsignedShorts), dst, 2);
+        for(int i = 0; i < 2; ++i) {
+            ASSERT_EQ(static_cast<float>(unsignedShorts[i]), dst[i]) << GetPixelKernelIsaName(static_cast<pixelKernelIsa_t>(isa));
+        }
+    }
+}
+
+} //end of namespace
@@ -0,0 +1,35 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef __KERNELS_TESTS_H__
+#define __KERNELS_TESTS_H__
+
+#include "gtest/gtest.h"
+#include "utils/pixelKernels.h"
+#include "utils/vertexKernels.h"
+
+#include <vector>
+
+namespace Testing {
+
+class KernelsTest : public ::testing::Test {
+protected:
+    void SetUp(void);
+    void TearDown(void);
+
+    std::vector<uint8_t> Source;
+};
+
+} //end of namespace
+
+#endif // __KERNELS_TESTS_H__
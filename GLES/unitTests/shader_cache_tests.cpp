@@ -0,0 +1,198 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "shader_cache_tests.h"
+
+#include <algorithm>
+#include <cstring>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+namespace Testing {
+
+// Size of an entry's data, plus the header of its file
+static const size_t ENTRY_SIZE = 1000;
+static const size_t ENTRY_FILE_SIZE = ENTRY_SIZE + 88;
+
+std::string Sha256Test::Digest(const void *data, size_t size) {
+    Sha256 sha256;
+    sha256.Update(data, size);
+    return sha256.FinalizeHex();
+}
+
+// The FIPS 180-2 test vectors, through the raw Update()
+TEST_F(Sha256Test, FipsVectors)
+{
+    ASSERT_EQ("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855", Digest("", 0));
+    ASSERT_EQ("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", Digest("abc", 3));
+
+    const char *message = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    ASSERT_EQ("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1", Digest(message, strlen(message)));
+
+    const std::string million(1000000, 'a');
+    ASSERT_EQ("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0", Digest(million.data(), million.size()));
+
+    // the same message, split at sizes that do not line up with the 64 byte blocks
+    Sha256 sha256;
+    for(size_t pos = 0, size = 1; pos < million.size(); pos += size, size = size % 127 + 1) {
+        sha256.Update(million.data() + pos, std::min(size, million.size() - pos));
+    }
+    ASSERT_EQ("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0", sha256.FinalizeHex());
+}
+
+// Strings are prefixed with their length, so they are intentionally not the plain digest
+TEST_F(Sha256Test, StringsArePrefixedWithTheirLength)
+{
+    Sha256 str;
+    str.Update(std::string("abc"));
+
+    Sha256 prefixed;
+    prefixed.Update((uint32_t)3);
+    prefixed.Update("abc", 3);
+
+    const std::string digest = str.FinalizeHex();
+    ASSERT_EQ(prefixed.FinalizeHex(), digest);
+    ASSERT_NE(Digest("abc", 3), digest);
+
+    Sha256 first, second;
+    first.Update(std::string("ab"));
+    first.Update(std::string("c"));
+    second.Update(std::string("a"));
+    second.Update(std::string("bc"));
+    ASSERT_NE(first.FinalizeHex(), second.FinalizeHex());
+}
+
+// Code here will be called immediately after the constructor (right
+// before each test).
+void ShaderCacheTest::SetUp(void) {
+    char directory[] = "/tmp/glove_shader_cache_tests.XXXXXX";
+    ASSERT_TRUE(mkdtemp(directory) != NULL);
+    Directory = directory;
+}
+
+// Code here will be called immediately after each test (right
+// before the destructor).
+void ShaderCacheTest::TearDown() {
+    DIR *dir = opendir(Directory.c_str());
+    if(dir) {
+        struct dirent *dirEntry;
+        while((dirEntry = readdir(dir)) != NULL) {
+            remove(Filename(dirEntry->d_name).c_str());
+        }
+        closedir(dir);
+    }
+    rmdir(Directory.c_str());
+}
+
+std::string ShaderCacheTest::Digest(uint32_t index) {
+    Sha256 sha256;
+    sha256.Update(index);
+    return sha256.FinalizeHex();
+}
+
+std::vector<uint8_t> ShaderCacheTest::Data(uint32_t index) {
+    std::vector<uint8_t> data(ENTRY_SIZE);
+    for(size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(index + i);
+    }
+    return data;
+}
+
+std::string ShaderCacheTest::Filename(const char *name) {
+    return Directory + "/" + name;
+}
+
+void ShaderCacheTest::SetFileAge(const std::string &filename, time_t age) {
+    struct utimbuf times;
+    times.actime = times.modtime = time(NULL) - age;
+    ASSERT_EQ(0, utime(filename.c_str(), &times));
+}
+
+TEST_F(ShaderCacheTest, RoundTrip)
+{
+    std::vector<uint8_t> data;
+    {
+        ShaderCache cache(16 * ENTRY_SIZE, Directory.c_str(), 64 * ENTRY_FILE_SIZE);
+
+        ASSERT_FALSE(cache.Find(Digest(0), data));
+        cache.Insert(Digest(0), Data(0));
+        cache.Insert(Digest(1), Data(1));
+
+        ASSERT_TRUE(cache.Find(Digest(0), data));
+        ASSERT_EQ(Data(0), data);
+        ASSERT_EQ(2 * ENTRY_SIZE, cache.GetSize());
+        ASSERT_EQ(1u, cache.GetHits());
+        ASSERT_EQ(1u, cache.GetMisses());
+    }
+
+    // another cache on the same directory finds the entries on disk
+    ShaderCache cache(16 * ENTRY_SIZE, Directory.c_str(), 64 * ENTRY_FILE_SIZE);
+    ASSERT_TRUE(cache.Find(Digest(1), data));
+    ASSERT_EQ(Data(1), data);
+    ASSERT_TRUE(cache.Find(Digest(0), data));
+    ASSERT_EQ(Data(0), data);
+    ASSERT_FALSE(cache.Find(Digest(2), data));
+    ASSERT_TRUE(data.empty());
+
+    // a corrupted file is a miss
+    ShaderCache corrupted(16 * ENTRY_SIZE, Directory.c_str(), 64 * ENTRY_FILE_SIZE);
+    FILE *file = fopen(Filename((Digest(1) + ".glsc").c_str()).c_str(), "r+b");
+    ASSERT_TRUE(file != NULL);
+    fseek(file, -1, SEEK_END);
+    fputc(~Data(1).back(), file);
+    fclose(file);
+    ASSERT_FALSE(corrupted.Find(Digest(1), data));
+    ASSERT_TRUE(corrupted.Find(Digest(0), data));
+}
+
+TEST_F(ShaderCacheTest, PruneKeepsMostRecentlyUsed)
+{
+    std::vector<uint8_t> data;
+    {
+        ShaderCache cache(16 * ENTRY_SIZE, Directory.c_str(), 64 * ENTRY_FILE_SIZE);
+        for(uint32_t i = 0; i < 8; ++i) {
+            cache.Insert(Digest(i), Data(i));
+        }
+    }
+
+    // entries were used in their order, the first one being the least recent
+    for(uint32_t i = 0; i < 8; ++i) {
+        SetFileAge(Filename((Digest(i) + ".glsc").c_str()), 1000 - i);
+    }
+
+    // files other than entries are never removed, temporary files only once they are stale
+    std::ofstream(Filename("pipeline.bin")) << "pipeline cache";
+    std::ofstream(Filename("stale.glsc.1.2.tmp")) << "interrupted write";
+    std::ofstream(Filename("fresh.glsc.3.4.tmp")) << "ongoing write";
+    SetFileAge(Filename("stale.glsc.1.2.tmp"), 2 * 60 * 60);
+    SetFileAge(Filename("pipeline.bin"), 2 * 60 * 60);
+
+    // with a ninth entry the files exceed the limit of eight and are pruned
+    // down to three quarters of it, the three least recently used ones
+    ShaderCache cache(0, Directory.c_str(), 8 * ENTRY_FILE_SIZE);
+    ASSERT_TRUE(cache.Find(Digest(0), data));
+    cache.Insert(Digest(8), Data(8));
+
+    for(uint32_t i = 0; i < 9; ++i) {
+        ASSERT_EQ(i < 1 || i > 3, cache.Find(Digest(i), data)) << "entry " << i;
+    }
+
+    struct stat fileStat;
+    ASSERT_EQ(0, stat(Filename("pipeline.bin").c_str(), &fileStat));
+    ASSERT_EQ(0, stat(Filename("fresh.glsc.3.4.tmp").c_str(), &fileStat));
+    ASSERT_NE(0, stat(Filename("stale.glsc.1.2.tmp").c_str(), &fileStat));
+}
+
+} //end of namespace
@@ -0,0 +1,43 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef __SHADER_CACHE_TESTS_H__
+#define __SHADER_CACHE_TESTS_H__
+
+#include "gtest/gtest.h"
+#include "resources/shaderCache.h"
+#include "utils/sha256.h"
+
+namespace Testing {
+
+class Sha256Test : public ::testing::Test {
+protected:
+    std::string Digest(const void *data, size_t size);
+};
+
+class ShaderCacheTest : public ::testing::Test {
+protected:
+    void SetUp(void);
+    void TearDown(void);
+
+    std::string Digest(uint32_t index);
+    std::vector<uint8_t> Data(uint32_t index);
+    std::string Filename(const char *name);
+    void SetFileAge(const std::string &filename, time_t age);
+
+    std::string Directory;
+};
+
+} //end of namespace
+
+#endif // __SHADER_CACHE_TESTS_H__
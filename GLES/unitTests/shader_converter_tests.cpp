@@ -0,0 +1,290 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "shader_converter_tests.h"
+
+namespace Testing {
+
+// The expected sources below are the output of the converter that rewrote
+// the source in place, one pass per kind of declaration. The single-pass
+// converter must keep producing them, apart from the differences noted.
+static const string convertedHeader =
+    "#version 400\n"
+    "#extension GL_ARB_shading_language_420pack : enable\n"
+    "#extension GL_ARB_separate_shader_objects : enable\n"
+    "#extension GL_OES_EGL_image_external : enable\n"
+    "\n"
+    "#ifdef GL_ES\n"
+    "    precision highp float;\n"
+    "#endif\n"
+    "\n"
+    "/// GL_KHR_vulkan_glsl removed texture2D(), texture2Dproj()\n"
+    "#define texture2D texture\n"
+    "#define texture2Dproj texture\n"
+    "#define samplerExternalOES sampler2D\n"
+    "\n"
+    "/// GL_KHR_vulkan_glsl removed textureCube()\n"
+    "#define textureCube texture\n"
+    "\n"
+    "#define gl_MaxVertexAttribs 32\n"
+    "#define gl_MaxVertexUniformVectors 128\n"
+    "#define gl_MaxVaryingVectors 8\n"
+    "#define gl_MaxVertexTextureImageUnits 8\n"
+    "#define gl_MaxCombinedTextureImageUnits 8 + 32\n"
+    "#define gl_MaxTextureImageUnits 32\n"
+    "#define gl_MaxFragmentUniformVectors 128\n"
+    "#define gl_MaxDrawBuffers 4\n"
+    "\n";
+
+static const char *preprocessorVertexShader =
+    "#define HAS_COLOR 1\n"
+    "#if HAS_COLOR\n"
+    "uniform vec4 u_color;\n"
+    "#else\n"
+    "#define u_color vec4(1.0)\n"
+    "#endif\n"
+    "uniform mat4 u_mvp;\n"
+    "attribute vec4 a_position;\n"
+    "varying vec4 v_color;\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    float uniformity = 1.0;\n"
+    "    {\n"
+    "        {\n"
+    "            v_color = u_color * uniformity;\n"
+    "        }\n"
+    "    }\n"
+    "    gl_Position = u_mvp * a_position;\n"
+    "}\n";
+
+static const char *preprocessorVertexShaderConverted =
+    "#define HAS_COLOR 1\n"
+    "#if HAS_COLOR\n"
+    "layout(std140, binding = 0) uniform blk_u_color {vec4 u_color;};\n"
+    "#else\n"
+    "#define u_color vec4(1.0)\n"
+    "#endif\n"
+    "layout(std140, binding = 0) uniform blk_u_mvp {mat4 u_mvp;};\n"
+    "layout(location = 0) in vec4 a_position;\n"
+    "layout(location = 0) out vec4 v_color;\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    float uniformity = 1.0;\n"
+    "    {\n"
+    "        {\n"
+    "            v_color = u_color * uniformity;\n"
+    "        }\n"
+    "    }\n"
+    "    gl_Position = u_mvp * a_position;\n"
+    "    gl_Position.z = (gl_Position.z + gl_Position.w) / 2.0;\n"
+    "}\n";
+
+// Code here will be called immediately after the constructor (right
+// before each test).
+void ShaderConverterTest::SetUp(void) {
+    Reflection.ResetReflection();
+    LiveAttributes = 0;
+}
+
+// Code here will be called immediately after each test (right
+// before the destructor).
+void ShaderConverterTest::TearDown() {
+    IoMapResolver.Reset();
+    UniformBlocks.clear();
+}
+
+void ShaderConverterTest::AddUniform(const char *name, uint32_t binding) {
+    UniformBlocks[name] = uniformBlock_t(name, string("blk_") + name, binding, false, 16, SHADER_TYPE_VERTEX, nullptr);
+}
+
+void ShaderConverterTest::AddAttribute(const char *name) {
+    Reflection.SetAttributeName(name, LiveAttributes);
+    Reflection.SetAttributeLocation(LiveAttributes, LiveAttributes);
+    Reflection.SetAttributeType(GL_FLOAT_VEC4, LiveAttributes);
+    Reflection.SetLiveAttributes(++LiveAttributes);
+}
+
+// Varyings get a location only when both stages of the program use them.
+void ShaderConverterTest::AddVarying(const char *name) {
+    IoMapResolver.notifyInOut(EShLangVertex, name, glslang::TType(glslang::EbtFloat, glslang::EvqVaryingOut, 4), true);
+    IoMapResolver.notifyInOut(EShLangFragment, name, glslang::TType(glslang::EbtFloat, glslang::EvqVaryingIn, 4), true);
+}
+
+string ShaderConverterTest::Convert(const char *source, shader_type_t shaderType) {
+    ShaderConverter converter;
+    converter.Initialize(ShaderConverter::SHADER_CONVERSION_100_400, shaderType);
+    converter.SetSlangProgram(&SlangProgram);
+    converter.SetIoMapResolver(&IoMapResolver);
+
+    string converted(source);
+    converter.Convert(converted, UniformBlocks, &Reflection);
+    return converted;
+}
+
+TEST_F(ShaderConverterTest, PreprocessorLinesAndNestedBraces)
+{
+    AddUniform("u_mvp", 0);
+    AddUniform("u_color", 0);
+    AddAttribute("a_position");
+    AddVarying("v_color");
+
+    ASSERT_EQ(convertedHeader + preprocessorVertexShaderConverted,
+              Convert(preprocessorVertexShader, SHADER_TYPE_VERTEX));
+}
+
+TEST_F(ShaderConverterTest, VersionIsReplaced)
+{
+    AddUniform("u_mvp", 0);
+    AddUniform("u_color", 0);
+    AddAttribute("a_position");
+    AddVarying("v_color");
+
+    // The line break of the dropped #version line is kept
+    ASSERT_EQ(convertedHeader + "\n" + preprocessorVertexShaderConverted,
+              Convert((string("#version 100\n") + preprocessorVertexShader).c_str(), SHADER_TYPE_VERTEX));
+
+    // Comments ahead of #version used to stay ahead of the header, they follow it now
+    ASSERT_EQ(convertedHeader + "// Header comment\n\n" + preprocessorVertexShaderConverted,
+              Convert((string("// Header comment\n#version 100\n") + preprocessorVertexShader).c_str(), SHADER_TYPE_VERTEX));
+}
+
+TEST_F(ShaderConverterTest, CommentsAreCopied)
+{
+    AddUniform("u_mvp", 0);
+    AddUniform("u_color", 0);
+    AddAttribute("a_position");
+    AddAttribute("a_texCoord");
+    AddVarying("v_texCoord");
+    AddVarying("v_color");
+
+    const char *source =
+        "#version 100\n"
+        "// Comments, preprocessor lines and nested braces\n"
+        "#define SCALE 2.0\n"
+        "#ifdef GL_ES\n"
+        "precision highp float;\n"
+        "#endif\n"
+        "\n"
+        "/* uniform mat4 u_unused; attribute vec4 a_unused; */\n"
+        "uniform mat4 u_mvp; // uniform vec4 u_commented;\n"
+        "uniform vec4 u_color;\n"
+        "attribute vec4 a_position;\n"
+        "attribute vec2 a_texCoord;\n"
+        "varying vec2 v_texCoord;\n"
+        "varying vec4 v_color;\n"
+        "\n"
+        "vec4 shade(vec4 c)\n"
+        "{\n"
+        "    if(c.a > 0.5) {\n"
+        "        for(int i = 0; i < 2; ++i) {\n"
+        "            c.rgb *= SCALE;\n"
+        "        }\n"
+        "    } else {\n"
+        "        c = vec4(0.0);\n"
+        "    }\n"
+        "    return c;\n"
+        "}\n"
+        "\n"
+        "void main()\n"
+        "{\n"
+        "    v_texCoord = a_texCoord;\n"
+        "    v_color = shade(u_color);\n"
+        "    gl_Position = u_mvp * a_position;\n"
+        "}\n";
+
+    // The previous converter also rewrote the declarations found in comments,
+    // e.g. "/* layout(std140, binding = 2) uniform uni2 {mat4 u_unused;};  vec4 a_unused; */"
+    const string expected = convertedHeader +
+        "\n"
+        "// Comments, preprocessor lines and nested braces\n"
+        "#define SCALE 2.0\n"
+        "#ifdef GL_ES\n"
+        "precision highp float;\n"
+        "#endif\n"
+        "\n"
+        "/* uniform mat4 u_unused; attribute vec4 a_unused; */\n"
+        "layout(std140, binding = 0) uniform blk_u_mvp {mat4 u_mvp;}; // uniform vec4 u_commented;\n"
+        "layout(std140, binding = 0) uniform blk_u_color {vec4 u_color;};\n"
+        "layout(location = 0) in vec4 a_position;\n"
+        "layout(location = 1) in vec2 a_texCoord;\n"
+        "layout(location = 0) out vec2 v_texCoord;\n"
+        "layout(location = 1) out vec4 v_color;\n"
+        "\n"
+        "vec4 shade(vec4 c)\n"
+        "{\n"
+        "    if(c.a > 0.5) {\n"
+        "        for(int i = 0; i < 2; ++i) {\n"
+        "            c.rgb *= SCALE;\n"
+        "        }\n"
+        "    } else {\n"
+        "        c = vec4(0.0);\n"
+        "    }\n"
+        "    return c;\n"
+        "}\n"
+        "\n"
+        "void main()\n"
+        "{\n"
+        "    v_texCoord = a_texCoord;\n"
+        "    v_color = shade(u_color);\n"
+        "    gl_Position = u_mvp * a_position;\n"
+        "    gl_Position.z = (gl_Position.z + gl_Position.w) / 2.0;\n"
+        "}\n";
+
+    ASSERT_EQ(expected, Convert(source, SHADER_TYPE_VERTEX));
+}
+
+TEST_F(ShaderConverterTest, FragmentShader)
+{
+    AddUniform("u_texture", 1);
+    AddUniform("u_tint", 0);
+    AddVarying("v_texCoord");
+    AddVarying("v_color");
+
+    const char *source =
+        "precision mediump float;\n"
+        "uniform sampler2D u_texture;\n"
+        "uniform vec4 u_tint;\n"
+        "varying vec2 v_texCoord;\n"
+        "varying vec4 v_color;\n"
+        "\n"
+        "void main()\n"
+        "{\n"
+        "    vec4 c = texture2D(u_texture, v_texCoord);\n"
+        "    if(c.a < 0.1) {\n"
+        "        discard;\n"
+        "    }\n"
+        "    gl_FragColor = c * v_color * u_tint;\n"
+        "}\n";
+
+    const string expected = convertedHeader +
+        "precision mediump float;\n"
+        "layout(binding = 1) uniform sampler2D u_texture;\n"
+        "layout(std140, binding = 0) uniform blk_u_tint {vec4 u_tint;};\n"
+        "layout(location = 0) in vec2 v_texCoord;\n"
+        "layout(location = 1) in vec4 v_color;\n"
+        "\n"
+        "void main()\n"
+        "{\n"
+        "    vec4 c = texture2D(u_texture, v_texCoord);\n"
+        "    if(c.a < 0.1) {\n"
+        "        discard;\n"
+        "    }\n"
+        "    gl_FragColor = c * v_color * u_tint;\n"
+        "}\n";
+
+    ASSERT_EQ(expected, Convert(source, SHADER_TYPE_FRAGMENT));
+}
+
+} //end of namespace
@@ -13,6 +13,7 @@ INSTALL_PATH="/usr/local"
 BUILD_FOLDER=build
 CROSS_COMPILATION_ARM=false
 WORKAROUNDS=ON
+BENCHMARKS=OFF
 
 #########################################################
 ####################### GLOVE ###########################
@@ -25,6 +26,7 @@ function buildGlove() {
           -DVULKAN_LIBRARY=$VULKAN_LIBRARY \
           -DTRACE_BUILD=$TRACE_BUILD \
           -DWORKAROUNDS=$WORKAROUNDS \
+          -DBENCHMARKS=$BENCHMARKS \
           -DCMAKE_TOOLCHAIN_FILE=$TOOLCHAIN_FILE \
           -DCMAKE_SYSROOT=$SYSROOT \
           -DCMAKE_INSTALL_PREFIX=$INSTALL_PATH ..
@@ -49,6 +51,11 @@ else
                 INSTALL_PATH=""
                 echo "Cross compiling for ARM"
                 ;;
+            # option to build the benchmarks
+            -b|--benchmarks)
+                BENCHMARKS=ON
+                echo "Building benchmarks"
+                ;;
             # option to build with Debug option
             -d|--debug)
                 BUILD_TYPE=Debug
@@ -92,6 +99,7 @@ else
                 echo "Unrecognized option: $option"
                 echo "Try the following:"
                 echo " -a | --arm-compile                   # cross build for ARM platform (default OFF)"
+                echo " -b | --benchmarks                    # build the benchmarks (default OFF)"
                 echo " -d | --debug                         # build in Debug mode (default Release)"
                 echo " -i | --install-path        (dir)     # set custom installation path"
                 echo " -s | --sysroot             (dir)     # set sysroot for cross compilation"